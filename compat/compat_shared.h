@@ -69,7 +69,7 @@ extern void (*failure_notify) (const char *);
 /* Limited due to delay pools */
 # define SQUID_MAXFD_LIMIT    ((signed int)FD_SETSIZE)
 
-#elif defined(USE_KQUEUE) || defined(USE_EPOLL) || defined(USE_DEVPOLL)
+#elif defined(USE_KQUEUE) || defined(USE_EPOLL) || defined(USE_DEVPOLL) || defined(USE_IO_URING)
 # define SQUID_FDSET_NOUSE 1
 
 #else
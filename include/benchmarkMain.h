@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#ifndef SQUID_INCLUDE_BENCHMARKMAIN_H
+#define SQUID_INCLUDE_BENCHMARKMAIN_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// Implements a micro-benchmark program main() function, printing results
+/// as one JSON object. Each benchmark step is calibrated to run for at least
+/// the minimum measurement time; the median of several such runs is reported
+/// to reduce noise. Programs may also report non-timing metrics.
+///
+/// Command line options:
+///   --min-time=SECONDS  minimum duration of one measurement (default 0.2)
+///   --repeat=N          measurements per benchmark (default 5)
+///   --filter=TEXT       only run benchmarks whose name contains TEXT
+class BenchmarkProgram
+{
+public:
+    /// one iteration of the measured code
+    using Step = std::function<void()>;
+
+    explicit BenchmarkProgram(const char *aName): name(aName) {}
+    virtual ~BenchmarkProgram() = default;
+
+    /// Runs before any benchmarks are registered.
+    /// Does nothing by default.
+    virtual void startup() {}
+
+    /// registers benchmarks using add()
+    virtual void addBenchmarks() = 0;
+
+    /// Implements main(), combining all the steps.
+    /// Must be called from main().
+    /// \returns desired main() result.
+    int run(int argc, char *argv[]);
+
+protected:
+    /// registers a benchmark; bytes is the input size processed by one step
+    /// (if any) and enables throughput reporting
+    void add(const char *benchName, const Step &step, size_t bytes = 0) {
+        benchmarks.push_back(Benchmark{benchName, step, bytes});
+    }
+
+    /// reports a named measurement that is not a timing (e.g., memory use)
+    void addMetric(const std::string &metricName, const double value) {
+        metrics.emplace_back(metricName, value);
+    }
+
+private:
+    struct Benchmark {
+        std::string name;
+        Step step;
+        size_t bytes;
+    };
+
+    bool parseOptions(int argc, char *argv[]);
+    void measure(const Benchmark &, const char *separator) const;
+
+    /// runs the step the given number of times; returns elapsed nanoseconds
+    static double Time(const Step &step, uint64_t iterations) {
+        const auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations; ++i)
+            step();
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    }
+
+    const char *name; ///< program name for the report
+    std::vector<Benchmark> benchmarks;
+    std::vector< std::pair<std::string, double> > metrics;
+
+    double minTime = 0.2; ///< seconds
+    int repeat = 5;
+    std::string filter;
+};
+
+int
+BenchmarkProgram::run(int argc, char *argv[])
+{
+    if (!parseOptions(argc, argv))
+        return EXIT_FAILURE;
+
+    startup();
+    addBenchmarks();
+
+    std::cout << "{\"program\": \"" << name << "\"" <<
+              ", \"min_time\": " << minTime <<
+              ", \"repeat\": " << repeat <<
+              ", \"results\": [";
+    const char *separator = "";
+    for (const auto &benchmark: benchmarks) {
+        if (!filter.empty() && benchmark.name.find(filter) == std::string::npos)
+            continue;
+        measure(benchmark, separator);
+        separator = ",";
+    }
+    std::cout << "\n], \"metrics\": {";
+    separator = "";
+    for (const auto &metric: metrics) {
+        std::cout << separator << "\n  \"" << metric.first << "\": " << metric.second;
+        separator = ",";
+    }
+    std::cout << "\n}}" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+bool
+BenchmarkProgram::parseOptions(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        const std::string option(argv[i]);
+        if (option.compare(0, 11, "--min-time=") == 0)
+            minTime = std::atof(option.c_str() + 11);
+        else if (option.compare(0, 9, "--repeat=") == 0)
+            repeat = std::atoi(option.c_str() + 9);
+        else if (option.compare(0, 9, "--filter=") == 0)
+            filter = option.substr(9);
+        else {
+            std::cerr << "usage: " << argv[0] << " [--min-time=SECONDS] [--repeat=N] [--filter=TEXT]" << std::endl;
+            return false;
+        }
+    }
+    if (minTime <= 0 || repeat <= 0) {
+        std::cerr << argv[0] << ": --min-time and --repeat must be positive" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void
+BenchmarkProgram::measure(const Benchmark &benchmark, const char *separator) const
+{
+    // warm up caches and lazy initialization, then calibrate
+    uint64_t iterations = 1;
+    const auto minNs = minTime * 1e9;
+    for (auto elapsed = Time(benchmark.step, iterations); elapsed < minNs; elapsed = Time(benchmark.step, iterations)) {
+        const auto factor = elapsed > 0 ? std::min(10.0, 1.2 * minNs / elapsed) : 10.0;
+        iterations = std::max<uint64_t>(iterations + 1, iterations * factor);
+    }
+
+    std::vector<double> samples;
+    for (int i = 0; i < repeat; ++i)
+        samples.push_back(Time(benchmark.step, iterations) / iterations);
+    std::sort(samples.begin(), samples.end());
+    const auto median = samples[samples.size() / 2];
+
+    std::cout << separator << "\n  {\"name\": \"" << benchmark.name << "\"" <<
+              ", \"iterations\": " << iterations <<
+              ", \"ns_per_op\": " << median <<
+              ", \"ns_per_op_min\": " << samples.front() <<
+              ", \"ns_per_op_max\": " << samples.back();
+    if (benchmark.bytes)
+        std::cout << ", \"bytes_per_op\": " << benchmark.bytes <<
+                  ", \"mb_per_s\": " << (benchmark.bytes * 1e3 / median);
+    std::cout << "}" << std::flush;
+}
+
+/// prevents the compiler from optimizing away a benchmarked computation
+template <typename T>
+inline void
+BenchmarkKeep(const T &value)
+{
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+#endif /* SQUID_INCLUDE_BENCHMARKMAIN_H */
+
@@ -15,6 +15,7 @@
 #include "ipc/mem/Segment.h"
 #include "ipc/Messages.h"
 #include "ipc/Port.h"
+#include "ipc/QueueWakeups.h"
 #include "ipc/TypedMsgHdr.h"
 #include "MemObject.h"
 #include "SquidConfig.h"
@@ -63,6 +64,7 @@ CollapsedForwarding::Init()
         AsyncCall::Pointer callback = asyncCall(17, 4, "CollapsedForwarding::HandleNewDataAtStart",
                                                 NullaryFunDialer(&CollapsedForwarding::HandleNewDataAtStart));
         ScheduleCallHere(callback);
+        Ipc::QueueWakeups::Subscribe(&CollapsedForwarding::HandleWakeup);
     }
 }
 
@@ -108,8 +110,10 @@ CollapsedForwarding::Broadcast(const sfileno index, const bool includingThisWork
 void
 CollapsedForwarding::Notify(const int workerId)
 {
-    // TODO: Count and report the total number of notifications, pops, pushes.
     debugs(17, 7, "to kid" << workerId);
+    if (Ipc::QueueWakeups::Notify(workerId))
+        return;
+
     Ipc::TypedMsgHdr msg;
     msg.setType(Ipc::mtCollapsedForwardingNotification);
     msg.putInt(KidIdentifier);
@@ -161,6 +165,15 @@ CollapsedForwarding::HandleNewDataAtStart()
     HandleNewData("at start");
 }
 
+/// handles Ipc::QueueWakeups notifications
+void
+CollapsedForwarding::HandleWakeup()
+{
+    // a wakeup does not tell which worker has pushed new items
+    queue->clearAllReaderSignals();
+    HandleNewData("after wakeup");
+}
+
 void
 CollapsedForwarding::StatQueue(std::ostream &os)
 {
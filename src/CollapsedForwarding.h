@@ -47,6 +47,7 @@ public:
 
 private:
     static void HandleNewDataAtStart();
+    static void HandleWakeup();
 
     typedef Ipc::MultiQueue Queue;
     static std::unique_ptr<Queue> queue; ///< IPC queue
@@ -15,6 +15,7 @@
 #include "CpuAffinitySet.h"
 #include "debug/Stream.h"
 #include "globals.h"
+#include "ipc/mem/Numa.h"
 #include "SquidConfig.h"
 #include "tools.h"
 
@@ -22,16 +23,41 @@
 
 static CpuAffinitySet *TheCpuAffinitySet = nullptr;
 
+/// the CPUs of the given NUMA node or nil
+static CpuAffinitySet *
+NumaNodeCpuSet(const int node)
+{
+    const auto cpus = Ipc::Mem::Numa::NodeCpus(node);
+    if (cpus.empty()) {
+        debugs(54, DBG_IMPORTANT, "WARNING: cannot find CPUs of NUMA node " << node <<
+               " in cpu_affinity_map");
+        return nullptr;
+    }
+
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (const auto cpu: cpus)
+        CPU_SET(cpu, &cpuSet);
+    const auto cpuAffinitySet = new CpuAffinitySet;
+    cpuAffinitySet->set(cpuSet);
+    return cpuAffinitySet;
+}
+
 void
 CpuAffinityInit()
 {
     Must(!TheCpuAffinitySet);
+    int node = 0;
     if (Config.cpuAffinityMap) {
         const int processNumber = InDaemonMode() ? KidIdentifier : 1;
         TheCpuAffinitySet = Config.cpuAffinityMap->calculateSet(processNumber);
+        node = Config.cpuAffinityMap->numaNode(processNumber);
+        if (!TheCpuAffinitySet && node > 0)
+            TheCpuAffinitySet = NumaNodeCpuSet(node);
         if (TheCpuAffinitySet)
             TheCpuAffinitySet->apply();
     }
+    Ipc::Mem::Numa::PreferNode(node);
 }
 
 void
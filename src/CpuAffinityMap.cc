@@ -15,39 +15,55 @@
 #include "debug/Stream.h"
 
 bool
-CpuAffinityMap::add(const std::vector<int> &aProcesses, const std::vector<int> &aCores)
+CpuAffinityMap::add(const std::vector<int> &aProcesses, const std::vector<int> &aCores, const std::vector<int> &aNodes)
 {
-    if (aProcesses.size() != aCores.size())
+    if (aCores.empty() && aNodes.empty())
+        return false;
+    if (!aCores.empty() && aProcesses.size() != aCores.size())
+        return false;
+    if (!aNodes.empty() && aProcesses.size() != aNodes.size())
         return false;
 
     for (size_t i = 0; i < aProcesses.size(); ++i) {
         const int process = aProcesses[i];
-        const int core = aCores[i];
-        if (process <= 0 || core <= 0)
+        const int core = aCores.empty() ? 0 : aCores[i];
+        const int node = aNodes.empty() ? 0 : aNodes[i];
+        if (process <= 0 || core < 0 || node < 0)
+            return false;
+        if ((!aCores.empty() && core == 0) || (!aNodes.empty() && node == 0))
             return false;
         theProcesses.push_back(process);
         theCores.push_back(core);
+        theNodes.push_back(node);
     }
 
     return true;
 }
 
-CpuAffinitySet *
-CpuAffinityMap::calculateSet(const int targetProcess) const
+/// the last positive value mapped to the given process or zero
+int
+CpuAffinityMap::find(const std::vector<int> &values, const int targetProcess, const char *const what) const
 {
-    Must(theProcesses.size() == theCores.size());
-    int core = 0;
+    Must(theProcesses.size() == values.size());
+    int value = 0;
     for (size_t i = 0; i < theProcesses.size(); ++i) {
         const int process = theProcesses[i];
-        if (process == targetProcess) {
-            if (core > 0) {
+        if (process == targetProcess && values[i] > 0) {
+            if (value > 0) {
                 debugs(54, DBG_CRITICAL, "WARNING: conflicting "
                        "'cpu_affinity_map' for process number " << process <<
-                       ", using the last core seen: " << theCores[i]);
+                       ", using the last " << what << " seen: " << values[i]);
             }
-            core = theCores[i];
+            value = values[i];
         }
     }
+    return value;
+}
+
+CpuAffinitySet *
+CpuAffinityMap::calculateSet(const int targetProcess) const
+{
+    const int core = find(theCores, targetProcess, "core");
     CpuAffinitySet *cpuAffinitySet = nullptr;
     if (core > 0) {
         cpuAffinitySet = new CpuAffinitySet;
@@ -59,3 +75,9 @@ CpuAffinityMap::calculateSet(const int targetProcess) const
     return cpuAffinitySet;
 }
 
+int
+CpuAffinityMap::numaNode(const int targetProcess) const
+{
+    return find(theNodes, targetProcess, "NUMA node");
+}
+
@@ -17,21 +17,31 @@ class CpuAffinitySet;
 class CpuAffinityMap
 {
 public:
-    /// append cpu_affinity_map option
-    bool add(const std::vector<int> &aProcesses, const std::vector<int> &aCores);
+    /// append cpu_affinity_map option; an empty aCores or aNodes list
+    /// means that the option does not map processes to cores or nodes
+    bool add(const std::vector<int> &aProcesses, const std::vector<int> &aCores, const std::vector<int> &aNodes);
 
     /// calculate CPU set for this process
     CpuAffinitySet *calculateSet(const int targetProcess) const;
 
+    /// the NUMA node for this process or zero
+    int numaNode(const int targetProcess) const;
+
     /// returns list of process numbers
     const std::vector<int> &processes() const { return theProcesses; }
 
-    /// returns list of cores
+    /// returns list of cores (zero for processes without a core)
     const std::vector<int> &cores() const { return theCores; }
 
+    /// returns list of NUMA nodes (zero for processes without a node)
+    const std::vector<int> &numaNodes() const { return theNodes; }
+
 private:
+    int find(const std::vector<int> &values, const int targetProcess, const char *what) const;
+
     std::vector<int> theProcesses; ///< list of process numbers
     std::vector<int> theCores; ///< list of cores
+    std::vector<int> theNodes; ///< list of NUMA nodes
 };
 
 #endif /* SQUID_SRC_CPUAFFINITYMAP_H */
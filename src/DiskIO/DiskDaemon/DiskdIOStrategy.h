@@ -30,6 +30,7 @@ public:
 };
 
 #include "DiskIO/DiskIOStrategy.h"
+#include "mem_node.h"
 #include "StoreIOState.h"
 
 class DiskFile;
@@ -94,7 +95,8 @@ private:
 };
 
 /// \ingroup diskd
-#define SHMBUF_BLKSZ SM_PAGE_SIZE
+/// shared buffers hold up to one swapped out mem_node page
+#define SHMBUF_BLKSZ static_cast<ssize_t>(mem_node::PageSize())
 
 /// \ingroup diskd
 struct diskd_stats_t {
@@ -27,13 +27,16 @@ public:
     class Config
     {
     public:
-        Config(): ioTimeout(0), ioRate(-1) {}
+        Config(): ioTimeout(0), ioRate(-1), ioDepth(0) {}
 
         /// canRead/Write should return false if expected I/O delay exceeds it
         time_msec_t ioTimeout; // not enforced if zero, which is the default
 
         /// shape I/O request stream to approach that many per second
         int ioRate; // not enforced if negative, which is the default
+
+        /// keep up to that many I/Os in progress; blocking I/O if zero
+        int ioDepth;
     };
 
     typedef RefCount<DiskFile> Pointer;
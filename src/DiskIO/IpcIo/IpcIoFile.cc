@@ -15,6 +15,7 @@
 #include "base/TextException.h"
 #include "DiskIO/IORequestor.h"
 #include "DiskIO/IpcIo/IpcIoFile.h"
+#include "DiskIO/IpcIo/IpcIoRing.h"
 #include "DiskIO/ReadRequest.h"
 #include "DiskIO/WriteRequest.h"
 #include "fd.h"
@@ -24,6 +25,7 @@
 #include "ipc/Messages.h"
 #include "ipc/Port.h"
 #include "ipc/Queue.h"
+#include "ipc/QueueWakeups.h"
 #include "ipc/StrandCoord.h"
 #include "ipc/StrandSearch.h"
 #include "ipc/UdsOp.h"
@@ -51,8 +53,9 @@ std::unique_ptr<IpcIoFile::Queue> IpcIoFile::queue;
 
 bool IpcIoFile::DiskerHandleMoreRequestsScheduled = false;
 
-static bool DiskerOpen(const SBuf &path, int flags, mode_t mode);
+static bool DiskerOpen(const SBuf &path, int flags, mode_t mode, int ioDepth);
 static void DiskerClose(const SBuf &path);
+static void DiskerStat(std::ostream &);
 
 /// IpcIo wrapper for debugs() streams; XXX: find a better class name
 struct SipcIo {
@@ -134,10 +137,11 @@ IpcIoFile::open(int flags, mode_t mode, RefCount<IORequestor> callback)
         AsyncCall::Pointer call = asyncCall(79, 4, "IpcIoFile::HandleMessagesAtStart",
                                             NullaryFunDialer(&IpcIoFile::HandleMessagesAtStart));
         ScheduleCallHere(call);
+        Ipc::QueueWakeups::Subscribe(&IpcIoFile::HandleWakeup);
     }
 
     if (IamDiskProcess()) {
-        error_ = !DiskerOpen(SBuf(dbName.termedBuf()), flags, mode);
+        error_ = !DiskerOpen(SBuf(dbName.termedBuf()), flags, mode, config.ioDepth);
         if (error_)
             return;
 
@@ -511,8 +515,10 @@ IpcIoFile::handleResponse(IpcIoMsg &ipcIo)
 void
 IpcIoFile::Notify(const int peerId)
 {
-    // TODO: Count and report the total number of notifications, pops, pushes.
     debugs(47, 7, "kid" << peerId);
+    if (Ipc::QueueWakeups::Notify(peerId))
+        return;
+
     Ipc::TypedMsgHdr msg;
     msg.setType(Ipc::mtIpcIoNotification); // TODO: add proper message type?
     msg.putInt(KidIdentifier);
@@ -544,6 +550,18 @@ IpcIoFile::HandleMessagesAtStart()
         HandleResponses("at start");
 }
 
+/// handles Ipc::QueueWakeups notifications
+void
+IpcIoFile::HandleWakeup()
+{
+    // a wakeup does not tell which queue has new items or who pushed them
+    queue->clearAllReaderSignals();
+    if (IamDiskProcess())
+        DiskerHandleRequests();
+    else
+        HandleResponses("after wakeup");
+}
+
 void
 IpcIoFile::StatQueue(std::ostream &os)
 {
@@ -551,6 +569,8 @@ IpcIoFile::StatQueue(std::ostream &os)
         os << "SMP disk I/O queues:\n";
         queue->stat<IpcIoMsg>(os);
     }
+    if (IamDiskProcess())
+        DiskerStat(os);
 }
 
 /// handles open request timeout
@@ -728,15 +748,28 @@ IpcIoPendingRequest::completeIo(IpcIoMsg *const response)
 
 static SBuf DbName; ///< full db file name
 static int TheFile = -1; ///< db file descriptor
+#if USE_IPCIO_RING
+static IpcIoRing *TheRing = nullptr; ///< asynchronous TheFile I/O (or nil)
+#endif
 
-static void
-diskerRead(IpcIoMsg &ipcIo)
+/// allocates a page for the data to be read
+/// \returns false (after preparing an error response) on failures
+static bool
+diskerGetReadPage(IpcIoMsg &ipcIo)
 {
     if (!Ipc::Mem::GetPage(Ipc::Mem::PageId::ioPage, ipcIo.page)) {
         ipcIo.len = 0;
         debugs(47,2, "run out of shared memory pages for IPC I/O");
-        return;
+        return false;
     }
+    return true;
+}
+
+static void
+diskerRead(IpcIoMsg &ipcIo)
+{
+    if (!diskerGetReadPage(ipcIo))
+        return;
 
     char *const buf = Ipc::Mem::PagePointer(ipcIo.page);
     const ssize_t read = pread(TheFile, buf, min(ipcIo.len, Ipc::Mem::PageSize()), ipcIo.offset);
@@ -822,6 +855,17 @@ diskerWrite(IpcIoMsg &ipcIo)
     Ipc::Mem::PutPage(ipcIo.page);
 }
 
+/// whether we must wait for some I/Os to complete before starting more
+static bool
+diskerRingFull()
+{
+#if USE_IPCIO_RING
+    return TheRing && TheRing->full();
+#else
+    return false;
+#endif
+}
+
 void
 IpcIoFile::DiskerHandleMoreRequests(void *source)
 {
@@ -904,7 +948,7 @@ IpcIoFile::DiskerHandleRequests()
     int popped = 0;
     int workerId = 0;
     IpcIoMsg ipcIo;
-    while (!WaitBeforePop() && queue->pop(workerId, ipcIo)) {
+    while (!diskerRingFull() && !WaitBeforePop() && queue->pop(workerId, ipcIo)) {
         ++popped;
 
         // at least one I/O per call is guaranteed if the queue is not empty
@@ -928,6 +972,12 @@ IpcIoFile::DiskerHandleRequests()
         }
     }
 
+#if USE_IPCIO_RING
+    // a single system call starts all I/Os popped above
+    if (TheRing)
+        TheRing->submit();
+#endif
+
     // TODO: consider using O_DIRECT with "elevator" optimization where we pop
     // requests first, then reorder the popped requests to optimize seek time,
     // then do I/O, then take a break, and come back for the next set of I/O
@@ -950,8 +1000,18 @@ IpcIoFile::DiskerHandleRequest(const int workerId, IpcIoMsg &ipcIo)
            ipcIo.len << " at " << ipcIo.offset <<
            " ipcIo" << workerId << '.' << ipcIo.requestId);
 
+    assert(ipcIo.workerPid >= 0);
+
+#if USE_IPCIO_RING
+    if (TheRing) {
+        // the ring responds when the I/O completes
+        if (ipcIo.command == IpcIo::cmdWrite || diskerGetReadPage(ipcIo))
+            return TheRing->start(workerId, ipcIo);
+        return DiskerRespond(workerId, ipcIo);
+    }
+#endif
+
     const auto workerPid = ipcIo.workerPid;
-    assert(workerPid >= 0);
 
     if (ipcIo.command == IpcIo::cmdRead)
         diskerRead(ipcIo);
@@ -960,6 +1020,13 @@ IpcIoFile::DiskerHandleRequest(const int workerId, IpcIoMsg &ipcIo)
 
     assert(ipcIo.workerPid == workerPid);
 
+    DiskerRespond(workerId, ipcIo);
+}
+
+/// sends the I/O results to the worker that requested the I/O
+void
+IpcIoFile::DiskerRespond(const int workerId, IpcIoMsg &ipcIo)
+{
     debugs(47, 7, "pushing " << SipcIo(workerId, ipcIo, KidIdentifier));
 
     try {
@@ -977,7 +1044,7 @@ IpcIoFile::DiskerHandleRequest(const int workerId, IpcIoMsg &ipcIo)
 }
 
 static bool
-DiskerOpen(const SBuf &path, int flags, mode_t)
+DiskerOpen(const SBuf &path, int flags, mode_t, const int ioDepth)
 {
     assert(TheFile < 0);
 
@@ -993,12 +1060,27 @@ DiskerOpen(const SBuf &path, int flags, mode_t)
 
     ++store_open_disk_fd;
     debugs(79,3, "rock db opened " << DbName << ": FD " << TheFile);
+
+    if (ioDepth > 0) {
+#if USE_IPCIO_RING
+        TheRing = IpcIoRing::Create(TheFile, DbName, ioDepth);
+#else
+        debugs(47, DBG_IMPORTANT, "WARNING: " << DbName << " ignores io-depth: " <<
+               "this Squid was built without io_uring support");
+#endif
+    }
+
     return true;
 }
 
 static void
 DiskerClose(const SBuf &path)
 {
+#if USE_IPCIO_RING
+    delete TheRing;
+    TheRing = nullptr;
+#endif
+
     if (TheFile >= 0) {
         file_close(TheFile);
         debugs(79,3, "rock db closed " << path << ": FD " << TheFile);
@@ -1008,6 +1090,18 @@ DiskerClose(const SBuf &path)
     DbName.clear();
 }
 
+/// reports disker I/O statistics
+static void
+DiskerStat(std::ostream &os)
+{
+#if USE_IPCIO_RING
+    if (TheRing)
+        TheRing->stat(os);
+#else
+    (void)os;
+#endif
+}
+
 /// reports our needs for shared memory pages to Ipc::Mem::Pages
 /// and initializes shared memory segments used by IpcIoFile
 class IpcIoRr: public Ipc::Mem::RegisteredRunner
@@ -60,6 +60,7 @@ public:
 };
 
 class IpcIoPendingRequest;
+class IpcIoRing;
 
 /// In a worker process, represents a single (remote) cache_dir disker file.
 /// In a disker process, used as a bunch of static methods handling that file.
@@ -99,6 +100,7 @@ public:
 
 protected:
     friend class IpcIoPendingRequest;
+    friend class IpcIoRing;
     void openCompleted(const Ipc::StrandMessage *);
     void readCompleted(ReadRequest *readRequest, IpcIoMsg *const response);
     void writeCompleted(WriteRequest *writeRequest, const IpcIoMsg *const response);
@@ -126,9 +128,11 @@ private:
     static void DiskerHandleMoreRequests(void*);
     static void DiskerHandleRequests();
     static void DiskerHandleRequest(const int workerId, IpcIoMsg &ipcIo);
+    static void DiskerRespond(const int workerId, IpcIoMsg &ipcIo);
     static bool WaitBeforePop();
 
     static void HandleMessagesAtStart();
+    static void HandleWakeup();
 
 private:
     const String dbName; ///< the name of the file we are managing
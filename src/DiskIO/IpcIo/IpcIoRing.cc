@@ -0,0 +1,454 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+/* DEBUG: section 47    Store Directory Routines */
+
+#include "squid.h"
+#include "DiskIO/IpcIo/IpcIoRing.h"
+
+#if USE_IPCIO_RING
+
+#include "comm/Loops.h"
+#include "event.h"
+#include "fd.h"
+#include "globals.h"
+#include "ipc/mem/Pages.h"
+#include "StatCounters.h"
+#include "time/gadgets.h"
+
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#if HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+#if HAVE_SYS_SYSCALL_H
+#include <sys/syscall.h>
+#endif
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+/// how many times we try to write leftovers of a partially written page;
+/// mimics blocking disker writes
+static const int WriteAttemptLimit = 10;
+
+IpcIoRing *
+IpcIoRing::Create(const int fd, const SBuf &aDbName, const unsigned int aDepth)
+{
+    const auto ring = new IpcIoRing(fd, aDbName, aDepth);
+    if (ring->setup())
+        return ring;
+    delete ring;
+    return nullptr;
+}
+
+IpcIoRing::IpcIoRing(const int fd, const SBuf &aDbName, const unsigned int aDepth):
+    file(fd),
+    dbName(aDbName),
+    depth(aDepth),
+    slots(aDepth)
+{
+    assert(depth > 0);
+    freeSlots.reserve(depth);
+    for (size_t i = depth; i > 0; --i)
+        freeSlots.push_back(i - 1);
+}
+
+IpcIoRing::~IpcIoRing()
+{
+    // requests still in progress are abandoned; their workers time out
+    abandonRequests();
+
+    if (retryScheduled)
+        eventDelete(&IpcIoRing::RetrySubmit, this);
+
+    if (eventFd >= 0) {
+        Comm::SetSelect(eventFd, COMM_SELECT_READ, nullptr, nullptr, 0);
+        fd_close(eventFd);
+        close(eventFd);
+    }
+
+    if (sqes)
+        munmap(sqes, sqesSize);
+
+    if (ringMemory)
+        munmap(ringMemory, ringMemorySize);
+
+    if (ringFd >= 0) {
+        fd_close(ringFd);
+        close(ringFd);
+    }
+}
+
+/// creates the kernel rings and the completion eventfd
+/// \returns false (after reporting the problem) on failures
+bool
+IpcIoRing::setup()
+{
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    // up to depth requests are in progress, so completions cannot overflow
+    // the default completion ring, which is twice as large
+    ringFd = syscall(__NR_io_uring_setup, depth, &params);
+    if (ringFd < 0) {
+        const auto xerrno = errno;
+        debugs(47, DBG_IMPORTANT, "WARNING: " << dbName << " cannot use io_uring: " <<
+               "io_uring_setup(): " << xstrerr(xerrno) << Debug::Extra <<
+               "advice: Use Linux 5.6 or later or remove the io-depth option");
+        return false;
+    }
+    fd_open(ringFd, FD_FILE, "disker io_uring");
+
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+        debugs(47, DBG_IMPORTANT, "WARNING: " << dbName << " cannot use io_uring: " <<
+               "the kernel lacks IORING_FEAT_SINGLE_MMAP" << Debug::Extra <<
+               "advice: Use Linux 5.6 or later or remove the io-depth option");
+        return false;
+    }
+
+    ringMemorySize = std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                              params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+    const auto rings = mmap(nullptr, ringMemorySize, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+    if (rings == MAP_FAILED) {
+        const auto xerrno = errno;
+        debugs(47, DBG_IMPORTANT, "WARNING: " << dbName << " cannot use io_uring: ring mmap(): " << xstrerr(xerrno));
+        return false;
+    }
+    ringMemory = rings;
+
+    sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    const auto entries = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE,
+                              MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+    if (entries == MAP_FAILED) {
+        const auto xerrno = errno;
+        debugs(47, DBG_IMPORTANT, "WARNING: " << dbName << " cannot use io_uring: submission entries mmap(): " << xstrerr(xerrno));
+        return false;
+    }
+    sqes = static_cast<io_uring_sqe *>(entries);
+
+    const auto base = static_cast<char *>(rings);
+    sqHead = reinterpret_cast<unsigned *>(base + params.sq_off.head);
+    sqTail = reinterpret_cast<unsigned *>(base + params.sq_off.tail);
+    sqMask = reinterpret_cast<unsigned *>(base + params.sq_off.ring_mask);
+    sqArray = reinterpret_cast<unsigned *>(base + params.sq_off.array);
+    cqHead = reinterpret_cast<unsigned *>(base + params.cq_off.head);
+    cqTail = reinterpret_cast<unsigned *>(base + params.cq_off.tail);
+    cqMask = reinterpret_cast<unsigned *>(base + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe *>(base + params.cq_off.cqes);
+
+    eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (eventFd < 0) {
+        const auto xerrno = errno;
+        debugs(47, DBG_IMPORTANT, "WARNING: " << dbName << " cannot use io_uring: eventfd(): " << xstrerr(xerrno));
+        return false;
+    }
+    fd_open(eventFd, FD_PIPE, "disker io_uring completions");
+
+    if (syscall(__NR_io_uring_register, ringFd, IORING_REGISTER_EVENTFD, &eventFd, 1) < 0) {
+        const auto xerrno = errno;
+        debugs(47, DBG_IMPORTANT, "WARNING: " << dbName << " cannot use io_uring: IORING_REGISTER_EVENTFD: " << xstrerr(xerrno));
+        return false;
+    }
+
+    Comm::SetSelect(eventFd, COMM_SELECT_READ, &IpcIoRing::HandleCompletions, this, 0);
+
+    debugs(47, 2, dbName << " uses io_uring FD " << ringFd << " with up to " << depth << " concurrent I/Os");
+    return true;
+}
+
+void
+IpcIoRing::start(const int workerId, const IpcIoMsg &ipcIo)
+{
+    assert(!full());
+    const auto slot = freeSlots.back();
+    freeSlots.pop_back();
+
+    auto &request = slots[slot];
+    request = Request();
+    request.msg = ipcIo;
+    request.msg.len = std::min(ipcIo.len, Ipc::Mem::PageSize());
+    request.workerId = workerId;
+    request.started = current_time;
+    queue(slot);
+}
+
+/// fills the next submission entry for the given request (or its leftovers)
+void
+IpcIoRing::queue(const size_t slot)
+{
+    auto &request = slots[slot];
+    const auto &msg = request.msg;
+
+    // at most depth entries are queued because each has its own slot
+    const auto tail = *sqTail;
+    assert(tail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) <= *sqMask);
+    const auto index = tail & *sqMask;
+    auto &sqe = sqes[index];
+    memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = msg.command == IpcIo::cmdRead ? IORING_OP_READ : IORING_OP_WRITE;
+    sqe.fd = file;
+    sqe.addr = reinterpret_cast<uint64_t>(Ipc::Mem::PagePointer(msg.page) + request.done);
+    sqe.len = msg.len - request.done;
+    sqe.off = msg.offset + request.done;
+    sqe.user_data = slot;
+    sqArray[index] = index;
+    __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+    ++pending;
+}
+
+void
+IpcIoRing::submit()
+{
+    if (!pending)
+        return;
+
+    Count(depths, depth - freeSlots.size());
+
+    while (pending) {
+        const auto submitted = syscall(__NR_io_uring_enter, ringFd, pending, 0, 0, nullptr, 0);
+        ++submitCalls;
+        if (submitted >= 0) {
+            pending -= submitted;
+            continue;
+        }
+
+        const auto xerrno = errno;
+        if (xerrno == EINTR)
+            continue;
+
+        if (xerrno == EAGAIN || xerrno == EBUSY) {
+            // the kernel lacks resources or waits for us to reap completions
+            if (reapCompletions())
+                continue;
+            debugs(47, 3, dbName << " retries " << pending << " submissions later: " << xstrerr(xerrno));
+            if (!retryScheduled) {
+                eventAdd("IpcIoRing::RetrySubmit", &IpcIoRing::RetrySubmit, this, 0.001, 0, false);
+                retryScheduled = true;
+            }
+            return;
+        }
+
+        fatalf(SQUIDSBUFPH ": io_uring_enter(): %s\n", SQUIDSBUFPRINT(dbName), xstrerr(xerrno));
+    }
+
+    maxInFlight = std::max(maxInFlight, static_cast<unsigned int>(depth - freeSlots.size()));
+}
+
+void
+IpcIoRing::HandleCompletions(int, void *data)
+{
+    const auto ring = static_cast<IpcIoRing *>(data);
+    ring->handleCompletions();
+}
+
+void
+IpcIoRing::RetrySubmit(void *data)
+{
+    const auto ring = static_cast<IpcIoRing *>(data);
+    ring->retryScheduled = false;
+    ring->submit();
+}
+
+/// reaps all posted completions and resumes handling of queued requests
+void
+IpcIoRing::handleCompletions()
+{
+    uint64_t signals = 0;
+    if (::read(eventFd, &signals, sizeof(signals)) < 0 && errno != EAGAIN) {
+        const auto xerrno = errno;
+        debugs(47, DBG_IMPORTANT, "ERROR: " << dbName << " io_uring eventfd read failure: " << xstrerr(xerrno));
+    }
+    Comm::SetSelect(eventFd, COMM_SELECT_READ, &IpcIoRing::HandleCompletions, this, 0);
+
+    reapCompletions();
+
+    submit(); // leftovers of partial writes, if any
+
+    // full() may have stopped IpcIoFile from popping more requests
+    if (!IpcIoFile::DiskerHandleMoreRequestsScheduled)
+        IpcIoFile::DiskerHandleRequests();
+}
+
+/// handles all posted completions
+/// \returns whether there were any
+bool
+IpcIoRing::reapCompletions()
+{
+    const auto tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+    const auto head = *cqHead;
+    for (auto pos = head; pos != tail; ++pos) {
+        const auto cqe = cqes[pos & *cqMask];
+        __atomic_store_n(cqHead, pos + 1, __ATOMIC_RELEASE);
+        complete(cqe);
+    }
+    return head != tail;
+}
+
+/// waits for the kernel to finish requests in progress (so that it no longer
+/// accesses their pages) and frees their pages without responding
+void
+IpcIoRing::abandonRequests()
+{
+    if (!cqes)
+        return; // setup() failed before any requests could start
+
+    while (freeSlots.size() < depth) {
+        const auto inFlight = depth - freeSlots.size();
+        const auto submitted = syscall(__NR_io_uring_enter, ringFd, pending, inFlight, IORING_ENTER_GETEVENTS, nullptr, 0);
+        if (submitted < 0) {
+            const auto xerrno = errno;
+            if (xerrno == EINTR || xerrno == EAGAIN || xerrno == EBUSY)
+                continue;
+            // the kernel may still use the pages; leaking them is safer
+            debugs(47, DBG_IMPORTANT, "ERROR: " << dbName << " abandons " << inFlight <<
+                   " I/O pages: io_uring_enter(): " << xstrerr(xerrno));
+            return;
+        }
+        pending -= submitted;
+
+        const auto tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+        for (auto head = *cqHead; head != tail; ++head) {
+            const auto slot = static_cast<size_t>(cqes[head & *cqMask].user_data);
+            __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+            assert(slot < slots.size());
+            debugs(47, 5, dbName << " abandons ipcIo" << slots[slot].workerId << '.' << slots[slot].msg.requestId);
+            Ipc::Mem::PutPage(slots[slot].msg.page);
+            freeSlots.push_back(slot);
+        }
+    }
+}
+
+/// handles the result of one system call made by the kernel for us
+void
+IpcIoRing::complete(const io_uring_cqe &cqe)
+{
+    const auto slot = static_cast<size_t>(cqe.user_data);
+    assert(slot < slots.size());
+    auto &request = slots[slot];
+    auto &msg = request.msg;
+    ++request.attempts;
+
+    if (msg.command == IpcIo::cmdRead) {
+        ++statCounter.syscalls.disk.reads;
+        fd_bytes(file, cqe.res, IoDirection::Read);
+        if (cqe.res >= 0) {
+            msg.xerrno = 0;
+            msg.len = static_cast<size_t>(cqe.res);
+        } else {
+            msg.xerrno = -cqe.res;
+            msg.len = 0;
+            debugs(47, 5, "disker" << KidIdentifier << " read error: " << msg.xerrno);
+        }
+        finish(slot);
+        return;
+    }
+
+    ++statCounter.syscalls.disk.writes;
+    fd_bytes(file, cqe.res, IoDirection::Write);
+
+    if (cqe.res < 0) {
+        msg.xerrno = -cqe.res;
+        debugs(47, DBG_IMPORTANT, "ERROR: " << dbName << " failure writing " <<
+               (msg.len - request.done) << '/' << msg.len << " at " << msg.offset <<
+               '+' << request.done << " on " << request.attempts << " try: " <<
+               xstrerr(msg.xerrno));
+        msg.len = request.done;
+        finish(slot);
+        return;
+    }
+
+    msg.xerrno = 0;
+    request.done += static_cast<size_t>(cqe.res);
+    if (request.done >= msg.len) {
+        finish(slot);
+        return;
+    }
+
+    if (request.attempts >= WriteAttemptLimit) {
+        debugs(47, DBG_IMPORTANT, "ERROR: " << dbName << " exhausted all " <<
+               WriteAttemptLimit << " attempts while writing " <<
+               (msg.len - request.done) << '/' << msg.len << " at " <<
+               msg.offset << '+' << request.done);
+        msg.len = request.done;
+        finish(slot);
+        return;
+    }
+
+    // partial writes to disk do happen; write the leftovers
+    queue(slot);
+}
+
+/// sends the response for the given completed request and frees its slot
+void
+IpcIoRing::finish(const size_t slot)
+{
+    auto &request = slots[slot];
+    Count(latencies, std::max<int64_t>(tvSubUsec(request.started, current_time), 0));
+
+    if (request.msg.command == IpcIo::cmdRead) {
+        ++reads;
+    } else {
+        ++writes;
+        Ipc::Mem::PutPage(request.msg.page);
+    }
+
+    IpcIoFile::DiskerRespond(request.workerId, request.msg);
+    freeSlots.push_back(slot);
+}
+
+/// adds the value to the histogram with power-of-two bins
+void
+IpcIoRing::Count(Histogram &histogram, uint64_t value)
+{
+    int bin = 0;
+    while (value > 1 && bin < HistogramBins - 1) {
+        value >>= 1;
+        ++bin;
+    }
+    ++histogram[bin];
+}
+
+/// prints non-empty histogram bins
+void
+IpcIoRing::Dump(std::ostream &os, const char *label, const Histogram &histogram)
+{
+    os << label << ":\n";
+    for (int bin = 0; bin < HistogramBins; ++bin) {
+        if (!histogram[bin])
+            continue;
+        const auto low = bin ? (uint64_t(1) << bin) : 0;
+        os << std::setw(12) << low;
+        if (bin < HistogramBins - 1)
+            os << " - " << std::setw(12) << std::left << ((uint64_t(1) << (bin + 1)) - 1) << std::right;
+        else
+            os << " or more       ";
+        os << ' ' << std::setw(12) << histogram[bin] << "\n";
+    }
+}
+
+void
+IpcIoRing::stat(std::ostream &os) const
+{
+    os << "\nDisker " << KidIdentifier << " io_uring for " << dbName << ":\n";
+    os << "Maximum concurrent I/Os: " << depth << "\n";
+    os << "I/Os in progress: " << (depth - freeSlots.size()) <<
+       " (at most " << maxInFlight << " so far)\n";
+    os << "Completed reads: " << reads << "\n";
+    os << "Completed writes: " << writes << "\n";
+    os << "io_uring_enter(2) calls: " << submitCalls << "\n";
+    Dump(os, "I/Os in progress when submitting more", depths);
+    Dump(os, "I/O latency histogram (microseconds)", latencies);
+}
+
+#endif /* USE_IPCIO_RING */
+
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#ifndef SQUID_SRC_DISKIO_IPCIO_IPCIORING_H
+#define SQUID_SRC_DISKIO_IPCIO_IPCIORING_H
+
+// io_uring(7) is used through raw system calls; no library is needed
+#if HAVE_LINUX_IO_URING_H && HAVE_SYS_EVENTFD_H
+#define USE_IPCIO_RING 1
+#else
+#define USE_IPCIO_RING 0
+#endif
+
+#if USE_IPCIO_RING
+
+#include "DiskIO/IpcIo/IpcIoFile.h"
+#include "sbuf/SBuf.h"
+
+#include <iosfwd>
+#include <vector>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+/// In a disker process, keeps up to a configured number of IpcIoMsg reads
+/// and writes in progress using Linux io_uring(7). Completions are
+/// signaled through an eventfd(2) watched by the main loop.
+class IpcIoRing
+{
+public:
+    /// \returns a ring doing I/O on the given file or nil if the kernel
+    /// does not support io_uring
+    static IpcIoRing *Create(int fd, const SBuf &dbName, unsigned int depth);
+
+    IpcIoRing(IpcIoRing &&) = delete; // no copying of any kind
+    ~IpcIoRing();
+
+    /// whether the maximum number of I/O requests are in progress
+    bool full() const { return freeSlots.empty(); }
+
+    /// queues a read into the already allocated ipcIo.page or a write of
+    /// the ipcIo.page contents; the ring owns the page until the response
+    void start(int workerId, const IpcIoMsg &);
+
+    /// hands all queued I/O requests to the kernel
+    void submit();
+
+    /// prints queue depth and I/O latency statistics
+    void stat(std::ostream &) const;
+
+private:
+    /// an I/O request in progress
+    class Request
+    {
+    public:
+        IpcIoMsg msg; ///< the request message (updated to become a response)
+        int workerId = -1; ///< the kid ID of the I/O requestor
+        size_t done = 0; ///< bytes written so far
+        int attempts = 0; ///< the number of system calls used so far
+        timeval started = {}; ///< when the request was first queued
+    };
+
+    /// the number of histogram bins; the last bin collects all larger values
+    static const int HistogramBins = 24;
+    using Histogram = uint64_t[HistogramBins];
+
+    IpcIoRing(int fd, const SBuf &dbName, unsigned int depth);
+    bool setup();
+    void queue(size_t slot);
+    void handleCompletions();
+    bool reapCompletions();
+    void complete(const io_uring_cqe &);
+    void finish(size_t slot);
+    void abandonRequests();
+
+    static void HandleCompletions(int fd, void *data);
+    static void RetrySubmit(void *data);
+    static void Count(Histogram &, uint64_t value);
+    static void Dump(std::ostream &, const char *label, const Histogram &);
+
+    const int file; ///< the db file descriptor
+    const SBuf dbName; ///< the db file name, for debugging
+    const unsigned int depth; ///< the maximum number of requests in progress
+
+    int ringFd = -1; ///< io_uring(7) instance descriptor
+    int eventFd = -1; ///< eventfd(2) signaled on completions
+
+    /* kernel-shared ring pointers */
+    unsigned *sqHead = nullptr;
+    unsigned *sqTail = nullptr;
+    unsigned *sqMask = nullptr;
+    unsigned *sqArray = nullptr;
+    io_uring_sqe *sqes = nullptr;
+    unsigned *cqHead = nullptr;
+    unsigned *cqTail = nullptr;
+    unsigned *cqMask = nullptr;
+    io_uring_cqe *cqes = nullptr;
+
+    void *ringMemory = nullptr; ///< the mapped rings
+    size_t ringMemorySize = 0;
+    size_t sqesSize = 0;
+
+    unsigned int pending = 0; ///< requests queued since the last submit()
+    bool retryScheduled = false; ///< whether RetrySubmit() will be called
+
+    std::vector<Request> slots; ///< requests indexed by io_uring user_data
+    std::vector<size_t> freeSlots; ///< indexes of unused slots
+
+    /* statistics */
+    uint64_t reads = 0; ///< reads completed
+    uint64_t writes = 0; ///< writes completed
+    uint64_t submitCalls = 0; ///< io_uring_enter(2) calls
+    unsigned int maxInFlight = 0; ///< the maximum number of concurrent requests
+    Histogram depths = {}; ///< requests in progress when submitting
+    Histogram latencies = {}; ///< request duration in microseconds
+};
+
+#endif /* USE_IPCIO_RING */
+
+#endif /* SQUID_SRC_DISKIO_IPCIO_IPCIORING_H */
+
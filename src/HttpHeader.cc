@@ -16,6 +16,7 @@
 #include "base64.h"
 #include "globals.h"
 #include "http/ContentLengthInterpreter.h"
+#include "http/one/MimeScanner.h"
 #include "HttpHdrCc.h"
 #include "HttpHdrContRange.h"
 #include "HttpHdrScTarget.h" // also includes HttpHdrSc.h
@@ -369,45 +370,43 @@ HttpHeader::parse(const char *header_start, size_t hdrLen, Http::ContentLengthIn
     while (field_ptr < header_end) {
         const char *field_start = field_ptr;
         const char *field_end;
+        const char *name_end = nullptr;
 
         const char *hasBareCr = nullptr;
         size_t lines = 0;
         do {
             const char *this_line = field_ptr;
-            field_ptr = (const char *)memchr(field_ptr, '\n', header_end - field_ptr);
+            const auto line = Http::One::ScanMimeLine(this_line, header_end - this_line);
             ++lines;
 
-            if (!field_ptr) {
+            if (!line.terminated) {
                 // missing <LF>
                 clean();
                 return 0;
             }
 
-            field_end = field_ptr;
+            field_end = this_line + line.length;
+            field_ptr = field_end + 1;    /* Move to next line */
 
-            ++field_ptr;    /* Move to next line */
+            if (lines == 1 && line.colon != line.npos)
+                name_end = this_line + line.colon;
 
+            size_t crs = line.crs;
             if (field_end > this_line && field_end[-1] == '\r') {
                 --field_end;    /* Ignore CR LF */
+                --crs;
 
-                if (owner == hoRequest && field_end > this_line) {
-                    bool cr_only = true;
-                    for (const char *p = this_line; p < field_end && cr_only; ++p) {
-                        if (*p != '\r')
-                            cr_only = false;
-                    }
-                    if (cr_only) {
-                        debugs(55, DBG_IMPORTANT, "SECURITY WARNING: Rejecting HTTP request with a CR+ "
-                               "header field to prevent request smuggling attacks: {" <<
-                               getStringPrefix(header_start, hdrLen) << "}");
-                        clean();
-                        return 0;
-                    }
+                if (owner == hoRequest && field_end > this_line && crs == size_t(field_end - this_line)) {
+                    debugs(55, DBG_IMPORTANT, "SECURITY WARNING: Rejecting HTTP request with a CR+ "
+                           "header field to prevent request smuggling attacks: {" <<
+                           getStringPrefix(header_start, hdrLen) << "}");
+                    clean();
+                    return 0;
                 }
             }
 
             /* Barf on stray CR characters */
-            if (memchr(this_line, '\r', field_end - this_line)) {
+            if (crs) {
                 hasBareCr = "bare CR";
                 debugs(55, warnOnError, "WARNING: suspicious CR characters in HTTP header {" <<
                        getStringPrefix(field_start, field_end-field_start) << "}");
@@ -444,7 +443,7 @@ HttpHeader::parse(const char *header_start, size_t hdrLen, Http::ContentLengthIn
             break;      /* terminating blank line */
         }
 
-        const auto e = HttpHeaderEntry::parse(field_start, field_end, owner);
+        const auto e = HttpHeaderEntry::parse(field_start, field_end, owner, name_end);
         if (!e) {
             debugs(55, warnOnError, "WARNING: unparsable HTTP header field {" <<
                    getStringPrefix(field_start, field_end-field_start) << "}");
@@ -1389,10 +1388,11 @@ HttpHeaderEntry::~HttpHeaderEntry()
 
 /* parses and inits header entry, returns true/false */
 HttpHeaderEntry *
-HttpHeaderEntry::parse(const char *field_start, const char *field_end, const http_hdr_owner_type msgType)
+HttpHeaderEntry::parse(const char *field_start, const char *field_end, const http_hdr_owner_type msgType, const char *name_end)
 {
     /* note: name_start == field_start */
-    const char *name_end = (const char *)memchr(field_start, ':', field_end - field_start);
+    if (!name_end)
+        name_end = (const char *)memchr(field_start, ':', field_end - field_start);
     int name_len = name_end ? name_end - field_start :0;
     const char *value_start = field_start + name_len + 1;   /* skip ':' */
     /* note: value_end == field_end */
@@ -54,7 +54,8 @@ class HttpHeaderEntry
 public:
     HttpHeaderEntry(Http::HdrType id, const SBuf &name, const char *value);
     ~HttpHeaderEntry();
-    static HttpHeaderEntry *parse(const char *field_start, const char *field_end, const http_hdr_owner_type msgType);
+    /// \param name_end the first ':' in the field if the caller has found it already
+    static HttpHeaderEntry *parse(const char *field_start, const char *field_end, const http_hdr_owner_type msgType, const char *name_end = nullptr);
     HttpHeaderEntry *clone() const;
     void packInto(Packable *p) const;
     int getInt() const;
@@ -12,6 +12,7 @@
 #include "AccessLogEntry.h"
 #include "acl/AclSizeLimit.h"
 #include "acl/FilledChecklist.h"
+#include "acl/Memo.h"
 #include "CachePeer.h"
 #include "client_side.h"
 #include "client_side_request.h"
@@ -143,6 +144,7 @@ HttpRequest::clean()
     myportname.clean();
 
     theNotes = nullptr;
+    aclMemo_ = nullptr;
 
     tag.clean();
 #if USE_AUTH
@@ -755,6 +757,14 @@ HttpRequest::notes()
     return theNotes;
 }
 
+Acl::MemoPointer
+HttpRequest::aclMemo()
+{
+    if (!aclMemo_)
+        aclMemo_ = new Acl::Memo;
+    return aclMemo_;
+}
+
 void
 UpdateRequestNotes(ConnStateData *csd, HttpRequest &request, NotePairs const &helperNotes)
 {
@@ -9,6 +9,7 @@
 #ifndef SQUID_SRC_HTTPREQUEST_H
 #define SQUID_SRC_HTTPREQUEST_H
 
+#include "acl/forward.h"
 #include "anyp/Uri.h"
 #include "base/CbcPointer.h"
 #include "dns/forward.h"
@@ -244,6 +245,10 @@ public:
     NotePairs::Pointer notes();
     bool hasNotes() const { return bool(theNotes) && !theNotes->empty(); }
 
+    /// \returns ACL evaluation results remembered for this request,
+    /// creating an empty Acl::Memo if needed
+    Acl::MemoPointer aclMemo();
+
     void configureContentLengthInterpreter(Http::ContentLengthInterpreter &) override {}
 
     /// Check whether the message framing headers are valid.
@@ -263,6 +268,9 @@ private:
     /// annotations added by the note directive and helpers
     /// and(or) by annotate_transaction/annotate_client ACLs.
     NotePairs::Pointer theNotes;
+
+    /// ACL evaluation results remembered for acl_memoization (or nil)
+    Acl::MemoPointer aclMemo_;
 protected:
     void packFirstLineInto(Packable * p, bool full_uri) const override;
 
@@ -198,6 +198,11 @@ public:
         int32_t index = -1; ///< entry position inside the memory cache
         int64_t offset = 0; ///< bytes written/read to/from the memory cache so far
 
+        /// Whether entry bytes after data_hdr end are read directly from the
+        /// (complete and reading-locked) memory cache entry instead of being
+        /// copied into data_hdr first.
+        bool inPlace = false;
+
         Store::IoStatus io = Store::ioUndecided; ///< current I/O state
     };
     MemCache memCache; ///< current [shared] memory caching state for the entry
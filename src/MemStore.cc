@@ -25,6 +25,8 @@
 #include "StoreStats.h"
 #include "tools.h"
 
+#include <vector>
+
 /// shared memory segment path to use for MemStore maps
 static const auto MapLabel = "cache_mem_map";
 /// shared memory segment path to use for the free slices index
@@ -33,6 +35,25 @@ static const char *SpaceLabel = "cache_mem_space";
 static const char *ExtrasLabel = "cache_mem_ex";
 // TODO: sync with Rock::SwapDir::*Path()
 
+/// the number of cache pages of the given size that fit into the given
+/// percentage of cache_mem
+static int64_t
+CachePageLimit(const size_t pageSize, const int percent)
+{
+    const auto bytes = Config.memMaxSize / 100 * percent + Config.memMaxSize % 100 * percent / 100;
+    return bytes / pageSize;
+}
+
+/// the cache_mem percentage not reserved by memory_cache_page_class
+static int
+DefaultPageClassPercent()
+{
+    auto percent = 100;
+    for (const auto &pageClass: Config.memPageClasses)
+        percent -= pageClass.second;
+    return percent;
+}
+
 /// Packs to shared memory, allocating new slots/pages as needed.
 /// Requires an Ipc::StoreMapAnchor locked for writing.
 class ShmWriter: public Packable
@@ -56,6 +77,9 @@ public:
 
     uint64_t totalWritten; ///< cumulative number of bytes appended so far
 
+    /// the total number of bytes the caller expects to append (or negative)
+    int64_t expectedSize;
+
 protected:
     void copyToShm();
     void copyToShmSlice(Ipc::StoreMap::Slice &slice);
@@ -77,6 +101,7 @@ ShmWriter::ShmWriter(MemStore &aStore, StoreEntry *anEntry, const sfileno aFileN
     firstSlice(aFirstSlice),
     lastSlice(firstSlice),
     totalWritten(0),
+    expectedSize(-1),
     store(aStore),
     fileNo(aFileNo),
     buf(nullptr),
@@ -122,7 +147,10 @@ ShmWriter::copyToShm()
 
     // fill, skip slices that are already full
     while (bufWritten < bufSize) {
-        Ipc::StoreMap::Slice &slice = store.nextAppendableSlice(fileNo, lastSlice);
+        const int64_t bufDebt = bufSize - bufWritten;
+        const int64_t remainingSize = expectedSize >= 0 ?
+                                      max(bufDebt, expectedSize - static_cast<int64_t>(totalWritten)) : -1;
+        Ipc::StoreMap::Slice &slice = store.nextAppendableSlice(fileNo, lastSlice, remainingSize);
         if (firstSlice < 0)
             firstSlice = lastSlice;
         copyToShmSlice(slice);
@@ -141,8 +169,8 @@ ShmWriter::copyToShmSlice(Ipc::StoreMap::Slice &slice)
 
     Must(bufWritten <= bufSize);
     const int64_t writingDebt = bufSize - bufWritten;
-    const int64_t pageSize = Ipc::Mem::PageSize();
-    const int64_t sliceOffset = totalWritten % pageSize;
+    const int64_t pageSize = Ipc::Mem::PageSize(page);
+    const int64_t sliceOffset = slice.size;
     const int64_t copySize = std::min(writingDebt, pageSize - sliceOffset);
     memcpy(static_cast<char*>(PagePointer(page)) + sliceOffset, buf + bufWritten,
            copySize);
@@ -204,13 +232,9 @@ MemStore::init()
 void
 MemStore::getStats(StoreInfoStats &stats) const
 {
-    const size_t pageSize = Ipc::Mem::PageSize();
-
     stats.mem.shared = true;
-    stats.mem.capacity =
-        Ipc::Mem::PageLimit(Ipc::Mem::PageId::cachePage) * pageSize;
-    stats.mem.size =
-        Ipc::Mem::PageLevel(Ipc::Mem::PageId::cachePage) * pageSize;
+    stats.mem.capacity = Ipc::Mem::CacheBytesLimit();
+    stats.mem.size = Ipc::Mem::CacheBytesLevel();
     stats.mem.count = currentCount();
 }
 
@@ -235,9 +259,10 @@ MemStore::stat(StoreEntry &e) const
 
         storeAppendPrintf(&e, "Maximum slots:   %9d\n", slotLimit);
         if (slotLimit > 0) {
-            const unsigned int slotsFree =
-                Ipc::Mem::PagesAvailable(Ipc::Mem::PageId::cachePage);
-            if (slotsFree <= static_cast<unsigned int>(slotLimit)) {
+            size_t slotsFree = 0;
+            for (size_t pageClass = 0; pageClass < Ipc::Mem::CachePageClasses(); ++pageClass)
+                slotsFree += Ipc::Mem::CachePageLimit(pageClass) - Ipc::Mem::CachePageLevel(pageClass);
+            if (slotsFree <= static_cast<size_t>(slotLimit)) {
                 const int usedSlots = slotLimit - static_cast<int>(slotsFree);
                 storeAppendPrintf(&e, "Used slots:      %9d %.2f%%\n",
                                   usedSlots, (100.0 * usedSlots / slotLimit));
@@ -248,10 +273,38 @@ MemStore::stat(StoreEntry &e) const
                 map->updateStats(stats);
                 stats.dump(e);
             }
+
+            statPageClasses(e);
         }
     }
 }
 
+/// reports how well entry slices fill the pages of each cache page class
+void
+MemStore::statPageClasses(StoreEntry &e) const
+{
+    // approximate: slices and their pages may change while we are counting
+    const auto classes = Ipc::Mem::CachePageClasses();
+    std::vector<uint64_t> storedBytes(classes, 0);
+    for (Ipc::StoreMapSliceId sliceId = 0; sliceId < map->sliceLimit(); ++sliceId) {
+        const Ipc::Mem::PageId page = extras->items[sliceId].page;
+        if (!page)
+            continue;
+        const auto pageClass = Ipc::Mem::CachePageClass(page);
+        if (pageClass < classes)
+            storedBytes[pageClass] += map->peekAtSlice(sliceId).size;
+    }
+
+    storeAppendPrintf(&e, "Page classes:\n");
+    for (size_t pageClass = 0; pageClass < classes; ++pageClass) {
+        const auto pageSize = Ipc::Mem::CachePageSize(pageClass);
+        const auto pagesUsed = Ipc::Mem::CachePageLevel(pageClass);
+        storeAppendPrintf(&e, "  %7.2f KB pages: %9zu of %9zu used, %6.2f%% filled\n",
+                          pageSize / 1024.0, pagesUsed, Ipc::Mem::CachePageLimit(pageClass),
+                          Math::doublePercent(storedBytes[pageClass], static_cast<double>(pagesUsed) * pageSize));
+    }
+}
+
 void
 MemStore::maintain()
 {
@@ -272,8 +325,7 @@ MemStore::maxSize() const
 uint64_t
 MemStore::currentSize() const
 {
-    return Ipc::Mem::PageLevel(Ipc::Mem::PageId::cachePage) *
-           Ipc::Mem::PageSize();
+    return Ipc::Mem::CacheBytesLevel();
 }
 
 uint64_t
@@ -322,8 +374,10 @@ MemStore::get(const cache_key *key)
 
         anchorEntry(*e, index, *slot);
 
-        // TODO: make copyFromShm() throw on all failures, simplifying this code
-        if (copyFromShm(*e, index, *slot))
+        // Complete entries do not change, so we can keep them locked and serve
+        // their bodies straight from shared memory. TODO: make copyFromShm()
+        // throw on all failures, simplifying this code
+        if (copyFromShm(*e, index, *slot, slot->complete()))
             return e;
         debugs(20, 3, "failed for " << *e);
     } catch (...) {
@@ -334,7 +388,7 @@ MemStore::get(const cache_key *key)
     }
 
     map->freeEntry(index); // do not let others into the same trap
-    destroyStoreEntry(static_cast<hash_link *>(e));
+    destroyStoreEntry(e);
     return nullptr;
 }
 
@@ -374,18 +428,28 @@ MemStore::updateHeadersOrThrow(Ipc::StoreMapUpdate &update)
     Must(update.stale.anchor->basics.swap_file_sz >= staleHdrSz);
 
     Must(update.stale.anchor);
+
+    /* find same-slice payload remaining after the stored headers */
+    uint64_t headersBeforeLastSlice = 0;
+    for (Ipc::StoreMapSliceId sliceId = update.stale.anchor->start; sliceId != update.stale.splicingPoint;) {
+        Must(sliceId >= 0);
+        const auto &prefixSlice = map->readableSlice(update.stale.fileNo, sliceId);
+        headersBeforeLastSlice += prefixSlice.size;
+        sliceId = prefixSlice.next;
+    }
+    Must(staleHdrSz > headersBeforeLastSlice); // or sliceContaining() would have stopped earlier
+    const Ipc::StoreMapSlice &slice = map->readableSlice(update.stale.fileNo, update.stale.splicingPoint);
+    const Ipc::StoreMapSlice::Size headersInLastSlice = staleHdrSz - headersBeforeLastSlice;
+    Must(slice.size >= headersInLastSlice);
+    const Ipc::StoreMapSlice::Size payloadInLastSlice = slice.size - headersInLastSlice;
+
     ShmWriter writer(*this, update.entry, update.fresh.fileNo);
+    writer.expectedSize = staleHdrSz + payloadInLastSlice; // fresh headers are usually similar
     update.entry->mem().freshestReply().packHeadersUsingSlowPacker(writer);
     const uint64_t freshHdrSz = writer.totalWritten;
     debugs(20, 7, "fresh hdr_sz: " << freshHdrSz << " diff: " << (freshHdrSz - staleHdrSz));
 
     /* copy same-slice payload remaining after the stored headers */
-    const Ipc::StoreMapSlice &slice = map->readableSlice(update.stale.fileNo, update.stale.splicingPoint);
-    const Ipc::StoreMapSlice::Size sliceCapacity = Ipc::Mem::PageSize();
-    const Ipc::StoreMapSlice::Size headersInLastSlice = staleHdrSz % sliceCapacity;
-    Must(headersInLastSlice > 0); // or sliceContaining() would have stopped earlier
-    Must(slice.size >= headersInLastSlice);
-    const Ipc::StoreMapSlice::Size payloadInLastSlice = slice.size - headersInLastSlice;
     const MemStoreMapExtras::Item &extra = extras->items[update.stale.splicingPoint];
     char *page = static_cast<char*>(PagePointer(extra.page));
     debugs(20, 5, "appending same-slice payload: " << payloadInLastSlice);
@@ -466,9 +530,11 @@ MemStore::anchorEntry(StoreEntry &e, const sfileno index, const Ipc::StoreMapAnc
     mc.io = Store::ioReading;
 }
 
-/// copies the entire entry from shared to local memory
+/// Copies the entire entry from shared to local memory or, if headersOnly is
+/// set, just the slices with HTTP response headers. In the latter case, the
+/// entry stays locked for MemObject::MemCache::inPlace reading.
 bool
-MemStore::copyFromShm(StoreEntry &e, const sfileno index, const Ipc::StoreMapAnchor &anchor)
+MemStore::copyFromShm(StoreEntry &e, const sfileno index, const Ipc::StoreMapAnchor &anchor, const bool headersOnly)
 {
     debugs(20, 7, "mem-loading entry " << index << " from " << anchor.start);
     assert(e.mem_obj);
@@ -514,6 +580,13 @@ MemStore::copyFromShm(StoreEntry &e, const sfileno index, const Ipc::StoreMapAnc
                 if (reply.parseTerminatedPrefix(httpHeaderParsingBuffer.c_str(), httpHeaderParsingBuffer.length()))
                     httpHeaderParsingBuffer = SBuf(); // we do not need these bytes anymore
             }
+
+            if (headersOnly && e.hasParsedReplyHeader() && slice.next >= 0) {
+                debugs(20, 5, "leaving " << (anchor.basics.swap_file_sz - e.mem_obj->endOffset()) <<
+                       " bytes of " << e << " in shared memory");
+                e.mem_obj->memCache.inPlace = true;
+                return true; // anchorEntry() has marked the complete entry as such
+            }
         }
         // else skip a [possibly incomplete] slice that we copied earlier
 
@@ -690,11 +763,15 @@ MemStore::copyToShm(StoreEntry &e)
     Ipc::StoreMapAnchor &anchor = map->writeableEntry(index);
     lastWritingSlice = anchor.start;
 
+    const int64_t expectedSize = e.mem_obj->expectedReplySize(); // may be < 0
+
     // fill, skip slices that are already full
     // Optimize: remember lastWritingSlice in e.mem_obj
     while (e.mem_obj->memCache.offset < eSize) {
+        const int64_t remainingSize = expectedSize >= 0 ?
+                                      max(expectedSize, eSize) - e.mem_obj->memCache.offset : -1;
         Ipc::StoreMap::Slice &slice = nextAppendableSlice(
-                                          e.mem_obj->memCache.index, lastWritingSlice);
+                                          e.mem_obj->memCache.index, lastWritingSlice, remainingSize);
         if (anchor.start < 0)
             anchor.start = lastWritingSlice;
         copyToShmSlice(e, anchor, slice);
@@ -711,8 +788,8 @@ MemStore::copyToShmSlice(StoreEntry &e, Ipc::StoreMapAnchor &anchor, Ipc::StoreM
     debugs(20, 7, "entry " << e << " slice " << lastWritingSlice << " has " <<
            page);
 
-    const int64_t bufSize = Ipc::Mem::PageSize();
-    const int64_t sliceOffset = e.mem_obj->memCache.offset % bufSize;
+    const int64_t bufSize = Ipc::Mem::PageSize(page);
+    const int64_t sliceOffset = slice.size;
     StoreIOBuffer sharedSpace(bufSize - sliceOffset, e.mem_obj->memCache.offset,
                               static_cast<char*>(PagePointer(page)) + sliceOffset);
 
@@ -734,24 +811,25 @@ MemStore::copyToShmSlice(StoreEntry &e, Ipc::StoreMapAnchor &anchor, Ipc::StoreM
 }
 
 /// starts checking with the entry chain slice at a given offset and
-/// returns a not-full (but not necessarily empty) slice, updating sliceOffset
+/// returns a not-full (but not necessarily empty) slice, updating sliceOffset;
+/// new slices get pages suitable for storing remainingSize bytes (if known)
 Ipc::StoreMap::Slice &
-MemStore::nextAppendableSlice(const sfileno fileNo, sfileno &sliceOffset)
+MemStore::nextAppendableSlice(const sfileno fileNo, sfileno &sliceOffset, const int64_t remainingSize)
 {
     // allocate the very first slot for the entry if needed
     if (sliceOffset < 0) {
         Ipc::StoreMapAnchor &anchor = map->writeableEntry(fileNo);
         Must(anchor.start < 0);
         Ipc::Mem::PageId page;
-        sliceOffset = reserveSapForWriting(page); // throws
+        sliceOffset = reserveSapForWriting(page, remainingSize); // throws
         extras->items[sliceOffset].page = page;
         anchor.start = sliceOffset;
     }
 
-    const size_t sliceCapacity = Ipc::Mem::PageSize();
     do {
         Ipc::StoreMap::Slice &slice = map->writeableSlice(fileNo, sliceOffset);
 
+        const size_t sliceCapacity = Ipc::Mem::PageSize(pageForSlice(sliceOffset));
         if (slice.size >= sliceCapacity) {
             if (slice.next >= 0) {
                 sliceOffset = slice.next;
@@ -759,7 +837,7 @@ MemStore::nextAppendableSlice(const sfileno fileNo, sfileno &sliceOffset)
             }
 
             Ipc::Mem::PageId page;
-            slice.next = sliceOffset = reserveSapForWriting(page);
+            slice.next = sliceOffset = reserveSapForWriting(page, remainingSize);
             extras->items[sliceOffset].page = page;
             debugs(20, 7, "entry " << fileNo << " new slice: " << sliceOffset);
             continue; // to get and return the slice at the new sliceOffset
@@ -781,16 +859,17 @@ MemStore::pageForSlice(Ipc::StoreMapSliceId sliceId)
     return page;
 }
 
-/// finds a slot and a free page to fill or throws
+/// finds a slot and a free page to fill or throws; prefers pages suitable
+/// for storing the given number of bytes (if known)
 sfileno
-MemStore::reserveSapForWriting(Ipc::Mem::PageId &page)
+MemStore::reserveSapForWriting(Ipc::Mem::PageId &page, const int64_t remainingSize)
 {
     Ipc::Mem::PageId slot;
     if (freeSlots->pop(slot)) {
         const auto slotId = slot.number - 1;
         debugs(20, 5, "got a previously free slot: " << slotId);
 
-        if (Ipc::Mem::GetPage(Ipc::Mem::PageId::cachePage, page)) {
+        if (Ipc::Mem::GetCachePageFor(remainingSize, page)) {
             debugs(20, 5, "and got a previously free page: " << page);
             map->prepFreeSlice(slotId);
             return slotId;
@@ -926,11 +1005,51 @@ MemStore::evictIfFound(const cache_key *key)
         map->freeEntryByKey(key);
 }
 
+ssize_t
+MemStore::readInPlace(const StoreEntry &e, const StoreIOBuffer &buf, Store::InPlaceReadPosition &position) const
+{
+    const auto &memCache = e.mem().memCache;
+    Assure(memCache.inPlace);
+    Assure(map);
+    const auto index = memCache.index;
+    const Ipc::StoreMapAnchor &anchor = map->readableEntry(index);
+
+    // the locked entry is complete so its slices do not change
+    auto sid = anchor.start.load();
+    int64_t sliceOffset = 0;
+    if (position.slice >= 0 && position.sliceOffset <= buf.offset) {
+        sid = position.slice; // skip slices read earlier
+        sliceOffset = position.sliceOffset;
+    }
+
+    ssize_t copied = 0;
+    while (sid >= 0 && static_cast<size_t>(copied) < buf.length) {
+        const Ipc::StoreMapSlice &slice = map->readableSlice(index, sid);
+        const int64_t sliceEnd = sliceOffset + slice.size;
+        const int64_t readOffset = buf.offset + copied;
+        if (readOffset < sliceEnd) {
+            const auto prefixSize = readOffset - sliceOffset;
+            const auto copySize = min(sliceEnd - readOffset, static_cast<int64_t>(buf.length - copied));
+            const auto page = static_cast<const char*>(PagePointer(extras->items[sid].page));
+            memcpy(buf.data + copied, page + prefixSize, copySize);
+            copied += copySize;
+            position.slice = sid;
+            position.sliceOffset = sliceOffset;
+        }
+        sliceOffset = sliceEnd;
+        sid = slice.next;
+    }
+
+    debugs(20, 7, "copied " << copied << " bytes of " << e << " from " << buf.offset);
+    return copied;
+}
+
 void
 MemStore::disconnect(StoreEntry &e)
 {
     assert(e.mem_obj);
     MemObject &mem_obj = *e.mem_obj;
+    mem_obj.memCache.inPlace = false; // the remaining shared bytes become unreachable
     if (e.hasMemStore()) {
         if (mem_obj.memCache.io == Store::ioWriting) {
             map->abortWriting(mem_obj.memCache.index);
@@ -960,8 +1079,10 @@ MemStore::EntryLimit()
     if (!Requested())
         return 0;
 
-    const int64_t minEntrySize = Ipc::Mem::PageSize();
-    const int64_t entryLimit = Config.memMaxSize / minEntrySize;
+    // each cache page may store a small entry
+    auto entryLimit = CachePageLimit(Ipc::Mem::PageSize(), DefaultPageClassPercent());
+    for (const auto &pageClass: Config.memPageClasses)
+        entryLimit += CachePageLimit(pageClass.first, pageClass.second);
     return entryLimit;
 }
 
@@ -993,7 +1114,13 @@ DefineRunnerRegistrator(MemStoreRr);
 void
 MemStoreRr::claimMemoryNeeds()
 {
-    Ipc::Mem::NotePageNeed(Ipc::Mem::PageId::cachePage, MemStore::EntryLimit());
+    if (!MemStore::Requested())
+        return;
+
+    Ipc::Mem::NotePageNeed(Ipc::Mem::PageId::cachePage,
+                           CachePageLimit(Ipc::Mem::PageSize(), DefaultPageClassPercent()));
+    for (const auto &pageClass: Config.memPageClasses)
+        Ipc::Mem::NoteCachePageNeed(pageClass.first, CachePageLimit(pageClass.first, pageClass.second));
 }
 
 void
@@ -1010,10 +1137,12 @@ MemStoreRr::finalizeConfig()
                " a single worker is running");
     }
 
-    if (MemStore::Requested() && Config.memMaxSize < Ipc::Mem::PageSize()) {
+    const auto minPageSize = Config.memPageClasses.empty() ?
+                             Ipc::Mem::PageSize() : Config.memPageClasses.begin()->first;
+    if (MemStore::Requested() && Config.memMaxSize < minPageSize) {
         debugs(20, DBG_IMPORTANT, "WARNING: mem-cache size is too small (" <<
                (Config.memMaxSize / 1024.0) << " KB), should be >= " <<
-               (Ipc::Mem::PageSize() / 1024.0) << " KB");
+               (minPageSize / 1024.0) << " KB");
     }
 }
 
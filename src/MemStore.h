@@ -44,6 +44,12 @@ public:
     /// called when the entry is about to forget its association with mem cache
     void disconnect(StoreEntry &e);
 
+    /// copies bytes of an entry loaded with MemObject::MemCache::inPlace
+    /// directly from shared memory pages into the given buffer, starting the
+    /// slice chain walk at the given (updated) position when possible
+    /// \returns the number of copied bytes
+    ssize_t readInPlace(const StoreEntry &, const StoreIOBuffer &, Store::InPlaceReadPosition &) const;
+
     /* Storage API */
     void create() override {}
     void init() override;
@@ -79,7 +85,7 @@ protected:
 
     void copyToShm(StoreEntry &e);
     void copyToShmSlice(StoreEntry &e, Ipc::StoreMapAnchor &anchor, Ipc::StoreMap::Slice &slice);
-    bool copyFromShm(StoreEntry &e, const sfileno index, const Ipc::StoreMapAnchor &anchor);
+    bool copyFromShm(StoreEntry &e, const sfileno index, const Ipc::StoreMapAnchor &anchor, const bool headersOnly = false);
     void copyFromShmSlice(StoreEntry &, const StoreIOBuffer &);
 
     void updateHeadersOrThrow(Ipc::StoreMapUpdate &update);
@@ -88,8 +94,10 @@ protected:
     bool updateAnchoredWith(StoreEntry &, const sfileno, const Ipc::StoreMapAnchor &);
 
     Ipc::Mem::PageId pageForSlice(Ipc::StoreMapSliceId sliceId);
-    Ipc::StoreMap::Slice &nextAppendableSlice(const sfileno entryIndex, sfileno &sliceOffset);
-    sfileno reserveSapForWriting(Ipc::Mem::PageId &page);
+    Ipc::StoreMap::Slice &nextAppendableSlice(const sfileno entryIndex, sfileno &sliceOffset, int64_t remainingSize);
+    sfileno reserveSapForWriting(Ipc::Mem::PageId &page, int64_t remainingSize);
+
+    void statPageClasses(StoreEntry &) const;
 
     // Ipc::StoreMapCleaner API
     void noteFreeMapSlice(const Ipc::StoreMapSliceId sliceId) override;
@@ -19,6 +19,7 @@
 #include "helper/ChildConfig.h"
 #include "HttpHeaderTools.h"
 #include "ip/Address.h"
+#include "ipc/mem/Numa.h"
 #if USE_DELAY_POOLS
 #include "MessageDelayPools.h"
 #endif
@@ -33,6 +34,7 @@
 #include "time/gadgets.h"
 
 #include <chrono>
+#include <map>
 
 #if USE_OPENSSL
 class sslproxy_cert_sign;
@@ -88,7 +90,12 @@ public:
 
     YesNoNone memShared; ///< whether the memory cache is shared among workers
     YesNoNone shmLocking; ///< shared_memory_locking
+    Ipc::Mem::Numa::Policy shmNumaPolicy; ///< shared_memory_numa_policy
     size_t memMaxSize;
+    size_t memPageSize; ///< memory_page_size
+    /// memory_cache_page_class: cache_mem percentage for each page size
+    using MemPageClasses = std::map<size_t, int>;
+    MemPageClasses memPageClasses;
 
     struct {
         int64_t min;
@@ -321,6 +328,8 @@ public:
         int httpd_suppress_version_string;
         int global_internal_static;
         int collapsed_forwarding;
+        int aclMemoization;
+        int aclTiming;
 
 #if FOLLOW_X_FORWARDED_FOR
         int acl_uses_indirect_client;
@@ -334,11 +343,18 @@ public:
         int WIN32_IpAddrChangeMonitor;
         int memory_cache_first;
         int memory_cache_disk;
+        int memPageHugepages; ///< memory_page_hugepages
         int hostStrictVerify;
         int client_dst_passthru;
         int dns_mdns;
 #if USE_OPENSSL
         bool logTlsServerHelloDetails;
+#endif
+#if USE_EPOLL
+        int epoll_batch_updates;
+#endif
+#if HAVE_SPLICE
+        int tunnel_splice;
 #endif
     } onoff;
 
@@ -34,7 +34,7 @@ class RequestFlags;
 
 extern StoreIoStats store_io_stats;
 
-class StoreEntry : public hash_link, public Packable
+class StoreEntry : public Packable
 {
 
 public:
@@ -217,6 +217,10 @@ public:
     /// allow or forbid collapsed requests feeding
     void setCollapsingRequirement(const bool required);
 
+    /// the public or private cache_key indexing this entry in store_table
+    /// (or nil)
+    void *key = nullptr;
+
     MemObject *mem_obj;
     RemovalPolicyNode repl;
     /* START OF ON-DISK STORE_META_STD TLV field */
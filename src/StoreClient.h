@@ -13,6 +13,7 @@
 #include "base/AsyncCall.h"
 #include "base/forward.h"
 #include "dlink.h"
+#include "store/forward.h"
 #include "store/ParsingBuffer.h"
 #include "StoreIOBuffer.h"
 #include "StoreIOState.h"
@@ -193,6 +194,9 @@ private:
 
     StoreIOBuffer lastDiskRead; ///< buffer used for the last storeRead() call
 
+    /// where our last Store::Controller::memoryRead() stopped
+    Store::InPlaceReadPosition inPlacePosition;
+
     /* Until we finish stuffing code into store_client */
 
 public:
@@ -12,9 +12,11 @@
 #include "acl/Acl.h"
 #include "acl/Checklist.h"
 #include "acl/Gadgets.h"
+#include "acl/Memo.h"
 #include "acl/Options.h"
 #include "anyp/PortCfg.h"
 #include "base/IoManip.h"
+#include "base/Stopwatch.h"
 #include "cache_cf.h"
 #include "ConfigParser.h"
 #include "debug/Stream.h"
@@ -27,8 +29,10 @@
 #include "SquidConfig.h"
 
 #include <algorithm>
+#include <iomanip>
 #include <map>
 #include <unordered_map>
+#include <vector>
 
 namespace Acl {
 
@@ -141,6 +145,31 @@ Acl::ParsingContext::detailCodeContext(std::ostream &os) const
            Debug::Extra << "configuration context: " << ConfigParser::CurrentLocation();
 }
 
+/* Acl::NodeStats */
+
+void
+Acl::NodeStats::note(const uint64_t nanoseconds, const bool matched, const bool waited)
+{
+    ++evaluations;
+    if (matched)
+        ++matches;
+    if (waited)
+        ++asyncWaits;
+    totalTime += nanoseconds;
+    maxTime = std::max(maxTime, nanoseconds);
+}
+
+Acl::NodeStats &
+Acl::NodeStats::operator +=(const NodeStats &other)
+{
+    evaluations += other.evaluations;
+    matches += other.matches;
+    asyncWaits += other.asyncWaits;
+    totalTime += other.totalTime;
+    maxTime = std::max(maxTime, other.maxTime);
+    return *this;
+}
+
 /* Acl::Node */
 
 void *
@@ -190,6 +219,12 @@ Acl::Node::matches(ACLChecklist *checklist) const
 {
     debugs(28, 5, "checking " << name);
 
+    // clock reads are not free; they are enabled by acl_timing
+    const auto timed = Config.onoff.aclTiming;
+    Stopwatch timer;
+    if (timed)
+        timer.resume();
+
     checklist->setLastCheckedName(name);
 
     int result = 0;
@@ -207,11 +242,25 @@ Acl::Node::matches(ACLChecklist *checklist) const
         if (requiresAle())
             checklist->verifyAle();
 
-        // have to cast because old match() API is missing const
-        result = const_cast<Node*>(this)->match(checklist);
+        const auto memo = memoizable() ? checklist->memo() : nullptr;
+        bool matched = false;
+        if (memo && memo->find(*this, matched)) {
+            ++memoHits;
+            result = matched ? 1 : 0;
+        } else {
+            // have to cast because old match() API is missing const
+            result = const_cast<Node*>(this)->match(checklist);
+            if (memo && memo->remember(*this, result, checklist->asyncInProgress()))
+                ++memoMisses;
+        }
     }
 
-    const char *extra = checklist->asyncInProgress() ? " async" : "";
+    if (timed)
+        timer.pause();
+    const auto waiting = checklist->asyncInProgress();
+    stats.note(std::chrono::duration_cast<std::chrono::nanoseconds>(timer.total()).count(), result == 1, waiting);
+
+    const char *extra = waiting ? " async" : "";
     debugs(28, 3, "checked: " << name << " = " << result << extra);
     return result == 1; // true for match; false for everything else
 }
@@ -350,6 +399,38 @@ Acl::FreeNamedAcls(NamedAcls ** const namedAcls)
     *namedAcls = nullptr;
 }
 
+void
+Acl::VisitNamedAcls(const NamedAclVisitor &visitor)
+{
+    if (Config.namedAcls) {
+        for (const auto &nameAndAcl: *Config.namedAcls)
+            visitor(*nameAndAcl.second);
+    }
+}
+
+void
+Acl::ReportMemoStats(std::ostream &os)
+{
+    os << "ACL result memoization: " << (Config.onoff.aclMemoization ? "on" : "off") << "\n\n";
+
+    std::vector<const Node *> acls;
+    VisitNamedAcls([&acls](const Node &acl) {
+        if (acl.memoHits || acl.memoMisses)
+            acls.push_back(&acl);
+    });
+    std::sort(acls.begin(), acls.end(), [](const Node *a, const Node *b) {
+        return a->name < b->name;
+    });
+
+    os << "ACL\tType\tHits\tMisses\tHit%\n";
+    for (const auto acl: acls) {
+        const auto lookups = acl->memoHits + acl->memoMisses;
+        os << acl->name << '\t' << acl->typeString() << '\t' <<
+           acl->memoHits << '\t' << acl->memoMisses << '\t' <<
+           std::fixed << std::setprecision(1) << (100.0 * acl->memoHits / lookups) << "\n";
+    }
+}
+
 bool
 Acl::Node::isProxyAuth() const
 {
@@ -451,6 +532,12 @@ Acl::Node::requiresReply() const
     return false;
 }
 
+bool
+Acl::Node::memoizable() const
+{
+    return false;
+}
+
 bool
 Acl::Node::requiresRequest() const
 {
@@ -15,6 +15,7 @@
 #include "sbuf/SBuf.h"
 
 #include <algorithm>
+#include <functional>
 #include <optional>
 #include <ostream>
 
@@ -131,6 +132,14 @@ void DumpNamedAcls(std::ostream &, const char *directiveName, NamedAcls *);
 /// delete the given list of "acl" directives
 void FreeNamedAcls(NamedAcls **);
 
+using NamedAclVisitor = std::function<void (const Node &)>;
+
+/// calls the given visitor for each ACL configured with an "acl" directive
+void VisitNamedAcls(const NamedAclVisitor &);
+
+/// report acl_memoization statistics of the configured ACLs
+void ReportMemoStats(std::ostream &);
+
 } // namespace Acl
 
 /// \ingroup ACLAPI
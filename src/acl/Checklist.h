@@ -121,6 +121,9 @@ public:
     /// warns if there are uninitialized ALE components and fills them
     virtual void verifyAle() const = 0;
 
+    /// ACL results remembered for the checked transaction (or nil)
+    virtual Acl::Memo *memo() { return nullptr; }
+
     /// change the current ACL list
     void changeAcl(const acl_access *);
 
@@ -21,7 +21,7 @@ static void LookupDone(const char *, const Dns::LookupDetails &, void *data);
 static void
 StartLookup(ACLFilledChecklist &cl, const Acl::Node &)
 {
-    fqdncache_nbgethostbyaddr(cl.dst_addr, LookupDone, &cl);
+    fqdncache_nbgethostbyaddr(cl.request->url.hostIP(), LookupDone, &cl);
 }
 
 static void
@@ -72,13 +72,7 @@ Acl::DestinationDomainCheck::match(ACLChecklist * const ch)
     }
 
     /* raw IP without rDNS? look it up and wait for the result */
-    if (!checklist->dst_addr.fromHost(checklist->request->url.host())) {
-        /* not a valid IPA */
-        checklist->dst_rdns = xstrdup("invalid");
-        return 0;
-    }
-
-    const char *fqdn = fqdncache_gethostbyaddr(checklist->dst_addr, FQDN_LOOKUP_IF_MISS);
+    const char *fqdn = fqdncache_gethostbyaddr(checklist->request->url.hostIP(), FQDN_LOOKUP_IF_MISS);
 
     if (fqdn) {
         checklist->dst_rdns = xstrdup(fqdn);
@@ -24,6 +24,7 @@ public:
     /* Acl::Node API */
     int match(ACLChecklist *) override;
     bool requiresRequest() const override {return true;}
+    bool memoizable() const override {return true;}
     const Acl::Options &options() override;
 
 private:
@@ -0,0 +1,309 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+/* DEBUG: section 28    Access Control */
+
+#include "squid.h"
+#include "acl/DomainTrie.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+
+/// the label at the given depth of a DomainTrie key
+std::pair<const char *, size_t>
+LabelAt(const std::string &key, size_t depth)
+{
+    size_t start = 0;
+    while (depth-- > 0)
+        start = key.find('\0', start) + 1;
+    const auto end = key.find('\0', start);
+    return std::make_pair(key.data() + start, (end == std::string::npos ? key.size() : end) - start);
+}
+
+/// whether the two labels returned by LabelAt() are the same
+bool
+SameLabel(const std::pair<const char *, size_t> &a, const std::pair<const char *, size_t> &b)
+{
+    return a.second == b.second && memcmp(a.first, b.first, a.second) == 0;
+}
+
+/// the number of labels in a DomainTrie key
+size_t
+LabelCount(const std::string &key)
+{
+    return std::count(key.begin(), key.end(), '\0') + 1;
+}
+
+/// compares a (lowercase) trie label with a host label using key order
+int
+CompareLabels(const char *stored, const size_t storedSize, const char *host, const size_t hostSize)
+{
+    const auto size = std::min(storedSize, hostSize);
+    for (size_t i = 0; i < size; ++i) {
+        const auto a = static_cast<unsigned char>(stored[i]);
+        const auto b = static_cast<unsigned char>(xtolower(host[i]));
+        if (a != b)
+            return a < b ? -1 : +1;
+    }
+    return storedSize < hostSize ? -1 : (storedSize > hostSize ? +1 : 0);
+}
+
+} // namespace
+
+/// Converts a value to its reversed labels separated by NUL characters. That
+/// separator makes std::string order group values by their labels.
+std::string
+Acl::DomainTrie::Key(const char *value, bool &subdomains)
+{
+    subdomains = (*value == '.');
+    if (subdomains)
+        ++value;
+
+    std::string key;
+    key.reserve(strlen(value));
+    const char *end = value + strlen(value);
+    for (;;) {
+        auto start = end;
+        while (start > value && start[-1] != '.')
+            --start;
+        key.append(start, end - start);
+        if (start == value)
+            break;
+        key.push_back('\0');
+        end = start - 1;
+    }
+    return key;
+}
+
+/// the inverse of Key()
+std::string
+Acl::DomainTrie::Value(const std::string &key, const bool subdomains)
+{
+    std::string value;
+    value.reserve(key.size() + 1);
+    if (subdomains)
+        value.push_back('.');
+    for (auto end = key.size();;) {
+        const auto separator = end ? key.rfind('\0', end - 1) : std::string::npos;
+        const auto start = (separator == std::string::npos) ? 0 : separator + 1;
+        value.append(key, start, end - start);
+        if (separator == std::string::npos)
+            break;
+        value.push_back('.');
+        end = separator;
+    }
+    return value;
+}
+
+void
+Acl::DomainTrie::add(const char *value, const Reporter &report)
+{
+    thaw();
+
+    bool subdomains = false;
+    const auto key = Key(value, subdomains);
+
+    // a set covering this value: an identical set or a parent domain set
+    for (auto end = key.find('\0'); ; end = key.find('\0', end + 1)) {
+        const auto found = pending.find(key.substr(0, end));
+        if (found != pending.end() && found->second) {
+            report(Value(key, subdomains), Value(found->first, true), false);
+            return;
+        }
+        if (end == std::string::npos)
+            break;
+    }
+
+    const auto identical = pending.find(key);
+    if (identical != pending.end()) {
+        if (!subdomains) {
+            report(Value(key, false), Value(key, false), false);
+            return;
+        }
+        report(Value(key, false), Value(key, true), true);
+        pending.erase(identical);
+    }
+
+    if (subdomains) {
+        // remove earlier values this set covers
+        auto prefix = key;
+        prefix.push_back('\0');
+        auto it = pending.lower_bound(prefix);
+        while (it != pending.end() && it->first.compare(0, prefix.size(), prefix) == 0) {
+            report(Value(it->first, it->second), Value(key, true), true);
+            it = pending.erase(it);
+        }
+    }
+
+    pending.emplace(key, subdomains);
+}
+
+void
+Acl::DomainTrie::compile()
+{
+    if (pending.empty())
+        return;
+
+    nodes.clear();
+    labels.clear();
+    nodes.emplace_back(); // the root
+    addChildren(0, pending.begin(), pending.end(), 0);
+    nodes.shrink_to_fit();
+    labels.shrink_to_fit();
+    pending.clear();
+}
+
+/// Appends nodes for the depth-th labels of the given sorted values (and for
+/// their deeper labels) as children of the given parent node. All the values
+/// share their first depth labels and have more than depth labels.
+void
+Acl::DomainTrie::addChildren(const size_t parent, const Pending::const_iterator begin, const Pending::const_iterator end, const size_t depth)
+{
+    std::vector<std::pair<Pending::const_iterator, Pending::const_iterator> > groups;
+    for (auto it = begin; it != end;) {
+        const auto label = LabelAt(it->first, depth);
+        auto groupEnd = std::next(it);
+        while (groupEnd != end && SameLabel(LabelAt(groupEnd->first, depth), label))
+            ++groupEnd;
+        groups.emplace_back(it, groupEnd);
+        it = groupEnd;
+    }
+
+    const auto firstChild = nodes.size();
+    nodes[parent].firstChild = firstChild;
+    nodes[parent].childCount = groups.size();
+    nodes.resize(firstChild + groups.size());
+
+    for (size_t i = 0; i < groups.size(); ++i) {
+        auto deeper = groups[i].first;
+        const auto label = LabelAt(deeper->first, depth);
+        auto &node = nodes[firstChild + i];
+        node.labelOffset = labels.size();
+        node.labelSize = label.second;
+        labels.append(label.first, label.second);
+
+        // a value ending with this label precedes longer values in its group
+        if (LabelCount(deeper->first) == depth + 1) {
+            node.exact = !deeper->second;
+            node.subdomains = deeper->second;
+            ++deeper;
+        }
+
+        if (deeper != groups[i].second)
+            addChildren(firstChild + i, deeper, groups[i].second, depth + 1);
+    }
+}
+
+const Acl::DomainTrie::Node *
+Acl::DomainTrie::findChild(const Node &parent, const char *label, const size_t labelSize) const
+{
+    auto low = parent.firstChild;
+    auto high = parent.firstChild + parent.childCount;
+    while (low < high) {
+        const auto middle = low + (high - low) / 2;
+        const auto &child = nodes[middle];
+        const auto diff = CompareLabels(labels.data() + child.labelOffset, child.labelSize, label, labelSize);
+        if (diff == 0)
+            return &child;
+        if (diff < 0)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return nullptr;
+}
+
+bool
+Acl::DomainTrie::match(const char *host, const bool honorWildcards) const
+{
+    if (!host || nodes.empty())
+        return false;
+
+    while (*host == '.')
+        ++host;
+
+    auto end = host + strlen(host);
+    if (end == host)
+        return false;
+
+    // walk host labels from right to left
+    auto node = &nodes[0];
+    for (;;) {
+        auto start = end;
+        while (start > host && start[-1] != '.')
+            --start;
+
+        if (honorWildcards && node != &nodes[0] && end - start == 1 && *start == '*')
+            return node->childCount > 0;
+
+        node = findChild(*node, start, end - start);
+        if (!node)
+            return false;
+        if (node->subdomains)
+            return true;
+        if (start == host)
+            return node->exact;
+        end = start - 1;
+    }
+}
+
+void
+Acl::DomainTrie::visit(const Node &node, const std::string &key, std::vector<std::string> &result) const
+{
+    if (node.exact || node.subdomains)
+        result.push_back(Value(key, node.subdomains));
+
+    for (auto i = node.firstChild; i < node.firstChild + node.childCount; ++i) {
+        const auto &child = nodes[i];
+        auto childKey = key;
+        if (&node != &nodes[0])
+            childKey.push_back('\0');
+        childKey.append(labels, child.labelOffset, child.labelSize);
+        visit(child, childKey, result);
+    }
+}
+
+std::vector<std::string>
+Acl::DomainTrie::values() const
+{
+    std::vector<std::string> result;
+    if (!nodes.empty())
+        visit(nodes[0], std::string(), result);
+    for (const auto &value: pending)
+        result.push_back(Value(value.first, value.second));
+    return result;
+}
+
+size_t
+Acl::DomainTrie::memoryUsed() const
+{
+    return nodes.capacity() * sizeof(Node) + labels.capacity();
+}
+
+/// moves compiled values back to the pending index so that add() can check
+/// them for duplicates
+void
+Acl::DomainTrie::thaw()
+{
+    if (nodes.empty())
+        return;
+
+    std::vector<std::string> compiled;
+    visit(nodes[0], std::string(), compiled);
+    nodes.clear();
+    labels.clear();
+    for (const auto &value: compiled) {
+        bool subdomains = false;
+        const auto key = Key(value.c_str(), subdomains);
+        pending.emplace(key, subdomains);
+    }
+}
+
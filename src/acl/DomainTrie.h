@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#ifndef SQUID_SRC_ACL_DOMAINTRIE_H
+#define SQUID_SRC_ACL_DOMAINTRIE_H
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Acl
+{
+
+/// A set of domain names (e.g., example.com) and domain name sets (e.g.,
+/// .example.com matching example.com and all its subdomains), matched using
+/// matchDomainName() rules. Values are indexed by their reversed labels
+/// (e.g., com, example, www) while being added and then compiled into a
+/// compact read-only trie that is safe to search concurrently.
+class DomainTrie
+{
+public:
+    /// Reports a value that add() ignores (or has removed) because another
+    /// value covers it. The flag is true when the ignored value was added
+    /// earlier than the covering one.
+    using Reporter = std::function<void(const std::string &ignored, const std::string &coveringValue, bool ignoredEarlier)>;
+
+    /// Adds a lowercase domain name or (if it starts with a dot) a domain
+    /// name set, dropping values that become redundant.
+    void add(const char *value, const Reporter &);
+
+    /// Builds the lookup trie from all added values. Must be called before
+    /// match(). The values added later require another compile() call.
+    void compile();
+
+    /// whether all added values have been compiled
+    bool compiled() const { return pending.empty(); }
+
+    /// whether the (case-insensitive) host name matches any compiled value
+    /// \param honorWildcards whether a host label "*" (e.g., in *.example.com)
+    /// matches any label, as in matchDomainName(mdnHonorWildcards)
+    bool match(const char *host, bool honorWildcards = false) const;
+
+    /// whether there are no values
+    bool empty() const { return nodes.size() <= 1 && pending.empty(); }
+
+    /// all values, using the spelling given to add()
+    std::vector<std::string> values() const;
+
+    /// the number of bytes used by the compiled trie
+    size_t memoryUsed() const;
+
+private:
+    /// a trie node representing a single domain label
+    class Node
+    {
+    public:
+        Node(): labelSize(0), exact(0), subdomains(0) {}
+
+        uint32_t labelOffset = 0; ///< where the label starts in labels
+        uint32_t labelSize: 30; ///< label length
+        uint32_t exact: 1; ///< whether the node path is a value
+        uint32_t subdomains: 1; ///< whether the node path is a domain name set
+        uint32_t firstChild = 0; ///< index of the first child node
+        uint32_t childCount = 0; ///< the number of (consecutive) child nodes
+    };
+
+    /// values added since the last compile(), indexed by their Key()
+    /// \sa thaw()
+    using Pending = std::map<std::string, bool /* subdomains */>;
+
+    static std::string Key(const char *value, bool &subdomains);
+    static std::string Value(const std::string &key, bool subdomains);
+
+    const Node *findChild(const Node &, const char *label, size_t labelSize) const;
+    void addChildren(size_t parent, Pending::const_iterator begin, Pending::const_iterator end, size_t depth);
+    void visit(const Node &, const std::string &key, std::vector<std::string> &result) const;
+    void thaw();
+
+    /// compiled nodes; nodes[0] is the root with top-level domain children
+    std::vector<Node> nodes;
+
+    /// concatenated labels of compiled nodes
+    std::string labels;
+
+    Pending pending;
+};
+
+} // namespace Acl
+
+#endif /* SQUID_SRC_ACL_DOMAINTRIE_H */
+
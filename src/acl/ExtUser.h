@@ -26,6 +26,7 @@ public:
     /* Acl::Node API */
     char const *typeString() const override;
     void parse() override;
+    void prepareForUse() override { data->prepareForUse(); }
     int match(ACLChecklist *checklist) override;
     bool requiresRequest() const override { return true; }
     SBufList dump() const override;
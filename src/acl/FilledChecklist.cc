@@ -8,6 +8,7 @@
 
 #include "squid.h"
 #include "acl/FilledChecklist.h"
+#include "acl/Memo.h"
 #include "client_side.h"
 #include "comm/Connection.h"
 #include "comm/forward.h"
@@ -119,6 +120,18 @@ ACLFilledChecklist::syncAle(HttpRequest *adaptedRequest, const char *logUri) con
         al->url = logUri;
 }
 
+Acl::Memo *
+ACLFilledChecklist::memo()
+{
+    if (!Config.onoff.aclMemoization || !request)
+        return nullptr;
+
+    // our addresses are public and may change between ACL evaluations
+    const auto memo = request->aclMemo();
+    memo->sync(request->url.generation(), reply_, src_addr, dst_addr, my_addr, dst_peer_name);
+    return memo.getRaw();
+}
+
 ConnStateData *
 ACLFilledChecklist::conn() const
 {
@@ -92,6 +92,7 @@ public:
     bool hasAle() const override { return al != nullptr; }
     void syncAle(HttpRequest *adaptedRequest, const char *logUri) const override;
     void verifyAle() const override;
+    Acl::Memo *memo() override;
 
 public:
     Ip::Address src_addr;
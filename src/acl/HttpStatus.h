@@ -36,6 +36,7 @@ public:
     SBufList dump() const override;
     bool empty () const override;
     bool requiresReply() const override { return true; }
+    bool memoizable() const override { return true; }
 
 protected:
     Splay<acl_httpstatus_data*> *data;
@@ -12,6 +12,7 @@
 #include "acl/Checklist.h"
 #include "acl/Ip.h"
 #include "acl/SplayInserter.h"
+#include "base/Assure.h"
 #include "cache_cf.h"
 #include "ConfigParser.h"
 #include "debug/Stream.h"
@@ -136,37 +137,6 @@ operator <<(std::ostream &os, acl_ip_data *value)
     return os;
 }
 
-/*
- * aclIpAddrNetworkCompare - The guts of the comparison for IP ACLs
- * matching checks.  The first argument (p) is a "host" address,
- * i.e.  the IP address of a cache client.  The second argument (q)
- * is an entry in some address-based access control element.  This
- * function is called via ACLIP::match() and the splay library.
- */
-static int
-aclIpAddrNetworkCompare(acl_ip_data * const &p, acl_ip_data * const &q)
-{
-    Ip::Address A = p->addr1;
-
-    /* apply netmask */
-    A.applyMask(q->mask);
-
-    debugs(28,9, "aclIpAddrNetworkCompare: compare: " << p->addr1 << "/" << q->mask << " (" << A << ")  vs " <<
-           q->addr1 << "-" << q->addr2 << "/" << q->mask);
-
-    if (q->addr2.isAnyAddr()) {       /* single address check */
-
-        return A.matchIPAddr( q->addr1 );
-
-    } else {                   /* range address check */
-
-        if ( (A >= q->addr1) && (A <= q->addr2) )
-            return 0; /* valid. inside range. */
-        else
-            return A.matchIPAddr( q->addr1 ); /* outside of range, 'less than' */
-    }
-}
-
 /**
  * Decode an ascii representation (asc) of a IP netmask address or CIDR,
  * and place resulting information in mask.
@@ -387,20 +357,6 @@ acl_ip_data::FactoryParse(const char *t)
     if (changed)
         debugs(28, DBG_CRITICAL, "WARNING: aclIpParseIpData: Netmask masks away part of the specified IP in '" << t << "'");
 
-    // TODO: Either switch match() to Acl::SplayInserter<acl_ip_data*>::Compare()
-    // range logic (that does not have these problems) OR warn that some (or
-    // even all) addresses will never match this configured ACL value when
-    // `q->addr1.applyMask()` above is positive:
-    //
-    // * A single configured IP value will never match:
-    //   A.matchIPAddr(q->addr1) in aclIpAddrNetworkCompare() will not return 0.
-    //   For example, `acl x src 127.0.0.1/24` does not match any address.
-    //
-    // * A configured IP range will not match any q->addr1/mask IPs:
-    //   (A >= q->addr1) in aclIpAddrNetworkCompare() is false and
-    //   A.matchIPAddr(q->addr1) will not return 0.
-    //   For example, `acl y src 10.0.0.1-10.0.0.255/24` does not match 10.0.0.1.
-
     debugs(28,9, "Parsed: " << q->addr1 << "-" << q->addr2 << "/" << q->mask << "(/" << q->mask.cidr() <<")");
 
     /* 1.2.3.4/255.255.255.0  --> 1.2.3.0 */
@@ -515,6 +471,19 @@ ACLIP::empty() const
     return data->empty() && !matchAnyIpv4 && !matchAnyIpv6;
 }
 
+void
+ACLIP::prepareForUse()
+{
+    if (data) {
+        const auto addRange = [this](acl_ip_data * const &ip) {
+            addresses.add(ip->firstAddress(), ip->lastAddress());
+        };
+        data->visit(addRange);
+    }
+    addresses.compile();
+    debugs(28, 3, "trie bytes: " << addresses.memoryUsed());
+}
+
 int
 ACLIP::match(const Ip::Address &clientip)
 {
@@ -536,20 +505,10 @@ ACLIP::match(const Ip::Address &clientip)
         // fall through to look for an IPv4 match among IP parameters
     }
 
-    static acl_ip_data ClientAddress;
-    /*
-     * aclIpAddrNetworkCompare() takes two acl_ip_data pointers as
-     * arguments, so we must create a fake one for the client's IP
-     * address. Since we are scanning for a single IP mask and addr2
-     * MUST be set to empty.
-     */
-    ClientAddress.addr1 = clientip;
-    ClientAddress.addr2.setEmpty();
-    ClientAddress.mask.setEmpty();
-
-    const acl_ip_data * const * result =  data->find(&ClientAddress, aclIpAddrNetworkCompare);
-    debugs(28, 3, "aclIpMatchIp: '" << clientip << "' " << (result ? "found" : "NOT found"));
-    return (result != nullptr);
+    Assure(addresses.compiled()); // Acl::Node::Initialize() calls prepareForUse()
+    const auto found = addresses.match(clientip);
+    debugs(28, 3, "aclIpMatchIp: '" << clientip << "' " << (found ? "found" : "NOT found"));
+    return found;
 }
 
 acl_ip_data::acl_ip_data() :addr1(), addr2(), mask(), next (nullptr) {}
@@ -10,6 +10,7 @@
 #define SQUID_SRC_ACL_IP_H
 
 #include "acl/Data.h"
+#include "acl/IpTrie.h"
 #include "acl/Node.h"
 #include "ip/Address.h"
 #include "splay.h"
@@ -63,12 +64,17 @@ public:
     int match(ACLChecklist *checklist) override = 0;
     SBufList dump() const override;
     bool empty () const override;
+    void prepareForUse() override;
+    bool memoizable() const override { return true; }
 
 protected:
 
     int match(const Ip::Address &);
     IPSplay *data;
 
+    /// read-only index of data ranges built by prepareForUse()
+    Acl::IpTrie addresses;
+
 private:
     bool parseGlobal(const char *);
 
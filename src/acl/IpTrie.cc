@@ -0,0 +1,325 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+/* DEBUG: section 28    Access Control */
+
+#include "squid.h"
+#include "acl/IpTrie.h"
+#include "debug/Stream.h"
+#include "ip/Address.h"
+
+#include <algorithm>
+
+namespace
+{
+
+/// the maximum number of address bits covered by one trie node
+const unsigned int Stride = 6;
+
+/// the number of address bits in an IPv4-mapped IPv6 address prefix
+const unsigned int MappedPrefixBits = 96;
+
+/// the number of leading IPv4 address bits indexing IpTrie::ipv4Direct
+const unsigned int DirectBits = 16;
+
+/// the minimum number of IPv4 ranges that justifies ipv4Direct memory
+const size_t DirectMinRanges = 4096;
+
+/// marks IpTrie::ipv4Direct entries that are not node indexes
+const uint32_t DirectLeaf = 0x80000000;
+
+/// marks DirectLeaf entries covered by some range
+const uint32_t DirectMatch = 1;
+
+/// the number of bits covered by a node at the given depth
+unsigned int
+StrideAt(const unsigned int depth)
+{
+    return std::min(Stride, 128 - depth);
+}
+
+} // namespace
+
+Acl::IpTrie::Key
+Acl::IpTrie::KeyOf(const Ip::Address &address)
+{
+    struct in6_addr raw;
+    address.getInAddr(raw);
+    Key key;
+    for (size_t i = 0; i < 8; ++i) {
+        key.hi = (key.hi << 8) | raw.s6_addr[i];
+        key.lo = (key.lo << 8) | raw.s6_addr[i + 8];
+    }
+    return key;
+}
+
+/// the given number of key bits starting at the given depth
+static uint64_t
+Chunk(const uint64_t hi, const uint64_t lo, const unsigned int depth, const unsigned int stride)
+{
+    uint64_t top;
+    if (depth == 0)
+        top = hi;
+    else if (depth < 64)
+        top = (hi << depth) | (lo >> (64 - depth));
+    else
+        top = lo << (depth - 64);
+    return top >> (64 - stride);
+}
+
+/// the key with the stride bits at the given depth set to the given value;
+/// those bits must be zero in the original key
+template <class Key>
+static Key
+WithChunk(Key key, const unsigned int depth, const unsigned int stride, const uint64_t value)
+{
+    const auto shift = 128 - depth - stride; // position of the lowest chunk bit
+    if (shift >= 64) {
+        key.hi |= value << (shift - 64);
+    } else {
+        key.lo |= value << shift;
+        if (shift + stride > 64)
+            key.hi |= value >> (64 - shift);
+    }
+    return key;
+}
+
+/// the key with all bits at and after the given depth set
+template <class Key>
+static Key
+WithOnesFrom(Key key, const unsigned int depth)
+{
+    if (depth < 64) {
+        key.hi |= ~uint64_t(0) >> depth;
+        key.lo = ~uint64_t(0);
+    } else if (depth < 128) {
+        key.lo |= ~uint64_t(0) >> (depth - 64);
+    }
+    return key;
+}
+
+void
+Acl::IpTrie::add(const Ip::Address &first, const Ip::Address &last)
+{
+    const auto firstKey = KeyOf(first);
+    const auto lastKey = KeyOf(last);
+    if (lastKey < firstKey)
+        return; // an empty range
+    pending.emplace_back(firstKey, lastKey);
+    compiled_ = false;
+}
+
+/// sorts the given ranges and merges overlapping and adjacent ones
+Acl::IpTrie::Ranges
+Acl::IpTrie::Normalize(Ranges ranges)
+{
+    std::sort(ranges.begin(), ranges.end());
+    Ranges result;
+    for (const auto &range: ranges) {
+        if (!result.empty()) {
+            auto &previous = result.back();
+            // the key right after the previous range (if there is one)
+            auto next = previous.second;
+            const auto wrapped = (++next.lo == 0) && (++next.hi == 0);
+            if (wrapped || range.first <= next) {
+                if (previous.second < range.second)
+                    previous.second = range.second;
+                continue;
+            }
+        }
+        result.push_back(range);
+    }
+    return result;
+}
+
+void
+Acl::IpTrie::compile()
+{
+    const auto ranges = Normalize(std::move(pending));
+    pending = Ranges();
+
+    // the IPv4-mapped address space, ::ffff:0.0.0.0/96
+    Key mappedFirst;
+    mappedFirst.lo = uint64_t(0xFFFF) << 32;
+    const auto mappedLast = WithOnesFrom(mappedFirst, MappedPrefixBits);
+
+    Ranges ipv4;
+    Ranges ipv6;
+    for (const auto &range: ranges) {
+        if (range.second < mappedFirst || mappedLast < range.first) {
+            ipv6.push_back(range);
+            continue;
+        }
+
+        ipv4.emplace_back(std::max(range.first, mappedFirst), std::min(range.second, mappedLast));
+
+        // IPv6 lookups never visit the IPv4-mapped space; keep it empty
+        if (range.first < mappedFirst) {
+            auto beforeMapped = mappedFirst;
+            --beforeMapped.lo; // mappedFirst.lo is not zero
+            ipv6.emplace_back(range.first, beforeMapped);
+        }
+        if (mappedLast < range.second) {
+            auto afterMapped = mappedLast;
+            ++afterMapped.lo; // mappedLast.lo is not all ones
+            ipv6.emplace_back(afterMapped, range.second);
+        }
+    }
+
+    nodes.clear();
+    ipv4Direct.clear();
+    if (ipv4.size() >= DirectMinRanges)
+        buildDirect(ipv4, mappedFirst);
+    else
+        ipv4Root = build(ipv4, 0, ipv4.size(), mappedFirst, MappedPrefixBits);
+    ipv6Root = build(ipv6, 0, ipv6.size(), Key(), 0);
+    nodes.shrink_to_fit();
+    compiled_ = true;
+
+    debugs(28, 5, "IPv4 ranges: " << ipv4.size() << " IPv6 ranges: " << ipv6.size() <<
+           " nodes: " << nodes.size() << " direct entries: " << ipv4Direct.size());
+}
+
+/// Determines how the given sorted disjoint ranges cover the given slot.
+/// Skips leading ranges that end before the slot.
+/// \returns the end of ranges intersecting the slot (begin if none)
+/// \param covered whether all slot addresses are in one range
+template <class Ranges, class Key>
+static size_t
+Coverage(const Ranges &ranges, size_t &begin, const size_t end, const Key &slotFirst, const Key &slotLast, bool &covered)
+{
+    covered = false;
+
+    while (begin < end && ranges[begin].second < slotFirst)
+        ++begin;
+
+    if (begin == end || slotLast < ranges[begin].first)
+        return begin;
+
+    covered = ranges[begin].first <= slotFirst && slotLast <= ranges[begin].second;
+
+    auto intersectingEnd = begin + 1;
+    while (intersectingEnd < end && ranges[intersectingEnd].first <= slotLast)
+        ++intersectingEnd;
+    // the last range may continue into the next slot; do not skip it
+    return intersectingEnd;
+}
+
+/// creates a subtrie for the given sorted disjoint ranges, all inside the
+/// address space of the given prefix of the given depth (in bits)
+/// \returns the subtrie root index
+uint32_t
+Acl::IpTrie::build(const Ranges &ranges, const size_t begin, const size_t end, const Key &prefix, const unsigned int depth)
+{
+    const uint32_t root = nodes.size();
+    nodes.emplace_back();
+    fill(root, ranges, begin, end, prefix, depth);
+    return root;
+}
+
+/// computes node slots and creates child nodes for the given ranges
+void
+Acl::IpTrie::fill(const uint32_t nodeIndex, const Ranges &ranges, size_t begin, const size_t end, const Key &prefix, const unsigned int depth)
+{
+    const auto stride = StrideAt(depth);
+    const uint64_t slots = uint64_t(1) << stride;
+
+    class Child
+    {
+    public:
+        Key prefix;
+        size_t begin;
+        size_t end;
+    };
+    std::vector<Child> children;
+
+    uint64_t childMap = 0;
+    uint64_t matchMap = 0;
+    for (uint64_t slot = 0; slot < slots; ++slot) {
+        const auto slotFirst = WithChunk(prefix, depth, stride, slot);
+        const auto slotLast = WithOnesFrom(slotFirst, depth + stride);
+        bool covered = false;
+        const auto intersectingEnd = Coverage(ranges, begin, end, slotFirst, slotLast, covered);
+        if (covered) {
+            matchMap |= uint64_t(1) << slot;
+        } else if (intersectingEnd != begin) {
+            childMap |= uint64_t(1) << slot;
+            children.push_back(Child{slotFirst, begin, intersectingEnd});
+        }
+    }
+
+    const uint32_t firstChild = nodes.size();
+    nodes[nodeIndex].children = childMap;
+    nodes[nodeIndex].matches = matchMap;
+    nodes[nodeIndex].firstChild = firstChild;
+    nodes.resize(nodes.size() + children.size());
+
+    for (size_t i = 0; i < children.size(); ++i)
+        fill(firstChild + i, ranges, children[i].begin, children[i].end, children[i].prefix, depth + stride);
+}
+
+/// fills ipv4Direct with a leaf or a subtrie for every DirectBits prefix
+/// of the IPv4-mapped address space
+void
+Acl::IpTrie::buildDirect(const Ranges &ranges, const Key &prefix)
+{
+    const auto depth = MappedPrefixBits + DirectBits;
+    size_t begin = 0;
+    ipv4Direct.resize(uint32_t(1) << DirectBits);
+    for (uint32_t slot = 0; slot < ipv4Direct.size(); ++slot) {
+        const auto slotFirst = WithChunk(prefix, MappedPrefixBits, DirectBits, slot);
+        const auto slotLast = WithOnesFrom(slotFirst, depth);
+        bool covered = false;
+        const auto intersectingEnd = Coverage(ranges, begin, ranges.size(), slotFirst, slotLast, covered);
+        if (covered)
+            ipv4Direct[slot] = DirectLeaf | DirectMatch;
+        else if (intersectingEnd == begin)
+            ipv4Direct[slot] = DirectLeaf;
+        else
+            ipv4Direct[slot] = build(ranges, begin, intersectingEnd, slotFirst, depth);
+    }
+}
+
+bool
+Acl::IpTrie::match(const Ip::Address &address) const
+{
+    if (!compiled_)
+        return false;
+
+    const auto key = KeyOf(address);
+    if (address.isIPv4()) {
+        if (ipv4Direct.empty())
+            return lookup(key, ipv4Root, MappedPrefixBits);
+        const auto entry = ipv4Direct[Chunk(key.hi, key.lo, MappedPrefixBits, DirectBits)];
+        if (entry & DirectLeaf)
+            return entry & DirectMatch;
+        return lookup(key, entry, MappedPrefixBits + DirectBits);
+    }
+    return lookup(key, ipv6Root, 0);
+}
+
+bool
+Acl::IpTrie::lookup(const Key &key, uint32_t nodeIndex, unsigned int depth) const
+{
+    for (;;) {
+        const auto &node = nodes[nodeIndex];
+        const auto stride = StrideAt(depth);
+        const auto bit = uint64_t(1) << Chunk(key.hi, key.lo, depth, stride);
+        if (!(node.children & bit))
+            return node.matches & bit;
+        nodeIndex = node.firstChild + __builtin_popcountll(node.children & (bit - 1));
+        depth += stride;
+    }
+}
+
+size_t
+Acl::IpTrie::memoryUsed() const
+{
+    return nodes.capacity() * sizeof(Node) + ipv4Direct.capacity() * sizeof(uint32_t) + pending.capacity() * sizeof(Range);
+}
+
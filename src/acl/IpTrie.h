@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#ifndef SQUID_SRC_ACL_IPTRIE_H
+#define SQUID_SRC_ACL_IPTRIE_H
+
+#include "ip/forward.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Acl
+{
+
+/// A set of IP address ranges (e.g., CIDR prefixes), compiled into a
+/// compact multibit trie in the spirit of Poptrie: each node covers six
+/// address bits using two 64-bit maps, one marking child nodes and one
+/// marking covered slots. IPv4 addresses are looked up from a separate root
+/// that skips the IPv4-mapped prefix (or, for large sets, from a table
+/// indexed by leading IPv4 address bits). The compiled trie is read-only.
+class IpTrie
+{
+public:
+    /// adds addresses from first to last, inclusive; must be followed by compile()
+    void add(const Ip::Address &first, const Ip::Address &last);
+
+    /// replaces the lookup trie with one built from ranges add()ed since
+    /// the previous compile() call
+    void compile();
+
+    /// whether compile() was called after the last add()
+    bool compiled() const { return compiled_; }
+
+    /// whether the address belongs to any compiled range
+    bool match(const Ip::Address &) const;
+
+    /// the number of bytes used by the compiled trie
+    size_t memoryUsed() const;
+
+private:
+    /// a 128-bit IPv6 (or IPv4-mapped) address in host byte order
+    class Key
+    {
+    public:
+        bool operator <(const Key &other) const { return hi < other.hi || (hi == other.hi && lo < other.lo); }
+        bool operator <=(const Key &other) const { return !(other < *this); }
+
+        uint64_t hi = 0;
+        uint64_t lo = 0;
+    };
+
+    /// a trie node covering Stride (or fewer) address bits
+    class Node
+    {
+    public:
+        uint64_t children = 0; ///< slots with child nodes
+        uint64_t matches = 0; ///< slots without child nodes that are inside some range
+        uint32_t firstChild = 0; ///< index of the first (consecutive) child node
+    };
+
+    using Range = std::pair<Key, Key>;
+    using Ranges = std::vector<Range>;
+
+    static Key KeyOf(const Ip::Address &);
+    static Ranges Normalize(Ranges);
+
+    uint32_t build(const Ranges &, size_t begin, size_t end, const Key &prefix, unsigned int depth);
+    void buildDirect(const Ranges &, const Key &prefix);
+    void fill(uint32_t nodeIndex, const Ranges &, size_t begin, size_t end, const Key &prefix, unsigned int depth);
+    bool lookup(const Key &, uint32_t nodeIndex, unsigned int depth) const;
+
+    /// ranges add()ed since the last compile()
+    Ranges pending;
+
+    /// compiled nodes of both roots
+    std::vector<Node> nodes;
+
+    /// Poptrie-like direct pointing for large IPv4 sets: maps the leading
+    /// IPv4 address bits to a subtrie index or a leaf; empty if unused
+    std::vector<uint32_t> ipv4Direct;
+
+    uint32_t ipv4Root = 0; ///< the root of the IPv4-mapped address space trie (without ipv4Direct)
+    uint32_t ipv6Root = 0; ///< the root of the trie for other addresses
+
+    bool compiled_ = false;
+};
+
+} // namespace Acl
+
+#endif /* SQUID_SRC_ACL_IPTRIE_H */
+
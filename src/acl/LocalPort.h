@@ -21,6 +21,7 @@ class LocalPortCheck: public ParameterizedNode< ACLData<int> >
 public:
     /* Acl::Node API */
     int match(ACLChecklist *) override;
+    bool memoizable() const override { return true; }
 };
 
 } // namespace Acl
@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+/* DEBUG: section 28    Access Control */
+
+#include "squid.h"
+#include "acl/Memo.h"
+#include "debug/Stream.h"
+#include "HttpReply.h"
+
+/// whether the two addresses have the same IP address and port
+static bool
+SameAddress(const Ip::Address &a, const Ip::Address &b)
+{
+    return a == b && a.port() == b.port();
+}
+
+Acl::Memo::Memo() = default;
+
+Acl::Memo::~Memo() = default;
+
+void
+Acl::Memo::sync(const uint64_t anUrlGeneration, const HttpReply::Pointer &aReply, const Ip::Address &aSource, const Ip::Address &aDestination, const Ip::Address &aLocal, const SBuf &aPeerName)
+{
+    if (urlGeneration == anUrlGeneration && reply == aReply && SameAddress(source, aSource) &&
+            SameAddress(destination, aDestination) && SameAddress(local, aLocal) && peerName == aPeerName)
+        return;
+
+    if (!results.empty()) {
+        debugs(28, 5, "forgetting " << results.size() << " results");
+        results.clear();
+    }
+
+    urlGeneration = anUrlGeneration;
+    reply = aReply;
+    source = aSource;
+    destination = aDestination;
+    local = aLocal;
+    peerName = aPeerName;
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#ifndef SQUID_SRC_ACL_MEMO_H
+#define SQUID_SRC_ACL_MEMO_H
+
+#include "acl/Node.h"
+#include "base/RefCount.h"
+#include "ip/Address.h"
+#include "mem/PoolingAllocator.h"
+#include "sbuf/SBuf.h"
+
+#include <unordered_map>
+
+class HttpReply;
+
+namespace Acl
+{
+
+/// Results of ACL evaluations remembered within one transaction so that
+/// directives checked later can reuse them (see acl_memoization). Results
+/// are forgotten when the checked request URL, response, or addresses change.
+class Memo: public RefCountable
+{
+public:
+    using Pointer = RefCount<Memo>;
+
+    Memo();
+    ~Memo() override;
+
+    /// Sets the given remembered result of the given ACL (if any).
+    /// \returns whether the result was remembered
+    bool find(const Node &acl, bool &matched) const
+    {
+        const auto found = results.find(&acl);
+        if (found == results.end())
+            return false;
+        matched = found->second.matched;
+        return true;
+    }
+
+    /// Remembers the given ACL match() result if it is final: Results of
+    /// evaluations that are waiting for an async lookup (or have failed to
+    /// produce a match/mismatch answer) are not remembered.
+    /// \param waiting whether the checklist is waiting for an async lookup
+    /// \returns whether the result was remembered
+    bool remember(const Node &acl, const int result, const bool waiting)
+    {
+        if (waiting || (result != 0 && result != 1))
+            return false;
+        results[&acl] = Result{RefCount<const Node>(&acl), result == 1};
+        return true;
+    }
+
+    /// Forgets all results if they were computed for a different request URL,
+    /// response, or addresses, remembering the given ones for the future
+    /// sync() calls.
+    /// \param urlGeneration AnyP::Uri::generation() of the request URL
+    void sync(uint64_t urlGeneration, const RefCount<HttpReply> &, const Ip::Address &source, const Ip::Address &destination, const Ip::Address &local, const SBuf &peerName);
+
+    /// the number of remembered results
+    size_t size() const { return results.size(); }
+
+private:
+    /// a remembered ACL evaluation result
+    class Result
+    {
+    public:
+        /// prevents (reconfiguration-driven) reuse of the ACL object address
+        RefCount<const Node> acl;
+        bool matched = false;
+    };
+
+    using Results = std::unordered_map<const Node *, Result, std::hash<const Node *>, std::equal_to<const Node *>, PoolingAllocator< std::pair<const Node * const, Result> > >;
+
+    /// remembered results indexed by the ACL they belong to
+    Results results;
+
+    /* the checked state the results are valid for */
+    uint64_t urlGeneration = 0;
+    RefCount<HttpReply> reply;
+    Ip::Address source;
+    Ip::Address destination;
+    Ip::Address local;
+    SBuf peerName;
+};
+
+} // namespace Acl
+
+#endif /* SQUID_SRC_ACL_MEMO_H */
+
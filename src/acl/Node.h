@@ -18,6 +18,26 @@ class ConfigParser;
 
 namespace Acl {
 
+/// Acl::Node::matches() statistics (see the acl_stats cache manager report)
+class NodeStats
+{
+public:
+    /// accounts for one matches() call
+    void note(uint64_t nanoseconds, bool matched, bool waited);
+
+    NodeStats &operator +=(const NodeStats &);
+
+    uint64_t evaluations = 0; ///< the number of matches() calls
+    uint64_t matches = 0; ///< the number of matches() calls that returned true
+    uint64_t asyncWaits = 0; ///< the number of matches() calls that started waiting for an async lookup
+    /// nanoseconds spent in matches() calls, including nested ACLs
+    /// (zero unless acl_timing is on)
+    uint64_t totalTime = 0;
+    /// the duration of the longest matches() call in nanoseconds
+    /// (zero unless acl_timing is on)
+    uint64_t maxTime = 0;
+};
+
 /// A configurable condition. A node in the ACL expression tree.
 /// Can evaluate itself in FilledChecklist context.
 /// Does not change during evaluation.
@@ -82,6 +102,14 @@ public:
 
     char *cfgline = nullptr;
 
+    /// the number of matches() answered using a result remembered in Acl::Memo
+    mutable uint64_t memoHits = 0;
+    /// the number of match() results remembered in Acl::Memo
+    mutable uint64_t memoMisses = 0;
+
+    /// matches() statistics of this ACL
+    mutable NodeStats stats;
+
 private:
     /// Matches the actual data in checklist against this Acl::Node.
     virtual int match(ACLChecklist *checklist) = 0;  // XXX: missing const
@@ -92,6 +120,9 @@ private:
     virtual bool requiresRequest() const;
     /// whether our (i.e. shallow) match() requires checklist to have a reply
     virtual bool requiresReply() const;
+    /// whether our (i.e. shallow) match() result depends on nothing but the
+    /// transaction request, reply, and addresses tracked by Acl::Memo
+    virtual bool memoizable() const;
 
     // TODO: Rename to globalOptions(); these are not the only supported options
     /// \returns (linked) 'global' Options supported by this Acl::Node
@@ -21,6 +21,7 @@ class PeerNameCheck: public ParameterizedNode< ACLData<const char *> >
 public:
     /* Acl::Node API */
     int match(ACLChecklist *) override;
+    bool memoizable() const override { return true; }
 };
 
 } // namespace Acl
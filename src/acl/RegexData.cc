@@ -26,6 +26,8 @@
 #include "sbuf/List.h"
 #include "sbuf/Stream.h"
 
+#include <algorithm>
+
 Acl::BooleanOptionValue ACLRegexData::CaseInsensitive_;
 
 ACLRegexData::~ACLRegexData()
@@ -49,19 +51,44 @@ ACLRegexData::match(char const *word)
 
     debugs(28, 3, "checking '" << word << "'");
 
-    // walk the list of patterns to see if one matches
-    for (auto &i : data) {
-        if (i.match(word)) {
-            debugs(28, 2, '\'' << i << "' found in '" << word << '\'');
-            // TODO: old code also popped the pattern to second place of the list
-            // in order to reduce patterns search times.
-            return 1;
-        }
+    if (const auto pattern = firstMatch(word)) {
+        debugs(28, 2, '\'' << *pattern << "' found in '" << word << '\'');
+        return 1;
     }
 
     return 0;
 }
 
+const RegexPattern *
+ACLRegexData::firstMatch(const char *word)
+{
+    if (!prefilter.compiled()) {
+        for (const auto pattern: patterns) {
+            if (pattern->match(word))
+                return pattern;
+        }
+        return nullptr;
+    }
+
+    candidates.clear();
+    prefilter.find(word, candidates);
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    // merge prefilter candidates with patterns lacking required literals
+    auto candidate = candidates.cbegin();
+    auto other = unfiltered.cbegin();
+    while (candidate != candidates.cend() || other != unfiltered.cend()) {
+        const auto useCandidate = other == unfiltered.cend() ||
+                                  (candidate != candidates.cend() && *candidate < *other);
+        const auto pattern = patterns[useCandidate ? *candidate++ : *other++];
+        if (pattern->match(word))
+            return pattern;
+    }
+
+    return nullptr;
+}
+
 SBufList
 ACLRegexData::dump() const
 {
@@ -217,27 +244,65 @@ compileUnoptimisedREs(std::list<RegexPattern> &curlist, const SBufList &sl, cons
     }
 }
 
+/// Compiles the given REs (and -i/+i flags), preserving their configuration
+/// order. An RE with required literals is compiled individually and
+/// registered with the prefilter. Consecutive REs without such literals are
+/// merged (if possible) by compileUnfiltered().
 void
-ACLRegexData::parse()
+ACLRegexData::compileLine(const SBufList &sl, const int flagsAtLineStart)
 {
-    debugs(28, 2, "new Regex line or file");
+    auto flags = flagsAtLineStart;
+    SBufList run; // consecutive REs without required literals (and -i/+i flags)
+    auto runFlags = flags; // flags in effect before the first run RE
+    auto runSize = 0; // the number of REs in the run
 
-    int flagsAtLineStart = REG_EXTENDED | REG_NOSUB;
-    if (CaseInsensitive_)
-        flagsAtLineStart |= REG_ICASE;
+    static const SBuf minus_i("-i"), plus_i("+i");
+    for (const auto &configurationLineWord: sl) {
+        if (configurationLineWord == minus_i || configurationLineWord == plus_i) {
+            if (configurationLineWord == minus_i)
+                flags |= REG_ICASE;
+            else
+                flags &= ~REG_ICASE;
+            if (runSize)
+                run.push_back(configurationLineWord);
+            continue;
+        }
 
-    SBufList sl;
-    while (char *t = ConfigParser::RegexStrtokFile()) {
-        const char *clean = removeUnnecessaryWildcards(t);
-        debugs(28, 3, "buffering RE '" << clean << "'");
-        sl.emplace_back(clean);
+        const auto literal = Acl::RegexPrefilter::RequiredLiteral(SBuf(configurationLineWord).c_str());
+        if (literal.empty()) {
+            if (!runSize)
+                runFlags = flags;
+            run.push_back(configurationLineWord);
+            ++runSize;
+            continue;
+        }
+
+        compileUnfiltered(run, runFlags);
+        run.clear();
+        runSize = 0;
+
+        debugs(28, 3, "prefiltering RE '" << configurationLineWord << "' using '" << literal << "'");
+        compileRE(data, configurationLineWord, flags);
+        prefilter.add(literal, patterns.size());
+        patterns.push_back(&data.back());
     }
 
+    compileUnfiltered(run, runFlags);
+}
+
+/// Compiles REs that must be checked for every word, merging them if possible.
+void
+ACLRegexData::compileUnfiltered(const SBufList &sl, const int flagsAtRunStart)
+{
+    if (sl.empty())
+        return;
+
+    const auto oldSize = data.size();
     try {
         // ignore the danger of merging invalid REs into a valid "optimized" RE
-        compileOptimisedREs(data, sl, flagsAtLineStart);
+        compileOptimisedREs(data, sl, flagsAtRunStart);
     } catch (...) {
-        compileUnoptimisedREs(data, sl, flagsAtLineStart);
+        compileUnoptimisedREs(data, sl, flagsAtRunStart);
         // Delay compileOptimisedREs() failure reporting until we know that
         // compileUnoptimisedREs() above have succeeded. If
         // compileUnoptimisedREs() also fails, then the compileOptimisedREs()
@@ -247,6 +312,40 @@ ACLRegexData::parse()
                Debug::Extra << "configuration: " << cfg_filename << " line " << config_lineno << ": " << config_input_line <<
                Debug::Extra << "optimization error: " << CurrentException);
     }
+
+    for (auto i = std::next(data.cbegin(), oldSize); i != data.cend(); ++i) {
+        unfiltered.push_back(patterns.size());
+        patterns.push_back(&*i);
+    }
+}
+
+void
+ACLRegexData::parse()
+{
+    debugs(28, 2, "new Regex line or file");
+
+    int flagsAtLineStart = REG_EXTENDED | REG_NOSUB;
+    if (CaseInsensitive_)
+        flagsAtLineStart |= REG_ICASE;
+
+    SBufList sl;
+    while (char *t = ConfigParser::RegexStrtokFile()) {
+        const char *clean = removeUnnecessaryWildcards(t);
+        debugs(28, 3, "buffering RE '" << clean << "'");
+        sl.emplace_back(clean);
+    }
+
+    compileLine(sl, flagsAtLineStart);
+}
+
+void
+ACLRegexData::prepareForUse()
+{
+    if (prefilter.empty())
+        return;
+
+    prefilter.compile();
+    debugs(28, 3, "prefiltered REs: " << (patterns.size() - unfiltered.size()) << '/' << patterns.size());
 }
 
 bool
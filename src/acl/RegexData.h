@@ -10,8 +10,10 @@
 #define SQUID_SRC_ACL_REGEXDATA_H
 
 #include "acl/Data.h"
+#include "acl/RegexPrefilter.h"
 
 #include <list>
+#include <vector>
 
 class RegexPattern;
 
@@ -24,8 +26,13 @@ public:
     bool match(char const *user) override;
     SBufList dump() const override;
     void parse() override;
+    void prepareForUse() override;
     bool empty() const override;
 
+    /// the first configured pattern that matches the given word
+    /// \returns nil if no pattern matches
+    const RegexPattern *firstMatch(const char *word);
+
 private:
     /// whether parse() is called in a case insensitive context
     static Acl::BooleanOptionValue CaseInsensitive_;
@@ -33,7 +40,24 @@ private:
     /* ACLData API */
     const Acl::Options &lineOptions() override;
 
+    void compileLine(const SBufList &, int flagsAtLineStart);
+    void compileUnfiltered(const SBufList &, int flagsAtRunStart);
+
+    /// configured patterns (with consecutive patterns lacking required
+    /// literals possibly merged into one) in configuration order
     std::list<RegexPattern> data;
+
+    /// data patterns in data order; prefilter IDs are their indexes
+    std::vector<const RegexPattern *> patterns;
+
+    /// indexes of patterns that must be checked for every word
+    std::vector<size_t> unfiltered;
+
+    /// finds patterns that may match a word among those with required literals
+    Acl::RegexPrefilter prefilter;
+
+    /// prefilter results (reused to avoid allocations)
+    std::vector<size_t> candidates;
 };
 
 #endif /* SQUID_SRC_ACL_REGEXDATA_H */
@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+/* DEBUG: section 28    Access Control */
+
+#include "squid.h"
+#include "acl/RegexPrefilter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <deque>
+
+namespace
+{
+
+/// literals shorter than this are too common to narrow the search
+const size_t MinLiteralSize = 3;
+
+/// the prefilter spelling of a byte
+uint8_t
+Fold(const char c)
+{
+    return static_cast<uint8_t>(xtolower(static_cast<unsigned char>(c)));
+}
+
+/// skips a bracket expression starting at the given '['
+/// \returns the position after the closing ']' or nil on parsing errors
+const char *
+SkipBracket(const char *p)
+{
+    ++p; // '['
+    if (*p == '^')
+        ++p;
+    if (*p == ']') // a literal ']' as the first list item
+        ++p;
+    while (*p && *p != ']') {
+        if (*p == '[' && (p[1] == ':' || p[1] == '.' || p[1] == '=')) {
+            const char terminator[3] = { p[1], ']', '\0' };
+            const auto end = strstr(p + 2, terminator);
+            if (!end)
+                return nullptr;
+            p = end + 2;
+        } else {
+            ++p;
+        }
+    }
+    return *p ? p + 1 : nullptr;
+}
+
+} // namespace
+
+/// Finds runs of ordinary characters outside of groups and picks the longest
+/// one. Ignores characters made optional by a quantifier and gives up on
+/// top-level alternations. Non-ASCII characters end a run because their
+/// case-insensitive matching may depend on the locale.
+std::string
+Acl::RegexPrefilter::RequiredLiteral(const char *pattern)
+{
+    std::string best;
+    std::string run;
+    const auto endRun = [&best, &run]() {
+        if (run.size() > best.size())
+            best = run;
+        run.clear();
+    };
+
+    size_t depth = 0; // group nesting level
+    auto lastAtomInRun = false; // whether the last atom is the last run character
+    for (auto p = pattern; *p;) {
+        const auto c = *p;
+
+        if (c == '[') {
+            p = SkipBracket(p);
+            if (!p)
+                return std::string();
+            if (!depth)
+                endRun();
+            lastAtomInRun = false;
+            continue;
+        }
+
+        if (c == '\\') {
+            const auto escaped = p[1];
+            if (!escaped)
+                return std::string();
+            p += 2;
+            if (depth)
+                continue;
+            // \. is a literal but \w, \b, \1, and similar extensions are not;
+            // neither are GNU anchors \< (word start), \> (word end), \`
+            // (buffer start), and \' (buffer end)
+            const auto ordinary = !isalnum(static_cast<unsigned char>(escaped)) && static_cast<unsigned char>(escaped) < 0x80 &&
+                                  !strchr("<>`'", escaped);
+            if (ordinary)
+                run.push_back(escaped);
+            else
+                endRun();
+            lastAtomInRun = ordinary;
+            continue;
+        }
+
+        ++p;
+
+        if (c == '(') {
+            if (!depth)
+                endRun();
+            ++depth;
+            lastAtomInRun = false;
+            continue;
+        }
+
+        if (c == ')') {
+            if (!depth)
+                return std::string();
+            --depth;
+            continue;
+        }
+
+        if (depth)
+            continue;
+
+        switch (c) {
+        case '|':
+            return std::string();
+
+        case '*':
+        case '?':
+        case '{':
+        case '+': {
+            // a quantifier (or a chain of them, like a+?) ends the run; the
+            // quantified atom stays required only if all of them are '+'
+            auto required = true;
+            for (auto q = c;; q = *p++) {
+                if (q == '{') {
+                    p = strchr(p, '}');
+                    if (!p)
+                        return std::string();
+                    ++p;
+                }
+                if (q != '+')
+                    required = false;
+                if (!strchr("*?{+", *p) || !*p)
+                    break;
+            }
+            if (lastAtomInRun && !required)
+                run.pop_back();
+            endRun();
+            lastAtomInRun = false;
+            break;
+        }
+
+        case '.':
+        case '^':
+        case '$':
+            endRun();
+            lastAtomInRun = false;
+            break;
+
+        default:
+            if (static_cast<unsigned char>(c) >= 0x80) {
+                endRun();
+                lastAtomInRun = false;
+            } else {
+                run.push_back(c);
+                lastAtomInRun = true;
+            }
+        }
+    }
+
+    if (depth)
+        return std::string();
+
+    endRun();
+    if (best.size() < MinLiteralSize)
+        return std::string();
+    return best;
+}
+
+void
+Acl::RegexPrefilter::add(const std::string &literal, const size_t id)
+{
+    assert(!literal.empty());
+    compiled_ = false;
+
+    StateId current = 0;
+    for (const auto c: literal) {
+        const auto byte = Fold(c);
+        auto &next = states[current].next;
+        const auto found = std::find_if(next.begin(), next.end(), [byte](const auto &edge) { return edge.first == byte; });
+        if (found != next.end()) {
+            current = found->second;
+        } else {
+            const StateId fresh = states.size();
+            next.emplace_back(byte, fresh);
+            states.emplace_back();
+            current = fresh;
+        }
+    }
+    states[current].ids.push_back(id);
+}
+
+void
+Acl::RegexPrefilter::compile()
+{
+    rootNext.fill(0);
+    for (auto &state: states) {
+        std::sort(state.next.begin(), state.next.end());
+        state.next.shrink_to_fit();
+    }
+    for (const auto &edge: states[0].next)
+        rootNext[edge.first] = edge.second;
+
+    // compute failure and output links in breadth-first order so that links
+    // of all shorter prefixes are ready
+    std::deque<StateId> queue;
+    for (const auto &edge: states[0].next) {
+        states[edge.second].failure = 0;
+        states[edge.second].output = 0;
+        queue.push_back(edge.second);
+    }
+    while (!queue.empty()) {
+        const auto parent = queue.front();
+        queue.pop_front();
+        for (const auto &edge: states[parent].next) {
+            auto &state = states[edge.second];
+            state.failure = transition(states[parent].failure, edge.first);
+            const auto &failure = states[state.failure];
+            state.output = failure.ids.empty() ? failure.output : state.failure;
+            queue.push_back(edge.second);
+        }
+    }
+
+    states.shrink_to_fit();
+    compiled_ = true;
+}
+
+/// the goto transition of the given state or zero
+Acl::RegexPrefilter::StateId
+Acl::RegexPrefilter::child(const State &state, const uint8_t byte) const
+{
+    const auto found = std::lower_bound(state.next.begin(), state.next.end(), byte,
+    [](const auto &edge, const uint8_t b) { return edge.first < b; });
+    return (found != state.next.end() && found->first == byte) ? found->second : 0;
+}
+
+/// the automaton state after consuming the given byte in the given state
+Acl::RegexPrefilter::StateId
+Acl::RegexPrefilter::transition(StateId current, const uint8_t byte) const
+{
+    while (current) {
+        if (const auto next = child(states[current], byte))
+            return next;
+        current = states[current].failure;
+    }
+    return rootNext[byte];
+}
+
+void
+Acl::RegexPrefilter::find(const char *text, std::vector<size_t> &ids) const
+{
+    assert(compiled_);
+    StateId current = 0;
+    for (auto p = text; *p; ++p) {
+        current = transition(current, Fold(*p));
+        for (auto matched = states[current].ids.empty() ? states[current].output : current; matched; matched = states[matched].output)
+            ids.insert(ids.end(), states[matched].ids.begin(), states[matched].ids.end());
+    }
+}
+
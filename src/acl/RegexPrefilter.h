@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#ifndef SQUID_SRC_ACL_REGEXPREFILTER_H
+#define SQUID_SRC_ACL_REGEXPREFILTER_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Acl
+{
+
+/// Finds regular expressions that may match a given string by searching the
+/// string for literals that those expressions require (e.g., "example" in
+/// ^https?://www\.example\.). Uses a single Aho-Corasick automaton pass, so
+/// the search cost does not depend on the number of expressions. Letter case
+/// is ignored; callers must confirm candidates using the expressions.
+class RegexPrefilter
+{
+public:
+    /// The longest literal that every string matching the given POSIX
+    /// extended regular expression must contain. Empty if there is no such
+    /// literal or it is too short to be selective.
+    static std::string RequiredLiteral(const char *pattern);
+
+    /// Registers the given non-empty literal of the expression with the
+    /// given ID. Must be followed by compile().
+    void add(const std::string &literal, size_t id);
+
+    /// prepares add()ed literals for find()
+    void compile();
+
+    /// whether compile() was called after the last add()
+    bool compiled() const { return compiled_; }
+
+    /// whether no literals were added
+    bool empty() const { return states.size() <= 1; }
+
+    /// Appends IDs of expressions with literals found in the given text.
+    /// The appended IDs may be unordered and may repeat.
+    void find(const char *text, std::vector<size_t> &ids) const;
+
+private:
+    using StateId = uint32_t;
+
+    /// an automaton node representing a prefix of one or more literals
+    class State
+    {
+    public:
+        /// goto transitions, sorted by their byte after compile()
+        std::vector<std::pair<uint8_t, StateId> > next;
+
+        /// the state of the longest proper suffix that is a literal prefix
+        StateId failure = 0;
+
+        /// the state of the longest proper suffix that ends some literal
+        StateId output = 0;
+
+        /// expressions with a literal ending at this state
+        std::vector<size_t> ids;
+    };
+
+    StateId child(const State &, uint8_t) const;
+    StateId transition(StateId, uint8_t) const;
+
+    /// states[0] is the root (an empty prefix)
+    std::vector<State> states = std::vector<State>(1);
+
+    /// root transitions for every byte, avoiding root failure searches
+    std::array<StateId, 256> rootNext = {};
+
+    bool compiled_ = false;
+};
+
+} // namespace Acl
+
+#endif /* SQUID_SRC_ACL_REGEXPREFILTER_H */
+
@@ -25,6 +25,7 @@ public:
     /* Acl::Node API */
     int match(ACLChecklist *) override;
     bool requiresRequest() const override {return true;}
+    bool memoizable() const override {return true;}
 };
 
 } // namespace Acl
@@ -12,6 +12,7 @@
 #include "acl/FilledChecklist.h"
 #include "acl/ServerName.h"
 #include "anyp/Host.h"
+#include "base/Assure.h"
 #include "client_side.h"
 #include "http/Stream.h"
 #include "HttpRequest.h"
@@ -20,16 +21,6 @@
 #include "ssl/ServerBump.h"
 #include "ssl/support.h"
 
-// Compare function for tree search algorithms
-static int
-aclHostDomainCompare( char *const &a, char * const &b)
-{
-    const char *h = static_cast<const char *>(a);
-    const char *d = static_cast<const char *>(b);
-    debugs(28, 7, "Match:" << h << " <>  " << d);
-    return matchDomainName(h, d, mdnHonorWildcards);
-}
-
 bool
 ACLServerNameData::match(const char *host)
 {
@@ -38,13 +29,12 @@ ACLServerNameData::match(const char *host)
 
     debugs(28, 3, "checking '" << host << "'");
 
-    char *h = const_cast<char *>(host);
-    char const * const * result = domains->find(h, aclHostDomainCompare);
+    Assure(domains.compiled()); // Acl::Node::Initialize() calls prepareForUse()
+    const auto result = domains.match(host, true);
 
     debugs(28, 3, "'" << host << "' " << (result ? "found" : "NOT found"));
 
-    return (result != nullptr);
-
+    return result;
 }
 
 namespace Acl {
@@ -22,6 +22,7 @@ class SourceAsnCheck: public ParameterizedNode< ACLData<Ip::Address> >
 public:
     /* Acl::Node API */
     int match(ACLChecklist *) override;
+    bool memoizable() const override { return true; }
 };
 
 } // namespace Acl
@@ -23,6 +23,7 @@ class SourceDomainCheck: public ParameterizedNode< ACLData<const char *> >
 public:
     /* Acl::Node API */
     int match(ACLChecklist *) override;
+    bool memoizable() const override { return true; }
 };
 
 } // namespace Acl
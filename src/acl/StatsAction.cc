@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+/* DEBUG: section 28    Access Control */
+
+#include "squid.h"
+#include "acl/Acl.h"
+#include "acl/StatsAction.h"
+#include "base/PackableStream.h"
+#include "base/TextException.h"
+#include "ipc/Messages.h"
+#include "ipc/TypedMsgHdr.h"
+#include "mgr/Command.h"
+#include "mgr/Registration.h"
+#include "mgr/StringParam.h"
+#include "sbuf/StringConvert.h"
+#include "SquidConfig.h"
+#include "Store.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+
+namespace
+{
+
+/// Kid responses must fit into one IPC message. This is the space left for
+/// ACL records after the response header, the record count, the statistics
+/// of omitted ACLs, and the truncation flag.
+const size_t PackBudget = Ipc::TypedMsgHdr::maxSize - 512;
+
+/// the number of message bytes used by a packed ACL record
+size_t
+PackedSize(const SBuf &name, const SBuf &type)
+{
+    return 2*sizeof(int) + name.length() + type.length() + sizeof(Acl::NodeStats);
+}
+
+/// the given number of nanoseconds in the given (smaller) units
+double
+Scaled(const uint64_t nanoseconds, const double unitNanoseconds)
+{
+    return nanoseconds / unitNanoseconds;
+}
+
+/// reports one acl_stats row
+/// \param partial whether the row lacks statistics from some kids
+void
+DumpRow(std::ostream &os, const SBuf &name, const SBuf &type, const Acl::NodeStats &stats, const bool partial)
+{
+    const auto meanTime = stats.evaluations ? stats.totalTime / stats.evaluations : 0;
+    os << name << (partial ? "*" : "") << '\t' << type << '\t' <<
+       stats.evaluations << '\t' << stats.matches << '\t' << stats.asyncWaits << '\t' <<
+       std::fixed << std::setprecision(3) <<
+       Scaled(stats.totalTime, 1e6) << '\t' <<
+       Scaled(meanTime, 1e3) << '\t' <<
+       Scaled(stats.maxTime, 1e3) << "\n";
+}
+
+} // namespace
+
+Acl::StatsAction::Pointer
+Acl::StatsAction::Create(const Mgr::CommandPointer &cmd)
+{
+    return new StatsAction(cmd);
+}
+
+Acl::StatsAction::StatsAction(const Mgr::CommandPointer &aCmd):
+    Action(aCmd)
+{
+}
+
+void
+Acl::StatsAction::collect()
+{
+    VisitNamedAcls([this](const Node &acl) {
+        if (acl.stats.evaluations) {
+            auto &record = records[acl.name];
+            record.type = SBuf(acl.typeString());
+            record.stats = acl.stats;
+        }
+    });
+}
+
+void
+Acl::StatsAction::add(const Mgr::Action &action)
+{
+    const auto &other = dynamic_cast<const StatsAction &>(action);
+    for (const auto &nameAndRecord: other.records) {
+        auto &record = records[nameAndRecord.first];
+        record.type = nameAndRecord.second.type;
+        record.stats += nameAndRecord.second.stats;
+        record.truncatedReports += nameAndRecord.second.truncatedReports;
+    }
+    omitted += other.omitted;
+    truncatedKids += other.truncatedKids;
+}
+
+void
+Acl::StatsAction::pack(Ipc::TypedMsgHdr &msg) const
+{
+    msg.setType(Ipc::mtCacheMgrResponse);
+
+    // send the most expensive ACLs that fit and combine the others
+    std::vector<Records::const_iterator> byTime;
+    for (auto i = records.begin(); i != records.end(); ++i)
+        byTime.push_back(i);
+    std::sort(byTime.begin(), byTime.end(), [](const auto a, const auto b) {
+        return a->second.stats.totalTime > b->second.stats.totalTime;
+    });
+
+    std::vector<Records::const_iterator> packed;
+    auto rest = omitted;
+    auto budget = PackBudget;
+    for (const auto i: byTime) {
+        const auto size = PackedSize(i->first, i->second.type);
+        if (size <= budget) {
+            packed.push_back(i);
+            budget -= size;
+        } else {
+            rest += i->second.stats;
+        }
+    }
+
+    msg.putInt(packed.size());
+    for (const auto i: packed) {
+        msg.putString(SBufToString(i->first));
+        msg.putString(SBufToString(i->second.type));
+        msg.putPod(i->second.stats);
+    }
+    msg.putPod(rest);
+    msg.putInt(packed.size() < records.size() ? 1 : 0);
+}
+
+void
+Acl::StatsAction::unpack(const Ipc::TypedMsgHdr &msg)
+{
+    msg.checkType(Ipc::mtCacheMgrResponse);
+
+    const auto count = msg.getInt();
+    Must(count >= 0);
+    for (int i = 0; i < count; ++i) {
+        String name;
+        msg.getString(name);
+        String type;
+        msg.getString(type);
+        auto &record = records[StringToSBuf(name)];
+        record.type = StringToSBuf(type);
+        msg.getPod(record.stats);
+    }
+    msg.getPod(omitted);
+
+    truncatedKids = msg.getInt();
+    Must(truncatedKids == 0 || truncatedKids == 1);
+    for (auto &nameAndRecord: records)
+        nameAndRecord.second.truncatedReports = truncatedKids;
+}
+
+std::vector<Acl::StatsAction::Records::const_iterator>
+Acl::StatsAction::sorted() const
+{
+    std::vector<Records::const_iterator> result;
+    for (auto i = records.begin(); i != records.end(); ++i)
+        result.push_back(i);
+
+    const char *key = "time";
+    const auto param = command().params.queryParams.get("sort");
+    if (const auto stringParam = dynamic_cast<const Mgr::StringParam *>(param.getRaw()))
+        key = stringParam->value().termedBuf();
+
+    using Metric = uint64_t (*)(const NodeStats &);
+    Metric metric = nullptr;
+    if (strcmp(key, "max") == 0)
+        metric = [](const NodeStats &stats) { return stats.maxTime; };
+    else if (strcmp(key, "evaluations") == 0)
+        metric = [](const NodeStats &stats) { return stats.evaluations; };
+    else if (strcmp(key, "matches") == 0)
+        metric = [](const NodeStats &stats) { return stats.matches; };
+    else if (strcmp(key, "waits") == 0)
+        metric = [](const NodeStats &stats) { return stats.asyncWaits; };
+    else if (strcmp(key, "name") != 0)
+        metric = [](const NodeStats &stats) { return stats.totalTime; };
+
+    // records are already sorted by name; keep that order for equal metrics
+    if (metric) {
+        std::stable_sort(result.begin(), result.end(), [metric](const auto a, const auto b) {
+            return metric(a->second.stats) > metric(b->second.stats);
+        });
+    }
+    return result;
+}
+
+void
+Acl::StatsAction::dump(StoreEntry *entry)
+{
+    PackableStream os(*entry);
+    os << "ACL evaluation statistics\n" <<
+       "Sort with ?sort=time (default), max, evaluations, matches, waits, or name.\n" <<
+       "Times include ACLs nested in any-of and all-of ACLs.\n";
+    if (!Config.onoff.aclTiming)
+        os << "Times are not measured; see acl_timing.\n";
+    if (truncatedKids) {
+        os << truncatedKids << " kid(s) reported only their most expensive ACLs.\n" <<
+           "Rows marked with * lack statistics from some of those kids;\n" <<
+           "the missing statistics are in the (other ACLs) row.\n";
+    }
+    os << "\n";
+
+    os << "ACL\tType\tEvaluations\tMatches\tAsync waits\tTotal ms\tMean us\tMax us\n";
+    for (const auto i: sorted())
+        DumpRow(os, i->first, i->second.type, i->second.stats, i->second.truncatedReports < truncatedKids);
+    if (omitted.evaluations)
+        DumpRow(os, SBuf("(other ACLs)"), SBuf("-"), omitted, false);
+    os.flush();
+}
+
+void
+Acl::StatsAction::RegisterWithCacheManager()
+{
+    Mgr::RegisterAction("acl_stats", "ACL Evaluation Statistics", &StatsAction::Create, 0, 1);
+}
+
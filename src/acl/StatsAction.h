@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#ifndef SQUID_SRC_ACL_STATSACTION_H
+#define SQUID_SRC_ACL_STATSACTION_H
+
+#include "acl/Node.h"
+#include "mgr/Action.h"
+#include "sbuf/SBuf.h"
+
+#include <map>
+#include <vector>
+
+namespace Acl
+{
+
+/// per-ACL evaluation statistics (Acl::NodeStats) for the acl_stats cache
+/// manager report, aggregated across SMP kids
+class StatsAction: public Mgr::Action
+{
+public:
+    /// Mgr::ClassActionCreationHandler for Mgr::RegisterAction()
+    static Pointer Create(const Mgr::CommandPointer &);
+    static void RegisterWithCacheManager();
+
+    /* Mgr::Action API */
+    void add(const Mgr::Action &) override;
+    void pack(Ipc::TypedMsgHdr &) const override;
+    void unpack(const Ipc::TypedMsgHdr &) override;
+
+protected:
+    explicit StatsAction(const Mgr::CommandPointer &);
+
+    /* Mgr::Action API */
+    void collect() override;
+    void dump(StoreEntry *) override;
+
+private:
+    /// statistics of one named ACL
+    class Record
+    {
+    public:
+        SBuf type; ///< ACL type name
+        NodeStats stats;
+
+        /// the number of truncated kid responses that included this record
+        int truncatedReports = 0;
+    };
+
+    /// collected statistics indexed by ACL name
+    using Records = std::map<SBuf, Record>;
+
+    /// records in the report order requested by the "sort" query parameter
+    std::vector<Records::const_iterator> sorted() const;
+
+    Records records;
+
+    /// combined statistics of ACLs that did not fit into kid responses
+    NodeStats omitted;
+
+    /// The number of kid responses that omitted some ACLs. Records included
+    /// in fewer truncated responses may lack statistics from other kids.
+    int truncatedKids = 0;
+};
+
+} // namespace Acl
+
+#endif /* SQUID_SRC_ACL_STATSACTION_H */
+
@@ -26,6 +26,7 @@ class AndNode;
 class Answer;
 class ChecklistFiller;
 class InnerNode;
+class Memo;
 class NamedAcls;
 class NotNode;
 class OrNode;
@@ -37,6 +38,8 @@ void Init(void);
 /// reconfiguration-safe storage of ACL rules
 using TreePointer = RefCount<Acl::Tree>;
 
+using MemoPointer = RefCount<Acl::Memo>;
+
 } // namespace Acl
 
 typedef void ACLCB(Acl::Answer, void *);
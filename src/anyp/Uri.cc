@@ -683,6 +683,7 @@ AnyP::Uri::touch()
     absolute_.clear();
     authorityHttp_.clear();
     authorityWithPort_.clear();
+    generation_ = NewGeneration();
 }
 
 SBuf &
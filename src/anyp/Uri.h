@@ -48,7 +48,10 @@ public:
         port_ = std::nullopt;
         touch();
     }
-    void touch(); ///< clear the cached URI display forms
+    void touch(); ///< clear the cached URI display forms and update generation()
+
+    /// changes whenever this URI changes; equal values imply equal URIs
+    uint64_t generation() const { return generation_; }
 
     bool parse(const HttpRequestMethod &, const SBuf &url);
 
@@ -187,6 +190,11 @@ private:
     mutable SBuf authorityHttp_;     ///< RFC 7230 section 5.3.3 authority, maybe without default-port
     mutable SBuf authorityWithPort_; ///< RFC 7230 section 5.3.3 authority with explicit port
     mutable SBuf absolute_;          ///< RFC 7230 section 5.3.2 absolute-URI
+
+    /// \returns a generation() value not used by any other URI so far
+    static uint64_t NewGeneration() { static uint64_t LastGeneration = 0; return ++LastGeneration; }
+
+    uint64_t generation_ = NewGeneration(); ///< \copydoc generation()
 };
 
 inline std::ostream &
@@ -28,6 +28,7 @@ public:
     /* Acl::Node API */
     char const *typeString() const override;
     void parse() override;
+    void prepareForUse() override { data->prepareForUse(); }
     bool isProxyAuth() const override {return true;}
     int match(ACLChecklist *checklist) override;
     SBufList dump() const override;
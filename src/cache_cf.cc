@@ -47,8 +47,10 @@
 #include "ip/QosConfig.h"
 #include "ip/tools.h"
 #include "ipc/Kids.h"
+#include "ipc/mem/Pages.h"
 #include "log/Config.h"
 #include "log/CustomLog.h"
+#include "mem_node.h"
 #include "MemBuf.h"
 #include "MessageDelayPools.h"
 #include "mgr/ActionPasswordList.h"
@@ -96,6 +98,7 @@
 #include <glob.h>
 #endif
 #include <chrono>
+#include <cmath>
 #include <limits>
 #include <list>
 #if HAVE_PWD_H
@@ -242,6 +245,14 @@ static void parse_CpuAffinityMap(CpuAffinityMap **const cpuAffinityMap);
 static void dump_CpuAffinityMap(StoreEntry *const entry, const char *const name, const CpuAffinityMap *const cpuAffinityMap);
 static void free_CpuAffinityMap(CpuAffinityMap **const cpuAffinityMap);
 
+static void parse_MemPageClasses(SquidConfig::MemPageClasses *);
+static void dump_MemPageClasses(StoreEntry *, const char *, const SquidConfig::MemPageClasses &);
+static void free_MemPageClasses(SquidConfig::MemPageClasses *);
+
+static void parse_ShmNumaPolicy(Ipc::Mem::Numa::Policy *);
+static void dump_ShmNumaPolicy(StoreEntry *, const char *, Ipc::Mem::Numa::Policy);
+static void free_ShmNumaPolicy(Ipc::Mem::Numa::Policy *);
+
 static void parse_UrlHelperTimeout(SquidConfig::UrlHelperTimeout *);
 static void dump_UrlHelperTimeout(StoreEntry *, const char *, SquidConfig::UrlHelperTimeout &);
 static void free_UrlHelperTimeout(SquidConfig::UrlHelperTimeout *);
@@ -764,6 +775,11 @@ configDoConfigure(void)
     }
 #endif
 
+    if (Config.memPageSize < 4*1024 || Config.memPageSize > 1024*1024 ||
+            (Config.memPageSize & (Config.memPageSize - 1)))
+        fatalf("memory_page_size must be a power of two between 4 KB and 1 MB; got %zu bytes", Config.memPageSize);
+    mem_node::Configure(Config.memPageSize, Config.onoff.memPageHugepages);
+
     storeConfigure();
 
     snprintf(ThisCache, sizeof(ThisCache), "%s (%s)",
@@ -3254,6 +3270,89 @@ dump_YesNoNone(StoreEntry * entry, const char *name, YesNoNone &option)
         dump_onoff(entry, name, option ? 1 : 0);
 }
 
+static void
+parse_MemPageClasses(SquidConfig::MemPageClasses *pageClasses)
+{
+    size_t pageSize = 0;
+    parseBytesLine(&pageSize, B_BYTES_STR);
+    const auto percent = static_cast<int>(std::lround(GetPercentage() * 100));
+
+    if (pageSize == 0 || pageSize >= Ipc::Mem::PageSize()) {
+        debugs(3, DBG_CRITICAL, "FATAL: memory_cache_page_class page size must be " <<
+               "positive and smaller than " << Ipc::Mem::PageSize() << " bytes");
+        self_destruct();
+        return;
+    }
+
+    if (pageClasses->count(pageSize)) {
+        debugs(3, DBG_CRITICAL, "FATAL: duplicate memory_cache_page_class for " <<
+               pageSize << "-byte pages");
+        self_destruct();
+        return;
+    }
+
+    auto total = percent;
+    for (const auto &pageClass: *pageClasses)
+        total += pageClass.second;
+    if (total > 100) {
+        debugs(3, DBG_CRITICAL, "FATAL: memory_cache_page_class percentages exceed 100%");
+        self_destruct();
+        return;
+    }
+
+    (*pageClasses)[pageSize] = percent;
+}
+
+static void
+dump_MemPageClasses(StoreEntry *entry, const char *name, const SquidConfig::MemPageClasses &pageClasses)
+{
+    for (const auto &pageClass: pageClasses)
+        storeAppendPrintf(entry, "%s %zu bytes %d%%\n", name, pageClass.first, pageClass.second);
+}
+
+static void
+free_MemPageClasses(SquidConfig::MemPageClasses *pageClasses)
+{
+    pageClasses->clear();
+}
+
+static void
+parse_ShmNumaPolicy(Ipc::Mem::Numa::Policy *policy)
+{
+    const auto token = ConfigParser::NextToken();
+    if (!token) {
+        self_destruct();
+        return;
+    }
+
+    if (strcmp(token, "none") == 0)
+        *policy = Ipc::Mem::Numa::Policy::none;
+    else if (strcmp(token, "interleave") == 0)
+        *policy = Ipc::Mem::Numa::Policy::interleave;
+    else if (strcmp(token, "local") == 0)
+        *policy = Ipc::Mem::Numa::Policy::local;
+    else {
+        debugs(3, DBG_CRITICAL, "FATAL: Invalid option '" << token << "': 'shared_memory_numa_policy' accepts 'none', 'interleave', and 'local'.");
+        self_destruct();
+        return;
+    }
+
+    if (*policy != Ipc::Mem::Numa::Policy::none && Ipc::Mem::Numa::NodeCount() == 0)
+        debugs(3, DBG_PARSE_NOTE(DBG_IMPORTANT), "WARNING: Ignoring shared_memory_numa_policy " << token << ": No NUMA memory policy support.");
+}
+
+static void
+dump_ShmNumaPolicy(StoreEntry *entry, const char *name, const Ipc::Mem::Numa::Policy policy)
+{
+    storeAppendPrintf(entry, "%s %s\n", name, Ipc::Mem::Numa::PolicyName(policy));
+}
+
+static void
+free_ShmNumaPolicy(Ipc::Mem::Numa::Policy *policy)
+{
+    *policy = Ipc::Mem::Numa::Policy::none;
+}
+
 static void
 free_memcachemode(SquidConfig *)
 {}
@@ -4090,40 +4189,86 @@ parse_CpuAffinityMap(CpuAffinityMap **const cpuAffinityMap)
         *cpuAffinityMap = new CpuAffinityMap;
 
     const char *const pToken = ConfigParser::NextToken();
-    const char *const cToken = ConfigParser::NextToken();
-    std::vector<int> processes, cores;
+    std::vector<int> processes, cores, nodes;
     if (!parseNamedIntList(pToken, "process_numbers", processes)) {
         debugs(3, DBG_CRITICAL, "FATAL: bad 'process_numbers' parameter " <<
                "in 'cpu_affinity_map'");
         self_destruct();
-    } else if (!parseNamedIntList(cToken, "cores", cores)) {
-        debugs(3, DBG_CRITICAL, "FATAL: bad 'cores' parameter in " <<
-               "'cpu_affinity_map'");
-        self_destruct();
-    } else if (!(*cpuAffinityMap)->add(processes, cores)) {
+        return;
+    }
+
+    while (const char *const token = ConfigParser::NextToken()) {
+        if (strncmp(token, "cores=", 6) == 0) {
+            if (!parseNamedIntList(token, "cores", cores)) {
+                debugs(3, DBG_CRITICAL, "FATAL: bad 'cores' parameter in " <<
+                       "'cpu_affinity_map'");
+                self_destruct();
+                return;
+            }
+        } else if (strncmp(token, "numa_nodes=", 11) == 0) {
+            if (!parseNamedIntList(token, "numa_nodes", nodes)) {
+                debugs(3, DBG_CRITICAL, "FATAL: bad 'numa_nodes' parameter in " <<
+                       "'cpu_affinity_map'");
+                self_destruct();
+                return;
+            }
+        } else {
+            debugs(3, DBG_CRITICAL, "FATAL: unknown 'cpu_affinity_map' parameter: " << token);
+            self_destruct();
+            return;
+        }
+    }
+
+    if (!(*cpuAffinityMap)->add(processes, cores, nodes)) {
         debugs(3, DBG_CRITICAL, "FATAL: bad 'cpu_affinity_map'; " <<
-               "process_numbers and cores lists differ in length or " <<
+               "missing both cores and numa_nodes lists, or " <<
+               "process_numbers, cores, and numa_nodes lists differ in length or " <<
                "contain numbers <= 0");
         self_destruct();
     }
 #endif
 }
 
+/// dumps cpu_affinity_map entries [first, last) as one directive
+static void
+dumpCpuAffinityMapEntries(StoreEntry *const entry, const char *const name, const CpuAffinityMap &cpuAffinityMap, const size_t first, const size_t last)
+{
+    const auto mapsAll = [first, last](const std::vector<int> &values) {
+        return std::find(values.begin() + first, values.begin() + last, 0) == values.begin() + last;
+    };
+    const auto dumpList = [entry, first, last](const char *const listName, const std::vector<int> &values) {
+        storeAppendPrintf(entry, " %s=", listName);
+        for (auto i = first; i < last; ++i)
+            storeAppendPrintf(entry, "%s%i", (i > first ? "," : ""), values[i]);
+    };
+
+    storeAppendPrintf(entry, "%s", name);
+    dumpList("process_numbers", cpuAffinityMap.processes());
+    if (mapsAll(cpuAffinityMap.cores()))
+        dumpList("cores", cpuAffinityMap.cores());
+    if (mapsAll(cpuAffinityMap.numaNodes()))
+        dumpList("numa_nodes", cpuAffinityMap.numaNodes());
+    storeAppendPrintf(entry, "\n");
+}
+
 static void
 dump_CpuAffinityMap(StoreEntry *const entry, const char *const name, const CpuAffinityMap *const cpuAffinityMap)
 {
-    if (cpuAffinityMap) {
-        storeAppendPrintf(entry, "%s process_numbers=", name);
-        for (size_t i = 0; i < cpuAffinityMap->processes().size(); ++i) {
-            storeAppendPrintf(entry, "%s%i", (i ? "," : ""),
-                              cpuAffinityMap->processes()[i]);
-        }
-        storeAppendPrintf(entry, " cores=");
-        for (size_t i = 0; i < cpuAffinityMap->cores().size(); ++i) {
-            storeAppendPrintf(entry, "%s%i", (i ? "," : ""),
-                              cpuAffinityMap->cores()[i]);
+    if (cpuAffinityMap && !cpuAffinityMap->processes().empty()) {
+        // merged options that map processes to different things are
+        // dumped as one option per process
+        const auto &cores = cpuAffinityMap->cores();
+        const auto &nodes = cpuAffinityMap->numaNodes();
+        const auto uniform = [](const std::vector<int> &values) {
+            return std::count(values.begin(), values.end(), 0) % values.size() == 0;
+        };
+        const auto count = cpuAffinityMap->processes().size();
+        if (uniform(cores) && uniform(nodes)) {
+            dumpCpuAffinityMapEntries(entry, name, *cpuAffinityMap, 0, count);
+        } else {
+            for (size_t i = 0; i < count; ++i)
+                dumpCpuAffinityMapEntries(entry, name, *cpuAffinityMap, i, i + 1);
         }
-        storeAppendPrintf(entry, "\n");
     }
 }
 
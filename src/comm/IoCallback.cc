@@ -68,6 +68,54 @@ Comm::IoCallback::setCallback(Comm::iocb_type t, AsyncCall::Pointer &cb, char *b
     freefunc = f;
     size = sz;
     offset = 0;
+    moreBufsCount = 0;
+}
+
+void
+Comm::IoCallback::appendBuffers(const struct iovec *iov, const int iovcnt)
+{
+    assert(active());
+    assert(type == IOCB_WRITE);
+    assert(moreBufsCount + iovcnt < MaxBuffers);
+
+    for (int i = 0; i < iovcnt; ++i) {
+        if (!iov[i].iov_len)
+            continue;
+        moreBufs[moreBufsCount++] = iov[i];
+        size += iov[i].iov_len;
+    }
+}
+
+int
+Comm::IoCallback::unwrittenBuffers(struct iovec *iov, int maxBytes) const
+{
+    int count = 0;
+    int skip = offset; // bytes to skip at the beginning of the next buffer
+
+    int bufSize = size;
+    for (int i = 0; i < moreBufsCount; ++i)
+        bufSize -= moreBufs[i].iov_len;
+
+    const auto addBuffer = [&](char *start, int length) {
+        if (skip >= length) {
+            skip -= length;
+            return;
+        }
+        const auto available = std::min(length - skip, maxBytes);
+        if (available <= 0)
+            return;
+        iov[count].iov_base = start + skip;
+        iov[count].iov_len = available;
+        ++count;
+        maxBytes -= available;
+        skip = 0;
+    };
+
+    addBuffer(buf, bufSize);
+    for (int i = 0; i < moreBufsCount; ++i)
+        addBuffer(static_cast<char *>(moreBufs[i].iov_base), moreBufs[i].iov_len);
+
+    return count;
 }
 
 void
@@ -104,6 +152,7 @@ Comm::IoCallback::reset()
         freefunc = nullptr;
     }
     xerrno = 0;
+    moreBufsCount = 0;
 
 #if USE_DELAY_POOLS
     quotaQueueReserv = 0;
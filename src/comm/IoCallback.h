@@ -15,6 +15,10 @@
 #include "mem/forward.h"
 #include "sbuf/forward.h"
 
+#if HAVE_SYS_UIO_H
+#include <sys/uio.h>
+#endif
+
 namespace Comm
 {
 
@@ -29,13 +33,20 @@ typedef enum {
 class IoCallback
 {
 public:
+    /// maximum number of buffers in one vectored write
+    static const int MaxBuffers = 4;
+
     iocb_type type;
     Comm::ConnectionPointer conn;
     AsyncCall::Pointer callback;
     char *buf;
     FREE *freefunc;
-    int size;
-    int offset;
+    int size; ///< total size of buf and moreBufs
+    int offset; ///< number of bytes already transferred
+    /// buffers to write after buf, as if they were appended to it;
+    /// not owned (see freefunc); used by vectored writes only
+    struct iovec moreBufs[MaxBuffers - 1];
+    int moreBufsCount; ///< number of used moreBufs entries
     Comm::Flag errcode;
     int xerrno;
 #if USE_DELAY_POOLS
@@ -45,6 +56,14 @@ public:
     bool active() const { return callback != nullptr; }
     void setCallback(iocb_type type, AsyncCall::Pointer &cb, char *buf, FREE *func, int sz);
 
+    /// adds buffers to write after the setCallback() buffer
+    void appendBuffers(const struct iovec *iov, int iovcnt);
+
+    /// fills iov with (at most maxBytes of) the not yet written parts of
+    /// all write buffers
+    /// \returns the number of iov entries used
+    int unwrittenBuffers(struct iovec *iov, int maxBytes) const;
+
     /// called when fd needs to write but may need to wait in line for its quota
     void selectOrQueueWrite();
 
@@ -38,6 +38,7 @@
 #include "fde.h"
 #include "globals.h"
 #include "mgr/Registration.h"
+#include "SquidConfig.h"
 #include "StatCounters.h"
 #include "StatHist.h"
 #include "Store.h"
@@ -45,6 +46,7 @@
 #define DEBUG_EPOLL 0
 
 #include <cerrno>
+#include <vector>
 #if HAVE_SYS_EPOLL_H
 #include <sys/epoll.h>
 #endif
@@ -54,6 +56,22 @@ static int max_poll_time = 1000;
 
 static struct epoll_event *pevents;
 
+/// FDs with interest changes waiting for commEPollFlushUpdates()
+/// (used only when epoll_batch_updates is on)
+static std::vector<int> pendingUpdates;
+
+/** \brief epoll(7) engine statistics for the comm_epoll_incoming report */
+static struct {
+    uint64_t ctlCalls = 0; ///< total epoll_ctl(2) calls
+    uint64_t waitCalls = 0; ///< total epoll_wait(2) calls
+    uint64_t coalescedUpdates = 0; ///< interest changes that did not need their own epoll_ctl(2)
+    uint64_t readDispatches = 0; ///< read handlers called
+    uint64_t writeDispatches = 0; ///< write handlers called
+    uint64_t idleEvents = 0; ///< events delivered for an FD direction without a handler
+    int loopCtlCalls = 0; ///< epoll_ctl(2) calls since the last epoll_wait(2)
+    StatHist ctlCallsHist; ///< epoll_ctl(2) calls per loop iteration
+} epollStats;
+
 static void commEPollRegisterWithCacheManager(void);
 
 /* XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX */
@@ -80,6 +98,9 @@ Comm::SelectLoopInit(void)
         fatalf("comm_select_init: epoll_create(): %s\n", xstrerr(xerrno));
     }
 
+    pendingUpdates.reserve(SQUID_MAXFD);
+    epollStats.ctlCallsHist.enumInit(64);
+
     commEPollRegisterWithCacheManager();
 }
 
@@ -101,15 +122,86 @@ static const char* epolltype_atoi(int x)
     }
 }
 
+/// Registers F->epoll_pending events with the kernel, if they differ from
+/// the currently registered F->epoll_state events.
+static void
+commEPollApplyUpdate(const int fd)
+{
+    fde *F = &fd_table[fd];
+    if (F->epoll_pending == F->epoll_state)
+        return;
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.data.fd = fd;
+    ev.events = F->epoll_pending;
+
+    int epoll_ctl_type = 0;
+    if (F->epoll_state) // already monitoring something.
+        epoll_ctl_type = ev.events ? EPOLL_CTL_MOD : EPOLL_CTL_DEL;
+    else
+        epoll_ctl_type = EPOLL_CTL_ADD;
+
+    F->epoll_state = ev.events;
+
+    ++epollStats.ctlCalls;
+    ++epollStats.loopCtlCalls;
+    if (epoll_ctl(kdpfd, epoll_ctl_type, fd, &ev) < 0) {
+        int xerrno = errno;
+        debugs(5, DEBUG_EPOLL ? 0 : 8, "ERROR: epoll_ctl(," << epolltype_atoi(epoll_ctl_type) <<
+               ",,): failed on FD " << fd << ": " << xstrerr(xerrno));
+    }
+}
+
+/// Remembers that the FD interest has changed, delaying the corresponding
+/// epoll_ctl(2) call until commEPollFlushUpdates(). Any further changes to
+/// the same FD before that flush are merged into a single call (or no call
+/// at all if the FD returns to its registered state).
+static void
+commEPollQueueUpdate(const int fd)
+{
+    fde *F = &fd_table[fd];
+    if (F->epoll_queued) {
+        ++epollStats.coalescedUpdates;
+        return;
+    }
+    F->epoll_queued = true;
+    pendingUpdates.push_back(fd);
+}
+
+/// Applies all queued interest changes. Called right before epoll_wait(2) so
+/// that the kernel always waits on the current interest set.
+static void
+commEPollFlushUpdates()
+{
+    for (const auto fd: pendingUpdates) {
+        fde *F = &fd_table[fd];
+        // an FD closed (or stripped of all interest) after queuing has lost its
+        // queued flag; a requeued FD has a duplicate entry that we skip later
+        if (!F->epoll_queued)
+            continue;
+        F->epoll_queued = false;
+        if (F->epoll_pending == F->epoll_state)
+            ++epollStats.coalescedUpdates;
+        else
+            commEPollApplyUpdate(fd);
+    }
+    pendingUpdates.clear();
+}
+
 /**
  * This is a needed exported function which will be called to register
  * and deregister interest in a pending IO state for a given FD.
+ *
+ * With epoll_batch_updates, new and modified interests are queued until the
+ * next Comm::DoSelect() call. Removing all interest in an FD is never delayed
+ * because the FD is usually about to be closed, and a descriptor duplicated
+ * elsewhere (e.g., by a forked helper) would keep the stale registration.
  */
 void
 Comm::SetSelect(int fd, unsigned int type, PF * handler, void *client_data, time_t timeout)
 {
     fde *F = &fd_table[fd];
-    int epoll_ctl_type = 0;
 
     assert(fd >= 0);
     debugs(5, 5, "FD " << fd << ", type=" << type <<
@@ -121,6 +213,8 @@ Comm::SetSelect(int fd, unsigned int type, PF * handler, void *client_data, time
     ev.data.fd = fd;
 
     if (!F->flags.open) {
+        ++epollStats.ctlCalls;
+        ++epollStats.loopCtlCalls;
         epoll_ctl(kdpfd, EPOLL_CTL_DEL, fd, &ev);
         return;
     }
@@ -140,7 +234,7 @@ Comm::SetSelect(int fd, unsigned int type, PF * handler, void *client_data, time
         F->read_data = client_data;
 
         // Otherwise, use previously stored value
-    } else if (F->epoll_state & EPOLLIN) {
+    } else if (F->epoll_pending & EPOLLIN) {
         ev.events |= EPOLLIN;
     }
 
@@ -154,25 +248,22 @@ Comm::SetSelect(int fd, unsigned int type, PF * handler, void *client_data, time
         F->write_data = client_data;
 
         // Otherwise, use previously stored value
-    } else if (F->epoll_state & EPOLLOUT) {
+    } else if (F->epoll_pending & EPOLLOUT) {
         ev.events |= EPOLLOUT;
     }
 
     if (ev.events)
         ev.events |= EPOLLHUP | EPOLLERR;
 
-    if (ev.events != F->epoll_state) {
-        if (F->epoll_state) // already monitoring something.
-            epoll_ctl_type = ev.events ? EPOLL_CTL_MOD : EPOLL_CTL_DEL;
-        else
-            epoll_ctl_type = EPOLL_CTL_ADD;
-
-        F->epoll_state = ev.events;
-
-        if (epoll_ctl(kdpfd, epoll_ctl_type, fd, &ev) < 0) {
-            int xerrno = errno;
-            debugs(5, DEBUG_EPOLL ? 0 : 8, "ERROR: epoll_ctl(," << epolltype_atoi(epoll_ctl_type) <<
-                   ",,): failed on FD " << fd << ": " << xstrerr(xerrno));
+    if (ev.events != F->epoll_pending) {
+        F->epoll_pending = ev.events;
+        if (Config.onoff.epoll_batch_updates && ev.events) {
+            commEPollQueueUpdate(fd);
+        } else {
+            // the immediate update supersedes any queued one; the flush skips
+            // the stale queue entry instead of counting it as coalesced
+            F->epoll_queued = false;
+            commEPollApplyUpdate(fd);
         }
     }
 
@@ -201,8 +292,20 @@ commIncomingStats(StoreEntry * sentry)
 {
     StatCounters *f = &statCounter;
     storeAppendPrintf(sentry, "Total number of epoll(2) loops: %ld\n", statCounter.select_loops);
+    storeAppendPrintf(sentry, "Batched interest updates: %s\n", Config.onoff.epoll_batch_updates ? "on" : "off");
+    storeAppendPrintf(sentry, "Total number of epoll_wait(2) calls: %" PRIu64 "\n", epollStats.waitCalls);
+    storeAppendPrintf(sentry, "Total number of epoll_ctl(2) calls: %" PRIu64 "\n", epollStats.ctlCalls);
+    storeAppendPrintf(sentry, "Interest updates coalesced: %" PRIu64 "\n", epollStats.coalescedUpdates);
+    if (epollStats.waitCalls)
+        storeAppendPrintf(sentry, "Average epoll syscalls per loop: %.2f\n",
+                          static_cast<double>(epollStats.ctlCalls + epollStats.waitCalls) / epollStats.waitCalls);
+    storeAppendPrintf(sentry, "Read handlers called: %" PRIu64 "\n", epollStats.readDispatches);
+    storeAppendPrintf(sentry, "Write handlers called: %" PRIu64 "\n", epollStats.writeDispatches);
+    storeAppendPrintf(sentry, "Events without a handler: %" PRIu64 "\n", epollStats.idleEvents);
     storeAppendPrintf(sentry, "Histogram of returned filedescriptors\n");
     f->select_fds_hist.dump(sentry, statHistIntDumper);
+    storeAppendPrintf(sentry, "Histogram of epoll_ctl(2) calls per loop\n");
+    epollStats.ctlCallsHist.dump(sentry, statHistIntDumper);
 }
 
 /**
@@ -227,9 +330,14 @@ Comm::DoSelect(int msec)
     if (msec > max_poll_time)
         msec = max_poll_time;
 
+    commEPollFlushUpdates();
+    epollStats.ctlCallsHist.count(epollStats.loopCtlCalls);
+    epollStats.loopCtlCalls = 0;
+
     for (;;) {
         num = epoll_wait(kdpfd, pevents, SQUID_MAXFD, msec);
         ++ statCounter.select_loops;
+        ++epollStats.waitCalls;
 
         if (num >= 0)
             break;
@@ -265,7 +373,9 @@ Comm::DoSelect(int msec)
                 F->read_handler = nullptr;
                 hdl(fd, F->read_data);
                 ++ statCounter.select_fds;
+                ++epollStats.readDispatches;
             } else {
+                ++epollStats.idleEvents;
                 debugs(5, DEBUG_EPOLL ? 0 : 8, "no read handler for FD " << fd);
                 // remove interest since no handler exist for this event.
                 SetSelect(fd, COMM_SELECT_READ, nullptr, nullptr, 0);
@@ -278,7 +388,9 @@ Comm::DoSelect(int msec)
                 F->write_handler = nullptr;
                 hdl(fd, F->write_data);
                 ++ statCounter.select_fds;
+                ++epollStats.writeDispatches;
             } else {
+                ++epollStats.idleEvents;
                 debugs(5, DEBUG_EPOLL ? 0 : 8, "no write handler for FD " << fd);
                 // remove interest since no handler exist for this event.
                 SetSelect(fd, COMM_SELECT_WRITE, nullptr, nullptr, 0);
@@ -0,0 +1,509 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+/* DEBUG: section 05    Socket Functions */
+
+/*
+ * This is a driver for the Linux io_uring(7) interface.
+ *
+ * Interest in an FD is kept as a single multishot IORING_OP_POLL_ADD request.
+ * Interest changes are queued as submission entries and handed to the kernel
+ * together with the wait for completions, in one io_uring_enter(2) call per
+ * loop iteration (plus one extra call whenever the submission ring fills up).
+ *
+ * Multishot polls report readiness edges. Squid handlers do not necessarily
+ * drain the socket, so when a handler is re-registered for a direction that
+ * has already been reported, the poll request is updated, which makes the
+ * kernel re-check current readiness without an extra system call.
+ *
+ * The rings are set up using raw system calls so that liburing is not needed.
+ */
+
+#include "squid.h"
+
+#if USE_IO_URING
+
+#include "base/CodeContext.h"
+#include "base/IoManip.h"
+#include "comm/Loops.h"
+#include "fatal.h"
+#include "fde.h"
+#include "globals.h"
+#include "mgr/Registration.h"
+#include "StatCounters.h"
+#include "StatHist.h"
+#include "Store.h"
+
+#define DEBUG_IO_URING 0
+
+#include <cerrno>
+#if HAVE_LINUX_IO_URING_H
+#include <linux/io_uring.h>
+#endif
+#if HAVE_POLL_H
+#include <poll.h>
+#endif
+#if HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+#if HAVE_SYS_SYSCALL_H
+#include <sys/syscall.h>
+#endif
+
+/// user_data bit marking completions of requests that manage poll requests
+/// (updates and removals); we do not need their results
+static const uint64_t ControlRequest = uint64_t(1) << 63;
+
+/** \brief Current state of the poll request for an FD */
+struct _uring_state {
+    unsigned events; ///< poll events requested by Comm::SetSelect()
+    uint32_t generation; ///< distinguishes completions of replaced requests
+    bool armed; ///< whether a multishot poll request for this FD exists
+    unsigned reported; ///< events dispatched since the request was (re)armed
+};
+
+/** \brief Kernel-shared submission queue ring */
+static struct {
+    unsigned *head; ///< first entry not yet consumed by the kernel
+    unsigned *tail; ///< next entry to fill
+    unsigned *ringMask;
+    unsigned *array; ///< indexes into sqes
+    struct io_uring_sqe *sqes;
+    unsigned entries; ///< ring capacity
+    unsigned pending; ///< entries filled since the last io_uring_enter(2)
+} sq;
+
+/** \brief Kernel-shared completion queue ring */
+static struct {
+    unsigned *head; ///< next entry to reap
+    unsigned *tail; ///< one past the last entry posted by the kernel
+    unsigned *ringMask;
+    struct io_uring_cqe *cqes;
+} cq;
+
+static int ringFd = -1;
+static int max_poll_time = 1000;
+
+static struct _uring_state *uring_state; /**< array of FD poll request states */
+
+/** \brief io_uring(7) engine statistics for the comm_io_uring_incoming report */
+static struct {
+    uint64_t enterCalls = 0; ///< io_uring_enter(2) calls
+    uint64_t pollAdds = 0; ///< IORING_OP_POLL_ADD requests submitted
+    uint64_t pollUpdates = 0; ///< poll requests updated (including re-checks)
+    uint64_t pollRemoves = 0; ///< poll requests removed
+    uint64_t completions = 0; ///< completions reaped
+    uint64_t staleCompletions = 0; ///< completions of replaced poll requests
+    uint64_t ringFullSubmissions = 0; ///< io_uring_enter(2) calls due to a full submission ring
+} uringStats;
+
+static void commIoUringRegisterWithCacheManager(void);
+
+static int
+sys_io_uring_setup(const unsigned entries, struct io_uring_params *params)
+{
+    return syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int
+sys_io_uring_enter(const unsigned toSubmit, const unsigned minComplete, const unsigned flags, void *arg, const size_t argSize)
+{
+    ++uringStats.enterCalls;
+    return syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, arg, argSize);
+}
+
+static uint64_t
+commIoUringUserData(const int fd, const uint32_t generation)
+{
+    return (uint64_t(generation & 0x7fffffff) << 32) | uint32_t(fd);
+}
+
+/// hands all filled submission entries to the kernel without waiting
+static void
+commIoUringSubmit()
+{
+    while (sq.pending) {
+        const auto submitted = sys_io_uring_enter(sq.pending, 0, 0, nullptr, 0);
+        if (submitted < 0) {
+            const auto xerrno = errno;
+            if (xerrno == EINTR || xerrno == EAGAIN || xerrno == EBUSY)
+                continue;
+            fatalf("comm_select: io_uring_enter(): %s\n", xstrerr(xerrno));
+        }
+        sq.pending -= submitted;
+    }
+}
+
+/// fills and publishes the next submission entry
+static void
+commIoUringQueue(const uint8_t opcode, const int fd, const uint64_t userData, const unsigned events, const unsigned len, const uint64_t addr)
+{
+    if (*sq.tail - __atomic_load_n(sq.head, __ATOMIC_ACQUIRE) >= sq.entries) {
+        ++uringStats.ringFullSubmissions;
+        commIoUringSubmit();
+    }
+
+    const auto tail = *sq.tail;
+    const auto index = tail & *sq.ringMask;
+    auto *sqe = &sq.sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->user_data = userData;
+    sqe->poll32_events = events;
+    sqe->len = len;
+    sqe->addr = addr;
+    sq.array[index] = index;
+    __atomic_store_n(sq.tail, tail + 1, __ATOMIC_RELEASE);
+    ++sq.pending;
+}
+
+/// brings the FD poll request in sync with the requested events
+/// \param recheck whether to make the kernel re-check current readiness
+static void
+commIoUringUpdate(const int fd, const bool recheck)
+{
+    auto &state = uring_state[fd];
+    const auto currentUserData = commIoUringUserData(fd, state.generation);
+
+    if (!state.events) {
+        if (state.armed) {
+            commIoUringQueue(IORING_OP_POLL_REMOVE, -1, ControlRequest, 0, 0, currentUserData);
+            ++uringStats.pollRemoves;
+            state.armed = false;
+            ++state.generation; // ignore completions of the removed request
+        }
+        return;
+    }
+
+    if (!state.armed) {
+        commIoUringQueue(IORING_OP_POLL_ADD, fd, currentUserData, state.events, IORING_POLL_ADD_MULTI, 0);
+        ++uringStats.pollAdds;
+        state.armed = true;
+        state.reported = 0;
+        return;
+    }
+
+    if (recheck) {
+        commIoUringQueue(IORING_OP_POLL_REMOVE, -1, ControlRequest, state.events,
+                         IORING_POLL_UPDATE_EVENTS | IORING_POLL_ADD_MULTI, currentUserData);
+        ++uringStats.pollUpdates;
+        state.reported = 0;
+    }
+}
+
+/* XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX */
+/* Public functions */
+
+/*
+ * This is a needed exported function which will be called to initialise
+ * the network loop code.
+ */
+void
+Comm::SelectLoopInit(void)
+{
+    uring_state = (struct _uring_state *)xcalloc(Squid_MaxFD, sizeof(struct _uring_state));
+
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    // multishot polls post one completion per readiness change, so make
+    // room for roughly two completions per FD, as epoll(7) would
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_CLAMP;
+    params.cq_entries = 2 * Squid_MaxFD;
+
+    ringFd = sys_io_uring_setup(4096, &params);
+    if (ringFd < 0) {
+        int xerrno = errno;
+        fatalf("comm_select_init: io_uring_setup(): %s\n", xstrerr(xerrno));
+    }
+
+    if (!(params.features & IORING_FEAT_EXT_ARG) || !(params.features & IORING_FEAT_NODROP))
+        fatal("comm_select_init: io_uring(7) is too old; need Linux 5.13 or later\n");
+
+    auto ringSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    const auto cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (cqRingSize > ringSize)
+        ringSize = cqRingSize;
+
+    // since IORING_FEAT_SINGLE_MMAP, both rings share one mapping
+    const auto rings = static_cast<char *>(mmap(nullptr, ringSize, PROT_READ | PROT_WRITE,
+                                         MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING));
+    if (rings == MAP_FAILED) {
+        int xerrno = errno;
+        fatalf("comm_select_init: io_uring ring mmap(): %s\n", xstrerr(xerrno));
+    }
+
+    const auto sqes = mmap(nullptr, params.sq_entries * sizeof(struct io_uring_sqe), PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        int xerrno = errno;
+        fatalf("comm_select_init: io_uring submission entries mmap(): %s\n", xstrerr(xerrno));
+    }
+
+    sq.head = reinterpret_cast<unsigned *>(rings + params.sq_off.head);
+    sq.tail = reinterpret_cast<unsigned *>(rings + params.sq_off.tail);
+    sq.ringMask = reinterpret_cast<unsigned *>(rings + params.sq_off.ring_mask);
+    sq.array = reinterpret_cast<unsigned *>(rings + params.sq_off.array);
+    sq.sqes = static_cast<struct io_uring_sqe *>(sqes);
+    sq.entries = params.sq_entries;
+    sq.pending = 0;
+
+    cq.head = reinterpret_cast<unsigned *>(rings + params.cq_off.head);
+    cq.tail = reinterpret_cast<unsigned *>(rings + params.cq_off.tail);
+    cq.ringMask = reinterpret_cast<unsigned *>(rings + params.cq_off.ring_mask);
+    cq.cqes = reinterpret_cast<struct io_uring_cqe *>(rings + params.cq_off.cqes);
+
+    debugs(5, 2, "io_uring FD " << ringFd << " with " << params.sq_entries <<
+           " submission and " << params.cq_entries << " completion entries");
+
+    commIoUringRegisterWithCacheManager();
+}
+
+/**
+ * This is a needed exported function which will be called to register
+ * and deregister interest in a pending IO state for a given FD.
+ */
+void
+Comm::SetSelect(int fd, unsigned int type, PF * handler, void *client_data, time_t timeout)
+{
+    fde *F = &fd_table[fd];
+    assert(fd >= 0);
+    debugs(5, 5, "FD " << fd << ", type=" << type <<
+           ", handler=" << handler << ", client_data=" << client_data <<
+           ", timeout=" << timeout);
+
+    auto &state = uring_state[fd];
+
+    if (!F->flags.open) {
+        state.events = 0;
+        commIoUringUpdate(fd, false);
+        return;
+    }
+
+    unsigned events = 0;
+    // whether the handler may be waiting for an already reported event
+    bool recheck = false;
+
+    // If read is an interest
+
+    if (type & COMM_SELECT_READ) {
+        if (handler) {
+            // Hack to keep the events flowing if there is data immediately ready
+            if (F->flags.read_pending)
+                events |= POLLOUT;
+            events |= POLLIN;
+            recheck = recheck || (state.reported & POLLIN);
+        }
+
+        F->read_handler = handler;
+
+        F->read_data = client_data;
+
+        // Otherwise, use previously stored value
+    } else if (state.events & POLLIN) {
+        events |= POLLIN;
+    }
+
+    // If write is an interest
+    if (type & COMM_SELECT_WRITE) {
+        if (handler) {
+            events |= POLLOUT;
+            recheck = recheck || (state.reported & POLLOUT);
+        }
+
+        F->write_handler = handler;
+
+        F->write_data = client_data;
+
+        // Otherwise, use previously stored value
+    } else if (state.events & POLLOUT) {
+        events |= POLLOUT;
+    }
+
+    if (events)
+        events |= POLLHUP | POLLERR;
+
+    if (events != state.events || recheck) {
+        state.events = events;
+        commIoUringUpdate(fd, true);
+    }
+
+    if (timeout)
+        F->timeout = squid_curtime + timeout;
+
+    if (timeout || handler) // all non-cleanup requests
+        F->codeContext = CodeContext::Current(); // TODO: Avoid clearing if set?
+    else if (!events) // full cleanup: no more FD-associated work expected
+        F->codeContext = nullptr;
+    // else: direction-specific/timeout cleanup requests preserve F->codeContext
+}
+
+static void commIncomingStats(StoreEntry * sentry);
+
+static void
+commIoUringRegisterWithCacheManager(void)
+{
+    Mgr::RegisterAction("comm_io_uring_incoming",
+                        "comm_incoming() stats",
+                        commIncomingStats, 0, 1);
+}
+
+static void
+commIncomingStats(StoreEntry * sentry)
+{
+    StatCounters *f = &statCounter;
+    storeAppendPrintf(sentry, "Total number of io_uring loops: %ld\n", statCounter.select_loops);
+    storeAppendPrintf(sentry, "Total number of io_uring_enter(2) calls: %" PRIu64 "\n", uringStats.enterCalls);
+    storeAppendPrintf(sentry, "Calls due to a full submission ring: %" PRIu64 "\n", uringStats.ringFullSubmissions);
+    storeAppendPrintf(sentry, "Poll requests added: %" PRIu64 "\n", uringStats.pollAdds);
+    storeAppendPrintf(sentry, "Poll requests updated: %" PRIu64 "\n", uringStats.pollUpdates);
+    storeAppendPrintf(sentry, "Poll requests removed: %" PRIu64 "\n", uringStats.pollRemoves);
+    storeAppendPrintf(sentry, "Completions: %" PRIu64 "\n", uringStats.completions);
+    storeAppendPrintf(sentry, "Stale completions: %" PRIu64 "\n", uringStats.staleCompletions);
+    storeAppendPrintf(sentry, "Histogram of returned filedescriptors\n");
+    f->select_fds_hist.dump(sentry, statHistIntDumper);
+}
+
+/// calls FD handlers for one poll request completion
+static void
+commIoUringDispatch(const struct io_uring_cqe &cqe)
+{
+    ++uringStats.completions;
+
+    if (cqe.user_data & ControlRequest)
+        return;
+
+    const int fd = static_cast<int>(cqe.user_data & 0xffffffff);
+    auto &state = uring_state[fd];
+    if (!state.armed || cqe.user_data != commIoUringUserData(fd, state.generation)) {
+        ++uringStats.staleCompletions;
+        return;
+    }
+
+    if (!(cqe.flags & IORING_CQE_F_MORE)) {
+        // the kernel has terminated this multishot request
+        state.armed = false;
+        ++state.generation;
+    }
+
+    const unsigned revents = cqe.res < 0 ? POLLERR : cqe.res;
+
+    fde *F = &fd_table[fd];
+    CodeContext::Reset(F->codeContext);
+    debugs(5, DEBUG_IO_URING ? 0 : 8, "got FD " << fd << " events=" <<
+           asHex(revents) << " monitoring=" << asHex(state.events) <<
+           " F->read_handler=" << F->read_handler << " F->write_handler=" << F->write_handler);
+
+    PF *hdl;
+    if ((revents & (POLLIN|POLLHUP|POLLERR)) || F->flags.read_pending) {
+        if ((hdl = F->read_handler) != nullptr) {
+            debugs(5, DEBUG_IO_URING ? 0 : 8, "Calling read handler on FD " << fd);
+            F->read_handler = nullptr;
+            state.reported |= POLLIN;
+            hdl(fd, F->read_data);
+            ++ statCounter.select_fds;
+        } else {
+            debugs(5, DEBUG_IO_URING ? 0 : 8, "no read handler for FD " << fd);
+            // remove interest since no handler exist for this event.
+            Comm::SetSelect(fd, COMM_SELECT_READ, nullptr, nullptr, 0);
+        }
+    }
+
+    if (revents & (POLLOUT|POLLHUP|POLLERR)) {
+        if ((hdl = F->write_handler) != nullptr) {
+            debugs(5, DEBUG_IO_URING ? 0 : 8, "Calling write handler on FD " << fd);
+            F->write_handler = nullptr;
+            state.reported |= POLLOUT;
+            hdl(fd, F->write_data);
+            ++ statCounter.select_fds;
+        } else {
+            debugs(5, DEBUG_IO_URING ? 0 : 8, "no write handler for FD " << fd);
+            // remove interest since no handler exist for this event.
+            Comm::SetSelect(fd, COMM_SELECT_WRITE, nullptr, nullptr, 0);
+        }
+    }
+
+    // re-arm a terminated request unless the handlers have done that already
+    if (F->flags.open && !state.armed)
+        commIoUringUpdate(fd, false);
+}
+
+/**
+ * Check all connections for new connections and input data that is to be
+ * processed. Also check for connections with data queued and whether we can
+ * write it out.
+ *
+ * Queued poll request changes are submitted in the same io_uring_enter(2)
+ * call that waits for completions.
+ */
+Comm::Flag
+Comm::DoSelect(int msec)
+{
+    if (msec > max_poll_time)
+        msec = max_poll_time;
+
+    struct __kernel_timespec ts;
+    ts.tv_sec = msec / 1000;
+    ts.tv_nsec = (msec % 1000) * 1000000L;
+
+    struct io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    arg.ts = reinterpret_cast<uint64_t>(&ts);
+
+    for (;;) {
+        const auto submitted = sys_io_uring_enter(sq.pending, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+        ++ statCounter.select_loops;
+
+        if (submitted >= 0) {
+            sq.pending -= submitted;
+            break;
+        }
+
+        const auto xerrno = errno;
+        if (xerrno == ETIME)
+            break;
+
+        if (ignoreErrno(xerrno) || xerrno == EBUSY)
+            break;
+
+        getCurrentTime();
+
+        return Comm::COMM_ERROR;
+    }
+
+    getCurrentTime();
+
+    // reap only what is already posted; handlers may trigger more completions
+    const auto tail = __atomic_load_n(cq.tail, __ATOMIC_ACQUIRE);
+    auto head = *cq.head;
+    const int num = tail - head;
+
+    statCounter.select_fds_hist.count(num);
+
+    if (num == 0)
+        return Comm::TIMEOUT;       /* No error.. */
+
+    for (; head != tail; ++head) {
+        const auto cqe = cq.cqes[head & *cq.ringMask];
+        // release the slot before calling handlers that may queue more work
+        __atomic_store_n(cq.head, head + 1, __ATOMIC_RELEASE);
+        commIoUringDispatch(cqe);
+    }
+
+    CodeContext::Reset();
+
+    return Comm::OK;
+}
+
+void
+Comm::QuickPollRequired(void)
+{
+    max_poll_time = 10;
+}
+
+#endif /* USE_IO_URING */
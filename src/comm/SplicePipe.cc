@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+/* DEBUG: section 05    Socket Functions */
+
+#include "squid.h"
+
+#if HAVE_SPLICE
+
+#include "comm/SplicePipe.h"
+#include "debug/Stream.h"
+
+#include <cerrno>
+#if HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+Comm::SplicePipe::~SplicePipe()
+{
+    for (const auto fd: fds) {
+        if (fd >= 0)
+            ::close(fd);
+    }
+}
+
+bool
+Comm::SplicePipe::open()
+{
+    assert(!isOpen());
+
+    int pipeFds[2];
+    if (pipe(pipeFds) < 0) {
+        const auto xerrno = errno;
+        debugs(5, 2, "pipe failure: " << xstrerr(xerrno));
+        return false;
+    }
+
+    fds[0] = pipeFds[0];
+    fds[1] = pipeFds[1];
+
+    for (const auto fd: fds) {
+        const auto flags = fcntl(fd, F_GETFL, 0);
+        if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+            const auto xerrno = errno;
+            debugs(5, 2, "cannot make pipe FD " << fd << " non-blocking: " << xstrerr(xerrno));
+            ::close(fds[0]);
+            ::close(fds[1]);
+            fds[0] = fds[1] = -1;
+            return false;
+        }
+    }
+
+    debugs(5, 5, "FDs " << fds[0] << " and " << fds[1]);
+    return true;
+}
+
+ssize_t
+Comm::SplicePipe::fill(const int fd, const size_t maxBytes)
+{
+    assert(isOpen());
+    const auto len = splice(fd, nullptr, fds[1], nullptr, maxBytes, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (len > 0)
+        buffered += len;
+    return len;
+}
+
+ssize_t
+Comm::SplicePipe::drain(const int fd)
+{
+    assert(isOpen());
+    const auto len = splice(fds[0], nullptr, fd, nullptr, buffered, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (len > 0) {
+        assert(static_cast<size_t>(len) <= buffered);
+        buffered -= len;
+    }
+    return len;
+}
+
+#endif /* HAVE_SPLICE */
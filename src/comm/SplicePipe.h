@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#ifndef SQUID_SRC_COMM_SPLICEPIPE_H
+#define SQUID_SRC_COMM_SPLICEPIPE_H
+
+#include <cstddef>
+#include <sys/types.h>
+
+namespace Comm
+{
+
+/// A kernel pipe relaying socket bytes with splice(2) so that they are not
+/// copied to and from user space. Does not register its descriptors in
+/// fd_table; owners that need fd_table entries must fd_close() them before
+/// destroying the pipe.
+class SplicePipe
+{
+public:
+    SplicePipe() = default;
+    SplicePipe(SplicePipe &&) = delete; // no copying or moving of any kind
+    ~SplicePipe();
+
+    /// creates the non-blocking pipe; \returns whether that succeeded
+    bool open();
+
+    /// whether open() succeeded
+    bool isOpen() const { return fds[0] >= 0; }
+
+    /// the pipe end drained by drain()
+    int readFd() const { return fds[0]; }
+
+    /// the pipe end filled by fill()
+    int writeFd() const { return fds[1]; }
+
+    /// the number of bytes filled but not drained yet
+    size_t size() const { return buffered; }
+
+    /// Moves up to maxBytes bytes available on the given socket into the
+    /// pipe, without blocking.
+    /// \returns the number of moved bytes, zero on EOF, or -1 (see errno)
+    ssize_t fill(int fd, size_t maxBytes);
+
+    /// Moves all or some buffered bytes into the given socket, without
+    /// blocking.
+    /// \returns the number of moved bytes or -1 (see errno)
+    ssize_t drain(int fd);
+
+private:
+    /// [0] is the read end and [1] is the write end
+    int fds[2] = { -1, -1 };
+
+    size_t buffered = 0; ///< \copydoc size()
+};
+
+} // namespace Comm
+
+#endif /* SQUID_SRC_COMM_SPLICEPIPE_H */
@@ -22,6 +22,9 @@
 #endif
 
 #include <cerrno>
+#if HAVE_SYS_UIO_H
+#include <sys/uio.h>
+#endif
 
 void
 Comm::Write(const Comm::ConnectionPointer &conn, MemBuf *mb, AsyncCall::Pointer &callback)
@@ -29,6 +32,54 @@ Comm::Write(const Comm::ConnectionPointer &conn, MemBuf *mb, AsyncCall::Pointer
     Comm::Write(conn, mb->buf, mb->size, callback, mb->freeFunc());
 }
 
+void
+Comm::Write(const Comm::ConnectionPointer &conn, MemBuf *mb, const char *buf, int size, AsyncCall::Pointer &callback)
+{
+    struct iovec iov[2];
+    iov[0].iov_base = mb->buf;
+    iov[0].iov_len = mb->size;
+    iov[1].iov_base = const_cast<char *>(buf);
+    iov[1].iov_len = size;
+    Comm::Write(conn, iov, 2, callback, mb->freeFunc());
+}
+
+void
+Comm::Write(const Comm::ConnectionPointer &conn, const struct iovec *iov, int iovcnt, AsyncCall::Pointer &callback, FREE *free_func)
+{
+    assert(iovcnt > 0);
+    debugs(5, 5, conn << ": " << iovcnt << " buffers: asynCall " << callback);
+
+    /* Make sure we are open, not closing, and not writing */
+    assert(fd_table[conn->fd].flags.open);
+    assert(!fd_table[conn->fd].closing());
+    Comm::IoCallback *ccb = COMMIO_FD_WRITECB(conn->fd);
+    assert(!ccb->active());
+
+    fd_table[conn->fd].writeStart = squid_curtime;
+    ccb->conn = conn;
+    /* Queue the write */
+    ccb->setCallback(IOCB_WRITE, callback, static_cast<char *>(iov[0].iov_base), free_func, iov[0].iov_len);
+    ccb->appendBuffers(iov + 1, iovcnt - 1);
+    ccb->selectOrQueueWrite();
+}
+
+/// writes (some of) the first nleft unwritten bytes of a vectored write
+static int
+WriteBuffers(const int fd, const Comm::IoCallback &state, const int nleft)
+{
+    struct iovec iov[Comm::IoCallback::MaxBuffers];
+    const auto count = state.unwrittenBuffers(iov, nleft);
+    assert(count > 0);
+
+#if HAVE_WRITEV
+    if (count > 1 && fd_table[fd].writesDirectly())
+        return writev(fd, iov, count);
+#endif
+
+    // other I/O methods (e.g., TLS) get one contiguous buffer at a time
+    return FD_WRITE_METHOD(fd, static_cast<const char *>(iov[0].iov_base), iov[0].iov_len);
+}
+
 void
 Comm::Write(const Comm::ConnectionPointer &conn, const char *buf, int size, AsyncCall::Pointer &callback, FREE * free_func)
 {
@@ -47,6 +98,33 @@ Comm::Write(const Comm::ConnectionPointer &conn, const char *buf, int size, Asyn
     ccb->selectOrQueueWrite();
 }
 
+void
+Comm::WriteWhenReady(const Comm::ConnectionPointer &conn, AsyncCall::Pointer &callback)
+{
+    debugs(5, 5, conn << ": asynCall " << callback);
+
+    /* Make sure we are open, not closing, and not writing */
+    assert(fd_table[conn->fd].flags.open);
+    assert(!fd_table[conn->fd].closing());
+    Comm::IoCallback *ccb = COMMIO_FD_WRITECB(conn->fd);
+    assert(!ccb->active());
+
+    // unlike Comm::Write(), keep writeStart: the caller's write continues
+    ccb->conn = conn;
+    ccb->setCallback(IOCB_WRITE, callback, nullptr, nullptr, 0);
+    SetSelect(conn->fd, COMM_SELECT_WRITE, Comm::HandleWriteReady, ccb, 0);
+}
+
+/// Comm::WriteWhenReady() handler for a writable FD
+void
+Comm::HandleWriteReady(int fd, void *data)
+{
+    const auto state = static_cast<Comm::IoCallback *>(data);
+    assert(state->conn != nullptr);
+    assert(state->conn->fd == fd);
+    state->finish(Comm::OK, 0);
+}
+
 /** Write to FD.
  * This function is used by the lowest level of IO loop which only has access to FD numbers.
  * We have to use the Comm::ioCallbacks() to map FD numbers to waiting data and Comm::Connections.
@@ -80,7 +158,10 @@ Comm::HandleWrite(int fd, void *data)
 
     /* actually WRITE data */
     int xerrno = errno = 0;
-    len = FD_WRITE_METHOD(fd, state->buf + state->offset, nleft);
+    if (state->moreBufsCount && nleft > 0)
+        len = WriteBuffers(fd, *state, nleft);
+    else
+        len = FD_WRITE_METHOD(fd, state->buf + state->offset, nleft);
     xerrno = errno;
     debugs(5, 5, "write() returns " << len);
 
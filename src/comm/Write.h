@@ -11,6 +11,7 @@
 
 #include "base/AsyncCall.h"
 #include "comm/forward.h"
+#include "compat/cmsg.h"
 #include "mem/forward.h"
 
 class MemBuf;
@@ -31,6 +32,36 @@ void Write(const Comm::ConnectionPointer &conn, const char *buf, int size, Async
  */
 void Write(const Comm::ConnectionPointer &conn, MemBuf *mb, AsyncCall::Pointer &callback);
 
+/**
+ * Queue a vectored write of iovcnt buffers, sent as if they were one
+ * contiguous buffer (using a single writev(2) call when the connection
+ * I/O method allows it). callback is scheduled when all buffers are
+ * written, on error, or on file descriptor close. The callback size
+ * parameter is the total number of bytes written.
+ *
+ * free_func is used to free the first buffer when the write has completed.
+ * The caller must keep the other buffers intact until the callback is called.
+ * At most IoCallback::MaxBuffers buffers are supported.
+ */
+void Write(const Comm::ConnectionPointer &conn, const struct iovec *iov, int iovcnt, AsyncCall::Pointer &callback, FREE *free_func);
+
+/**
+ * Queue a write of mb contents (e.g., message headers) followed by size
+ * bytes at buf (e.g., message body), without copying the latter into mb.
+ * The caller must keep buf intact until the callback is called.
+ */
+void Write(const Comm::ConnectionPointer &conn, MemBuf *mb, const char *buf, int size, AsyncCall::Pointer &callback);
+
+/**
+ * Wait until the connection is ready for writing without writing anything.
+ * For callers that write using other system calls (e.g., splice(2)) but
+ * still need Comm write timeouts and closure notifications. The callback
+ * is scheduled with Comm::OK when the FD becomes writable, with an
+ * ETIMEDOUT Comm::COMM_ERROR after write_timeout (counted from
+ * fde::writeStart), or with Comm::ERR_CLOSING on file descriptor close.
+ */
+void WriteWhenReady(const Comm::ConnectionPointer &conn, AsyncCall::Pointer &callback);
+
 /// Cancel the write pending on FD. No action if none pending.
 void WriteCancel(const Comm::ConnectionPointer &conn, const char *reason);
 
@@ -31,6 +31,8 @@ bool IsConnOpen(const Comm::ConnectionPointer &conn);
 
 // callback handler to process an FD which is available for writing.
 PF HandleWrite;
+// callback handler for Comm::WriteWhenReady() FDs that became writable.
+PF HandleWriteReady;
 
 /// Mark an FD to be watched for its IO status.
 void SetSelect(int, unsigned int, PF *, void *, time_t);
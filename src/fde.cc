@@ -29,6 +29,18 @@ fde::setIo(READ_HANDLER *reader, WRITE_HANDLER *writer)
     writeMethod_ = writer;
 }
 
+bool
+fde::readsDirectly() const
+{
+    return readMethod_ == &default_read_method;
+}
+
+bool
+fde::writesDirectly() const
+{
+    return writeMethod_ == &default_write_method;
+}
+
 void
 fde::useDefaultIo()
 {
@@ -87,6 +87,12 @@ public:
     int read(int fd, char *buf, int len) { return readMethod_(fd, buf, len); }
     int write(int fd, const char *buf, int len) { return writeMethod_(fd, buf, len); }
 
+    /// whether reads come straight from the OS descriptor
+    bool readsDirectly() const;
+
+    /// whether writes go straight to the OS descriptor (and may use writev(2))
+    bool writesDirectly() const;
+
     /* NOTE: memset is used on fdes today. 20030715 RBC */
     static void DumpStats(StoreEntry *);
 
@@ -143,7 +149,9 @@ public:
     ClientInfo * clientInfo = nullptr;
     MessageBucket::Pointer writeQuotaHandler; ///< response write limiter, if configured
 #endif
-    unsigned epoll_state = 0;
+    unsigned epoll_state = 0; ///< events registered with epoll(7)
+    unsigned epoll_pending = 0; ///< events requested by Comm::SetSelect() for epoll(7)
+    bool epoll_queued = false; ///< whether epoll_pending awaits a batched epoll(7) update
 
     _fde_disk disk;
     PF *read_handler;
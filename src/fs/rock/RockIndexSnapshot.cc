@@ -0,0 +1,445 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+/* DEBUG: section 47    Store Directory Routines */
+
+#include "squid.h"
+#include "base/TextException.h"
+#include "enums.h"
+#include "fs/rock/RockDbCell.h"
+#include "fs/rock/RockIndexSnapshot.h"
+#include "fs/rock/RockSwapDir.h"
+#include "globals.h"
+#include "ipc/mem/PageStack.h"
+#include "sbuf/Stream.h"
+#include "store_rebuild.h"
+#include "time/gadgets.h"
+
+#include <cerrno>
+#include <cstring>
+#if HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+namespace Rock
+{
+
+/// identifies snapshot files
+static const char SnapshotMagic[16] = "Squid rock idx";
+/// identifies db files with a DbHeader
+static const char DbMagic[16] = "Squid rock db";
+/// snapshot file format version; increment when changing the format
+static const uint32_t SnapshotVersion = 1;
+
+/// the beginning of the (otherwise unused) db file header
+class DbHeader
+{
+public:
+    char magic[sizeof(DbMagic)];
+    uint64_t indexGeneration; ///< the generation of the last saved snapshot
+};
+
+/// a snapshotted map entry, followed by sliceCount SliceRecords listing the
+/// entry slots in their chain order
+class EntryRecord
+{
+public:
+    uint64_t key[2];
+    int64_t timestamp;
+    int64_t lastref;
+    int64_t expires;
+    int64_t lastmod;
+    uint64_t swapFileSize;
+    uint16_t refcount;
+    uint16_t flags;
+    uint32_t sliceCount;
+};
+
+/// a snapshotted slot of an entry chain
+class SliceRecord
+{
+public:
+    int32_t id; ///< db slot ID
+    uint32_t size; ///< entry payload bytes stored in the slot
+};
+
+} // namespace Rock
+
+/// Snapshot files start with this header. The db and map geometry fields
+/// detect cache_dir configuration changes.
+class Rock::IndexSnapshot::Header
+{
+public:
+    char magic[sizeof(SnapshotMagic)];
+    uint32_t version; ///< SnapshotVersion
+    uint32_t headerSize; ///< sizeof(Header); detects ABI changes
+    uint64_t generation; ///< matches DbHeader::indexGeneration when valid
+    uint64_t slotSize;
+    int64_t slotLimit;
+    int64_t entryLimit;
+    uint64_t entryCount; ///< the number of EntryRecords that follow
+};
+
+Rock::IndexSnapshot::IndexSnapshot(SwapDir &aDir):
+    dir(aDir),
+    path(SBuf(aDir.path).append("/rock.index")),
+    file(nullptr),
+    generation(0)
+{
+}
+
+Rock::IndexSnapshot::~IndexSnapshot()
+{
+    if (file)
+        fclose(file);
+}
+
+/// opens the given snapshot file in the given fopen(3) mode
+bool
+Rock::IndexSnapshot::open(const char * const fileName, const char * const mode)
+{
+    assert(!file);
+    file = fopen(fileName, mode);
+    if (!file) {
+        const auto xerrno = errno;
+        if (xerrno != ENOENT || *mode != 'r') {
+            debugs(47, DBG_IMPORTANT, "ERROR: Cannot open cache_dir #" << dir.index <<
+                   " index snapshot " << fileName << ": " << xstrerr(xerrno));
+        }
+        return false;
+    }
+    return true;
+}
+
+void
+Rock::IndexSnapshot::fillHeader(Header &header, const uint64_t entryCount) const
+{
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SnapshotMagic, sizeof(header.magic));
+    header.version = SnapshotVersion;
+    header.headerSize = sizeof(header);
+    header.generation = generation;
+    header.slotSize = dir.slotSize;
+    header.slotLimit = dir.slotLimitActual();
+    header.entryLimit = dir.entryLimitActual();
+    header.entryCount = entryCount;
+}
+
+void
+Rock::IndexSnapshot::save()
+{
+    const auto start = current_time;
+    generation = readDbGeneration() + 1;
+
+    auto tmpPath = ToSBuf(path, ".new");
+    if (!open(tmpPath.c_str(), "wb"))
+        return;
+
+    // reserve space for the header; we do not know the entry count yet
+    Header header;
+    uint64_t entryCount = 0;
+    fillHeader(header, entryCount);
+    auto ok = fwrite(&header, sizeof(header), 1, file) == 1 && writeEntries(entryCount);
+    if (ok) {
+        fillHeader(header, entryCount);
+        ok = fseek(file, 0, SEEK_SET) == 0 &&
+             fwrite(&header, sizeof(header), 1, file) == 1 &&
+             fflush(file) == 0 &&
+             fsync(fileno(file)) == 0;
+    }
+    const auto xerrno = errno;
+    ok = (fclose(file) == 0) && ok;
+    file = nullptr;
+
+    if (!ok || rename(tmpPath.c_str(), path.c_str()) != 0) {
+        debugs(47, DBG_IMPORTANT, "ERROR: Cannot save cache_dir #" << dir.index <<
+               " index snapshot " << path << ": " << xstrerr(ok ? errno : xerrno));
+        (void)unlink(tmpPath.c_str());
+        return;
+    }
+
+    // the snapshot becomes valid when the db header points to it
+    writeDbGeneration(generation);
+
+    getCurrentTime();
+    debugs(47, DBG_IMPORTANT, "Saved " << entryCount << " cache_dir #" << dir.index <<
+           " entries to " << path << " in " << tvSubDsec(start, current_time) << " seconds");
+}
+
+/// writes an EntryRecord with SliceRecords for every complete map entry
+bool
+Rock::IndexSnapshot::writeEntries(uint64_t &entryCount)
+{
+    auto &map = *dir.map;
+    std::vector<SliceRecord> slices;
+    for (sfileno fileNo = 0; fileNo < map.entryLimit(); ++fileNo) {
+        const auto &peek = map.peekAtEntry(fileNo);
+        if (!peek.complete())
+            continue;
+
+        // the key may change until we lock the entry
+        EntryRecord entry;
+        entry.key[0] = peek.key[0];
+        entry.key[1] = peek.key[1];
+        const auto anchor = map.openForReadingAt(fileNo, reinterpret_cast<const cache_key*>(entry.key));
+        if (!anchor)
+            continue; // busy, marked for deletion, or replaced
+
+        slices.clear();
+        uint64_t chainSize = 0;
+        for (auto sliceId = anchor->start.load(); sliceId >= 0 && slices.size() <= static_cast<size_t>(map.sliceLimit());) {
+            const auto &slice = map.readableSlice(fileNo, sliceId);
+            slices.push_back(SliceRecord{sliceId, slice.size});
+            chainSize += slice.size;
+            sliceId = slice.next;
+        }
+
+        entry.timestamp = anchor->basics.timestamp;
+        entry.lastref = anchor->basics.lastref;
+        entry.expires = anchor->basics.expires;
+        entry.lastmod = anchor->basics.lastmod;
+        entry.swapFileSize = anchor->basics.swap_file_sz;
+        entry.refcount = anchor->basics.refcount;
+        entry.flags = anchor->basics.flags;
+        entry.sliceCount = slices.size();
+        map.closeForReading(fileNo);
+
+        // skip entries with incomplete or looping chains
+        if (!chainSize || chainSize != entry.swapFileSize ||
+                slices.size() > static_cast<size_t>(map.sliceLimit()))
+            continue;
+
+        if (fwrite(&entry, sizeof(entry), 1, file) != 1 ||
+                fwrite(slices.data(), sizeof(SliceRecord), slices.size(), file) != slices.size())
+            return false;
+        ++entryCount;
+    }
+    return true;
+}
+
+bool
+Rock::IndexSnapshot::valid()
+{
+    uint64_t entryCount = 0;
+    std::vector<bool> usedSlots;
+    const auto result = verify(entryCount, usedSlots);
+    if (file) {
+        fclose(file);
+        file = nullptr;
+    }
+    return result;
+}
+
+bool
+Rock::IndexSnapshot::load(StoreRebuildData &counts)
+{
+    const auto start = current_time;
+
+    // check everything before modifying the map
+    uint64_t entryCount = 0;
+    std::vector<bool> usedSlots;
+    if (!verify(entryCount, usedSlots))
+        return false;
+
+    if (fseek(file, sizeof(Header), SEEK_SET) != 0) {
+        debugs(47, DBG_IMPORTANT, "ERROR: Cannot rewind cache_dir #" << dir.index <<
+               " index snapshot " << path << ": " << xstrerr(errno));
+        return false;
+    }
+
+    importEntries(entryCount, usedSlots, counts);
+
+    getCurrentTime();
+    debugs(47, DBG_IMPORTANT, "Loaded " << counts.objcount << " cache_dir #" << dir.index <<
+           " entries from " << path << " in " << tvSubDsec(start, current_time) << " seconds");
+    return true;
+}
+
+/// opens the current snapshot file and checks all of its records
+bool
+Rock::IndexSnapshot::verify(uint64_t &entryCount, std::vector<bool> &usedSlots)
+{
+    generation = readDbGeneration();
+    if (!generation)
+        return false; // no snapshot was saved for this db
+
+    if (!open(path.c_str(), "rb"))
+        return false;
+
+    usedSlots.assign(dir.slotLimitActual(), false);
+    if (!readHeader(entryCount) || !scanEntries(entryCount, usedSlots)) {
+        debugs(47, DBG_IMPORTANT, "WARNING: Ignoring stale or damaged cache_dir #" << dir.index <<
+               " index snapshot " << path);
+        return false;
+    }
+    return true;
+}
+
+/// reads and checks the snapshot file header
+bool
+Rock::IndexSnapshot::readHeader(uint64_t &entryCount)
+{
+    Header header;
+    if (fread(&header, sizeof(header), 1, file) != 1)
+        return false;
+
+    Header expected;
+    fillHeader(expected, header.entryCount);
+    if (memcmp(&header, &expected, sizeof(header)) != 0)
+        return false;
+
+    entryCount = header.entryCount;
+    return true;
+}
+
+/// checks all snapshot entry records without modifying the map,
+/// marking the slots they use
+bool
+Rock::IndexSnapshot::scanEntries(const uint64_t entryCount, std::vector<bool> &usedSlots)
+{
+    const auto maxPayloadSize = dir.slotSize - sizeof(DbCellHeader);
+    for (uint64_t i = 0; i < entryCount; ++i) {
+        EntryRecord entry;
+        if (fread(&entry, sizeof(entry), 1, file) != 1)
+            return false;
+        if ((!entry.key[0] && !entry.key[1]) || !entry.sliceCount || entry.sliceCount > usedSlots.size())
+            return false;
+
+        uint64_t chainSize = 0;
+        for (uint32_t s = 0; s < entry.sliceCount; ++s) {
+            SliceRecord slice;
+            if (fread(&slice, sizeof(slice), 1, file) != 1)
+                return false;
+            if (slice.id < 0 || static_cast<size_t>(slice.id) >= usedSlots.size() || usedSlots[slice.id])
+                return false;
+            if (!slice.size || slice.size > maxPayloadSize)
+                return false;
+            usedSlots[slice.id] = true;
+            chainSize += slice.size;
+        }
+
+        if (chainSize != entry.swapFileSize)
+            return false;
+    }
+
+    // the file must end after the last entry
+    return fgetc(file) == EOF && !ferror(file);
+}
+
+/// adds previously checked snapshot entries to the map and frees all
+/// slots that are not used by the added entries
+void
+Rock::IndexSnapshot::importEntries(const uint64_t entryCount, std::vector<bool> &usedSlots, StoreRebuildData &counts)
+{
+    auto &map = *dir.map;
+    std::vector<SliceRecord> slices;
+    for (uint64_t i = 0; i < entryCount; ++i) {
+        EntryRecord entry;
+        Must(fread(&entry, sizeof(entry), 1, file) == 1);
+        slices.resize(entry.sliceCount);
+        Must(fread(slices.data(), sizeof(SliceRecord), slices.size(), file) == slices.size());
+
+        const auto key = reinterpret_cast<const cache_key*>(entry.key);
+        const auto fileNo = map.fileNoByKey(key);
+        // another snapshot entry may have the same position in the map
+        const auto anchor = map.openForWritingAt(fileNo, false);
+        if (!anchor) {
+            ++counts.clashcount;
+            for (const auto &slice: slices)
+                usedSlots[slice.id] = false;
+            continue;
+        }
+
+        anchor->setKey(key);
+        anchor->basics.timestamp = entry.timestamp;
+        anchor->basics.lastref = entry.lastref;
+        anchor->basics.expires = entry.expires;
+        anchor->basics.lastmod = entry.lastmod;
+        anchor->basics.swap_file_sz = entry.swapFileSize;
+        anchor->basics.refcount = entry.refcount;
+        anchor->basics.flags = entry.flags;
+        EBIT_SET(anchor->basics.flags, ENTRY_VALIDATED);
+
+        for (size_t s = 0; s < slices.size(); ++s) {
+            Ipc::StoreMapSlice slice;
+            slice.size = slices[s].size;
+            slice.next = (s + 1 < slices.size()) ? slices[s + 1].id : -1;
+            map.importSlice(slices[s].id, slice);
+        }
+        anchor->start = slices.front().id;
+
+        map.closeForWriting(fileNo);
+        ++counts.objcount;
+    }
+
+    for (size_t slotId = 0; slotId < usedSlots.size(); ++slotId) {
+        if (usedSlots[slotId])
+            continue;
+        Ipc::Mem::PageId pageId;
+        pageId.pool = Ipc::Mem::PageStack::IdForSwapDirSpace(dir.index);
+        pageId.number = slotId + 1;
+        dir.freeSlots->push(pageId);
+    }
+
+    // make Rebuild::Stats::completed() true for restarted kids
+    counts.updateStartTime(current_time);
+    counts.scancount = dir.slotLimitActual();
+    counts.validations = dir.entryLimitActual() + (opt_store_doublecheck ? dir.slotLimitActual() : 0);
+}
+
+void
+Rock::IndexSnapshot::invalidate()
+{
+    const auto removed = unlink(path.c_str()) == 0;
+    const auto dbGeneration = readDbGeneration();
+    if (removed || dbGeneration)
+        writeDbGeneration(dbGeneration + 1); // no snapshot has this generation
+}
+
+/// \returns the generation of the last snapshot saved for the db (or zero)
+uint64_t
+Rock::IndexSnapshot::readDbGeneration() const
+{
+    const auto fd = ::open(dir.filePath, O_RDONLY | O_BINARY);
+    if (fd < 0)
+        return 0;
+
+    DbHeader header;
+    const auto ok = read(fd, &header, sizeof(header)) == static_cast<ssize_t>(sizeof(header));
+    close(fd);
+    if (!ok || memcmp(header.magic, DbMagic, sizeof(header.magic)) != 0)
+        return 0;
+    return header.indexGeneration;
+}
+
+/// stores the given snapshot generation in the db header
+void
+Rock::IndexSnapshot::writeDbGeneration(const uint64_t newGeneration)
+{
+    DbHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DbMagic, sizeof(header.magic));
+    header.indexGeneration = newGeneration;
+
+    const auto fd = ::open(dir.filePath, O_WRONLY | O_BINARY);
+    const auto ok = fd >= 0 &&
+                    write(fd, &header, sizeof(header)) == static_cast<ssize_t>(sizeof(header)) &&
+                    fsync(fd) == 0;
+    const auto xerrno = errno;
+    if (fd >= 0)
+        close(fd);
+    if (!ok) {
+        debugs(47, DBG_CRITICAL, "ERROR: Cannot update " << dir.filePath << " header: " << xstrerr(xerrno));
+        // a stale snapshot must not be loaded
+        (void)unlink(path.c_str());
+    }
+}
+
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#ifndef SQUID_SRC_FS_ROCK_ROCKINDEXSNAPSHOT_H
+#define SQUID_SRC_FS_ROCK_ROCKINDEXSNAPSHOT_H
+
+#include "fs/rock/forward.h"
+#include "sbuf/SBuf.h"
+
+#include <cstdio>
+#include <vector>
+
+class StoreRebuildData;
+
+namespace Rock
+{
+
+/// \ingroup Rock
+/// A copy of the cache_dir index (i.e. map entries, their slot chains, and,
+/// implicitly, free slots) saved in a file next to the db during a clean
+/// shutdown. Loading a snapshot at startup replaces the db scan.
+///
+/// A snapshot is only valid for the db state at the time it was saved. The
+/// db file header stores the generation of the last saved snapshot. That
+/// generation changes before the db may be modified, invalidating older
+/// snapshot files.
+class IndexSnapshot
+{
+public:
+    explicit IndexSnapshot(SwapDir &);
+    ~IndexSnapshot();
+
+    /// Saves all complete entries of a fully indexed cache_dir. Logs errors.
+    /// Must be called when nobody can modify the db anymore.
+    void save();
+
+    /// Imports a valid snapshot (if any) into the cache_dir map that has not
+    /// been indexed yet. Logs errors.
+    /// \returns whether the cache_dir index has been loaded
+    bool load(StoreRebuildData &);
+
+    /// \returns whether load() would accept the current snapshot file
+    bool valid();
+
+    /// prevents any existing snapshot from being loaded in the future;
+    /// must be called before the db may be modified
+    void invalidate();
+
+private:
+    /// the unchanging part of a snapshot file prefix
+    class Header;
+
+    bool open(const char *fileName, const char *mode);
+    bool verify(uint64_t &entryCount, std::vector<bool> &usedSlots);
+    bool readHeader(uint64_t &entryCount);
+    bool scanEntries(uint64_t entryCount, std::vector<bool> &usedSlots);
+    void importEntries(uint64_t entryCount, std::vector<bool> &usedSlots, StoreRebuildData &);
+    bool writeEntries(uint64_t &entryCount);
+    void fillHeader(Header &, uint64_t entryCount) const;
+
+    uint64_t readDbGeneration() const;
+    void writeDbGeneration(uint64_t);
+
+    SwapDir &dir; ///< the cache_dir being snapshot
+    SBuf path; ///< the snapshot file name
+    FILE *file; ///< the open snapshot file (or nil)
+    uint64_t generation; ///< the snapshot generation being saved or loaded
+};
+
+} // namespace Rock
+
+#endif /* SQUID_SRC_FS_ROCK_ROCKINDEXSNAPSHOT_H */
+
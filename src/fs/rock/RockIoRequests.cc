@@ -26,6 +26,7 @@ Rock::WriteRequest::WriteRequest(const ::WriteRequest &base, const IoState::Poin
     sio(anSio),
     sidPrevious(-1),
     sidCurrent(-1),
+    slotCount(1),
     id(anId),
     eof(false)
 {
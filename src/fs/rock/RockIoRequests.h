@@ -39,14 +39,17 @@ public:
     WriteRequest(const ::WriteRequest &, const IoState::Pointer &, const IoXactionId);
     IoState::Pointer sio;
 
-    /* We own these two reserved slots until SwapDir links them into the map. */
+    /* We own these reserved slots until SwapDir links them into the map. */
 
     /// slot that will point to sidCurrent in the cache_dir map
     SlotId sidPrevious;
 
-    /// slot being written using this write request
+    /// the first slot being written using this write request
     SlotId sidCurrent;
 
+    /// the number of adjacent slots being written, starting with sidCurrent
+    SlotId slotCount;
+
     /// identifies this write transaction for the requesting IoState
     IoXactionId id;
 
@@ -40,7 +40,10 @@ Rock::IoState::IoState(Rock::SwapDir::Pointer &aDir,
     sidNext(-1),
     requestsSent(0),
     repliesReceived(0),
-    theBuf(dir->slotSize)
+    theBuf(dir->slotSize),
+    runBuf(nullptr),
+    runBufCapacity(0),
+    runSize(0)
 {
     e = anEntry;
     e->lock("rock I/O");
@@ -61,6 +64,9 @@ Rock::IoState::~IoState()
     cbdataReferenceDone(callback_data);
     theFile = nullptr;
 
+    if (runBuf)
+        memFreeBuf(runBufCapacity, runBuf);
+
     e->unlock("rock I/O");
 }
 
@@ -205,6 +211,8 @@ Rock::IoState::write(char const *buf, size_t size, off_t coreOff, FREE *dtor)
 /**
  * Possibly send data to be written to disk:
  * We only write data when full slot is accumulated or when close() is called.
+ * Full slots followed by an adjacent db slot are not written immediately but
+ * coalesced with that slot into one larger disk write (see extendRun()).
  * We buffer, in part, to avoid forcing OS to _read_ old unwritten portions of
  * the slot when the write does not end at the page or sector boundary.
  */
@@ -232,9 +240,13 @@ Rock::IoState::tryWrite(char const *buf, size_t size, off_t coreOff)
         // we do not want to risk writing a payload-free slot on EOF.
         if (overflow) {
             Must(sidNext < 0);
+            // reserve in disk order: free slots usually come in ascending order
+            if (sidFirst < 0)
+                sidCurrent = sidFirst = dir->reserveSlotForWriting();
             sidNext = dir->reserveSlotForWriting();
             assert(sidNext >= 0);
-            writeToDisk();
+            if (!extendRun())
+                writeToDisk();
             Must(sidNext < 0); // short sidNext lifetime simplifies code logic
         }
     }
@@ -255,12 +267,68 @@ Rock::IoState::writeToBuffer(char const *buf, size_t size)
         theBuf.appended(sizeof(DbCellHeader));
     }
 
-    size_t forCurrentSlot = min(size, static_cast<size_t>(theBuf.spaceSize()));
+    // theBuf capacity may exceed slotSize
+    size_t forCurrentSlot = min(size, slotSize - theBuf.size);
     theBuf.append(buf, forCurrentSlot);
     offset_ += forCurrentSlot; // so that Core thinks we wrote it
     return forCurrentSlot;
 }
 
+/// Adds sidNext to the run of adjacent slots waiting to be written together
+/// if sidNext immediately follows sidCurrent on disk and the resulting write
+/// request would not be too large.
+/// \returns whether sidNext became the new sidCurrent
+bool
+Rock::IoState::extendRun()
+{
+    assert(sidCurrent >= 0);
+    assert(sidNext >= 0);
+
+    if (sidNext != sidCurrent + 1)
+        return false;
+
+    const auto maxRunSize = dir->maxSlotsPerWrite() * slotSize;
+    if (runSize + theBuf.size + slotSize > maxRunSize)
+        return false;
+
+    Must(theBuf.size == slotSize); // only full slots may be followed by others
+    if (!runBuf)
+        runBuf = static_cast<char*>(memAllocBuf(maxRunSize, &runBufCapacity));
+    finalizeSlot(sidNext, false);
+
+    debugs(79, 5, "slot " << sidNext << " continues a run of " << (runSize/slotSize) << " slots");
+    sidCurrent = sidNext;
+    sidNext = -1;
+    return true;
+}
+
+/// Completes the db cell header of the buffered sidCurrent slot and moves the
+/// resulting slot image to the end of runBuf.
+void
+Rock::IoState::finalizeSlot(const SlotId nextSlot, const bool eof)
+{
+    DbCellHeader header;
+    memcpy(header.key, e->key, sizeof(header.key));
+    header.firstSlot = sidFirst;
+    header.nextSlot = nextSlot;
+    header.payloadSize = theBuf.size - sizeof(DbCellHeader);
+    header.entrySize = eof ? offset_ : 0; // storeSwapOutFileClosed sets swap_file_sz after write
+    header.version = writeAnchor().basics.timestamp;
+
+    // copy finalized db cell header into buffer
+    memcpy(theBuf.mem, &header, sizeof(DbCellHeader));
+
+    // and now move everything into runBuf so that we can support concurrent
+    // WriteRequests (and to ease cleaning); extendRun() allocates runs
+    if (!runBuf)
+        runBuf = static_cast<char*>(memAllocBuf(theBuf.size, &runBufCapacity));
+    Must(runSize + theBuf.size <= runBufCapacity);
+    memcpy(runBuf + runSize, theBuf.mem, theBuf.size);
+    runSize += theBuf.size;
+
+    theBuf.clear();
+}
+
 /// write what was buffered during write() calls
 void
 Rock::IoState::writeToDisk()
@@ -285,46 +353,36 @@ Rock::IoState::writeToDisk()
 
     assert(!eof || sidNext < 0); // no slots after eof
 
-    // finalize db cell header
-    DbCellHeader header;
-    memcpy(header.key, e->key, sizeof(header.key));
-    header.firstSlot = sidFirst;
-
     const auto lastUpdatingWrite = lastWrite && !touchingStoreEntry();
     assert(!lastUpdatingWrite || sidNext < 0);
-    header.nextSlot = lastUpdatingWrite ? staleSplicingPointNext : sidNext;
-
-    header.payloadSize = theBuf.size - sizeof(DbCellHeader);
-    header.entrySize = eof ? offset_ : 0; // storeSwapOutFileClosed sets swap_file_sz after write
-    header.version = writeAnchor().basics.timestamp;
+    finalizeSlot(lastUpdatingWrite ? staleSplicingPointNext : sidNext, eof);
 
-    // copy finalized db cell header into buffer
-    memcpy(theBuf.mem, &header, sizeof(DbCellHeader));
+    // the run buffer now ends with sidCurrent and starts with sidRunFirst
+    const auto runSlots = static_cast<SlotId>((runSize + slotSize - 1) / slotSize);
+    const auto sidRunFirst = sidCurrent - (runSlots - 1);
 
-    // and now allocate another buffer for the WriteRequest so that
-    // we can support concurrent WriteRequests (and to ease cleaning)
+    // the WriteRequest takes runBuf; the next finalizeSlot() allocates another
     // TODO: should we limit the number of outstanding requests?
-    size_t wBufCap = 0;
-    void *wBuf = memAllocBuf(theBuf.size, &wBufCap);
-    memcpy(wBuf, theBuf.mem, theBuf.size);
-
-    const uint64_t diskOffset = dir->diskOffset(sidCurrent);
+    const uint64_t diskOffset = dir->diskOffset(sidRunFirst);
     debugs(79, 5, swap_filen << " at " << diskOffset << '+' <<
-           theBuf.size);
+           runSize << " slots: " << runSlots);
     const auto id = ++requestsSent;
     WriteRequest *const r = new WriteRequest(
-        ::WriteRequest(static_cast<char*>(wBuf), diskOffset, theBuf.size,
-                       memFreeBufFunc(wBufCap)), this, id);
-    r->sidCurrent = sidCurrent;
+        ::WriteRequest(runBuf, diskOffset, runSize,
+                       memFreeBufFunc(runBufCapacity)), this, id);
+    r->sidCurrent = sidRunFirst;
+    r->slotCount = runSlots;
     r->sidPrevious = sidPrevious;
     r->eof = lastWrite;
 
+    runBuf = nullptr;
+    runBufCapacity = 0;
+    runSize = 0;
+
     sidPrevious = sidCurrent;
     sidCurrent = sidNext; // sidNext may be cleared/negative already
     sidNext = -1;
 
-    theBuf.clear();
-
     // theFile->write may call writeCompleted immediately
     theFile->write(r);
 }
@@ -349,8 +407,12 @@ void
 Rock::IoState::finishedWriting(const int errFlag)
 {
     if (sidCurrent >= 0) {
-        dir->noteFreeMapSlice(sidCurrent);
+        // also free slots coalesced with sidCurrent but not written yet
+        const auto runSlots = static_cast<SlotId>(runSize / slotSize);
+        for (auto sid = sidCurrent - runSlots; sid <= sidCurrent; ++sid)
+            dir->noteFreeMapSlice(sid);
         sidCurrent = -1;
+        runSize = 0;
     }
     if (sidNext >= 0) {
         dir->noteFreeMapSlice(sidNext);
@@ -69,6 +69,8 @@ private:
 
     void tryWrite(char const *buf, size_t size, off_t offset);
     size_t writeToBuffer(char const *buf, size_t size);
+    bool extendRun();
+    void finalizeSlot(SlotId nextSlot, bool eof);
     void writeToDisk();
 
     void callReaderBack(const char *buf, int rlen);
@@ -83,7 +85,8 @@ private:
     SlotId sidFirst;
 
     /// Unused by readers.
-    /// For writers, the slot pointing (via .next) to sidCurrent.
+    /// For writers, the slot pointing (via .next) to the first slot of the
+    /// next disk write (i.e. to sidCurrent unless runBuf has some slots).
     SlotId sidPrevious;
 
     /// For readers, the db slot currently being read from disk.
@@ -102,6 +105,13 @@ private:
 
     RefCount<DiskFile> theFile; // "file" responsible for this I/O
     MemBlob theBuf; // use for write content accumulation only
+
+    /// Unused by readers.
+    /// For writers, finalized images of adjacent slots preceding sidCurrent
+    /// on disk; they are written together with sidCurrent (as one request).
+    char *runBuf;
+    size_t runBufCapacity; ///< runBuf allocation size
+    size_t runSize; ///< the number of runBuf bytes in use
 };
 
 } // namespace Rock
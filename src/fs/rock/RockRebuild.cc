@@ -11,7 +11,9 @@
 #include "squid.h"
 #include "base/AsyncJobCalls.h"
 #include "debug/Messages.h"
+#include "fde.h"
 #include "fs/rock/RockDbCell.h"
+#include "fs/rock/RockIndexSnapshot.h"
 #include "fs/rock/RockRebuild.h"
 #include "fs/rock/RockSwapDir.h"
 #include "fs_io.h"
@@ -19,12 +21,16 @@
 #include "md5.h"
 #include "sbuf/Stream.h"
 #include "SquidMath.h"
+#include "StatCounters.h"
 #include "Store.h"
 #include "tools.h"
 
 #include <array>
 #include <cerrno>
 #include <cstring>
+#if HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
 
 CBDATA_NAMESPACED_CLASS_INIT(Rock, Rebuild);
 
@@ -76,6 +82,10 @@ CBDATA_NAMESPACED_CLASS_INIT(Rock, Rebuild);
 namespace Rock
 {
 
+/// the preferred number of bytes to read from disk at once when loading
+/// db slots; large sequential reads are a lot faster than one read per slot
+static const size_t ChunkSize = 1024*1024;
+
 static bool
 DoneLoading(const int64_t loadingPos, const int64_t dbSlotLimit)
 {
@@ -267,6 +277,27 @@ Rock::Rebuild::Stats::completed(const SwapDir &dir) const
            DoneValidating(counts.validations, dir.slotLimitActual(), dir.entryLimitActual());
 }
 
+void
+Rock::Rebuild::Stats::reportProgress(StoreEntry &e, const SwapDir &dir) const
+{
+    const auto slotLimit = dir.slotLimitActual();
+    const auto entryLimit = dir.entryLimitActual();
+    if (!counts.started() || completed(dir))
+        return;
+
+    const int64_t slotsLoaded = std::min<int64_t>(counts.scancount, slotLimit);
+    storeAppendPrintf(&e, "Rebuild progress: %" PRId64 " of %" PRId64 " slots loaded (%" PRId64 "%%), "
+                      "%" PRId64 " of %" PRId64 " entries validated\n",
+                      slotsLoaded, slotLimit, Math::int64Percent(slotsLoaded, slotLimit),
+                      std::min(counts.validations, entryLimit), entryLimit);
+
+    // after a restart, this includes time spent by the previous process
+    const auto elapsedSec = tvSubDsec(counts.startTime, current_time);
+    const auto rate = elapsedSec > 0 ? slotsLoaded / elapsedSec : 0.0;
+    storeAppendPrintf(&e, "Rebuild time: %.2f seconds, %.0f slots/sec, %.2f MB/sec\n",
+                      elapsedSec, rate, rate * dir.slotSize / (1024*1024));
+}
+
 /* Rebuild */
 
 bool
@@ -292,6 +323,14 @@ Rock::Rebuild::Start(SwapDir &dir)
         return false;
     }
 
+    // a saved index is only valid until the db changes
+    IndexSnapshot snapshot(dir);
+    const auto loaded = dir.indexSnapshots && !stats->counts.started() &&
+                        snapshot.load(stats->counts);
+    snapshot.invalidate();
+    if (loaded)
+        return false;
+
     AsyncJob::Start(new Rebuild(&dir, stats));
     return true;
 }
@@ -308,6 +347,10 @@ Rock::Rebuild::Rebuild(SwapDir *dir, const Ipc::Mem::Pointer<Stats> &s): AsyncJo
     dbOffset(0),
     loadingPos(stats->counts.scancount),
     validationPos(stats->counts.validations),
+    chunkPos(0),
+    chunkSlots(0),
+    chunkLoaded(0),
+    chunkFailed(false),
     counts(stats->counts),
     resuming(stats->counts.started())
 {
@@ -363,6 +406,11 @@ Rock::Rebuild::start()
 
     dbOffset = SwapDir::HeaderSize + loadingPos * dbSlotSize;
 
+    chunk.resize(std::max<size_t>(ChunkSize / dbSlotSize, 1) * dbSlotSize);
+#if HAVE_POSIX_FADVISE
+    (void)posix_fadvise(fd, dbOffset, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
     assert(!parts);
     parts = new LoadingParts(*sd, resuming);
 
@@ -475,12 +523,9 @@ Rock::Rebuild::loadOneSlot()
     // in a case of crash
     ++counts.scancount;
 
-    if (lseek(fd, dbOffset, SEEK_SET) < 0)
-        failure("cannot seek to db entry", errno);
-
     buf.reset();
 
-    if (!storeRebuildLoadEntry(fd, sd->index, buf, counts))
+    if (!loadSlotPrefix())
         return;
 
     const SlotId slotId = loadingPos;
@@ -510,6 +555,63 @@ Rock::Rebuild::loadOneSlot()
     useNewSlot(slotId, header);
 }
 
+/// Copies the beginning of the loadingPos slot into buf, reading the slot
+/// (and the slots after it) from disk if needed.
+/// \returns false if the slot could not be read
+bool
+Rock::Rebuild::loadSlotPrefix()
+{
+    if (loadingPos < chunkPos || loadingPos >= chunkPos + chunkSlots)
+        loadChunk();
+
+    const auto slotStart = static_cast<size_t>(loadingPos - chunkPos) * dbSlotSize;
+    const auto wanted = std::min(static_cast<size_t>(dbSlotSize), static_cast<size_t>(buf.spaceSize()));
+    if (chunkFailed && slotStart + wanted > chunkLoaded)
+        return false; // loadChunk() has reported the error
+
+    // a db file may be truncated; loadOneSlot() ignores incomplete prefixes
+    if (slotStart < chunkLoaded)
+        buf.append(chunk.data() + slotStart, std::min(wanted, chunkLoaded - slotStart));
+    return true;
+}
+
+/// reads as many db slots as fit into the chunk, starting with loadingPos
+void
+Rock::Rebuild::loadChunk()
+{
+    chunkPos = loadingPos;
+    chunkSlots = std::min<int64_t>(chunk.size() / dbSlotSize, dbSlotLimit - loadingPos);
+    chunkLoaded = 0;
+    chunkFailed = false;
+
+    if (lseek(fd, dbOffset, SEEK_SET) < 0)
+        failure("cannot seek to db entry", errno);
+
+    const auto chunkSize = static_cast<size_t>(chunkSlots * dbSlotSize);
+    while (chunkLoaded < chunkSize) {
+        const auto len = FD_READ_METHOD(fd, chunk.data() + chunkLoaded, chunkSize - chunkLoaded);
+        ++statCounter.syscalls.disk.reads;
+        if (len < 0) {
+            const auto xerrno = errno;
+            debugs(47, DBG_IMPORTANT, "WARNING: cache_dir[" << sd->index << "]: " <<
+                   "Ignoring cached entries after meta data read failure at " <<
+                   (dbOffset + chunkLoaded) << ": " << xstrerr(xerrno));
+            chunkFailed = true;
+            break;
+        }
+        if (!len)
+            break; // truncated db file
+        chunkLoaded += len;
+    }
+
+#if HAVE_POSIX_FADVISE
+    // let the kernel read the next chunk while we are indexing this one
+    (void)posix_fadvise(fd, dbOffset + chunkSize, chunkSize, POSIX_FADV_WILLNEED);
+#endif
+
+    debugs(47, 5, "loaded " << chunkLoaded << " bytes of " << chunkSlots << " slots starting with " << chunkPos);
+}
+
 /// whether the given slot buffer is likely to have nothing but zeros, as is
 /// common to slots in pre-initialized (with zeros) db files
 static bool
@@ -947,6 +1049,10 @@ Rock::Rebuild::progressDescription() const
 
     str << Debug::Extra << "slots loaded: " << Progress(loadingPos, dbSlotLimit);
 
+    const auto elapsedSec = tvSubDsec(counts.startTime, current_time);
+    if (elapsedSec > 0)
+        str << Debug::Extra << "loading speed: " << static_cast<int64_t>(loadingPos / elapsedSec) << " slots/sec";
+
     const auto validatingEntries = validationPos < dbEntryLimit;
     const auto entriesValidated = validatingEntries ? validationPos : dbEntryLimit;
     str << Debug::Extra << "entries validated: " << Progress(entriesValidated, dbEntryLimit);
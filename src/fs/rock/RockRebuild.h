@@ -18,6 +18,8 @@
 #include "MemBuf.h"
 #include "store_rebuild.h"
 
+#include <vector>
+
 namespace Rock
 {
 
@@ -45,6 +47,9 @@ public:
         /// whether the rebuild is finished already
         bool completed(const SwapDir &) const;
 
+        /// reports rebuild progress and speed for the cache manager
+        void reportProgress(StoreEntry &, const SwapDir &) const;
+
         StoreRebuildData counts;
     };
 
@@ -79,6 +84,8 @@ private:
     void loadingSteps();
     void validationSteps();
     void loadOneSlot();
+    bool loadSlotPrefix();
+    void loadChunk();
     void validateOneEntry(const sfileno fileNo);
     void validateOneSlot(const SlotId slotId);
     bool importEntry(Ipc::StoreMapAnchor &anchor, const sfileno slotId, const DbCellHeader &header);
@@ -122,6 +129,12 @@ private:
     int64_t validationPos; ///< index of the loaded db slot being validated now
     MemBuf buf; ///< space to load current db slot (and entry metadata) into
 
+    std::vector<char> chunk; ///< space to read several adjacent db slots into
+    int64_t chunkPos; ///< index of the first db slot in the chunk
+    int64_t chunkSlots; ///< the number of db slots the chunk was meant to get
+    size_t chunkLoaded; ///< the number of chunk bytes read from disk
+    bool chunkFailed; ///< whether the chunk read stopped due to an I/O error
+
     StoreRebuildData &counts; ///< a reference to the shared memory counters
 
     /// whether we have started indexing this cache_dir before,
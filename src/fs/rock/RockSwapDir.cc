@@ -18,6 +18,7 @@
 #include "DiskIO/ReadRequest.h"
 #include "DiskIO/WriteRequest.h"
 #include "fs/rock/RockHeaderUpdater.h"
+#include "fs/rock/RockIndexSnapshot.h"
 #include "fs/rock/RockIoRequests.h"
 #include "fs/rock/RockIoState.h"
 #include "fs/rock/RockSwapDir.h"
@@ -39,7 +40,7 @@
 
 Rock::SwapDir::SwapDir(): ::SwapDir("rock"),
     slotSize(HeaderSize), filePath(nullptr), map(nullptr), io(nullptr),
-    waitingForPage(nullptr)
+    waitingForPage(nullptr), indexSnapshots(false)
 {
 }
 
@@ -374,6 +375,8 @@ Rock::SwapDir::getOptionTree() const
         vector->options.push_back(new ConfigOptionAdapter<SwapDir>(*const_cast<SwapDir *>(this), &SwapDir::parseSizeOption, &SwapDir::dumpSizeOption));
         vector->options.push_back(new ConfigOptionAdapter<SwapDir>(*const_cast<SwapDir *>(this), &SwapDir::parseTimeOption, &SwapDir::dumpTimeOption));
         vector->options.push_back(new ConfigOptionAdapter<SwapDir>(*const_cast<SwapDir *>(this), &SwapDir::parseRateOption, &SwapDir::dumpRateOption));
+        vector->options.push_back(new ConfigOptionAdapter<SwapDir>(*const_cast<SwapDir *>(this), &SwapDir::parseDepthOption, &SwapDir::dumpDepthOption));
+        vector->options.push_back(new ConfigOptionAdapter<SwapDir>(*const_cast<SwapDir *>(this), &SwapDir::parseSnapshotOption, &SwapDir::dumpSnapshotOption));
     } else {
         // we don't know how to handle copt, as it's not a ConfigOptionVector.
         // free it (and return nullptr)
@@ -488,6 +491,71 @@ Rock::SwapDir::dumpRateOption(StoreEntry * e) const
         storeAppendPrintf(e, " max-swap-rate=%d", fileConfig.ioRate);
 }
 
+/// parses I/O concurrency options; mimics ::SwapDir::optionObjectSizeParse()
+bool
+Rock::SwapDir::parseDepthOption(char const *option, const char *value, int reconfig)
+{
+    int *storedDepth;
+    if (strcmp(option, "io-depth") == 0)
+        storedDepth = &fileConfig.ioDepth;
+    else
+        return false;
+
+    if (!value) {
+        self_destruct();
+        return false;
+    }
+
+    const int64_t parsedValue = strtoll(value, nullptr, 10);
+    // io_uring(7) limits the number of submission queue entries
+    const int64_t maxDepth = 4096;
+    if (parsedValue < 0 || parsedValue > maxDepth) {
+        debugs(3, DBG_CRITICAL, "FATAL: cache_dir " << path << ' ' << option << " must be between 0 and " << maxDepth << " but is: " << parsedValue);
+        self_destruct();
+        return false;
+    }
+
+    const int newDepth = static_cast<int>(parsedValue);
+
+    if (!reconfig)
+        *storedDepth = newDepth;
+    else if (*storedDepth != newDepth) {
+        debugs(3, DBG_IMPORTANT, "WARNING: cache_dir " << path << ' ' << option
+               << " cannot be changed dynamically, value left unchanged: " <<
+               *storedDepth);
+    }
+
+    return true;
+}
+
+/// reports I/O concurrency options; mimics ::SwapDir::optionObjectSizeDump()
+void
+Rock::SwapDir::dumpDepthOption(StoreEntry * e) const
+{
+    if (fileConfig.ioDepth > 0)
+        storeAppendPrintf(e, " io-depth=%d", fileConfig.ioDepth);
+}
+
+/// parses the index-snapshot option; mimics ::SwapDir::optionReadOnlyParse()
+bool
+Rock::SwapDir::parseSnapshotOption(char const *option, const char *value, int)
+{
+    if (strcmp(option, "index-snapshot") != 0)
+        return false;
+
+    // applies to future shutdowns, so reconfiguration may change it
+    indexSnapshots = value ? (xatoi(value) != 0) : true;
+    return true;
+}
+
+/// reports the index-snapshot option; mimics ::SwapDir::optionReadOnlyDump()
+void
+Rock::SwapDir::dumpSnapshotOption(StoreEntry * e) const
+{
+    if (indexSnapshots)
+        storeAppendPrintf(e, " index-snapshot");
+}
+
 /// parses size-specific options; mimics ::SwapDir::optionObjectSizeParse()
 bool
 Rock::SwapDir::parseSizeOption(char const *option, const char *value, int reconfig)
@@ -727,6 +795,14 @@ Rock::SwapDir::reserveSlotForWriting()
     throw TexcHere("ran out of free db slots");
 }
 
+size_t
+Rock::SwapDir::maxSlotsPerWrite() const
+{
+    // IpcIoFile copies each write request into one shared memory page; other
+    // DiskIO modules gain little from larger writes
+    return max(static_cast<size_t>(1), Ipc::Mem::PageSize() / static_cast<size_t>(slotSize));
+}
+
 bool
 Rock::SwapDir::validSlotId(const SlotId slotId) const
 {
@@ -855,7 +931,8 @@ Rock::SwapDir::writeCompleted(int errflag, size_t, RefCount< ::WriteRequest> r)
     // quit if somebody called IoState::close() while we were waiting
     if (!sio.stillWaiting()) {
         debugs(79, 3, "ignoring closed entry " << sio.swap_filen);
-        noteFreeMapSlice(request->sidCurrent);
+        for (SlotId i = 0; i < request->slotCount; ++i)
+            noteFreeMapSlice(request->sidCurrent + i);
         return;
     }
 
@@ -877,7 +954,9 @@ void
 Rock::SwapDir::handleWriteCompletionSuccess(const WriteRequest &request)
 {
     auto &sio = *(request.sio);
-    sio.splicingPoint = request.sidCurrent;
+    Must(request.slotCount > 0);
+    const auto sidLast = request.sidCurrent + request.slotCount - 1;
+    sio.splicingPoint = sidLast;
     // do not increment sio.offset_ because we do it in sio->write()
 
     assert(sio.writeableAnchor_);
@@ -890,11 +969,17 @@ Rock::SwapDir::handleWriteCompletionSuccess(const WriteRequest &request)
     }
 
     // finalize the shared slice info after writing slice contents to disk;
-    // the chain gets possession of the slice we were writing
-    Ipc::StoreMap::Slice &slice =
-        map->writeableSlice(sio.swap_filen, request.sidCurrent);
-    slice.size = request.len - sizeof(DbCellHeader);
-    Must(slice.next < 0);
+    // the chain gets possession of the slices we were writing
+    for (auto sid = request.sidCurrent; sid <= sidLast; ++sid) {
+        Ipc::StoreMap::Slice &slice = map->writeableSlice(sio.swap_filen, sid);
+        // all but the last coalesced slot are full
+        const uint64_t slotStart = (sid - request.sidCurrent) * slotSize;
+        const auto slotBytes = (sid == sidLast) ? request.len - slotStart : slotSize;
+        slice.size = slotBytes - sizeof(DbCellHeader);
+        Must(slice.next < 0);
+        if (sid < sidLast)
+            slice.next = sid + 1;
+    }
 
     if (request.eof) {
         assert(sio.e);
@@ -917,7 +1002,8 @@ Rock::SwapDir::handleWriteCompletionProblem(const int errflag, const WriteReques
 {
     auto &sio = *request.sio;
 
-    noteFreeMapSlice(request.sidCurrent);
+    for (SlotId i = 0; i < request.slotCount; ++i)
+        noteFreeMapSlice(request.sidCurrent + i);
 
     writeError(sio);
     sio.finishedWriting(errflag);
@@ -1077,6 +1163,9 @@ Rock::SwapDir::statfs(StoreEntry &e) const
         }
     }
 
+    const auto rebuildStats = shm_old(Rebuild::Stats)(Rebuild::Stats::Path(path).c_str());
+    rebuildStats->reportProgress(e, *this);
+
     storeAppendPrintf(&e, "Pending operations: %d out of %d\n",
                       store_open_disk_fd, Config.max_open_disk_fds);
 
@@ -1141,6 +1230,44 @@ void Rock::SwapDirRr::create()
     }
 }
 
+void
+Rock::SwapDirRr::finishShutdown()
+{
+    for (size_t i = 0; i < Config.cacheSwap.n_configured; ++i) {
+        const auto sd = dynamic_cast<Rock::SwapDir *>(INDEXSD(i));
+        if (!sd || !sd->indexSnapshots)
+            continue;
+
+        if (UsingSmp()) {
+            // any kid may modify the shared index until all kids exit
+            if (IamMasterProcess())
+                saveSharedIndex(*sd);
+        } else if (!StoreController::store_dirs_rebuilding && sd->map && sd->active()) {
+            // by now, this process cannot modify the db anymore
+            IndexSnapshot(*sd).save();
+        }
+    }
+}
+
+/// saves the shared index of the given cache_dir after all kids have exited
+void
+Rock::SwapDirRr::saveSharedIndex(SwapDir &sd)
+{
+    // the master process does not use cache_dirs and lacks their maps
+    Must(!sd.map);
+    sd.map = new SwapDir::DirMap(sd.inodeMapPath());
+
+    // an index being rebuilt is incomplete
+    const auto stats = shm_old(Rebuild::Stats)(Rebuild::Stats::Path(sd.path).c_str());
+    if (stats->completed(sd))
+        IndexSnapshot(sd).save();
+    else
+        debugs(47, DBG_IMPORTANT, "WARNING: Not saving incomplete cache_dir #" << sd.index << " index");
+
+    delete sd.map;
+    sd.map = nullptr;
+}
+
 Rock::SwapDirRr::~SwapDirRr()
 {
     for (size_t i = 0; i < mapOwners.size(); ++i) {
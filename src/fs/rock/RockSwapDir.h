@@ -70,6 +70,9 @@ public:
     /// finds and returns a free db slot to fill or throws
     SlotId reserveSlotForWriting();
 
+    /// the maximum number of adjacent slots written by one disk I/O request
+    size_t maxSlotsPerWrite() const;
+
     /// purges one or more entries to make full() false and free some slots
     void purgeSome();
 
@@ -115,6 +118,10 @@ protected:
     void dumpTimeOption(StoreEntry * e) const;
     bool parseRateOption(char const *option, const char *value, int reconfiguring);
     void dumpRateOption(StoreEntry * e) const;
+    bool parseDepthOption(char const *option, const char *value, int reconfiguring);
+    void dumpDepthOption(StoreEntry * e) const;
+    bool parseSnapshotOption(char const *option, const char *value, int reconfiguring);
+    void dumpSnapshotOption(StoreEntry * e) const;
     bool parseSizeOption(char const *option, const char *value, int reconfiguring);
     void dumpSizeOption(StoreEntry * e) const;
 
@@ -132,6 +139,8 @@ protected:
     friend class Rebuild;
     friend class IoState;
     friend class HeaderUpdater;
+    friend class IndexSnapshot;
+    friend class SwapDirRr;
     const char *filePath; ///< location of cache storage file inside path/
     DirMap *map; ///< entry key/sfileno to MaxExtras/inode mapping
 
@@ -147,6 +156,7 @@ private:
 
     /* configurable options */
     DiskFile::Config fileConfig; ///< file-level configuration options
+    bool indexSnapshots; ///< whether to save and load IndexSnapshots
 
     static const int64_t HeaderSize = 16*1024; ///< on-disk db header size
 };
@@ -157,12 +167,15 @@ class SwapDirRr: public Ipc::Mem::RegisteredRunner
 public:
     /* ::RegisteredRunner API */
     ~SwapDirRr() override;
+    void finishShutdown() override;
 
 protected:
     /* Ipc::Mem::RegisteredRunner API */
     void create() override;
 
 private:
+    void saveSharedIndex(SwapDir &);
+
     std::vector<Ipc::Mem::Owner<Rebuild::Stats> *> rebuildStatsOwners;
     std::vector<SwapDir::DirMap::Owner *> mapOwners;
     std::vector< Ipc::Mem::Owner<Ipc::Mem::PageStack> *> freeSlotsOwners;
@@ -41,6 +41,8 @@ class IoState;
 
 class HeaderUpdater;
 
+class IndexSnapshot;
+
 class DbCellHeader;
 
 class ReadRequest;
@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+/* DEBUG: section 47    Store Directory Routines */
+
+#include "squid.h"
+#include "CompactIndex.h"
+#include "debug/Stream.h"
+#include "Store.h"
+#include "StoreSwapLogData.h"
+
+#include <algorithm>
+#include <cstring>
+
+static_assert(sizeof(Fs::Ufs::CompactIndex::Record) == 48, "CompactIndex::Record stays packed");
+
+/// the largest time_t value stored as is; larger 32-bit values are negative
+static const uint32_t MaxPackedTime = 0xFFFFFFEF;
+
+Fs::Ufs::CompactIndex::Record::Record(const cache_key *aKey,
+                                      const sfileno filen,
+                                      const uint64_t fileSize,
+                                      const time_t expires,
+                                      const time_t timestamp,
+                                      const time_t lastref,
+                                      const time_t lastmod,
+                                      const uint16_t aRefcount,
+                                      const uint16_t newFlags):
+    swap_file_sz(fileSize),
+    expires_(Pack(expires)),
+    timestamp_(Pack(timestamp)),
+    lastref_(Pack(lastref)),
+    lastmod_(Pack(lastmod)),
+    swap_filen(filen),
+    refcount(aRefcount),
+    flags(newFlags)
+{
+    assert(filen >= 0);
+    memcpy(key, aKey, sizeof(key));
+}
+
+uint32_t
+Fs::Ufs::CompactIndex::Record::Pack(const time_t value)
+{
+    if (value < 0)
+        return static_cast<uint32_t>(static_cast<int32_t>(std::max<time_t>(value, -16)));
+    return static_cast<uint32_t>(std::min<time_t>(value, MaxPackedTime));
+}
+
+time_t
+Fs::Ufs::CompactIndex::Record::Unpack(const uint32_t value)
+{
+    if (value > MaxPackedTime)
+        return static_cast<int32_t>(value);
+    return value;
+}
+
+void
+Fs::Ufs::CompactIndex::Record::exportTo(StoreEntry &e, const sdirno dirn) const
+{
+    e.store_status = STORE_OK;
+    e.setMemStatus(NOT_IN_MEMORY);
+    e.attachToDisk(dirn, swap_filen, SWAPOUT_DONE);
+    e.swap_file_sz = swap_file_sz;
+    e.lastref = Unpack(lastref_);
+    e.timestamp = Unpack(timestamp_);
+    e.expires = Unpack(expires_);
+    e.lastModified(Unpack(lastmod_));
+    e.refcount = refcount;
+    e.flags = flags;
+    e.ping_status = PING_NONE;
+}
+
+void
+Fs::Ufs::CompactIndex::Record::exportTo(StoreSwapLogData &s) const
+{
+    s.swap_filen = swap_filen;
+    s.timestamp = Unpack(timestamp_);
+    s.lastref = Unpack(lastref_);
+    s.expires = Unpack(expires_);
+    s.lastmod = Unpack(lastmod_);
+    s.swap_file_sz = swap_file_sz;
+    s.refcount = refcount;
+    s.flags = flags;
+    memcpy(s.key, key, SQUID_MD5_DIGEST_LENGTH);
+}
+
+/// the smallest power-of-two number of slots that can hold the given number
+/// of records at the maximum load factor of 80%
+static size_t
+SlotsFor(const size_t records)
+{
+    size_t slots = 16;
+    while (slots / 5 * 4 < records)
+        slots <<= 1;
+    return slots;
+}
+
+Fs::Ufs::CompactIndex::CompactIndex(const size_t expectedRecords)
+{
+    rehash(SlotsFor(expectedRecords));
+}
+
+size_t
+Fs::Ufs::CompactIndex::Hash(const cache_key *key)
+{
+    // MD5 digests are uniformly distributed; any of their bits will do
+    uint64_t hash;
+    memcpy(&hash, key, sizeof(hash));
+    return static_cast<size_t>(hash);
+}
+
+size_t
+Fs::Ufs::CompactIndex::findSlot(const cache_key *key) const
+{
+    auto slot = Hash(key) & mask;
+    while (!slots[slot].empty() && memcmp(slots[slot].key, key, SQUID_MD5_DIGEST_LENGTH) != 0)
+        slot = (slot + 1) & mask;
+    return slot;
+}
+
+const Fs::Ufs::CompactIndex::Record *
+Fs::Ufs::CompactIndex::find(const cache_key *key) const
+{
+    return at(findSlot(key));
+}
+
+void
+Fs::Ufs::CompactIndex::add(const Record &record)
+{
+    assert(!record.empty());
+
+    if (count + 1 > capacity() / 5 * 4)
+        rehash(capacity() * 2);
+
+    const auto slot = findSlot(record.key);
+    assert(slots[slot].empty()); // the key is not indexed yet
+    slots[slot] = record;
+    ++count;
+}
+
+bool
+Fs::Ufs::CompactIndex::remove(const cache_key *key, Record *removed)
+{
+    const auto slot = findSlot(key);
+    if (slots[slot].empty())
+        return false;
+
+    if (removed)
+        *removed = slots[slot];
+    removeAt(slot);
+    return true;
+}
+
+void
+Fs::Ufs::CompactIndex::removeAt(const size_t slot)
+{
+    assert(!slots[slot].empty());
+
+    // Shift back later records of the same probe run so that no probe
+    // sequence crosses the hole. A record may fill the hole unless its home
+    // slot is in the cyclic (hole, record] range.
+    auto hole = slot;
+    for (auto next = (hole + 1) & mask; !slots[next].empty(); next = (next + 1) & mask) {
+        const auto home = Hash(slots[next].key) & mask;
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            slots[hole] = slots[next];
+            hole = next;
+        }
+    }
+    slots[hole] = Record();
+    --count;
+}
+
+void
+Fs::Ufs::CompactIndex::rehash(const size_t newCapacity)
+{
+    std::vector<Record> oldSlots(newCapacity);
+    oldSlots.swap(slots);
+    mask = newCapacity - 1;
+
+    for (const auto &record: oldSlots) {
+        if (!record.empty())
+            slots[findSlot(record.key)] = record;
+    }
+
+    debugs(47, 3, count << " records in " << capacity() << " slots");
+}
+
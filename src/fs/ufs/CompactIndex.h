@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#ifndef SQUID_SRC_FS_UFS_COMPACTINDEX_H
+#define SQUID_SRC_FS_UFS_COMPACTINDEX_H
+
+#include "md5.h"
+#include "store/forward.h"
+
+#include <cstdint>
+#include <vector>
+
+class StoreSwapLogData;
+
+namespace Fs
+{
+namespace Ufs
+{
+
+/// \ingroup UFS
+/// An open-addressing hash table of metadata of UFS cache_dir objects that
+/// have no StoreEntry yet. A record costs 48 bytes, a small fraction of a
+/// StoreEntry with its store_table slot, key copy, and replacement policy
+/// node. Uses linear probing with backward-shift deletion.
+class CompactIndex
+{
+public:
+    /// swap.state metadata of one indexed object
+    class Record
+    {
+    public:
+        Record() = default;
+        Record(const cache_key *, sfileno, uint64_t swap_file_sz, time_t expires, time_t timestamp, time_t lastref, time_t lastmod, uint16_t refcount, uint16_t flags);
+
+        /// copies metadata into a swapped out StoreEntry using our file
+        void exportTo(StoreEntry &, sdirno) const;
+        /// copies metadata into a swap.state record
+        void exportTo(StoreSwapLogData &) const;
+
+        bool empty() const { return swap_filen < 0; }
+        time_t lastref() const { return Unpack(lastref_); }
+
+        cache_key key[SQUID_MD5_DIGEST_LENGTH] = {};
+        uint64_t swap_file_sz = 0;
+
+    private:
+        /// stores a time_t in 32 bits, preserving small negative values
+        /// that mark unknown or special times
+        static uint32_t Pack(time_t);
+        static time_t Unpack(uint32_t);
+
+        uint32_t expires_ = 0;
+        uint32_t timestamp_ = 0;
+        uint32_t lastref_ = 0;
+        uint32_t lastmod_ = 0;
+
+    public:
+        sfileno swap_filen = -1; ///< negative for unused table slots
+        uint16_t refcount = 0;
+        uint16_t flags = 0;
+    };
+
+    /// creates an index able to hold the given number of records without
+    /// growing
+    explicit CompactIndex(size_t expectedRecords = 0);
+    CompactIndex(CompactIndex &&) = delete; // no copying of any kind
+
+    /// \returns the record with the given key or nil
+    const Record *find(const cache_key *) const;
+
+    /// adds a record with a key that is not indexed yet
+    void add(const Record &);
+
+    /// removes the record with the given key, copying it into the optional
+    /// `removed` parameter
+    /// \returns whether the record was found
+    bool remove(const cache_key *, Record *removed = nullptr);
+
+    /// removes the record in the given slot, possibly moving a record that
+    /// used to follow it into that slot
+    void removeAt(size_t slot);
+
+    /// the number of indexed records
+    size_t size() const { return count; }
+
+    /// the number of slots; slot positions are [0, capacity())
+    size_t capacity() const { return slots.size(); }
+
+    /// \returns the record in the given slot or nil for an unused slot
+    /// Slot positions change when the table grows.
+    const Record *at(const size_t slot) const { return slots[slot].empty() ? nullptr : &slots[slot]; }
+
+    /// the approximate number of bytes allocated for the table
+    size_t memoryUsed() const { return capacity() * sizeof(Record); }
+
+private:
+    static size_t Hash(const cache_key *);
+
+    /// the slot holding the given key or, if there is none, the empty slot
+    /// ending its probe sequence
+    size_t findSlot(const cache_key *) const;
+
+    /// rebuilds the table with the given power-of-two number of slots
+    void rehash(size_t newCapacity);
+
+    std::vector<Record> slots;
+    size_t mask = 0; ///< the number of slots minus one
+    size_t count = 0; ///< the number of used slots
+};
+
+} // namespace Ufs
+} // namespace Fs
+
+#endif /* SQUID_SRC_FS_UFS_COMPACTINDEX_H */
+
@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+/* DEBUG: section 47    Store Directory Routines */
+
+#include "squid.h"
+#include "RebuildReader.h"
+
+#if USE_UFS_REBUILD_THREADS
+
+#include "defines.h"
+#include "UFSSwapLogParser.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#if HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#if HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+/* Fs::Ufs::RebuildReader */
+
+void
+Fs::Ufs::RebuildReader::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopRequested = true;
+    }
+    changed.notify_all();
+
+    for (auto &worker: workers)
+        worker.join();
+    workers.clear();
+}
+
+void
+Fs::Ufs::RebuildReader::finished()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        assert(running > 0);
+        --running;
+    }
+    changed.notify_all();
+}
+
+bool
+Fs::Ufs::RebuildReader::stopping() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stopRequested;
+}
+
+/* Fs::Ufs::RebuildQueue */
+
+template <class Item>
+bool
+Fs::Ufs::RebuildQueue<Item>::ready() const
+{
+    if (currentPos < current.size())
+        return true;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    return !batches.empty() || !running;
+}
+
+template <class Item>
+bool
+Fs::Ufs::RebuildQueue<Item>::next(Item &item)
+{
+    if (currentPos >= current.size()) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [this] { return !batches.empty() || !running; });
+            if (batches.empty())
+                return false;
+            current = std::move(batches.front());
+            batches.pop_front();
+        }
+        changed.notify_all(); // a helper may be waiting for queue space
+        currentPos = 0;
+    }
+
+    item = std::move(current[currentPos++]);
+    return true;
+}
+
+template <class Item>
+bool
+Fs::Ufs::RebuildQueue<Item>::push(std::vector<Item> &batch)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this] { return stopRequested || batches.size() < MaxBatches; });
+        if (stopRequested)
+            return false;
+        batches.push_back(std::move(batch));
+    }
+    changed.notify_all();
+    batch.clear();
+    batch.reserve(BatchSize);
+    return true;
+}
+
+/* Fs::Ufs::SwapLogReader */
+
+Fs::Ufs::SwapLogReader::SwapLogReader(UFSSwapLogParser &aParser):
+    parser(aParser)
+{
+    start([this] { read(); });
+}
+
+Fs::Ufs::SwapLogReader::~SwapLogReader()
+{
+    stop();
+}
+
+/// helper thread code: reads swap.state until its end
+void
+Fs::Ufs::SwapLogReader::read()
+{
+    std::vector<StoreSwapLogData> batch;
+    batch.reserve(BatchSize);
+
+    StoreSwapLogData record;
+    while (parser.ReadRecord(record)) {
+        batch.push_back(record);
+        if (batch.size() == BatchSize && !push(batch))
+            return finished();
+    }
+
+    if (!batch.empty())
+        (void)push(batch);
+    finished();
+}
+
+/* Fs::Ufs::CacheDirWalker */
+
+Fs::Ufs::CacheDirWalker::CacheDirWalker(const char * const cacheDirPath, const int aL1, const int aL2):
+    root(cacheDirPath),
+    l1(aL1),
+    l2(aL2)
+{
+    // more threads rarely help: they compete for the same disk
+    const auto available = std::max(std::thread::hardware_concurrency(), 1U);
+    const auto threadCount = std::min<int>({static_cast<int>(available), 4, l1 * l2});
+    for (int i = 0; i < threadCount; ++i)
+        start([this, i, threadCount] { walk(i, threadCount); });
+}
+
+Fs::Ufs::CacheDirWalker::~CacheDirWalker()
+{
+    stop();
+}
+
+/// Whether the given file number maps to the given subdirectory.
+/// A thread-safe equivalent of UFSSwapDir::FilenoBelongsHere().
+bool
+Fs::Ufs::CacheDirWalker::belongsHere(const sfileno filen, const int d1, const int d2) const
+{
+    return ((filen / l2) / l2) % l1 == d1 && (filen / l2) % l2 == d2;
+}
+
+/// helper thread code: reads cache files in every subdirStep-th subdirectory
+void
+Fs::Ufs::CacheDirWalker::walk(const int firstSubdir, const int subdirStep)
+{
+    std::vector<CacheFile> batch;
+    batch.reserve(BatchSize);
+
+    const auto flush = [this, &batch] {
+        return batch.size() < BatchSize || push(batch);
+    };
+
+    char path[MAXPATHLEN];
+    for (auto subdir = firstSubdir; subdir < l1 * l2; subdir += subdirStep) {
+        if (stopping())
+            return finished();
+
+        const auto d1 = subdir / l2;
+        const auto d2 = subdir % l2;
+        snprintf(path, sizeof(path), "%s/%02X/%02X", root.c_str(), d1, d2);
+        const auto dir = opendir(path);
+        if (!dir) {
+            CacheFile failure;
+            failure.failedCall = "opendir";
+            failure.xerrno = errno;
+            failure.path = path;
+            batch.push_back(std::move(failure));
+            if (!flush())
+                return finished();
+            continue;
+        }
+
+        while (const dirent_t *entry = readdir(dir)) {
+            unsigned int filen = 0;
+            if (sscanf(entry->d_name, "%x", &filen) != 1)
+                continue; // including "." and ".."
+
+            if (!belongsHere(filen, d1, d2))
+                continue;
+
+            const auto pathLength = snprintf(path, sizeof(path), "%s/%02X/%02X/%s", root.c_str(), d1, d2, entry->d_name);
+            if (pathLength < 0 || static_cast<size_t>(pathLength) >= sizeof(path))
+                continue; // not a file name we could have created
+
+            CacheFile file;
+            file.filen = filen;
+            const auto fd = open(path, O_RDONLY | O_BINARY);
+            struct stat sb;
+            if (fd < 0) {
+                file.failedCall = "open";
+            } else if (fstat(fd, &sb) < 0) {
+                file.failedCall = "fstat";
+            } else {
+                file.size = sb.st_size > 0 ? static_cast<uint64_t>(sb.st_size) : 0;
+                file.prefix.resize(SM_PAGE_SIZE);
+                const auto len = ::read(fd, &file.prefix[0], file.prefix.size());
+                if (len < 0)
+                    file.failedCall = "read";
+                file.prefix.resize(len < 0 ? 0 : len);
+            }
+
+            if (file.failedCall) {
+                file.xerrno = errno;
+                file.path = path;
+            }
+
+            if (fd >= 0)
+                close(fd);
+
+            batch.push_back(std::move(file));
+            if (!flush()) {
+                closedir(dir);
+                return finished();
+            }
+        }
+
+        closedir(dir);
+    }
+
+    if (!batch.empty())
+        (void)push(batch);
+    finished();
+}
+
+template class Fs::Ufs::RebuildQueue<StoreSwapLogData>;
+template class Fs::Ufs::RebuildQueue<Fs::Ufs::CacheFile>;
+
+#endif /* USE_UFS_REBUILD_THREADS */
+
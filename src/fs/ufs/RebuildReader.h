@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#ifndef SQUID_SRC_FS_UFS_REBUILDREADER_H
+#define SQUID_SRC_FS_UFS_REBUILDREADER_H
+
+// Helper threads need the POSIX threads library. Squid links with it when
+// building the DiskThreads module (except on Windows, which uses native
+// threads there).
+#if HAVE_DISKIO_MODULE_DISKTHREADS && !_SQUID_WINDOWS_
+#define USE_UFS_REBUILD_THREADS 1
+#else
+#define USE_UFS_REBUILD_THREADS 0
+#endif
+
+#if USE_UFS_REBUILD_THREADS
+
+#include "StoreSwapLogData.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Fs
+{
+namespace Ufs
+{
+
+class UFSSwapLogParser;
+
+/// \ingroup UFS
+/// Reads cache_dir index sources on helper threads, queuing batches of
+/// results for the main thread to index. Helper threads must not use Squid
+/// globals: debugging, memory pools, and the descriptor table are not
+/// thread-safe.
+///
+/// Consequently, descriptors opened by helper threads are not counted in
+/// fd_table or Number_FD. Each helper thread has at most one directory and
+/// one cache file open at a time, so they use a few of the RESERVED_FD
+/// descriptors that Squid keeps spare.
+class RebuildReader
+{
+public:
+    RebuildReader() = default;
+    RebuildReader(RebuildReader &&) = delete; // no copying of any kind
+    virtual ~RebuildReader() = default;
+
+    /// whether the next item can be obtained without waiting for helper threads
+    virtual bool ready() const = 0;
+
+    /// the number of helper threads started
+    size_t threads() const { return workers.size(); }
+
+protected:
+    /// the maximum number of items in one batch
+    static const size_t BatchSize = 256;
+    /// the maximum number of queued batches; limits memory usage when the
+    /// main thread is slower than helper threads
+    static const size_t MaxBatches = 64;
+
+    /// starts a helper thread
+    template <class Function>
+    void start(Function &&work) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++running;
+        workers.emplace_back(std::forward<Function>(work));
+    }
+
+    /// tells helper threads to quit and waits for them; must be called by
+    /// kid destructors before destroying anything that helper threads use
+    void stop();
+
+    /// called by a helper thread when it has no more items to produce
+    void finished();
+
+    /// whether stop() was called; helper threads should quit ASAP
+    bool stopping() const;
+
+    mutable std::mutex mutex; ///< protects all members below
+    std::condition_variable changed; ///< signals any change of members below
+    size_t running = 0; ///< the number of helper threads that have not finished
+    bool stopRequested = false; ///< whether stop() was called
+
+private:
+    std::vector<std::thread> workers;
+};
+
+/// RebuildReader that delivers items of the given type in batches
+template <class Item>
+class RebuildQueue: public RebuildReader
+{
+public:
+    /* RebuildReader API */
+    bool ready() const override;
+
+    /// moves the next item into the given one, waiting for helper threads
+    /// as needed
+    /// \returns false when there are no more items
+    bool next(Item &);
+
+protected:
+    /// queues the given batch for the main thread, waiting for queue space
+    /// \returns false if the helper thread should quit instead
+    bool push(std::vector<Item> &);
+
+private:
+    std::deque< std::vector<Item> > batches; ///< batches queued by helpers
+
+    // used by the main thread only
+    std::vector<Item> current; ///< the batch being delivered by next()
+    size_t currentPos = 0; ///< the next item in the current batch
+};
+
+/// reads swap.state records on a helper thread
+class SwapLogReader: public RebuildQueue<StoreSwapLogData>
+{
+public:
+    /// starts reading with the given parser; the parser must outlive us
+    explicit SwapLogReader(UFSSwapLogParser &);
+    ~SwapLogReader() override;
+
+private:
+    void read();
+
+    UFSSwapLogParser &parser;
+};
+
+/// the beginning of a cache file found by CacheDirWalker
+class CacheFile
+{
+public:
+    sfileno filen = -1; ///< negative for directory-level failures
+    uint64_t size = 0; ///< the file size reported by fstat(2)
+    std::string prefix; ///< up to SM_PAGE_SIZE leading file bytes
+
+    const char *failedCall = nullptr; ///< the failed system call (or nil)
+    int xerrno = 0; ///< errno set by the failedCall
+    std::string path; ///< the file or directory that failedCall was given
+};
+
+/// reads beginnings of cache files in UFS cache_dir subdirectories,
+/// splitting subdirectories among several helper threads
+class CacheDirWalker: public RebuildQueue<CacheFile>
+{
+public:
+    CacheDirWalker(const char *cacheDirPath, int l1, int l2);
+    ~CacheDirWalker() override;
+
+private:
+    void walk(int firstSubdir, int subdirStep);
+    bool belongsHere(sfileno, int d1, int d2) const;
+
+    const std::string root; ///< cache_dir path
+    const int l1; ///< the number of first-level subdirectories
+    const int l2; ///< the number of second-level subdirectories
+};
+
+} // namespace Ufs
+} // namespace Fs
+
+#endif /* USE_UFS_REBUILD_THREADS */
+
+#endif /* SQUID_SRC_FS_UFS_REBUILDREADER_H */
+
@@ -14,6 +14,8 @@
 #include "globals.h"
 #include "RebuildState.h"
 #include "SquidConfig.h"
+#include "SquidMath.h"
+#include "StatCounters.h"
 #include "store/Disks.h"
 #include "store_key_md5.h"
 #include "store_rebuild.h"
@@ -42,6 +44,11 @@ Fs::Ufs::RebuildState::RebuildState(const RefCount<UFSSwapDir> &aSwapDir) :
     td(nullptr),
     fromLog(true),
     _done(false),
+    totalEntries(-1),
+#if USE_UFS_REBUILD_THREADS
+    logReader(nullptr),
+    dirWalker(nullptr),
+#endif
     cbdata(nullptr)
 {
 
@@ -72,7 +79,19 @@ Fs::Ufs::RebuildState::RebuildState(const RefCount<UFSSwapDir> &aSwapDir) :
     if (!clean)
         flags.need_to_validate = true;
 
+    // count records before a helper thread starts moving the file position
+    if (LogParser)
+        totalEntries = LogParser->SwapLogEntries();
+
+#if USE_UFS_REBUILD_THREADS
+    if (LogParser)
+        logReader = new SwapLogReader(*LogParser);
+    else
+        dirWalker = new CacheDirWalker(sd->path, sd->l1, sd->l2);
+#endif
+
     counts.updateStartTime(current_time);
+    sd->rebuildState = this;
 
     debugs(47, DBG_IMPORTANT, "Rebuilding storage in " << sd->path << " (" <<
            (clean ? "clean log" : (LogParser ? "dirty log" : "no log")) << ")");
@@ -80,6 +99,15 @@ Fs::Ufs::RebuildState::RebuildState(const RefCount<UFSSwapDir> &aSwapDir) :
 
 Fs::Ufs::RebuildState::~RebuildState()
 {
+    if (sd->rebuildState == this)
+        sd->rebuildState = nullptr;
+
+#if USE_UFS_REBUILD_THREADS
+    // stop helper threads before closing files they may be reading
+    delete logReader;
+    delete dirWalker;
+#endif
+
     sd->closeTmpSwapLog();
 
     if (LogParser)
@@ -112,9 +140,11 @@ Fs::Ufs::RebuildState::rebuildStep()
     const int maxSpentMsec = 50; // keep small: most RAM I/Os are under 1ms
     const timeval loopStart = current_time;
 
-    const int totalEntries = LogParser ? LogParser->SwapLogEntries() : -1;
-
     while (!isDone()) {
+        // do not block the main loop while helper threads are reading
+        if (!opt_foreground_rebuild && !readerReady())
+            break;
+
         if (fromLog)
             rebuildFromSwapLog();
         else
@@ -143,54 +173,19 @@ Fs::Ufs::RebuildState::rebuildFromDirectory()
 {
     cache_key key[SQUID_MD5_DIGEST_LENGTH];
 
-    struct stat sb;
-    int fd = -1;
     debugs(47, 3, "DIR #" << sd->index);
 
-    assert(fd == -1);
     sfileno filn = 0;
-    int size;
-    fd = getNextFile(&filn, &size);
-
-    if (fd == -2) {
-        debugs(47, DBG_IMPORTANT, "Done scanning " << sd->path << " dir (" <<
-               n_read << " entries)");
-        _done = true;
-        return;
-    } else if (fd < 0) {
-        return;
-    }
-
-    assert(fd > -1);
-    /* lets get file stats here */
-
-    ++n_read;
-
-    if (fstat(fd, &sb) < 0) {
-        int xerrno = errno;
-        debugs(47, DBG_IMPORTANT, MYNAME << "fstat(FD " << fd << "): " << xstrerr(xerrno));
-        file_close(fd);
-        --store_open_disk_fd;
-        fd = -1;
-        return;
-    }
-
+    uint64_t expectedSize = 0;
     MemBuf buf;
     buf.init(SM_PAGE_SIZE, SM_PAGE_SIZE);
-    if (!storeRebuildLoadEntry(fd, sd->index, buf, counts))
+    if (!loadNextFile(filn, buf, expectedSize))
         return;
 
-    const uint64_t expectedSize = sb.st_size > 0 ?
-                                  static_cast<uint64_t>(sb.st_size) : 0;
-
     StoreEntry tmpe;
     const bool parsed = storeRebuildParseEntry(buf, tmpe, key, counts,
                         expectedSize);
 
-    file_close(fd);
-    --store_open_disk_fd;
-    fd = -1;
-
     bool accepted = parsed && tmpe.swap_file_sz > 0;
     if (parsed && !accepted) {
         debugs(47, DBG_IMPORTANT, "WARNING: Ignoring ufs cache entry with " <<
@@ -215,6 +210,78 @@ Fs::Ufs::RebuildState::rebuildFromDirectory()
                tmpe.flags);
 }
 
+/// Loads the beginning of the next cache file into the given buffer.
+/// \returns false if there is no file to parse (yet)
+bool
+Fs::Ufs::RebuildState::loadNextFile(sfileno &filn, MemBuf &buf, uint64_t &expectedSize)
+{
+#if USE_UFS_REBUILD_THREADS
+    if (dirWalker) {
+        CacheFile file;
+        if (!dirWalker->next(file)) {
+            debugs(47, DBG_IMPORTANT, "Done scanning " << sd->path << " dir (" <<
+                   n_read << " entries)");
+            delete dirWalker;
+            dirWalker = nullptr;
+            _done = true;
+            return false;
+        }
+
+        if (file.failedCall) {
+            debugs(47, DBG_IMPORTANT, "ERROR: " << MYNAME << file.failedCall << "(" << file.path << "): " << xstrerr(file.xerrno));
+            return false;
+        }
+
+        // the helper thread could not know about files added since
+        if (sd->mapBitTest(file.filen)) {
+            debugs(47, 3, "Locked, continuing with next.");
+            return false;
+        }
+
+        ++n_read;
+        ++statCounter.syscalls.disk.reads;
+        filn = file.filen;
+        expectedSize = file.size;
+        buf.append(file.prefix.data(), file.prefix.size());
+        return true;
+    }
+#endif
+
+    struct stat sb;
+    int size;
+    const auto fd = getNextFile(&filn, &size);
+
+    if (fd == -2) {
+        debugs(47, DBG_IMPORTANT, "Done scanning " << sd->path << " dir (" <<
+               n_read << " entries)");
+        _done = true;
+        return false;
+    } else if (fd < 0) {
+        return false;
+    }
+
+    /* lets get file stats here */
+
+    ++n_read;
+
+    if (fstat(fd, &sb) < 0) {
+        int xerrno = errno;
+        debugs(47, DBG_IMPORTANT, MYNAME << "fstat(FD " << fd << "): " << xstrerr(xerrno));
+        file_close(fd);
+        --store_open_disk_fd;
+        return false;
+    }
+
+    if (!storeRebuildLoadEntry(fd, sd->index, buf, counts))
+        return false;
+
+    expectedSize = sb.st_size > 0 ? static_cast<uint64_t>(sb.st_size) : 0;
+
+    file_close(fd);
+    --store_open_disk_fd;
+    return true;
+}
+
 /// if the loaded entry metadata is still relevant, indexes the entry
 void
 Fs::Ufs::RebuildState::addIfFresh(const cache_key *key,
@@ -231,6 +298,20 @@ Fs::Ufs::RebuildState::addIfFresh(const cache_key *key,
         return;
 
     ++counts.objcount;
+
+    if (sd->compactIndexing()) {
+        sd->addCompactRestore(CompactIndex::Record(key,
+                              file_number,
+                              swap_file_sz,
+                              expires,
+                              timestamp,
+                              lastref,
+                              lastmod,
+                              refcount,
+                              newFlags));
+        return;
+    }
+
     const auto addedEntry = sd->addDiskRestore(key,
                             file_number,
                             swap_file_sz,
@@ -250,6 +331,22 @@ Fs::Ufs::RebuildState::addIfFresh(const cache_key *key,
 bool
 Fs::Ufs::RebuildState::evictStaleAndContinue(const cache_key *candidateKey, const time_t maxRef, int &staleCount)
 {
+    // check compact indexes first: peek() would create a StoreEntry
+    for (size_t i = 0; i < Config.cacheSwap.n_configured; ++i) {
+        const auto dir = dynamic_cast<UFSSwapDir *>(INDEXSD(i));
+        const auto record = dir ? dir->findCompact(candidateKey) : nullptr;
+        if (!record)
+            continue;
+
+        if (record->lastref() >= maxRef) {
+            ++counts.clashcount;
+            return false;
+        }
+
+        ++staleCount;
+        dir->evictCompact(candidateKey);
+    }
+
     if (auto *indexedEntry = Store::Root().peek(candidateKey)) {
 
         if (indexedEntry->lastref >= maxRef) {
@@ -271,8 +368,12 @@ Fs::Ufs::RebuildState::rebuildFromSwapLog()
 {
     StoreSwapLogData swapData;
 
-    if (LogParser->ReadRecord(swapData) != 1) {
+    if (!readSwapLogRecord(swapData)) {
         debugs(47, DBG_IMPORTANT, "Done reading " << sd->path << " swaplog (" << n_read << " entries)");
+#if USE_UFS_REBUILD_THREADS
+        delete logReader; // before closing the file it reads
+        logReader = nullptr;
+#endif
         LogParser->Close();
         delete LogParser;
         LogParser = nullptr;
@@ -350,6 +451,30 @@ Fs::Ufs::RebuildState::rebuildFromSwapLog()
                swapData.flags);
 }
 
+/// reads the next swap.state record, possibly queued by a helper thread
+bool
+Fs::Ufs::RebuildState::readSwapLogRecord(StoreSwapLogData &swapData)
+{
+#if USE_UFS_REBUILD_THREADS
+    if (logReader)
+        return logReader->next(swapData);
+#endif
+    return LogParser->ReadRecord(swapData);
+}
+
+/// whether the next rebuildFrom*() call would not wait for helper threads
+bool
+Fs::Ufs::RebuildState::readerReady() const
+{
+#if USE_UFS_REBUILD_THREADS
+    if (logReader)
+        return logReader->ready();
+    if (dirWalker)
+        return dirWalker->ready();
+#endif
+    return true;
+}
+
 int
 Fs::Ufs::RebuildState::getNextFile(sfileno * filn_p, int *)
 {
@@ -472,3 +597,29 @@ Fs::Ufs::RebuildState::isDone() const
     return _done;
 }
 
+void
+Fs::Ufs::RebuildState::reportProgress(StoreEntry &sentry) const
+{
+    storeAppendPrintf(&sentry, "Rebuilding from: %s\n", fromLog ? "swap.state" : "cache files");
+    if (totalEntries > 0)
+        storeAppendPrintf(&sentry, "Rebuild progress: %d of %d entries (%d%%)\n",
+                          n_read, totalEntries, Math::intPercent(n_read, totalEntries));
+    else
+        storeAppendPrintf(&sentry, "Rebuild progress: %d entries\n", n_read);
+
+    const auto elapsedSec = tvSubDsec(counts.startTime, current_time);
+    storeAppendPrintf(&sentry, "Rebuild time: %.2f seconds, %.0f entries/sec\n",
+                      elapsedSec, elapsedSec > 0 ? n_read / elapsedSec : 0.0);
+
+    size_t threads = 0;
+#if USE_UFS_REBUILD_THREADS
+    if (logReader)
+        threads = logReader->threads();
+    else if (dirWalker)
+        threads = dirWalker->threads();
+#endif
+    storeAppendPrintf(&sentry, "Rebuild reader threads: %zu\n", threads);
+
+    storeAppendPrintf(&sentry, "Rebuild counts: %d objects, %d invalid, %d clashes, %d duplicates\n",
+                      counts.objcount, counts.invalid, counts.clashcount, counts.dupcount);
+}
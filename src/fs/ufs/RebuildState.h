@@ -10,6 +10,7 @@
 #define SQUID_SRC_FS_UFS_REBUILDSTATE_H
 
 #include "base/RefCount.h"
+#include "RebuildReader.h"
 #include "store_rebuild.h"
 #include "UFSSwapDir.h"
 #include "UFSSwapLogParser.h"
@@ -34,6 +35,9 @@ public:
     virtual bool error() const;
     virtual bool isDone() const;
 
+    /// reports rebuild progress and speed on the cache manager storedir page
+    void reportProgress(StoreEntry &) const;
+
     RefCount<UFSSwapDir> sd;
     int n_read;
     /*    FILE *log;*/
@@ -59,6 +63,9 @@ public:
     StoreRebuildData counts;
 
 private:
+    bool readerReady() const;
+    bool readSwapLogRecord(StoreSwapLogData &);
+    bool loadNextFile(sfileno &, MemBuf &, uint64_t &expectedSize);
     void rebuildFromDirectory();
     void rebuildFromSwapLog();
     void rebuildStep();
@@ -75,6 +82,11 @@ private:
     int getNextFile(sfileno *, int *size);
     bool fromLog;
     bool _done;
+    int totalEntries; ///< the number of swap.state records (or -1)
+#if USE_UFS_REBUILD_THREADS
+    SwapLogReader *logReader; ///< reads swap.state on a helper thread (or nil)
+    CacheDirWalker *dirWalker; ///< reads cache files on helper threads (or nil)
+#endif
     // TODO: (callback) should be hidden behind a proper human readable name
     void (callback)(void *cbdata);
     void *cbdata;
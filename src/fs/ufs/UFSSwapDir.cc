@@ -45,6 +45,7 @@ class UFSCleanLog : public SwapDir::CleanLog
 
 public:
     UFSCleanLog(SwapDir *aSwapDir) : sd(aSwapDir) {}
+    ~UFSCleanLog() override { compactEntry.key = nullptr; }
 
     /// Get the next entry that is a candidate for clean log writing
     const StoreEntry *nextEntry() override;
@@ -60,6 +61,11 @@ public:
     int fd = -1;
     RemovalPolicyWalker *walker = nullptr;
     SwapDir *sd = nullptr;
+
+    /// compactly indexed objects to write after the walker ones (or nil)
+    const Fs::Ufs::CompactIndex *compactIndex = nullptr;
+    size_t compactSlot = 0; ///< the next compactIndex slot to write
+    StoreEntry compactEntry; ///< the last written compactIndex record
 };
 
 const StoreEntry *
@@ -70,6 +76,16 @@ UFSCleanLog::nextEntry()
     if (walker)
         entry = walker->Next(walker);
 
+    if (!entry && compactIndex) {
+        while (compactSlot < compactIndex->capacity()) {
+            if (const auto record = compactIndex->at(compactSlot++)) {
+                record->exportTo(compactEntry, sd->index);
+                compactEntry.key = const_cast<cache_key *>(record->key);
+                return &compactEntry;
+            }
+        }
+    }
+
     return entry;
 }
 
@@ -201,7 +217,7 @@ Fs::Ufs::UFSSwapDir::changeIO(DiskIOModule *module)
     IO->io = anIO;
     /* Change the IO Options */
 
-    if (currentIOOptions && currentIOOptions->options.size() > 2) {
+    if (currentIOOptions && currentIOOptions->options.size() > 3) {
         delete currentIOOptions->options.back();
         currentIOOptions->options.pop_back();
     }
@@ -246,6 +262,32 @@ Fs::Ufs::UFSSwapDir::optionIODump(StoreEntry * e) const
     storeAppendPrintf(e, " IOEngine=%s", ioType);
 }
 
+bool
+Fs::Ufs::UFSSwapDir::optionCompactParse(char const *option, const char *value, int isaReconfig)
+{
+    if (strcmp(option, "compact-index") != 0)
+        return false;
+
+    const auto enabled = value ? (xatoi(value) != 0) : true;
+
+    if (!isaReconfig)
+        compactIndexing_ = enabled;
+    else if (compactIndexing_ != enabled) {
+        debugs(3, DBG_IMPORTANT, "WARNING: cache_dir " << path << ' ' << option
+               << " cannot be changed dynamically, value left unchanged: " <<
+               (compactIndexing_ ? "on" : "off"));
+    }
+
+    return true;
+}
+
+void
+Fs::Ufs::UFSSwapDir::optionCompactDump(StoreEntry * e) const
+{
+    if (compactIndexing_)
+        storeAppendPrintf(e, " compact-index");
+}
+
 ConfigOption *
 Fs::Ufs::UFSSwapDir::getOptionTree() const
 {
@@ -256,6 +298,8 @@ Fs::Ufs::UFSSwapDir::getOptionTree() const
 
     currentIOOptions->options.push_back(parentResult);
 
+    currentIOOptions->options.push_back(new ConfigOptionAdapter<UFSSwapDir>(*const_cast<UFSSwapDir *>(this), &UFSSwapDir::optionCompactParse, &UFSSwapDir::optionCompactDump));
+
     currentIOOptions->options.push_back(new ConfigOptionAdapter<UFSSwapDir>(*const_cast<UFSSwapDir *>(this), &UFSSwapDir::optionIOParse, &UFSSwapDir::optionIODump));
 
     if (ConfigOption *ioOptions = IO->io->getOptionTree())
@@ -284,6 +328,11 @@ Fs::Ufs::UFSSwapDir::init()
     if (verifyCacheDirs())
         fatal(errmsg);
 
+    if (compactIndexing_ && !compactIndex) {
+        // grows while loading, so an empty cache_dir costs little memory
+        compactIndex = new CompactIndex();
+    }
+
     openLog();
 
     rebuild();
@@ -317,7 +366,11 @@ Fs::Ufs::UFSSwapDir::UFSSwapDir(char const *aType, const char *anIOType) :
     ioType(xstrdup(anIOType)),
     cur_size(0),
     n_disk_objects(0),
-    rebuilding_(false)
+    rebuilding_(false),
+    rebuildState(nullptr),
+    compactIndexing_(false),
+    compactIndex(nullptr),
+    compactPurgeSlot(0)
 {
     /* modulename is only set to disk modules that are built, by configure,
      * so the Find call should never return NULL here.
@@ -335,6 +388,7 @@ Fs::Ufs::UFSSwapDir::~UFSSwapDir()
     delete map;
     delete IO;
     delete currentIOOptions;
+    delete compactIndex;
 }
 
 void
@@ -384,6 +438,12 @@ Fs::Ufs::UFSSwapDir::statfs(StoreEntry & sentry) const
     storeAppendPrintf(&sentry, "Filemap bits in use: %d of %d (%d%%)\n",
                       map->numFilesInMap(), map->capacity(),
                       Math::intPercent(map->numFilesInMap(), map->capacity()));
+    if (compactIndex) {
+        storeAppendPrintf(&sentry, "Compact index: %zu objects in %.2f KB\n",
+                          compactIndex->size(), compactIndex->memoryUsed() / 1024.0);
+    }
+    if (rebuildState)
+        rebuildState->reportProgress(sentry);
     x = fsStats(path, &totl_kb, &free_kb, &totl_in, &free_in);
 
     if (0 == x) {
@@ -489,7 +549,7 @@ Fs::Ufs::UFSSwapDir::maintain()
 
     RemovalPurgeWalker *walker = repl->PurgeInit(repl, max_scan);
 
-    int removed = 0;
+    int removed = purgeCompact(lowWaterSz, max_remove);
     // only purge while above low-water
     while (currentSize() >= lowWaterSz) {
 
@@ -520,6 +580,31 @@ Fs::Ufs::UFSSwapDir::maintain()
     // Store::Maintain() schedules another purge in 1 second.
 }
 
+/// Evicts compactly indexed objects before those with a StoreEntry: Nobody
+/// has requested them since the cache_dir was loaded. Index slots are not
+/// ordered, so each call resumes the scan where the previous one stopped.
+/// \returns the number of evicted objects
+int
+Fs::Ufs::UFSSwapDir::purgeCompact(const uint64_t lowWaterSz, const int maxRemove)
+{
+    if (!compactIndex)
+        return 0;
+
+    int removed = 0;
+    while (compactIndex->size() && removed < maxRemove && currentSize() >= lowWaterSz) {
+        compactPurgeSlot %= compactIndex->capacity();
+        if (const auto record = compactIndex->at(compactPurgeSlot)) {
+            const auto victim = *record;
+            compactIndex->removeAt(compactPurgeSlot); // may move another record here
+            forgetCompact(victim);
+            ++removed;
+        } else {
+            ++compactPurgeSlot;
+        }
+    }
+    return removed;
+}
+
 void
 Fs::Ufs::UFSSwapDir::reference(StoreEntry &e)
 {
@@ -821,6 +906,85 @@ Fs::Ufs::UFSSwapDir::addDiskRestore(const cache_key * key,
     return e;
 }
 
+void
+Fs::Ufs::UFSSwapDir::addCompactRestore(const CompactIndex::Record &record)
+{
+    debugs(47, 5, storeKeyText(record.key) << ", fileno=" << asHex(record.swap_filen).upperCase().minDigits(8));
+    assert(compactIndex);
+    compactIndex->add(record);
+    mapBitSet(record.swap_filen);
+    cur_size += fs.blksize * sizeInBlocks(record.swap_file_sz);
+    ++n_disk_objects;
+
+    StoreSwapLogData s;
+    s.op = SWAP_LOG_ADD;
+    record.exportTo(s);
+    logRecord(s);
+}
+
+StoreEntry *
+Fs::Ufs::UFSSwapDir::get(const cache_key *key)
+{
+    CompactIndex::Record record;
+    if (!compactIndex || !compactIndex->remove(key, &record))
+        return nullptr; // other objects are indexed in the global store_table
+
+    // the new entry inherits the file, its filemap bit, and its accounting
+    const auto e = new StoreEntry();
+    record.exportTo(*e, index);
+    // storeCleanup() validates entries created before the rebuild ends
+    if (StoreController::store_dirs_rebuilding)
+        EBIT_CLR(e->flags, ENTRY_VALIDATED);
+    else
+        EBIT_SET(e->flags, ENTRY_VALIDATED);
+    replacementAdd(e);
+    debugs(47, 5, "loaded " << *e << " from the compact index");
+    return e;
+}
+
+const Fs::Ufs::CompactIndex::Record *
+Fs::Ufs::UFSSwapDir::findCompact(const cache_key *key) const
+{
+    return compactIndex ? compactIndex->find(key) : nullptr;
+}
+
+void
+Fs::Ufs::UFSSwapDir::evictCompact(const cache_key *key)
+{
+    CompactIndex::Record record;
+    if (compactIndex && compactIndex->remove(key, &record))
+        forgetCompact(record);
+}
+
+void
+Fs::Ufs::UFSSwapDir::EvictCompactCopies(const StoreEntry &e)
+{
+    for (size_t i = 0; i < Config.cacheSwap.n_configured; ++i) {
+        if (const auto dir = dynamic_cast<UFSSwapDir *>(INDEXSD(i)))
+            dir->evictCompact(static_cast<const cache_key *>(e.key));
+    }
+}
+
+/// Updates accounting and swap.state after removing a compactly indexed
+/// object. Leaves the file alone while the cache_dir is rebuilding because
+/// swap.state entries loaded later may still claim its file number; the
+/// storeDirClean event removes files that stay unclaimed.
+void
+Fs::Ufs::UFSSwapDir::forgetCompact(const CompactIndex::Record &record)
+{
+    debugs(47, 5, storeKeyText(record.key) << ", fileno=" << asHex(record.swap_filen).upperCase().minDigits(8));
+    cur_size -= fs.blksize * sizeInBlocks(record.swap_file_sz);
+    --n_disk_objects;
+    mapBitReset(record.swap_filen);
+    if (!StoreController::store_dirs_rebuilding)
+        unlinkFile(record.swap_filen);
+
+    StoreSwapLogData s;
+    s.op = SWAP_LOG_DEL;
+    record.exportTo(s);
+    logRecord(s);
+}
+
 void
 Fs::Ufs::UFSSwapDir::rebuild()
 {
@@ -959,6 +1123,7 @@ Fs::Ufs::UFSSwapDir::writeCleanStart()
     state->outbuf_offset += header.record_size;
 
     state->walker = repl->WalkInit(repl);
+    state->compactIndex = compactIndex;
     ::unlink(state->cln.c_str());
     debugs(47, 3, "opened " << state->newLog << ", FD " << state->fd);
 #if HAVE_FCHMOD
@@ -1197,10 +1362,11 @@ Fs::Ufs::UFSSwapDir::evictCached(StoreEntry & e)
 }
 
 void
-Fs::Ufs::UFSSwapDir::evictIfFound(const cache_key *)
+Fs::Ufs::UFSSwapDir::evictIfFound(const cache_key *key)
 {
-    // UFS disk entries always have (attached) StoreEntries so if we got here,
-    // the entry is not cached on disk and there is nothing for us to do.
+    // Other UFS disk entries always have (attached) StoreEntries so if we got
+    // here, they are not cached on disk and there is nothing for us to do.
+    evictCompact(key);
 }
 
 void
@@ -1281,23 +1447,35 @@ Fs::Ufs::UFSSwapDir::finalizeSwapoutFailure(StoreEntry &entry)
 
 void
 Fs::Ufs::UFSSwapDir::logEntry(const StoreEntry & e, int op) const
+{
+    // the logged entry supersedes any compactly indexed object with its key
+    if (op == SWAP_LOG_ADD)
+        EvictCompactCopies(e);
+
+    StoreSwapLogData s;
+    s.op = (char) op;
+    s.swap_filen = e.swap_filen;
+    s.timestamp = e.timestamp;
+    s.lastref = e.lastref;
+    s.expires = e.expires;
+    s.lastmod = e.lastModified();
+    s.swap_file_sz = e.swap_file_sz;
+    s.refcount = e.refcount;
+    s.flags = e.flags;
+    memcpy(s.key, e.key, SQUID_MD5_DIGEST_LENGTH);
+    logRecord(s);
+}
+
+/// appends a copy of the given record to swap.state
+void
+Fs::Ufs::UFSSwapDir::logRecord(const StoreSwapLogData &record) const
 {
     if (swaplog_fd < 0) {
-        debugs(36, 5, "cannot log " << e << " in the middle of reconfiguration");
+        debugs(36, 5, "cannot log " << storeKeyText(record.key) << " in the middle of reconfiguration");
         return;
     }
 
-    StoreSwapLogData *s = new StoreSwapLogData;
-    s->op = (char) op;
-    s->swap_filen = e.swap_filen;
-    s->timestamp = e.timestamp;
-    s->lastref = e.lastref;
-    s->expires = e.expires;
-    s->lastmod = e.lastModified();
-    s->swap_file_sz = e.swap_file_sz;
-    s->refcount = e.refcount;
-    s->flags = e.flags;
-    memcpy(s->key, e.key, SQUID_MD5_DIGEST_LENGTH);
+    StoreSwapLogData *s = new StoreSwapLogData(record);
     s->finalize();
     file_write(swaplog_fd,
                -1,
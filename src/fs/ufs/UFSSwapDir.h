@@ -9,6 +9,7 @@
 #ifndef SQUID_SRC_FS_UFS_UFSSWAPDIR_H
 #define SQUID_SRC_FS_UFS_UFSSWAPDIR_H
 
+#include "CompactIndex.h"
 #include "SquidString.h"
 #include "Store.h"
 #include "store/Disk.h"
@@ -21,14 +22,20 @@ class HttpRequest;
 class ConfigOptionVector;
 class FileMap;
 class DiskIOModule;
+class StoreSwapLogData;
 
 namespace Fs
 {
 namespace Ufs
 {
+
+class RebuildState;
+
 /// \ingroup UFS
 class UFSSwapDir : public SwapDir
 {
+    friend class RebuildState; // for rebuildState and subdirectory counts
+
 public:
     static bool IsUFSDir(SwapDir* sd);
     static int DirClean(int swap_index);
@@ -44,6 +51,11 @@ public:
     ~UFSSwapDir() override;
 
     /* Store::Disk API */
+    /// Moves a compactly indexed object into a new StoreEntry. Like rock
+    /// entries, the returned entry is not in store_table: find() indexes it,
+    /// but peek() callers must index or release() it. Otherwise, the object
+    /// stays on disk without any index until the next rebuild.
+    StoreEntry *get(const cache_key *) override;
     void create() override;
     void init() override;
     void dump(StoreEntry &) const override;
@@ -103,6 +115,17 @@ public:
                                uint32_t refcount,
                                uint16_t flags,
                                int clean);
+    /// Like addDiskRestore() but keeps the object metadata in the compact
+    /// index instead of creating a StoreEntry. Logs the addition.
+    void addCompactRestore(const CompactIndex::Record &);
+    /// whether the cache_dir keeps rebuilt objects in the compact index
+    bool compactIndexing() const { return compactIndexing_; }
+    /// \returns the compactly indexed record with the given key or nil
+    const CompactIndex::Record *findCompact(const cache_key *) const;
+    /// removes the compactly indexed object with the given key (if any)
+    void evictCompact(const cache_key *);
+    /// evicts compactly indexed copies of the given entry in all cache_dirs
+    static void EvictCompactCopies(const StoreEntry &);
     int validFileno(sfileno filn, int flag) const;
     int mapBitAllocate();
 
@@ -144,11 +167,21 @@ private:
     void changeIO(DiskIOModule *);
     bool optionIOParse(char const *option, const char *value, int reconfiguring);
     void optionIODump(StoreEntry * e) const;
+    bool optionCompactParse(char const *option, const char *value, int reconfiguring);
+    void optionCompactDump(StoreEntry * e) const;
+    void forgetCompact(const CompactIndex::Record &);
+    int purgeCompact(uint64_t lowWaterSz, int maxRemove);
+    void logRecord(const StoreSwapLogData &) const;
     mutable ConfigOptionVector *currentIOOptions;
     char const *ioType;
     uint64_t cur_size; ///< currently used space in the storage area
     uint64_t n_disk_objects; ///< total number of objects stored
     bool rebuilding_; ///< whether RebuildState is writing the new swap.state
+    RebuildState *rebuildState; ///< the ongoing index rebuild (or nil)
+
+    bool compactIndexing_; ///< whether the compact-index option is on
+    CompactIndex *compactIndex; ///< objects without StoreEntry (or nil)
+    size_t compactPurgeSlot; ///< where the next purgeCompact() scan starts
 };
 
 } //namespace Ufs
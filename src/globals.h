@@ -14,6 +14,7 @@
 #include "hash.h"
 #include "IoStats.h"
 #include "rfc2181.h"
+#include "store/forward.h"
 
 extern char *ConfigFile;    /* NULL */
 extern char *IcpOpcodeStr[];
@@ -59,8 +60,7 @@ extern int shutting_down;   /* 0 */
 extern int reconfiguring;   /* 0 */
 extern time_t hit_only_mode_until;  /* 0 */
 extern double request_failure_ratio;    /* 0.0 */
-extern int store_hash_buckets;  /* 0 */
-extern hash_table *store_table; /* NULL */
+extern Store::EntryIndex *store_table; /* NULL */
 extern int hot_obj_count;   /* 0 */
 extern int CacheDigestHashFuncCount;    /* 4 */
 extern CacheDigest *store_digest;   /* NULL */
@@ -277,15 +277,19 @@ Http::Stream::sendStartOfMessage(HttpReply *rep, StoreIOBuffer bodyData)
     /* Save length of headers for persistent conn checks */
     http->out.headers_sz = mb->contentSize();
 
+    // body bytes to send right after mb, without copying them into mb
+    const char *bodyBuf = nullptr;
+    size_t bodyLength = 0;
+
     if (bodyData.data && bodyData.length) {
         if (multipartRangeRequest())
             packRange(bodyData, mb);
         else if (http->request->flags.chunkedReply) {
             packChunk(bodyData, *mb);
         } else {
-            size_t length = lengthToSend(bodyData.range());
-            noteSentBodyBytes(length);
-            mb->append(bodyData.data, length);
+            bodyLength = lengthToSend(bodyData.range());
+            noteSentBodyBytes(bodyLength);
+            bodyBuf = bodyData.data;
         }
     }
 #if USE_DELAY_POOLS
@@ -307,7 +311,10 @@ Http::Stream::sendStartOfMessage(HttpReply *rep, StoreIOBuffer bodyData)
     }
 #endif
 
-    getConn()->write(mb);
+    if (bodyLength)
+        getConn()->write(mb, bodyBuf, bodyLength);
+    else
+        getConn()->write(mb);
     delete mb;
 }
 
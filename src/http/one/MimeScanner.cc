@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+/* DEBUG: section 74    HTTP Message */
+
+#include "squid.h"
+#include "debug/Stream.h"
+#include "http/one/MimeScanner.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define SQUID_MIME_SCAN_X86 1
+#include <immintrin.h>
+#else
+#define SQUID_MIME_SCAN_X86 0
+#endif
+
+using Http::One::MimeLineScan;
+using Http::One::MimeScanKernel;
+
+/// classifies octets [from, len) one at a time, continuing the given scan
+static void
+ScanTail(const char *buf, size_t from, const size_t len, MimeLineScan &scan)
+{
+    for (; from < len; ++from) {
+        const auto c = static_cast<unsigned char>(buf[from]);
+        if (c == '\n') {
+            scan.length = from;
+            scan.terminated = true;
+            return;
+        }
+        if (c == '\r')
+            ++scan.crs;
+        else if (c == ':' && scan.colon == MimeLineScan::npos)
+            scan.colon = from;
+    }
+    scan.length = len;
+}
+
+/// Accounts for one block of octets starting at offset, given bitmasks of
+/// the interesting octets in that block. Returns true when LF was found.
+template <typename Mask>
+static bool
+ScanBlock(const size_t offset, const Mask lf, Mask cr, Mask colon, MimeLineScan &scan)
+{
+    if (lf) {
+        const Mask before = (lf & (~lf + 1)) - 1; // the octets preceding the first LF
+        cr &= before;
+        colon &= before;
+        scan.length = offset + __builtin_ctzll(lf);
+        scan.terminated = true;
+    }
+    scan.crs += __builtin_popcountll(cr);
+    if (colon && scan.colon == MimeLineScan::npos)
+        scan.colon = offset + __builtin_ctzll(colon);
+    return scan.terminated;
+}
+
+static MimeLineScan
+ScanScalar(const char *buf, const size_t len)
+{
+    MimeLineScan scan;
+    ScanTail(buf, 0, len, scan);
+    return scan;
+}
+
+#if SQUID_MIME_SCAN_X86
+/// classifies 16 octets starting at offset; returns true when LF was found
+static inline bool
+ScanSse2Block(const char *buf, const size_t offset, MimeLineScan &scan)
+{
+    const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + offset));
+    const uint32_t lf = _mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8('\n')));
+    const uint32_t cr = _mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8('\r')));
+    const uint32_t colon = _mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8(':')));
+    return ScanBlock<uint32_t>(offset, lf, cr, colon, scan);
+}
+
+static MimeLineScan
+ScanSse2(const char *buf, const size_t len)
+{
+    MimeLineScan scan;
+    size_t offset = 0;
+    for (; offset + 16 <= len; offset += 16) {
+        if (ScanSse2Block(buf, offset, scan))
+            return scan;
+    }
+
+    ScanTail(buf, offset, len, scan);
+    return scan;
+}
+
+__attribute__((target("avx2")))
+static MimeLineScan
+ScanAvx2(const char *buf, const size_t len)
+{
+    MimeLineScan scan;
+    const auto lfs = _mm256_set1_epi8('\n');
+    const auto crs = _mm256_set1_epi8('\r');
+    const auto colons = _mm256_set1_epi8(':');
+
+    size_t offset = 0;
+    for (; offset + 32 <= len; offset += 32) {
+        const auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(buf + offset));
+        const uint32_t lf = _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, lfs));
+        const uint32_t cr = _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, crs));
+        const uint32_t colon = _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, colons));
+        if (ScanBlock<uint32_t>(offset, lf, cr, colon, scan))
+            return scan;
+    }
+
+    // short lines are common; do not leave up to 31 octets to ScanTail()
+    if (offset + 16 <= len) {
+        if (ScanSse2Block(buf, offset, scan))
+            return scan;
+        offset += 16;
+    }
+
+    ScanTail(buf, offset, len, scan);
+    return scan;
+}
+#endif /* SQUID_MIME_SCAN_X86 */
+
+bool
+Http::One::MimeScanKernelSupported(const MimeScanKernel kernel)
+{
+    switch (kernel) {
+    case MimeScanKernel::scalar:
+        return true;
+#if SQUID_MIME_SCAN_X86
+    case MimeScanKernel::sse2:
+        return true; // x86-64 baseline
+    case MimeScanKernel::avx2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#else
+    case MimeScanKernel::sse2:
+    case MimeScanKernel::avx2:
+        return false;
+#endif
+    }
+    return false;
+}
+
+Http::One::MimeScanKernel
+Http::One::DefaultMimeScanKernel()
+{
+    static const auto kernel = []() {
+        auto best = MimeScanKernel::scalar;
+        if (MimeScanKernelSupported(MimeScanKernel::avx2))
+            best = MimeScanKernel::avx2;
+        else if (MimeScanKernelSupported(MimeScanKernel::sse2))
+            best = MimeScanKernel::sse2;
+        debugs(74, 2, "using " << MimeScanKernelName(best) << " MIME scanner");
+        return best;
+    }();
+    return kernel;
+}
+
+const char *
+Http::One::MimeScanKernelName(const MimeScanKernel kernel)
+{
+    switch (kernel) {
+    case MimeScanKernel::scalar:
+        return "scalar";
+    case MimeScanKernel::sse2:
+        return "sse2";
+    case MimeScanKernel::avx2:
+        return "avx2";
+    }
+    return "unknown";
+}
+
+MimeLineScan
+Http::One::ScanMimeLine(const MimeScanKernel kernel, const char *buf, const size_t len)
+{
+    switch (kernel) {
+#if SQUID_MIME_SCAN_X86
+    case MimeScanKernel::avx2:
+        return ScanAvx2(buf, len);
+    case MimeScanKernel::sse2:
+        return ScanSse2(buf, len);
+#else
+    case MimeScanKernel::avx2:
+    case MimeScanKernel::sse2:
+        break;
+#endif
+    case MimeScanKernel::scalar:
+        break;
+    }
+    return ScanScalar(buf, len);
+}
+
+MimeLineScan
+Http::One::ScanMimeLine(const char *buf, const size_t len)
+{
+    static const auto kernel = DefaultMimeScanKernel();
+    return ScanMimeLine(kernel, buf, len);
+}
+
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#ifndef SQUID_SRC_HTTP_ONE_MIMESCANNER_H
+#define SQUID_SRC_HTTP_ONE_MIMESCANNER_H
+
+#include <cstddef>
+
+namespace Http {
+namespace One {
+
+/// what ScanMimeLine() found in one MIME header line
+class MimeLineScan
+{
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    /// the number of octets before the LF terminator
+    /// (or all scanned octets if the line is not terminated)
+    size_t length = 0;
+
+    /// offset of the first ':' octet before the LF terminator or npos
+    size_t colon = npos;
+
+    /// the number of CR octets before the LF terminator
+    size_t crs = 0;
+
+    /// whether the line ends with an LF octet
+    bool terminated = false;
+};
+
+/// implementations of ScanMimeLine(), fastest last
+enum class MimeScanKernel {
+    scalar, ///< one octet at a time
+    sse2, ///< 16 octets at a time (x86-64)
+    avx2 ///< 32 octets at a time (x86-64 CPUs with AVX2)
+};
+
+/// Scans buf for the LF ending the first MIME line, classifying the octets
+/// that HttpHeader::parse() looks at along the way: CR and ':'. Uses the
+/// fastest kernel supported by the running CPU.
+MimeLineScan ScanMimeLine(const char *buf, size_t len);
+
+/// ScanMimeLine() using the given kernel; for testing and benchmarking
+/// \pre MimeScanKernelSupported(kernel)
+MimeLineScan ScanMimeLine(MimeScanKernel kernel, const char *buf, size_t len);
+
+/// whether the running CPU (and this build) supports the given kernel
+bool MimeScanKernelSupported(MimeScanKernel);
+
+/// the kernel used by ScanMimeLine() without an explicit kernel argument
+MimeScanKernel DefaultMimeScanKernel();
+
+/// a short kernel name for debugging and reports
+const char *MimeScanKernelName(MimeScanKernel);
+
+} // namespace One
+} // namespace Http
+
+#endif /* SQUID_SRC_HTTP_ONE_MIMESCANNER_H */
+
@@ -13,6 +13,7 @@
 #include "debug/Stream.h"
 #include "globals.h"
 #include "ipc/Queue.h"
+#include "time/gadgets.h"
 
 #include <limits>
 
@@ -45,7 +46,7 @@ ReadersId(String id)
 InstanceIdDefinitions(Ipc::QueueReader, "ipcQR");
 
 Ipc::QueueReader::QueueReader(): popBlocked(false), popSignal(false),
-    rateLimit(0), balance(0)
+    rateLimit(0), balance(0), popped(0)
 {
     debugs(54, 7, "constructed " << id);
 }
@@ -151,10 +152,24 @@ Ipc::OneToOneUniQueues::operator [](const int index) const
 
 Ipc::BaseMultiQueue::BaseMultiQueue(const int aLocalProcessId):
     theLocalProcessId(aLocalProcessId),
-    theLastPopProcessId(std::numeric_limits<int>::max() - 1)
+    theLastPopProcessId(std::numeric_limits<int>::max() - 1),
+    lastStatTime(current_dtime),
+    lastStatPopped(0)
 {
 }
 
+void
+Ipc::BaseMultiQueue::statPopRate(std::ostream &os) const
+{
+    const auto popped = localReader().popped.load();
+    const auto interval = current_dtime - lastStatTime;
+    const auto rate = interval > 0 && popped >= lastStatPopped ? (popped - lastStatPopped) / interval : 0.0;
+    os << "  kid" << theLocalProcessId << " popped items: " << popped <<
+       " (" << rate << "/sec during the last " << interval << " seconds)\n";
+    lastStatTime = current_dtime;
+    lastStatPopped = popped;
+}
+
 void
 Ipc::BaseMultiQueue::clearReaderSignal(const int /*remoteProcessId*/)
 {
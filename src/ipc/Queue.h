@@ -63,6 +63,9 @@ public:
     /// how far ahead the reader is compared to a perfect read/sec event rate
     Balance balance;
 
+    /// the number of items popped by the reader; for cache manager reports
+    std::atomic<uint64_t> popped;
+
     /// unique ID for debugging which reader is used (works across processes)
     const InstanceId<QueueReader> id;
 };
@@ -224,11 +227,18 @@ protected:
     virtual int remotesCount() const = 0;
     virtual int remotesIdOffset() const = 0;
 
+    /// reports the number of items popped by the local reader
+    void statPopRate(std::ostream &) const;
+
 protected:
     const int theLocalProcessId; ///< process ID of this queue
 
 private:
     int theLastPopProcessId; ///< the ID of the last process we tried to pop() from
+
+    /* statPopRate() state as of its previous call */
+    mutable double lastStatTime; ///< current_dtime
+    mutable uint64_t lastStatPopped; ///< QueueReader::popped
 };
 
 /**
@@ -545,6 +555,7 @@ BaseMultiQueue::pop(int &remoteProcessId, Value &value)
             theLastPopProcessId = remotesIdOffset();
         OneToOneUniQueue &queue = inQueue(theLastPopProcessId);
         if (queue.pop(value, &localReader())) {
+            ++localReader().popped;
             remoteProcessId = theLastPopProcessId;
             debugs(54, 7, "popped from " << remoteProcessId << " to " << theLocalProcessId << " at " << queue.size());
             return true;
@@ -602,6 +613,7 @@ BaseMultiQueue::stat(std::ostream &os) const
     const auto &reader = localReader();
     os << "  kid" << theLocalProcessId << " reader flags: " <<
        "{ blocked: " << reader.blocked() << ", signaled: " << reader.signaled() << " }\n";
+    statPopRate(os);
 }
 
 // FewToFewBiQueue
@@ -0,0 +1,260 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+/* DEBUG: section 54    Interprocess Communication */
+
+#include "squid.h"
+#include "base/RunnersRegistry.h"
+#include "base/TextException.h"
+#include "comm/Loops.h"
+#include "debug/Stream.h"
+#include "fd.h"
+#include "globals.h"
+#include "ipc/mem/Pointer.h"
+#include "ipc/mem/Segment.h"
+#include "ipc/QueueWakeups.h"
+#include "time/gadgets.h"
+#include "tools.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <ostream>
+#include <vector>
+#if HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#if HAVE_SYS_EVENTFD_H
+#include <sys/eventfd.h>
+#endif
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+/// shared memory segment name
+static const char *const ShmLabel = "queue_wakeups";
+
+/// the wakeup states of all kids (or nil if wakeups are not supported)
+static Ipc::Mem::Pointer<Ipc::QueueWakeups::KidStates> TheStates;
+
+/// functions to call when this kid is woken up
+static std::vector<Ipc::QueueWakeups::Handler> &
+Handlers()
+{
+    static const auto handlers = new std::vector<Ipc::QueueWakeups::Handler>();
+    return *handlers;
+}
+
+/// this kid wakeup counters at the time of the previous Stat() call
+static struct {
+    double time = 0; ///< current_dtime
+    uint64_t sent = 0;
+    uint64_t received = 0;
+} LastStat;
+
+/// the current std::chrono::steady_clock time in microseconds; unlike
+/// current_time, this clock has the same origin in all kids
+static uint64_t
+MonotonicUsec()
+{
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+}
+
+/// the wakeup state of this kid or nil
+static Ipc::QueueWakeups::KidState *
+MyState()
+{
+    if (!TheStates || KidIdentifier < 1 || KidIdentifier > TheStates->capacity)
+        return nullptr;
+    return &TheStates->kids[KidIdentifier - 1];
+}
+
+/// Comm::SetSelect() callback for this kid eventfd
+static void
+HandleWakeup(const int fd, void *)
+{
+    uint64_t count = 0;
+    if (::read(fd, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+        const auto xerrno = errno;
+        debugs(54, DBG_IMPORTANT, "ERROR: queue wakeup eventfd read failure: " << xstrerr(xerrno));
+    }
+    Comm::SetSelect(fd, COMM_SELECT_READ, &HandleWakeup, nullptr, 0);
+
+    const auto state = MyState();
+    assert(state);
+    if (const auto sentAt = state->pendingSince.exchange(0)) {
+        const auto now = MonotonicUsec();
+        const auto latency = now > sentAt ? now - sentAt : 0;
+        state->latencySum += latency;
+        auto oldMax = state->latencyMax.load();
+        while (latency > oldMax && !state->latencyMax.compare_exchange_weak(oldMax, latency)) {}
+    }
+    ++state->received;
+    debugs(54, 7, "count: " << count);
+
+    for (const auto handler: Handlers())
+        handler();
+}
+
+/* Ipc::QueueWakeups::KidStates */
+
+Ipc::QueueWakeups::KidStates::KidStates(const int aCapacity):
+    capacity(aCapacity),
+    kids(capacity)
+{
+    Must(capacity > 0);
+}
+
+size_t
+Ipc::QueueWakeups::KidStates::SharedMemorySize(const int capacity)
+{
+    return sizeof(KidStates) + sizeof(KidState) * capacity;
+}
+
+/* Ipc::QueueWakeups API */
+
+void
+Ipc::QueueWakeups::Subscribe(const Handler handler)
+{
+    auto &handlers = Handlers();
+    if (std::find(handlers.begin(), handlers.end(), handler) == handlers.end())
+        handlers.push_back(handler);
+}
+
+bool
+Ipc::QueueWakeups::Notify(const int kidId)
+{
+    if (!TheStates || kidId < 1 || kidId > TheStates->capacity)
+        return false;
+
+    auto &kid = TheStates->kids[kidId - 1];
+    if (kid.fd < 0)
+        return false;
+
+    uint64_t none = 0;
+    (void)kid.pendingSince.compare_exchange_strong(none, MonotonicUsec());
+
+    const uint64_t increment = 1;
+    if (::write(kid.fd, &increment, sizeof(increment)) < 0 && errno != EAGAIN) {
+        // EAGAIN means that the counter is huge; the kid will wake up anyway
+        const auto xerrno = errno;
+        debugs(54, DBG_IMPORTANT, "ERROR: cannot wake up kid" << kidId << ": " << xstrerr(xerrno));
+        return false;
+    }
+
+    ++kid.sent;
+    debugs(54, 7, "kid" << kidId);
+    return true;
+}
+
+void
+Ipc::QueueWakeups::Stat(std::ostream &os)
+{
+    const auto state = MyState();
+    if (!state || state->fd < 0) {
+        os << "Queue reader wakeups: using UDS notifications\n";
+        return;
+    }
+
+    const auto sent = state->sent.load();
+    const auto received = state->received.load();
+    const auto interval = current_dtime - LastStat.time;
+    const auto rate = [interval](const uint64_t now, const uint64_t then) {
+        return interval > 0 && now >= then ? (now - then) / interval : 0.0;
+    };
+
+    os << "Queue reader wakeups of kid" << KidIdentifier << ":\n" <<
+       "  sent: " << sent << " (" << rate(sent, LastStat.sent) << "/sec)\n" <<
+       "  handled: " << received << " (" << rate(received, LastStat.received) << "/sec)\n" <<
+       "  mean latency: " << (received ? state->latencySum.load() / received : 0) << " usec\n" <<
+       "  max latency: " << state->latencyMax.load() << " usec\n";
+    if (LastStat.time > 0)
+        os << "  rates above are for the last " << interval << " seconds\n";
+
+    LastStat.time = current_dtime;
+    LastStat.sent = sent;
+    LastStat.received = received;
+}
+
+/// creates and attaches eventfd(2)-based queue reader wakeups
+class QueueWakeupsRr: public Ipc::Mem::RegisteredRunner
+{
+public:
+    /* RegisteredRunner API */
+    ~QueueWakeupsRr() override;
+
+protected:
+    void create() override;
+    void open() override;
+
+private:
+    Ipc::Mem::Owner<Ipc::QueueWakeups::KidStates> *owner = nullptr;
+};
+
+DefineRunnerRegistrator(QueueWakeupsRr);
+
+void
+QueueWakeupsRr::create()
+{
+    if (!UsingSmp())
+        return;
+
+    Must(!owner);
+    owner = shm_new(Ipc::QueueWakeups::KidStates)(ShmLabel, NumberOfKids());
+
+#if HAVE_SYS_EVENTFD_H
+    // no EFD_CLOEXEC: kids must inherit these descriptors
+    auto states = owner->object();
+    for (int i = 0; i < states->capacity; ++i) {
+        auto &kid = states->kids[i];
+        kid.fd = eventfd(0, EFD_NONBLOCK);
+        if (kid.fd < 0) {
+            const auto xerrno = errno;
+            debugs(54, DBG_IMPORTANT, "WARNING: Using UDS notifications for kid" << (i+1) <<
+                   " queue readers; eventfd(2) failure: " << xstrerr(xerrno));
+        }
+    }
+#endif
+}
+
+void
+QueueWakeupsRr::open()
+{
+    if (!UsingSmp())
+        return;
+
+    TheStates = shm_old(Ipc::QueueWakeups::KidStates)(ShmLabel);
+
+    // kid helpers and other programs we start must not inherit these
+    for (int i = 0; i < TheStates->capacity; ++i) {
+        if (TheStates->kids[i].fd >= 0)
+            (void)fcntl(TheStates->kids[i].fd, F_SETFD, FD_CLOEXEC);
+    }
+
+    const auto state = MyState();
+    if (state && state->fd >= 0) {
+        fd_open(state->fd, FD_PIPE, "queue reader wakeups");
+        Comm::SetSelect(state->fd, COMM_SELECT_READ, &HandleWakeup, nullptr, 0);
+    }
+}
+
+QueueWakeupsRr::~QueueWakeupsRr()
+{
+    if (!owner)
+        return;
+
+    // the master process closes all kid descriptors it has created
+    auto states = owner->object();
+    for (int i = 0; i < states->capacity; ++i) {
+        if (states->kids[i].fd >= 0)
+            close(states->kids[i].fd);
+    }
+    delete owner;
+}
+
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#ifndef SQUID_SRC_IPC_QUEUEWAKEUPS_H
+#define SQUID_SRC_IPC_QUEUEWAKEUPS_H
+
+#include "ipc/mem/FlexibleArray.h"
+
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+
+namespace Ipc
+{
+
+/// Cross-process notifications of blocked queue readers that do not use UDS
+/// messages: A queue writer increments the eventfd(2) counter of the reader
+/// kid, and the reader main loop wakes up when that counter becomes
+/// positive. The master process creates one eventfd per kid before starting
+/// kids. Kids inherit all those descriptors, including kids restarted later.
+///
+/// Each kid uses a single eventfd for all its queues. When woken up, the
+/// kid calls all subscribed handlers. Each handler is expected to clear its
+/// queue reader signal and pop all queued items, just like it does after
+/// receiving a UDS notification.
+namespace QueueWakeups
+{
+
+/// wakeup state of one kid, shared among all kids
+class KidState
+{
+public:
+    /// the kid eventfd(2) descriptor (the same in all kids) or -1
+    int fd = -1;
+
+    std::atomic<uint64_t> sent = {0}; ///< wakeups sent to this kid
+    std::atomic<uint64_t> received = {0}; ///< wakeups handled by this kid
+
+    /// when the oldest wakeup not yet handled by the kid was sent;
+    /// microseconds of std::chrono::steady_clock or zero
+    std::atomic<uint64_t> pendingSince = {0};
+
+    std::atomic<uint64_t> latencySum = {0}; ///< total wakeup delivery time (usec)
+    std::atomic<uint64_t> latencyMax = {0}; ///< maximum wakeup delivery time (usec)
+};
+
+/// shared array of KidStates, indexed by kid ID minus one
+class KidStates
+{
+public:
+    explicit KidStates(int aCapacity);
+
+    size_t sharedMemorySize() const { return SharedMemorySize(capacity); }
+    static size_t SharedMemorySize(int capacity);
+
+    const int capacity; ///< the number of kids
+    Ipc::Mem::FlexibleArray<KidState> kids;
+};
+
+/// a function that pops items from queues read by this kid
+using Handler = void (*)();
+
+/// starts calling the given handler whenever this kid is woken up;
+/// repeated subscriptions of the same handler are ignored
+void Subscribe(Handler);
+
+/// wakes up a blocked reader in the given kid
+/// \returns false if the caller must send a UDS notification instead
+bool Notify(int kidId);
+
+/// reports wakeup statistics of this kid; suitable for cache manager reports
+void Stat(std::ostream &);
+
+} // namespace QueueWakeups
+
+} // namespace Ipc
+
+#endif /* SQUID_SRC_IPC_QUEUEWAKEUPS_H */
+
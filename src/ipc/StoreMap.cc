@@ -309,6 +309,12 @@ Ipc::StoreMap::peekAtEntry(const sfileno fileno) const
     return anchorAt(fileno);
 }
 
+const Ipc::StoreMap::Slice &
+Ipc::StoreMap::peekAtSlice(const SliceId sliceId) const
+{
+    return sliceAt(sliceId);
+}
+
 bool
 Ipc::StoreMap::freeEntry(const sfileno fileno)
 {
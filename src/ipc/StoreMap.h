@@ -290,6 +290,10 @@ public:
     /// \returns the corresponding Anchor
     const Anchor &peekAtEntry(const sfileno fileno) const;
 
+    /// the caller does not have to hold a lock on the slice entry;
+    /// for approximate statistics only because the slice may change any time
+    const Slice &peekAtSlice(const SliceId sliceId) const;
+
     /// free the entry if possible or mark it as waiting to be freed if not
     /// \returns whether the entry was neither empty nor marked
     bool freeEntry(const sfileno);
@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+/* DEBUG: section 54    Interprocess Communication */
+
+#include "squid.h"
+#include "debug/Stream.h"
+#include "globals.h"
+#include "ipc/mem/Numa.h"
+#include "SquidConfig.h"
+
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <string>
+#if HAVE_LINUX_MEMPOLICY_H
+#include <linux/mempolicy.h>
+#endif
+#if HAVE_SYS_SYSCALL_H
+#include <sys/syscall.h>
+#endif
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#if defined(MPOL_INTERLEAVE) && defined(MPOL_LOCAL) && defined(SYS_mbind) && defined(SYS_set_mempolicy)
+#define HAVE_NUMA_POLICIES 1
+#else
+#define HAVE_NUMA_POLICIES 0
+#endif
+
+/// the one-based node given to the last PreferNode() call
+static int PreferredNode = 0;
+
+/// the OS IDs listed in the given sysfs list file (or nothing)
+static std::vector<int>
+ReadSysList(const char *const fileName)
+{
+    std::ifstream in(fileName);
+    return Ipc::Mem::Numa::ParseSysList(in);
+}
+
+/// the value of the named field in a /sys/devices/system/node/node*/meminfo
+static uint64_t
+NodeMemInfo(const int node, const char *const field)
+{
+    std::ifstream in("/sys/devices/system/node/node" + std::to_string(node - 1) + "/meminfo");
+    std::string line;
+    const std::string needle = std::string(" ") + field + ":";
+    while (std::getline(in, line)) {
+        const auto pos = line.find(needle);
+        if (pos != std::string::npos)
+            return std::strtoull(line.c_str() + pos + needle.size(), nullptr, 10);
+    }
+    return 0;
+}
+
+#if HAVE_NUMA_POLICIES
+/// a set_mempolicy(2) and mbind(2) node mask with all the given OS node IDs
+class NodeMask
+{
+public:
+    explicit NodeMask(const std::vector<int> &nodes) {
+        for (const auto node: nodes) {
+            const auto word = node / BitsPerWord;
+            if (words.size() <= static_cast<size_t>(word))
+                words.resize(word + 1, 0);
+            words[word] |= 1UL << (node % BitsPerWord);
+        }
+    }
+
+    const unsigned long *bits() const { return words.data(); }
+
+    /// the maxnode system call parameter
+    unsigned long maxNode() const { return words.size() * BitsPerWord + 1; }
+
+private:
+    static const int BitsPerWord = sizeof(unsigned long) * CHAR_BIT;
+    std::vector<unsigned long> words;
+};
+#endif
+
+const char *
+Ipc::Mem::Numa::PolicyName(const Policy policy)
+{
+    switch (policy) {
+    case Policy::none:
+        return "none";
+    case Policy::interleave:
+        return "interleave";
+    case Policy::local:
+        return "local";
+    }
+    return "[unknown]";
+}
+
+std::vector<int>
+Ipc::Mem::Numa::ParseSysList(std::istream &in)
+{
+    std::vector<int> result;
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        int first = -1;
+        int last = -1;
+        char dash = 0;
+        std::istringstream range(item);
+        if (!(range >> first) || first < 0)
+            break;
+        if (range >> dash >> last) {
+            if (dash != '-' || last < first)
+                break;
+        } else {
+            last = first;
+        }
+        for (auto id = first; id <= last; ++id)
+            result.push_back(id);
+    }
+    return result;
+}
+
+int
+Ipc::Mem::Numa::NodeCount()
+{
+#if HAVE_NUMA_POLICIES
+    static const auto nodes = ReadSysList("/sys/devices/system/node/online");
+    return nodes.empty() ? 0 : nodes.back() + 1;
+#else
+    return 0;
+#endif
+}
+
+std::vector<int>
+Ipc::Mem::Numa::NodeCpus(const int node)
+{
+    if (node < 1 || node > NodeCount())
+        return std::vector<int>();
+    const auto fileName = "/sys/devices/system/node/node" + std::to_string(node - 1) + "/cpulist";
+    return ReadSysList(fileName.c_str());
+}
+
+void
+Ipc::Mem::Numa::PlaceSegment(const char *const segmentName, void *const mem, const size_t size)
+{
+    const auto policy = Config.shmNumaPolicy;
+    if (policy == Policy::none || NodeCount() < 2)
+        return;
+
+#if HAVE_NUMA_POLICIES
+    std::vector<int> allNodes;
+    for (auto node = 0; node < NodeCount(); ++node)
+        allNodes.push_back(node);
+    const NodeMask mask(allNodes);
+
+    // for MAP_SHARED shm segments, the policy applies to the segment itself
+    // (not just this mapping), so kids touching segment pages honor it too
+    const auto result = policy == Policy::interleave ?
+                        syscall(SYS_mbind, mem, size, MPOL_INTERLEAVE, mask.bits(), mask.maxNode(), 0) :
+                        syscall(SYS_mbind, mem, size, MPOL_LOCAL, nullptr, 0, 0);
+    if (result != 0) {
+        const auto xerrno = errno;
+        debugs(54, DBG_IMPORTANT, "WARNING: cannot apply shared_memory_numa_policy to " <<
+               segmentName << ": " << xstrerr(xerrno));
+        return;
+    }
+    debugs(54, 5, segmentName << " policy: " << static_cast<int>(policy));
+#else
+    (void)segmentName;
+    (void)mem;
+    (void)size;
+#endif
+}
+
+void
+Ipc::Mem::Numa::PreferNode(const int node)
+{
+    if (node == PreferredNode)
+        return;
+
+    if (node > NodeCount()) {
+        debugs(54, DBG_IMPORTANT, "WARNING: ignoring NUMA node " << node << " of kid" << KidIdentifier <<
+               " in cpu_affinity_map; the number of NUMA nodes is " << NodeCount());
+        return;
+    }
+
+#if HAVE_NUMA_POLICIES
+    long result = 0;
+    if (node > 0) {
+        const NodeMask mask(std::vector<int>(1, node - 1));
+        result = syscall(SYS_set_mempolicy, MPOL_PREFERRED, mask.bits(), mask.maxNode());
+    } else {
+        result = syscall(SYS_set_mempolicy, MPOL_DEFAULT, nullptr, 0);
+    }
+    if (result != 0) {
+        const auto xerrno = errno;
+        debugs(54, DBG_IMPORTANT, "WARNING: cannot set NUMA memory policy of kid" << KidIdentifier <<
+               ": " << xstrerr(xerrno));
+        return;
+    }
+    debugs(54, 3, "kid" << KidIdentifier << " prefers NUMA node " << node);
+    PreferredNode = node;
+#endif
+}
+
+void
+Ipc::Mem::Numa::Stat(std::ostream &os)
+{
+    const auto nodeCount = NodeCount();
+    if (!nodeCount) {
+        os << "NUMA memory policies are not supported\n";
+        return;
+    }
+
+    os << "NUMA nodes: " << nodeCount << "\n" <<
+       "shared_memory_numa_policy: " << PolicyName(Config.shmNumaPolicy) << "\n" <<
+       "Preferred node of kid" << KidIdentifier << ": ";
+    if (PreferredNode)
+        os << PreferredNode << "\n";
+    else
+        os << "none\n";
+
+    // resident pages of this kid on each (zero-based) node, in KB
+    std::map<int, uint64_t> sharedKb;
+    std::map<int, uint64_t> privateKb;
+    std::ifstream maps("/proc/self/numa_maps");
+    std::string line;
+    while (std::getline(maps, line)) {
+        std::istringstream fields(line);
+        std::string field;
+        bool shared = false;
+        uint64_t pageKb = 4;
+        std::map<int, uint64_t> pages;
+        while (fields >> field) {
+            if (field.compare(0, 5, "file=") == 0)
+                shared = field.size() > 4 && field.compare(field.size() - 4, 4, ".shm") == 0;
+            else if (field.compare(0, 18, "kernelpagesize_kB=") == 0)
+                pageKb = std::strtoull(field.c_str() + 18, nullptr, 10);
+            else if (field.size() > 1 && field[0] == 'N' && isdigit(field[1])) {
+                char *end = nullptr;
+                const auto node = std::strtol(field.c_str() + 1, &end, 10);
+                if (*end == '=')
+                    pages[node] += std::strtoull(end + 1, nullptr, 10);
+            }
+        }
+        for (const auto &nodePages: pages)
+            (shared ? sharedKb : privateKb)[nodePages.first] += nodePages.second * pageKb;
+    }
+
+    os << "\n" <<
+       std::setw(6) << "Node" <<
+       std::setw(16) << "Total KB" <<
+       std::setw(16) << "Free KB" <<
+       std::setw(16) << "Shared KB" <<
+       std::setw(16) << "Private KB" << "\n";
+    for (auto node = 1; node <= nodeCount; ++node) {
+        os << std::setw(6) << node <<
+           std::setw(16) << NodeMemInfo(node, "MemTotal") <<
+           std::setw(16) << NodeMemInfo(node, "MemFree") <<
+           std::setw(16) << sharedKb[node - 1] <<
+           std::setw(16) << privateKb[node - 1] << "\n";
+    }
+    os << "\nShared KB: resident pages of shared memory segments mapped by this kid\n" <<
+       "Private KB: other resident pages of this kid\n";
+}
+
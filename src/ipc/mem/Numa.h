@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#ifndef SQUID_SRC_IPC_MEM_NUMA_H
+#define SQUID_SRC_IPC_MEM_NUMA_H
+
+#include <iosfwd>
+#include <vector>
+
+namespace Ipc
+{
+
+namespace Mem
+{
+
+/// NUMA placement of shared segments and kid memory. Squid numbers NUMA
+/// nodes starting from 1 (like cpu_affinity_map cores); the OS starts at 0.
+namespace Numa
+{
+
+/// shared_memory_numa_policy values
+enum class Policy { none = 0, interleave, local };
+
+/// the squid.conf spelling of the given policy
+const char *PolicyName(Policy);
+
+/// the number of NUMA nodes or zero if this OS or build lacks NUMA support
+int NodeCount();
+
+/// OS IDs of the CPUs that belong to the given (one-based) NUMA node
+std::vector<int> NodeCpus(int node);
+
+/// OS IDs listed in a sysfs list like "0-3,8,10-11"; parsing stops at the
+/// first malformed item
+std::vector<int> ParseSysList(std::istream &);
+
+/// applies shared_memory_numa_policy to a freshly mapped shared segment;
+/// affects segment pages that nobody has touched yet
+void PlaceSegment(const char *segmentName, void *mem, size_t size);
+
+/// makes this process prefer allocating memory on the given (one-based)
+/// NUMA node; zero restores the default OS policy
+void PreferNode(int node);
+
+/// reports NUMA placement settings and per-node memory use of this process
+void Stat(std::ostream &);
+
+} // namespace Numa
+
+} // namespace Mem
+
+} // namespace Ipc
+
+#endif /* SQUID_SRC_IPC_MEM_NUMA_H */
+
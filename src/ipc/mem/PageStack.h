@@ -167,6 +167,8 @@ public:
     static PoolId IdForMemStoreSpace() { return 10; }
     /// multipurpose PagePool of shared memory pages
     static PoolId IdForMultipurposePool() { return 200; } // segments could use 2xx
+    /// PagePool of shared memory cache pages of a given size class
+    static PoolId IdForCachePageClass(const size_t pageClass) { return 201 + pageClass; }
     /// stack of free rock cache_dir slot numbers
     static PoolId IdForSwapDirSpace(const int dirIdx) { return 900 + dirIdx + 1; }
 
@@ -13,16 +13,53 @@
 #include "base/TextException.h"
 #include "ipc/mem/PagePool.h"
 #include "ipc/mem/Pages.h"
+#include "sbuf/Stream.h"
 #include "tools.h"
 
-// Uses a single PagePool instance, for now.
-// Eventually, we may have pools dedicated to memory caching, disk I/O, etc.
+#include <algorithm>
+#include <vector>
+
+// Uses a multipurpose PagePool instance for PageSize() pages and, if needed,
+// one PagePool per smaller cache page size class.
 
 // TODO: make pool id more unique so it does not conflict with other Squids?
 static const char *PagePoolId = "squid-page-pool";
 static Ipc::Mem::PagePool *ThePagePool = nullptr;
 static int TheLimits[Ipc::Mem::PageId::maxPurpose+1];
 
+/// cache pages of one size, smaller than Ipc::Mem::PageSize()
+class PageClassPool
+{
+public:
+    /// the shared memory segment ID of the class pool
+    SBuf poolId() const { return ToSBuf(PagePoolId, '-', pageSize); }
+
+    size_t pageSize = 0; ///< the size of each page in this class
+    size_t limit = 0; ///< the number of pages in this class
+    Ipc::Mem::PagePool *pool = nullptr; ///< class pages (after open())
+};
+
+/// cache page classes with dedicated pools, in the ascending page size order
+static std::vector<PageClassPool> TheCachePageClasses;
+
+/// the pool that the given page belongs to
+static Ipc::Mem::PagePool &
+PoolOf(const Ipc::Mem::PageId &page)
+{
+    using Ipc::Mem::PageStack;
+    if (page.pool == PageStack::IdForMultipurposePool()) {
+        Must(ThePagePool);
+        return *ThePagePool;
+    }
+
+    Must(page.pool >= PageStack::IdForCachePageClass(0));
+    const auto pageClass = page.pool - PageStack::IdForCachePageClass(0);
+    Must(pageClass < TheCachePageClasses.size());
+    const auto pool = TheCachePageClasses[pageClass].pool;
+    Must(pool);
+    return *pool;
+}
+
 // TODO: make configurable to avoid waste when mem-cached objects are small/big
 size_t
 Ipc::Mem::PageSize()
@@ -40,15 +77,20 @@ Ipc::Mem::GetPage(const PageId::Purpose purpose, PageId &page)
 void
 Ipc::Mem::PutPage(PageId &page)
 {
-    Must(ThePagePool);
-    ThePagePool->put(page);
+    if (page)
+        PoolOf(page).put(page);
 }
 
 char *
 Ipc::Mem::PagePointer(const PageId &page)
 {
-    Must(ThePagePool);
-    return ThePagePool->pagePointer(page);
+    return PoolOf(page).pagePointer(page);
+}
+
+size_t
+Ipc::Mem::PageSize(const PageId &page)
+{
+    return PoolOf(page).pageSize();
 }
 
 size_t
@@ -76,6 +118,133 @@ Ipc::Mem::NotePageNeed(const int purpose, const int count)
     TheLimits[purpose] += count;
 }
 
+void
+Ipc::Mem::NoteCachePageNeed(const size_t pageSize, const int count)
+{
+    Must(0 < pageSize && pageSize < PageSize());
+    Must(count >= 0);
+    if (!count)
+        return;
+
+    const auto pos = std::find_if(TheCachePageClasses.begin(), TheCachePageClasses.end(),
+    [pageSize](const PageClassPool &pageClass) { return pageClass.pageSize >= pageSize; });
+    if (pos != TheCachePageClasses.end() && pos->pageSize == pageSize) {
+        pos->limit += count;
+        return;
+    }
+
+    PageClassPool pageClass;
+    pageClass.pageSize = pageSize;
+    pageClass.limit = count;
+    TheCachePageClasses.insert(pos, pageClass);
+}
+
+size_t
+Ipc::Mem::CachePageClasses()
+{
+    return TheCachePageClasses.size() + 1;
+}
+
+size_t
+Ipc::Mem::CachePageSize(const size_t pageClass)
+{
+    Must(pageClass < CachePageClasses());
+    return pageClass < TheCachePageClasses.size() ?
+           TheCachePageClasses[pageClass].pageSize : PageSize();
+}
+
+size_t
+Ipc::Mem::CachePageLimit(const size_t pageClass)
+{
+    Must(pageClass < CachePageClasses());
+    return pageClass < TheCachePageClasses.size() ?
+           TheCachePageClasses[pageClass].limit : PageLimit(PageId::cachePage);
+}
+
+size_t
+Ipc::Mem::CachePageLevel(const size_t pageClass)
+{
+    Must(pageClass < CachePageClasses());
+    if (pageClass < TheCachePageClasses.size()) {
+        const auto pool = TheCachePageClasses[pageClass].pool;
+        return pool ? pool->level() : 0;
+    }
+    return PageLevel(PageId::cachePage);
+}
+
+bool
+Ipc::Mem::GetCachePage(const size_t pageClass, PageId &page)
+{
+    Must(pageClass < CachePageClasses());
+    if (pageClass < TheCachePageClasses.size()) {
+        const auto pool = TheCachePageClasses[pageClass].pool;
+        return pool ? pool->get(PageId::cachePage, page) : false;
+    }
+    return GetPage(PageId::cachePage, page);
+}
+
+size_t
+Ipc::Mem::CachePageClassFor(const int64_t bytes)
+{
+    const auto largestClass = CachePageClasses() - 1;
+    if (bytes < 0)
+        return largestClass;
+
+    const auto smallestPageSize = CachePageSize(0);
+    for (size_t pageClass = 0; pageClass < largestClass; ++pageClass) {
+        const auto pageSize = CachePageSize(pageClass);
+        if (static_cast<uint64_t>(bytes) <= pageSize)
+            return (pageClass == 0 || pageSize - bytes <= smallestPageSize) ? pageClass : pageClass - 1;
+    }
+    return largestClass;
+}
+
+bool
+Ipc::Mem::GetCachePageFor(const int64_t bytes, PageId &page)
+{
+    const auto preferredClass = CachePageClassFor(bytes);
+    for (auto pageClass = preferredClass; pageClass < CachePageClasses(); ++pageClass) {
+        if (GetCachePage(pageClass, page))
+            return true;
+    }
+    for (auto pageClass = preferredClass; pageClass > 0; --pageClass) {
+        if (GetCachePage(pageClass - 1, page))
+            return true;
+    }
+    return false;
+}
+
+size_t
+Ipc::Mem::CachePageClass(const PageId &page)
+{
+    if (page.pool == PageStack::IdForMultipurposePool())
+        return page.purpose == PageId::cachePage ? TheCachePageClasses.size() : CachePageClasses();
+
+    const auto firstPoolId = PageStack::IdForCachePageClass(0);
+    if (page.pool >= firstPoolId && page.pool - firstPoolId < TheCachePageClasses.size())
+        return page.pool - firstPoolId;
+
+    return CachePageClasses(); // not a cache page
+}
+
+uint64_t
+Ipc::Mem::CacheBytesLimit()
+{
+    uint64_t bytes = 0;
+    for (size_t i = 0; i < CachePageClasses(); ++i)
+        bytes += static_cast<uint64_t>(CachePageLimit(i)) * CachePageSize(i);
+    return bytes;
+}
+
+uint64_t
+Ipc::Mem::CacheBytesLevel()
+{
+    uint64_t bytes = 0;
+    for (size_t i = 0; i < CachePageClasses(); ++i)
+        bytes += static_cast<uint64_t>(CachePageLevel(i)) * CachePageSize(i);
+    return bytes;
+}
+
 size_t
 Ipc::Mem::PageLevel()
 {
@@ -101,6 +270,7 @@ public:
 
 private:
     Ipc::Mem::PagePool::Owner *owner;
+    std::vector<Ipc::Mem::PagePool::Owner *> classOwners; ///< cache page class pools
 };
 
 DefineRunnerRegistrator(SharedMemPagesRr);
@@ -108,7 +278,7 @@ DefineRunnerRegistrator(SharedMemPagesRr);
 void
 SharedMemPagesRr::useConfig()
 {
-    if (Ipc::Mem::PageLimit() <= 0)
+    if (Ipc::Mem::PageLimit() <= 0 && TheCachePageClasses.empty())
         return;
 
     Ipc::Mem::RegisteredRunner::useConfig();
@@ -118,17 +288,34 @@ void
 SharedMemPagesRr::create()
 {
     Must(!owner);
-    owner = Ipc::Mem::PagePool::Init(PagePoolId,
-                                     Ipc::Mem::PageStack::IdForMultipurposePool(),
-                                     Ipc::Mem::PageLimit(),
-                                     Ipc::Mem::PageSize());
+    if (Ipc::Mem::PageLimit() > 0) {
+        owner = Ipc::Mem::PagePool::Init(PagePoolId,
+                                         Ipc::Mem::PageStack::IdForMultipurposePool(),
+                                         Ipc::Mem::PageLimit(),
+                                         Ipc::Mem::PageSize());
+    }
+
+    Must(classOwners.empty());
+    for (size_t i = 0; i < TheCachePageClasses.size(); ++i) {
+        const auto &pageClass = TheCachePageClasses[i];
+        classOwners.push_back(Ipc::Mem::PagePool::Init(pageClass.poolId().c_str(),
+                              Ipc::Mem::PageStack::IdForCachePageClass(i),
+                              pageClass.limit,
+                              pageClass.pageSize));
+    }
 }
 
 void
 SharedMemPagesRr::open()
 {
     Must(!ThePagePool);
-    ThePagePool = new Ipc::Mem::PagePool(PagePoolId);
+    if (Ipc::Mem::PageLimit() > 0)
+        ThePagePool = new Ipc::Mem::PagePool(PagePoolId);
+
+    for (auto &pageClass: TheCachePageClasses) {
+        Must(!pageClass.pool);
+        pageClass.pool = new Ipc::Mem::PagePool(pageClass.poolId().c_str());
+    }
 }
 
 SharedMemPagesRr::~SharedMemPagesRr()
@@ -136,5 +323,12 @@ SharedMemPagesRr::~SharedMemPagesRr()
     delete ThePagePool;
     ThePagePool = nullptr;
     delete owner;
+
+    for (auto &pageClass: TheCachePageClasses) {
+        delete pageClass.pool;
+        pageClass.pool = nullptr;
+    }
+    for (const auto classOwner: classOwners)
+        delete classOwner;
 }
 
@@ -56,6 +56,56 @@ size_t PageSize();
 /// claim the need for a number of pages for a given purpose
 void NotePageNeed(const int purpose, const int count);
 
+/* Cache page classes */
+
+// Shared memory cache pages come in size classes, indexed in the ascending
+// page size order. The last class uses PageId::cachePage pages of PageSize()
+// from the multipurpose pool. Other classes have dedicated pools.
+
+/// claim the need for a number of PageId::cachePage pages of the given size;
+/// PageSize() pages must be claimed using NotePageNeed() instead
+void NoteCachePageNeed(const size_t pageSize, const int count);
+
+/// the number of cache page classes (including the PageSize() class)
+size_t CachePageClasses();
+
+/// the size of pages in the given cache page class
+size_t CachePageSize(const size_t pageClass);
+
+/// the total number of pages in the given cache page class
+size_t CachePageLimit(const size_t pageClass);
+
+/// approximate number of pages in the given cache page class used now
+size_t CachePageLevel(const size_t pageClass);
+
+/// sets page ID and returns true unless no free pages of the given class are found
+bool GetCachePage(const size_t pageClass, PageId &page);
+
+/// The cache page class best suited for storing the given number of bytes
+/// (or an unknown number of bytes if negative). Prefers the smallest page
+/// that fits all the bytes unless that page would waste more than the
+/// smallest page size; uses the next smaller page in the latter case.
+size_t CachePageClassFor(int64_t bytes);
+
+/// Gets a free cache page, preferring the page class best suited for storing
+/// the given number of bytes (see CachePageClassFor()). Larger pages come
+/// next because they keep entry slice chains short.
+/// \returns false if all cache pages are in use
+bool GetCachePageFor(int64_t bytes, PageId &page);
+
+/// the total size of all cache pages in bytes
+uint64_t CacheBytesLimit();
+
+/// approximate total size of cache pages used now in bytes
+uint64_t CacheBytesLevel();
+
+/// the cache page class of the given page or CachePageClasses() if the
+/// page does not belong to any cache page class
+size_t CachePageClass(const PageId &page);
+
+/// the size of the given (set) page in bytes
+size_t PageSize(const PageId &page);
+
 } // namespace Mem
 
 } // namespace Ipc
@@ -13,6 +13,7 @@
 #include "compat/shm.h"
 #include "debug/Stream.h"
 #include "fatal.h"
+#include "ipc/mem/Numa.h"
 #include "ipc/mem/Segment.h"
 #include "sbuf/SBuf.h"
 #include "SquidConfig.h"
@@ -183,6 +184,8 @@ Ipc::Mem::Segment::attach()
     }
     theMem = p;
 
+    // before lock() touches the pages
+    Numa::PlaceSegment(theName.termedBuf(), theMem, theSize);
     lock();
 }
 
@@ -13,6 +13,7 @@
 //#include "acl/Acl.h"
 #include "acl/Asn.h"
 #include "acl/forward.h"
+#include "acl/StatsAction.h"
 #include "anyp/UriScheme.h"
 #include "auth/Config.h"
 #include "auth/Gadgets.h"
@@ -1200,6 +1201,7 @@ mainInitialize(void)
 
     FwdState::initModule();
     SBufStatsAction::RegisterWithCacheManager();
+    Acl::StatsAction::RegisterWithCacheManager();
 
     AsyncJob::RegisterWithCacheManager();
 
@@ -1451,6 +1453,7 @@ RegisterModules()
     CallRunnerRegistrator(MemStoreRr);
     CallRunnerRegistrator(PeerPoolMgrsRr);
     CallRunnerRegistrator(PeerSourceHashRr);
+    CallRunnerRegistrator(QueueWakeupsRr);
     CallRunnerRegistrator(SharedMemPagesRr);
     CallRunnerRegistrator(SharedSessionCacheRr);
     CallRunnerRegistrator(TransientsRr);
@@ -1469,6 +1472,7 @@ RegisterModules()
 #endif
 
 #if USE_OPENSSL
+    CallRunnerRegistrator(KtlsReportRr);
     CallRunnerRegistrator(sslBumpCfgRr);
 #endif
 
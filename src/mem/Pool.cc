@@ -13,6 +13,7 @@
 #include "squid.h"
 #include "mem/Pool.h"
 #include "mem/PoolChunked.h"
+#include "mem/PoolHuge.h"
 #include "mem/PoolMalloc.h"
 #include "mem/Stats.h"
 
@@ -59,6 +60,14 @@ MemPools::create(const char *label, size_t obj_size)
     return pools.back();
 }
 
+Mem::Allocator *
+MemPools::createHuge(const char *label, size_t obj_size)
+{
+    // leaked on shutdown, like create() pools
+    pools.push_back(new MemPoolHuge(label, obj_size));
+    return pools.back();
+}
+
 void
 MemPools::setDefaultPoolChunking(bool const &aBool)
 {
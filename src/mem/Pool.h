@@ -70,6 +70,10 @@ public:
      */
     Mem::Allocator *create(const char *, size_t);
 
+    /// Create an allocator with given name to allocate fixed-size objects
+    /// of the specified size from memory backed by huge pages.
+    Mem::Allocator *createHuge(const char *, size_t);
+
     /**
      * Sets upper limit in bytes to amount of free ram kept in pools. This is
      * not strict upper limit, but a hint. When MemPools are over this limit,
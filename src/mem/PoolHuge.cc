@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#include "squid.h"
+#include "mem/PoolHuge.h"
+#include "mem/Stats.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#if HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
+/// the size of one huge page and of all our memory regions
+static const size_t RegionSize = 2 * 1024 * 1024;
+
+/// \returns a RegionSize-aligned memory region (preferably using huge pages)
+static void *
+MapRegion()
+{
+#if HAVE_SYS_MMAN_H && defined(MAP_ANONYMOUS)
+#if defined(MAP_HUGETLB)
+    // explicit huge pages are available only if the admin reserved some
+    void *region = mmap(nullptr, RegionSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (region != MAP_FAILED)
+        return region;
+#endif
+
+    // over-allocate to align the region at a huge page boundary
+    const auto raw = static_cast<char *>(mmap(nullptr, 2 * RegionSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (raw == MAP_FAILED)
+        return nullptr;
+
+    const auto misalignment = reinterpret_cast<uintptr_t>(raw) % RegionSize;
+    const auto start = misalignment ? raw + (RegionSize - misalignment) : raw;
+    if (start > raw)
+        munmap(raw, start - raw);
+    munmap(start + RegionSize, raw + 2 * RegionSize - (start + RegionSize));
+#if defined(MADV_HUGEPAGE)
+    (void)madvise(start, RegionSize, MADV_HUGEPAGE);
+#endif
+    return start;
+#else
+    return xmalloc(RegionSize);
+#endif
+}
+
+static void
+UnmapRegion(void *region)
+{
+#if HAVE_SYS_MMAN_H && defined(MAP_ANONYMOUS)
+    munmap(region, RegionSize);
+#else
+    xfree(region);
+#endif
+}
+
+MemPoolHuge::MemPoolHuge(char const *aLabel, const size_t aSize):
+    Mem::Allocator(aLabel, aSize),
+    itemsPerRegion(std::max<size_t>(1, RegionSize / objectSize))
+{
+    assert(objectSize <= RegionSize);
+}
+
+MemPoolHuge::~MemPoolHuge()
+{
+    assert(getInUseCount() == 0);
+    for (const auto region: regions)
+        UnmapRegion(region);
+}
+
+void
+MemPoolHuge::addRegion()
+{
+    const auto region = static_cast<char *>(MapRegion());
+    if (!region)
+        throw std::bad_alloc();
+
+    regions.push_back(region);
+    for (size_t i = itemsPerRegion; i > 0; --i)
+        freelist.push(region + (i - 1) * objectSize);
+    meter.alloc += itemsPerRegion;
+    meter.idle += itemsPerRegion;
+}
+
+void *
+MemPoolHuge::allocate()
+{
+    if (freelist.empty())
+        addRegion();
+    else
+        ++countSavedAllocs;
+
+    const auto obj = freelist.top();
+    freelist.pop();
+    --meter.idle;
+    ++meter.inuse;
+    if (doZero)
+        memset(obj, 0, objectSize);
+    return obj;
+}
+
+void
+MemPoolHuge::deallocate(void *obj)
+{
+    --meter.inuse;
+    ++meter.idle;
+    freelist.push(obj);
+}
+
+size_t
+MemPoolHuge::getStats(Mem::PoolStats &stats)
+{
+    stats.pool = this;
+    stats.label = label;
+    stats.meter = &meter;
+    stats.obj_size = objectSize;
+    stats.chunk_capacity = itemsPerRegion;
+    stats.chunk_size = RegionSize;
+
+    stats.chunks_alloc += regions.size();
+
+    stats.items_alloc += meter.alloc.currentLevel();
+    stats.items_inuse += meter.inuse.currentLevel();
+    stats.items_idle += meter.idle.currentLevel();
+
+    stats.overhead += sizeof(*this) + strlen(label) + 1 + regions.size() * sizeof(void *);
+
+    return getInUseCount();
+}
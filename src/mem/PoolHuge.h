@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#ifndef SQUID_SRC_MEM_POOLHUGE_H
+#define SQUID_SRC_MEM_POOLHUGE_H
+
+#include "mem/Allocator.h"
+
+#include <stack>
+#include <vector>
+
+/// \ingroup MemPoolsAPI
+/// A pool of large fixed-size objects carved out of 2 MB memory regions
+/// backed by huge pages, reducing TLB misses when touching many objects.
+/// Uses MAP_HUGETLB pages when the OS has reserved some and transparent
+/// huge pages otherwise. Regions are returned to the OS only when the pool
+/// is destroyed.
+class MemPoolHuge : public Mem::Allocator
+{
+public:
+    MemPoolHuge(char const *label, size_t aSize);
+    ~MemPoolHuge() override;
+
+    /* Mem::Allocator API */
+    size_t getStats(Mem::PoolStats &) override;
+    bool idleTrigger(int) const override { return false; }
+    void clean(time_t) override {}
+
+protected:
+    /* Mem::Allocator API */
+    void *allocate() override;
+    void deallocate(void *) override;
+
+private:
+    void addRegion();
+
+    const size_t itemsPerRegion; ///< the number of objects in one region
+    std::vector<void *> regions; ///< all allocated memory regions
+    std::stack<void *> freelist; ///< objects available for allocate()
+};
+
+#endif /* SQUID_SRC_MEM_POOLHUGE_H */
@@ -9,27 +9,62 @@
 /* DEBUG: section 19    Store Memory Primitives */
 
 #include "squid.h"
+#include "debug/Stream.h"
+#include "mem/Allocator.h"
 #include "mem/Pool.h"
 #include "mem_node.h"
+#include "sbuf/Stream.h"
 
 #include <cstddef>
-#include <type_traits>
+#include <map>
 
-static ptrdiff_t makeMemNodeDataOffset();
+namespace {
 
-static ptrdiff_t _mem_node_data_offset = makeMemNodeDataOffset();
+/// precedes each mem_node in its pool-allocated memory
+class NodeHeader
+{
+public:
+    Mem::Allocator *pool; ///< the pool that has allocated this memory
+};
 
-/*
- * Calculate the offset between the start of a mem_node and
- * its 'data' member
- */
-static ptrdiff_t
-makeMemNodeDataOffset()
+/// NodeHeader size, including the padding that aligns the mem_node after it
+const size_t HeaderSize = (sizeof(NodeHeader) + alignof(std::max_align_t) - 1) /
+                          alignof(std::max_align_t) * alignof(std::max_align_t);
+
+/// mem_node::PageSize() after mem_node::Configure() or zero
+size_t ThePageSize = 0;
+
+/// whether nodes are allocated in huge pages
+bool UseHugePages = false;
+
+/// memory pools for nodes of each data capacity
+std::map<size_t, Mem::Allocator *> &
+Pools()
 {
-    static_assert(std::is_standard_layout<mem_node>::value, "offsetof(mem_node) is unconditionally supported");
-    return ptrdiff_t(offsetof(mem_node, data));
+    static const auto pools = new std::map<size_t, Mem::Allocator *>();
+    return *pools;
 }
 
+/// the pool for nodes with the given data capacity
+Mem::Allocator &
+PoolFor(const size_t capacity)
+{
+    auto &pool = Pools()[capacity];
+    if (!pool) {
+        const auto objectSize = HeaderSize + sizeof(mem_node) + capacity;
+        // the default pool label matches the one used by older Squids
+        auto label = capacity == SM_PAGE_SIZE && !UseHugePages ?
+                     SBuf("mem_node") : ToSBuf("mem_node_", capacity, (UseHugePages ? "_huge" : ""));
+        const auto labelCopy = xstrdup(label.c_str()); // pools are never destroyed
+        pool = UseHugePages ? MemPools::GetInstance().createHuge(labelCopy, objectSize) :
+               memPoolCreate(labelCopy, objectSize);
+        pool->zeroBlocks(false); // nodeBuffer tracks initialized data bytes
+    }
+    return *pool;
+}
+
+} // namespace
+
 /*
  * This is the callback when storeIOWrite() is done.  We need to
  * clear the write_pending flag for the mem_node.  First we have
@@ -39,12 +74,52 @@ makeMemNodeDataOffset()
 void
 memNodeWriteComplete(void* d)
 {
-    mem_node* n = (mem_node*)((char*)d - _mem_node_data_offset);
+    mem_node* n = reinterpret_cast<mem_node *>(d) - 1;
     assert(n->write_pending);
     n->write_pending = false;
 }
 
+void *
+mem_node::operator new(const size_t size)
+{
+    assert(size == sizeof(mem_node));
+    auto &pool = PoolFor(PageSize());
+    const auto header = static_cast<NodeHeader *>(pool.alloc());
+    header->pool = &pool;
+    return reinterpret_cast<char *>(header) + HeaderSize;
+}
+
+void
+mem_node::operator delete(void *address)
+{
+    const auto header = reinterpret_cast<NodeHeader *>(static_cast<char *>(address) - HeaderSize);
+    header->pool->freeOne(header);
+}
+
+size_t
+mem_node::PageSize()
+{
+    return ThePageSize ? ThePageSize : SM_PAGE_SIZE;
+}
+
+void
+mem_node::Configure(const size_t pageSize, const bool hugePages)
+{
+    if (!ThePageSize) {
+        ThePageSize = pageSize;
+        UseHugePages = hugePages;
+        debugs(19, 3, "page size: " << ThePageSize << " huge pages: " << UseHugePages);
+        return;
+    }
+
+    if (pageSize != ThePageSize || hugePages != UseHugePages)
+        debugs(19, DBG_IMPORTANT, "WARNING: memory_page_size and memory_page_hugepages changes require a restart;" <<
+               " still using " << ThePageSize << "-byte pages" << (UseHugePages ? " in huge pages" : ""));
+}
+
 mem_node::mem_node(int64_t offset) :
+    data(reinterpret_cast<char *>(this + 1)),
+    capacity(PageSize()),
     nodeBuffer(0,offset,data),
     write_pending(false)
 {
@@ -57,13 +132,19 @@ mem_node::~mem_node()
 size_t
 mem_node::InUseCount()
 {
-    return Pool().inUseCount();
+    size_t count = 0;
+    for (const auto &pool: Pools())
+        count += pool.second->getInUseCount();
+    return count;
 }
 
 size_t
 mem_node::StoreMemSize()
 {
-    return InUseCount() * SM_PAGE_SIZE;
+    size_t size = 0;
+    for (const auto &pool: Pools())
+        size += pool.second->getInUseCount() * pool.first;
+    return size;
 }
 
 int64_t
@@ -88,7 +169,7 @@ mem_node::dataRange() const
 size_t
 mem_node::space() const
 {
-    return SM_PAGE_SIZE - nodeBuffer.length;
+    return capacity - nodeBuffer.length;
 }
 
 bool
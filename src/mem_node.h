@@ -14,14 +14,26 @@
 #include "mem/forward.h"
 #include "StoreIOBuffer.h"
 
+/// A Store memory page: Up to PageSize() bytes of an object stored at the
+/// given object offset. Each node is allocated together with its data
+/// buffer, from a memory pool dedicated to nodes of that size.
 class mem_node
 {
-    MEMPROXY_CLASS(mem_node);
-
 public:
     static size_t InUseCount();
     static size_t StoreMemSize();
 
+    /// the data capacity of new nodes (i.e. memory_page_size)
+    static size_t PageSize();
+
+    /// applies memory_page_size and memory_page_hugepages settings;
+    /// changes after the first call are ignored
+    static void Configure(size_t pageSize, bool hugePages);
+
+    /// allocates memory for the node and its PageSize()-byte data buffer
+    static void *operator new(size_t);
+    static void operator delete(void *);
+
     mem_node(int64_t);
     ~mem_node();
     size_t space() const;
@@ -32,9 +44,10 @@ public:
     bool canAccept (int64_t const &location) const;
     bool operator < (mem_node const & rhs) const;
     /* public */
+    char * const data; ///< node content; stored right after this object
+    const size_t capacity; ///< data buffer size
     StoreIOBuffer nodeBuffer;
     /* Private */
-    char data[SM_PAGE_SIZE];
     bool write_pending;
 };
 
@@ -16,51 +16,33 @@
 size_t
 headersEnd(const char *mime, size_t l, bool &containsObsFold)
 {
-    size_t e = 0;
-    int state = 1;
     containsObsFold = false;
 
-    while (e < l && state < 3) {
-        switch (state) {
-
-        case 0:
-
-            if ('\n' == mime[e])
-                state = 1;
-
-            break;
-
-        case 1:
-            if ('\r' == mime[e])
-                state = 2;
-            else if ('\n' == mime[e])
-                state = 3;
-            else if (' ' == mime[e] || '\t' == mime[e]) {
-                containsObsFold = true;
-                state = 0;
-            } else
-                state = 0;
-
-            break;
-
-        case 2:
-            if ('\n' == mime[e])
-                state = 3;
-            else
-                state = 0;
-
-            break;
-
-        default:
-            break;
+    // each iteration starts at the beginning of a line
+    size_t e = 0;
+    while (e < l) {
+        if ('\n' == mime[e])
+            return e + 1; // (CR)LF LF or a lone LF
+
+        size_t lineRest = e + 1;
+        if ('\r' == mime[e]) {
+            if (lineRest >= l)
+                return 0;
+            if ('\n' == mime[lineRest])
+                return lineRest + 1; // (CR)LF CRLF or a lone CRLF
+            ++lineRest; // the octet after CR cannot end this line
+        } else if (' ' == mime[e] || '\t' == mime[e]) {
+            containsObsFold = true;
         }
 
-        ++e;
+        if (lineRest >= l)
+            return 0;
+        const auto lf = static_cast<const char *>(memchr(mime + lineRest, '\n', l - lineRest));
+        if (!lf)
+            return 0;
+        e = lf - mime + 1;
     }
 
-    if (3 == state)
-        return e;
-
     return 0;
 }
 
@@ -75,6 +75,13 @@ public:
         Comm::Write(clientConnection, mb, writer);
     }
 
+    /// schedule a Comm::Write() of mb contents followed by len bytes at buf
+    void write(MemBuf *mb, const char *buf, int len) {
+        typedef CommCbMemFunT<Server, CommIoCbParams> Dialer;
+        writer = JobCallback(33, 5, Dialer, this, Server::clientWriteDone);
+        Comm::Write(clientConnection, mb, buf, len, writer);
+    }
+
     /// schedule some data for a Comm::Write()
     void write(char *buf, int len) {
         typedef CommCbMemFunT<Server, CommIoCbParams> Dialer;
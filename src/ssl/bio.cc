@@ -16,19 +16,50 @@
 #if USE_OPENSSL
 
 #include "base/Raw.h"
+#include "base/RunnersRegistry.h"
 #include "comm.h"
 #include "fd.h"
 #include "fde.h"
 #include "globals.h"
 #include "ip/Address.h"
+#include "mgr/Registration.h"
 #include "parser/BinaryTokenizer.h"
 #include "ssl/bio.h"
+#include "Store.h"
 
 #if _SQUID_WINDOWS_
 extern int socket_read_method(int, char *, int);
 extern int socket_write_method(int, const char *, int);
 #endif
 
+// OpenSSL configures kernel TLS only through socket BIOs, using BIO_ctrl()
+// commands it reserves for itself; Ssl::Bio offers those commands to a socket
+// BIO and learns the outcome via the public BIO_get_ktls_*() queries. OpenSSL
+// v3 bio.h lists those internal commands in a comment without defining them,
+// so we only recognize them in the library versions that documented them.
+#if defined(SSL_OP_ENABLE_KTLS) && defined(BIO_get_ktls_send) && defined(BIO_get_ktls_recv) && !defined(OPENSSL_NO_KTLS) && \
+    OPENSSL_VERSION_NUMBER >= 0x30000000L && OPENSSL_VERSION_NUMBER < 0x40000000L
+#define SQUID_OPENSSL_KTLS 1
+/// BIO_CTRL_SET_KTLS: install kTLS keys (arg1 is the direction, arg2 the crypto info)
+static const int SquidBioCtrlSetKtls = 72;
+/// BIO_CTRL_SET_KTLS_TX_SEND_CTRL_MSG: frame the next write as a record of type arg1
+static const int SquidBioCtrlSetKtlsTxSendCtrlMsg = 74;
+/// BIO_CTRL_CLEAR_KTLS_TX_CTRL_MSG: frame the next writes as application data again
+static const int SquidBioCtrlClearKtlsTxCtrlMsg = 75;
+#else
+#define SQUID_OPENSSL_KTLS 0
+#endif
+
+/// kernel TLS activity summary for the tls_ktls cache manager report
+static struct {
+    uint64_t sendStarts = 0; ///< connections with kernel-encrypted writes
+    uint64_t receiveStarts = 0; ///< connections with kernel-decrypted reads
+    uint64_t refusedByBio = 0; ///< requests declined while Bio buffers records
+    uint64_t refusedByKernel = 0; ///< requests declined by the kernel (e.g., unsupported cipher)
+    uint64_t bytesSent = 0; ///< payload bytes written via kernel TLS
+    uint64_t bytesReceived = 0; ///< payload bytes read via kernel TLS
+} KtlsStats;
+
 /* BIO callbacks */
 static int squid_bio_write(BIO *h, const char *buf, int num);
 static int squid_bio_read(BIO *h, char *buf, int size);
@@ -100,10 +131,18 @@ Ssl::Bio::Bio(const int anFd): fd_(anFd)
 Ssl::Bio::~Bio()
 {
     debugs(83, 7, "Bio destructing, this=" << this << " FD " << fd_);
+    if (ktlsSocket_) {
+        debugs(83, 3, "FD " << fd_ << " kTLS sent=" << ktlsBytesSent_ << (ktlsSending_ ? "" : " (off)") <<
+               " received=" << ktlsBytesReceived_ << (ktlsReceiving_ ? "" : " (off)"));
+        BIO_free(ktlsSocket_); // BIO_NOCLOSE: comm owns the descriptor
+    }
 }
 
 int Ssl::Bio::write(const char *buf, int size, BIO *table)
 {
+    if (ktlsSending_)
+        return ktlsWrite(buf, size, table);
+
     errno = 0;
 #if _SQUID_WINDOWS_
     const int result = socket_write_method(fd_, buf, size);
@@ -127,6 +166,9 @@ int Ssl::Bio::write(const char *buf, int size, BIO *table)
 int
 Ssl::Bio::read(char *buf, int size, BIO *table)
 {
+    if (ktlsReceiving_)
+        return ktlsRead(buf, size, table);
+
     errno = 0;
 #if _SQUID_WINDOWS_
     const int result = socket_read_method(fd_, buf, size);
@@ -147,6 +189,107 @@ Ssl::Bio::read(char *buf, int size, BIO *table)
     return result;
 }
 
+long
+Ssl::Bio::ktlsCtrl(const int cmd, const long arg1, void *arg2)
+{
+#if SQUID_OPENSSL_KTLS
+    switch (cmd) {
+    case BIO_CTRL_GET_KTLS_SEND:
+        return ktlsSending_ ? 1 : 0;
+
+    case BIO_CTRL_GET_KTLS_RECV:
+        return ktlsReceiving_ ? 1 : 0;
+
+    case SquidBioCtrlSetKtls:
+        return arg2 ? startKtls(cmd, arg1, arg2) : 0;
+
+    case SquidBioCtrlSetKtlsTxSendCtrlMsg:
+    case SquidBioCtrlClearKtlsTxCtrlMsg:
+        // the type of the next record that the kernel should frame
+        return ktlsSending_ ? BIO_ctrl(ktlsSocket_, cmd, arg1, arg2) : 0;
+    }
+
+    debugs(83, 7, "FD " << fd_ << " ignores BIO_ctrl command " << cmd);
+    return 0;
+#else
+    (void)cmd;
+    (void)arg1;
+    (void)arg2;
+    return 0;
+#endif
+}
+
+#if SQUID_OPENSSL_KTLS
+long
+Ssl::Bio::startKtls(const int cmd, const long arg1, void *arg2)
+{
+    const auto sending = arg1 != 0; // OpenSSL passes the key direction here
+    const auto direction = sending ? "send" : "receive";
+    if (!ktlsCompatible(sending)) {
+        debugs(83, 3, "FD " << fd_ << " keeps user space TLS " << direction << " while rewriting or buffering records");
+        ++KtlsStats.refusedByBio;
+        return 0;
+    }
+
+    if (!ktlsSocket_ && !(ktlsSocket_ = BIO_new_socket(fd_, BIO_NOCLOSE))) {
+        debugs(83, 2, "FD " << fd_ << " cannot create a kTLS socket BIO" << Ssl::ReportAndForgetErrors);
+        ++KtlsStats.refusedByKernel;
+        return 0;
+    }
+
+    const auto result = BIO_ctrl(ktlsSocket_, cmd, arg1, arg2);
+
+    if (!ktlsSending_ && BIO_get_ktls_send(ktlsSocket_)) {
+        debugs(83, 3, "FD " << fd_ << " kernel now handles TLS send");
+        ktlsSending_ = true;
+        ++KtlsStats.sendStarts;
+    } else if (!ktlsReceiving_ && BIO_get_ktls_recv(ktlsSocket_)) {
+        debugs(83, 3, "FD " << fd_ << " kernel now handles TLS receive");
+        ktlsReceiving_ = true;
+        ++KtlsStats.receiveStarts;
+    } else {
+        // for example, the kernel lacks the tls module or the negotiated cipher
+        debugs(83, 3, "FD " << fd_ << " kernel declined TLS " << direction << " offload; using user space TLS");
+        ++KtlsStats.refusedByKernel;
+    }
+    return result;
+}
+#endif
+
+/// writes plain payload (or a TLS control record set via ktlsCtrl()) for the kernel to encrypt
+int
+Ssl::Bio::ktlsWrite(const char *buf, int size, BIO *table)
+{
+    const auto result = BIO_write(ktlsSocket_, buf, size);
+    debugs(83, 5, "FD " << fd_ << " kTLS wrote " << result << " <= " << size);
+
+    BIO_clear_retry_flags(table);
+    if (result > 0) {
+        ktlsBytesSent_ += result;
+        KtlsStats.bytesSent += result;
+    } else if (BIO_should_retry(ktlsSocket_)) {
+        BIO_set_retry_write(table);
+    }
+    return result;
+}
+
+/// reads a kernel-decrypted TLS record (with a header rebuilt by OpenSSL)
+int
+Ssl::Bio::ktlsRead(char *buf, int size, BIO *table)
+{
+    const auto result = BIO_read(ktlsSocket_, buf, size);
+    debugs(83, 5, "FD " << fd_ << " kTLS read " << result << " <= " << size);
+
+    BIO_clear_retry_flags(table);
+    if (result > 0) {
+        ktlsBytesReceived_ += result;
+        KtlsStats.bytesReceived += result;
+    } else if (BIO_should_retry(ktlsSocket_)) {
+        BIO_set_retry_read(table);
+    }
+    return result;
+}
+
 /// Called whenever the SSL connection state changes, an alert appears, or an
 /// error occurs. See SSL_set_info_callback().
 void
@@ -195,6 +338,17 @@ Ssl::ClientBio::stateChanged(const SSL *ssl, int where, int ret)
     }
 }
 
+bool
+Ssl::ClientBio::ktlsCompatible(const bool sending) const
+{
+    if (abortReason)
+        return false;
+    if (sending)
+        return !holdWrite_;
+    // the kernel cannot decrypt bytes we have already read from the socket
+    return !holdRead_ && rbuf.isEmpty();
+}
+
 int
 Ssl::ClientBio::write(const char *buf, int size, BIO *table)
 {
@@ -429,6 +583,18 @@ Ssl::ServerBio::flush(BIO *table)
     }
 }
 
+bool
+Ssl::ServerBio::ktlsCompatible(const bool sending) const
+{
+    // peeked connections may still be spliced, relaying raw TLS bytes
+    if (allowSplice)
+        return false;
+    if (sending)
+        return !holdWrite_ && helloMsg.isEmpty();
+    // the kernel cannot decrypt bytes we have already read from the socket
+    return parsedHandshake && !record_ && rbufConsumePos >= rbuf.length();
+}
+
 bool
 Ssl::ServerBio::resumingSession()
 {
@@ -548,7 +714,33 @@ squid_bio_ctrl(BIO *table, int cmd, long arg1, void *arg2)
         case BIO_CTRL_PENDING:
         case BIO_CTRL_WPENDING:
     */
+
+    case BIO_CTRL_PUSH:
+    case BIO_CTRL_POP:
+        // OpenSSL notifies us when a filter BIO (e.g., a buffering BIO used
+        // during handshakes) is added to or removed from our chain
+        return 0;
+
+#if SQUID_OPENSSL_KTLS
+    case BIO_CTRL_EOF:
+    case BIO_CTRL_GET_CLOSE:
+    case BIO_CTRL_SET_CLOSE:
+#if defined(BIO_CTRL_GET_RPOLL_DESCRIPTOR)
+    case BIO_CTRL_GET_RPOLL_DESCRIPTOR:
+    case BIO_CTRL_GET_WPOLL_DESCRIPTOR:
+#endif
+        // socket BIOs answer these, but their answers do not describe us
+        return 0;
+#endif
+
     default:
+#if SQUID_OPENSSL_KTLS
+        if (BIO_get_init(table)) {
+            Ssl::Bio *bio = static_cast<Ssl::Bio*>(BIO_get_data(table));
+            assert(bio);
+            return bio->ktlsCtrl(cmd, arg1, arg2);
+        }
+#endif
         return 0;
 
     }
@@ -628,5 +820,33 @@ applyTlsDetailsToSSL(SSL *ssl, Security::TlsDetails::Pointer const &details, Ssl
 #endif
 }
 
+/// cache manager report on kernel TLS offload (SSL_OP_ENABLE_KTLS)
+static void
+KtlsReport(StoreEntry *sentry)
+{
+    storeAppendPrintf(sentry, "Kernel TLS offload:\n");
+#if !SQUID_OPENSSL_KTLS
+    storeAppendPrintf(sentry, "(not supported by this OpenSSL build)\n");
+#endif
+    storeAppendPrintf(sentry, "connections sending via kTLS: %" PRIu64 "\n", KtlsStats.sendStarts);
+    storeAppendPrintf(sentry, "connections receiving via kTLS: %" PRIu64 "\n", KtlsStats.receiveStarts);
+    storeAppendPrintf(sentry, "offloads declined while buffering records: %" PRIu64 "\n", KtlsStats.refusedByBio);
+    storeAppendPrintf(sentry, "offloads declined by the kernel: %" PRIu64 "\n", KtlsStats.refusedByKernel);
+    storeAppendPrintf(sentry, "bytes sent via kTLS: %" PRIu64 "\n", KtlsStats.bytesSent);
+    storeAppendPrintf(sentry, "bytes received via kTLS: %" PRIu64 "\n", KtlsStats.bytesReceived);
+}
+
+/// registers the kernel TLS cache manager report
+class KtlsReportRr: public RegisteredRunner
+{
+public:
+    /* RegisteredRunner API */
+    void useConfig() override {
+        Mgr::RegisterAction("tls_ktls", "Kernel TLS offload statistics", KtlsReport, 0, 1);
+    }
+};
+
+DefineRunnerRegistrator(KtlsReportRr);
+
 #endif // USE_OPENSSL
 
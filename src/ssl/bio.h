@@ -59,9 +59,45 @@ public:
     static void Link(SSL *ssl, BIO *bio);
 
     const SBuf &rBufData() {return rbuf;} ///< The buffered input data
+
+    /// Handles a BIO_ctrl() command that squid_bio_ctrl() does not know,
+    /// including kernel TLS (SSL_OP_ENABLE_KTLS) commands that OpenSSL
+    /// reserves for itself and forwards them to the kernel TLS socket.
+    long ktlsCtrl(int cmd, long arg1, void *arg2);
+
+    /// whether the kernel encrypts the data we write
+    bool ktlsSending() const { return ktlsSending_; }
+
+    /// whether the kernel decrypts the data we read
+    bool ktlsReceiving() const { return ktlsReceiving_; }
+
 protected:
+    /// Whether our state allows the kernel to take over the given direction.
+    /// Bios that buffer or rewrite TLS records must refuse while they do so.
+    virtual bool ktlsCompatible(bool) const { return true; }
+
     const int fd_; ///< the SSL socket we are reading and writing
     SBuf rbuf;  ///< Used to buffer input data.
+
+private:
+    /// Handles OpenSSL request to move TLS keys for the arg1 direction into
+    /// the kernel. Returns zero if OpenSSL should keep encrypting (or
+    /// decrypting) in user space.
+    long startKtls(int cmd, long arg1, void *arg2);
+
+    int ktlsWrite(const char *buf, int size, BIO *table);
+    int ktlsRead(char *buf, int size, BIO *table);
+
+    /// OpenSSL socket BIO sharing our fd; OpenSSL knows how to configure
+    /// kernel TLS through it and how to exchange TLS control records with
+    /// the kernel after that
+    BIO *ktlsSocket_ = nullptr;
+
+    bool ktlsSending_ = false; ///< whether writes go through ktlsSocket_
+    bool ktlsReceiving_ = false; ///< whether reads go through ktlsSocket_
+
+    uint64_t ktlsBytesSent_ = 0; ///< payload bytes encrypted by the kernel
+    uint64_t ktlsBytesReceived_ = 0; ///< payload bytes decrypted by the kernel
 };
 
 /// BIO node to handle socket IO for squid client side
@@ -89,6 +125,11 @@ public:
     /// Used to pass payload data (normally client HELLO data) retrieved
     /// by the caller.
     void setReadBufData(SBuf &data) {rbuf = data;}
+
+protected:
+    /* Bio API */
+    bool ktlsCompatible(bool sending) const override;
+
 private:
     /// approximate size of a time window for computing client-initiated renegotiation rate (in seconds)
     static const time_t RenegotiationsWindow = 10;
@@ -169,6 +210,10 @@ public:
     /// \return the TLS Details advertised by TLS server.
     const Security::TlsDetails::Pointer &receivedHelloDetails() const {return parser_.details;}
 
+protected:
+    /* Bio API */
+    bool ktlsCompatible(bool sending) const override;
+
 private:
     int readAndGive(char *buf, const int size, BIO *table);
     int readAndParse(char *buf, const int size, BIO *table);
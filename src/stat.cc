@@ -10,6 +10,8 @@
 
 #include "squid.h"
 #include "AccessLogEntry.h"
+#include "acl/Acl.h"
+#include "base/PackableStream.h"
 #include "CacheDigest.h"
 #include "CachePeer.h"
 #include "CachePeers.h"
@@ -24,6 +26,7 @@
 #include "http/Stream.h"
 #include "HttpRequest.h"
 #include "IoStats.h"
+#include "ipc/mem/Numa.h"
 #include "mem/Pool.h"
 #include "mem/Stats.h"
 #include "mem_node.h"
@@ -88,6 +91,8 @@ static double statCPUUsage(int minutes);
 static OBJH stat_objects_get;
 static OBJH stat_vmobjects_get;
 static OBJH statOpenfdObj;
+static OBJH statNuma;
+static OBJH statAclMemo;
 static EVH statObjects;
 static OBJH statCountersDump;
 static OBJH statPeerSelect;
@@ -413,6 +418,22 @@ statOpenfdObj(StoreEntry * sentry)
     statObjectsStart(sentry, statObjectsOpenfdFilter);
 }
 
+static void
+statNuma(StoreEntry *sentry)
+{
+    PackableStream stream(*sentry);
+    Ipc::Mem::Numa::Stat(stream);
+    stream.flush();
+}
+
+static void
+statAclMemo(StoreEntry *sentry)
+{
+    PackableStream stream(*sentry);
+    Acl::ReportMemoStats(stream);
+    stream.flush();
+}
+
 #if XMALLOC_STATISTICS
 static void
 info_get_mallstat(int size, int number, int oldnum, void *data)
@@ -1198,6 +1219,8 @@ statRegisterWithCacheManager(void)
 #endif
     Mgr::RegisterAction("openfd_objects", "Objects with Swapout files open",
                         statOpenfdObj, 0, 0);
+    Mgr::RegisterAction("numa", "NUMA Memory Placement", statNuma, 0, 1);
+    Mgr::RegisterAction("acl_memo", "ACL Result Memoization Statistics", statAclMemo, 0, 1);
 #if STAT_GRAPHS
     Mgr::RegisterAction("graph_variables", "Display cache metrics graphically",
                         statGraphDump, 0, 1);
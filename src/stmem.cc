@@ -9,12 +9,14 @@
 /* DEBUG: section 19    Store Memory Primitives */
 
 #include "squid.h"
-#include "Generic.h"
+#include "fatal.h"
 #include "HttpReply.h"
 #include "mem_node.h"
 #include "MemObject.h"
 #include "stmem.h"
 
+#include <algorithm>
+
 /*
  * NodeGet() is called to get the data buffer to pass to storeIOWrite().
  * By setting the write_pending flag here we are assuming that there
@@ -33,10 +35,8 @@ mem_hdr::NodeGet(mem_node * aNode)
 int64_t
 mem_hdr::lowestOffset () const
 {
-    const SplayNode<mem_node *> *theStart = nodes.start();
-
-    if (theStart)
-        return theStart->data->nodeBuffer.offset;
+    if (!nodes.empty())
+        return nodes.front()->nodeBuffer.offset;
 
     return 0;
 }
@@ -45,10 +45,9 @@ int64_t
 mem_hdr::endOffset () const
 {
     int64_t result = 0;
-    const SplayNode<mem_node *> *theEnd = nodes.finish();
 
-    if (theEnd)
-        result = theEnd->data->dataRange().end;
+    if (!nodes.empty())
+        result = nodes.back()->dataRange().end;
 
     assert (result == inmem_hi);
 
@@ -58,21 +57,26 @@ mem_hdr::endOffset () const
 void
 mem_hdr::freeContent()
 {
-    nodes.destroy();
+    for (const auto node: nodes)
+        delete node;
+    nodes.clear();
     inmem_hi = 0;
     debugs(19, 9, this << " hi: " << inmem_hi);
 }
 
+/// removes the lowest node
+/// \returns false if the node cannot be removed now
 bool
-mem_hdr::unlink(mem_node *aNode)
+mem_hdr::unlinkFirst()
 {
+    const auto aNode = nodes.front();
     if (aNode->write_pending) {
         debugs(0, DBG_CRITICAL, "ERROR: cannot unlink mem_node " << aNode << " while write_pending");
         return false;
     }
 
     debugs(19, 8, this << " removing " << aNode);
-    nodes.remove (aNode, NodeCompare);
+    nodes.pop_front();
     delete aNode;
     return true;
 }
@@ -82,16 +86,11 @@ mem_hdr::freeDataUpto(int64_t target_offset)
 {
     debugs(19, 8, this << " up to " << target_offset);
     /* keep the last one to avoid change to other part of code */
-    SplayNode<mem_node*> const * theStart;
-
-    while ((theStart = nodes.start())) {
-        if (theStart == nodes.finish())
+    while (nodes.size() > 1) {
+        if (nodes.front()->end() > target_offset )
             break;
 
-        if (theStart->data->end() > target_offset )
-            break;
-
-        if (!unlink(theStart->data))
+        if (!unlinkFirst())
             break;
     }
 
@@ -124,10 +123,22 @@ mem_hdr::writeAvailable(mem_node *aNode, int64_t location, size_t amount, char c
     return copyLen;
 }
 
-void
-mem_hdr::appendNode (mem_node *aNode)
+/// \returns the index of the first node ending after the given location
+/// or, if there is no such node, nodes.size()
+size_t
+mem_hdr::findNode(const int64_t location) const
 {
-    nodes.insert (aNode, NodeCompare);
+    if (nodes.empty() || location < nodes.front()->start())
+        return 0;
+
+    // optimization: all nodes are usually full and adjacent
+    const auto guess = static_cast<uint64_t>(location - nodes.front()->start()) / nodes.front()->capacity;
+    if (guess < nodes.size() && nodes[guess]->contains(location))
+        return guess;
+
+    const auto pos = std::upper_bound(nodes.begin(), nodes.end(), location,
+    [](const int64_t loc, const mem_node *node) { return loc < node->end(); });
+    return pos - nodes.begin();
 }
 
 /* returns a mem_node that contains location..
@@ -136,13 +147,9 @@ mem_hdr::appendNode (mem_node *aNode)
 mem_node *
 mem_hdr::getBlockContainingLocation (int64_t location) const
 {
-    // Optimize: do not create a whole mem_node just to store location
-    mem_node target (location);
-    target.nodeBuffer.length = 1;
-    mem_node *const *result = nodes.find (&target, NodeCompare);
-
-    if (result)
-        return *result;
+    const auto pos = findNode(location);
+    if (pos < nodes.size() && nodes[pos]->contains(location))
+        return nodes[pos];
 
     return nullptr;
 }
@@ -171,8 +178,8 @@ mem_hdr::debugDump() const
 {
     debugs (19, 0, "mem_hdr::debugDump: lowest offset: " << lowestOffset() << " highest offset + 1: " << endOffset() << ".");
     std::ostringstream result;
-    PointerPrinter<mem_node *> foo(result, " - ");
-    getNodes().visit(foo);
+    for (const auto node: nodes)
+        result << *node << " - ";
     debugs (19, 0, "mem_hdr::debugDump: Current available data is: " << result.str() << ".");
 }
 
@@ -192,7 +199,7 @@ mem_hdr::copy(StoreIOBuffer const &target) const
 
     /* we shouldn't ever ask for absent offsets */
 
-    if (nodes.size() == 0) {
+    if (nodes.empty()) {
         debugs(19, DBG_IMPORTANT, "mem_hdr::copy: No data to read");
         debugDump();
         assert (0);
@@ -203,9 +210,9 @@ mem_hdr::copy(StoreIOBuffer const &target) const
     assert(target.length > 0);
 
     /* Seek our way into store */
-    mem_node *p = getBlockContainingLocation(target.offset);
+    auto pos = findNode(target.offset);
 
-    if (!p) {
+    if (pos >= nodes.size() || !nodes[pos]->contains(target.offset)) {
         debugs(19, DBG_IMPORTANT, "ERROR: memCopy: could not find start of " << target.range() <<
                " in memory.");
         debugDump();
@@ -220,8 +227,8 @@ mem_hdr::copy(StoreIOBuffer const &target) const
     /* Start copying beginning with this block until
      * we're satiated */
 
-    while (p && bytes_to_go > 0) {
-        size_t bytes_to_copy = copyAvailable (p,
+    while (pos < nodes.size() && bytes_to_go > 0) {
+        size_t bytes_to_copy = copyAvailable (nodes[pos],
                                               location, bytes_to_go, ptr_to_buf);
 
         /* hit a sparse patch */
@@ -235,7 +242,7 @@ mem_hdr::copy(StoreIOBuffer const &target) const
 
         bytes_to_go -= bytes_to_copy;
 
-        p = getBlockContainingLocation(location);
+        ++pos;
     }
 
     return target.length - bytes_to_go;
@@ -246,8 +253,8 @@ mem_hdr::hasContigousContentRange(Range<int64_t> const & range) const
 {
     int64_t currentStart = range.start;
 
-    while (mem_node *curr = getBlockContainingLocation(currentStart)) {
-        currentStart = curr->end();
+    for (auto pos = findNode(currentStart); pos < nodes.size() && nodes[pos]->contains(currentStart); ++pos) {
+        currentStart = nodes[pos]->end();
 
         if (currentStart >= range.end)
             return true;
@@ -260,9 +267,10 @@ bool
 mem_hdr::unionNotEmpty(StoreIOBuffer const &candidate)
 {
     assert (candidate.offset >= 0);
-    mem_node target(candidate.offset);
-    target.nodeBuffer.length = candidate.length;
-    return nodes.find (&target, NodeCompare);
+    if (!candidate.length)
+        return false;
+    const auto pos = findNode(candidate.offset);
+    return pos < nodes.size() && nodes[pos]->start() < candidate.range().end;
 }
 
 mem_node *
@@ -270,30 +278,28 @@ mem_hdr::nodeToRecieve(int64_t offset)
 {
     /* case 1: Nothing in memory */
 
-    if (!nodes.size()) {
-        appendNode (new mem_node(offset));
-        return nodes.start()->data;
+    if (nodes.empty()) {
+        nodes.push_back(new mem_node(offset));
+        return nodes.back();
     }
 
-    mem_node *candidate = nullptr;
-    /* case 2: location fits within an extant node */
+    /* case 2: location fits within an extant node; usually the last one */
 
-    if (offset > 0) {
-        mem_node search (offset - 1);
-        search.nodeBuffer.length = 1;
-        mem_node *const *leadup =  nodes.find (&search, NodeCompare);
+    if (nodes.back()->canAccept(offset))
+        return nodes.back();
 
-        if (leadup)
-            candidate = *leadup;
+    if (offset > 0) {
+        if (const auto leadup = getBlockContainingLocation(offset - 1)) {
+            if (leadup->canAccept(offset))
+                return leadup;
+        }
     }
 
-    if (candidate && candidate->canAccept(offset))
-        return candidate;
-
     /* candidate can't accept, so we need a new node */
-    candidate = new mem_node(offset);
+    const auto candidate = new mem_node(offset);
 
-    appendNode (candidate);
+    // write() checks that no node overlaps the written area
+    nodes.insert(nodes.begin() + findNode(offset), candidate);
 
     /* simpler to write than a indented if */
     return candidate;
@@ -339,27 +345,11 @@ mem_hdr::~mem_hdr()
     freeContent();
 }
 
-/* splay of mem nodes:
- * conditions:
- * a = b if a.intersection(b).size > 0;
- * a < b if a < b
- */
-int
-mem_hdr::NodeCompare(mem_node * const &left, mem_node * const &right)
-{
-    // possibly Range can help us at some point.
-
-    if (left->dataRange().intersection(right->dataRange()).size() > 0)
-        return 0;
-
-    return *left < *right ? -1 : 1;
-}
-
 void
 mem_hdr::dump() const
 {
-    debugs(20, DBG_IMPORTANT, "mem_hdr: " << (void *)this << " nodes.start() " << nodes.start());
-    debugs(20, DBG_IMPORTANT, "mem_hdr: " << (void *)this << " nodes.finish() " << nodes.finish());
+    debugs(20, DBG_IMPORTANT, "mem_hdr: " << (void *)this << " nodes.front() " << (nodes.empty() ? nullptr : nodes.front()));
+    debugs(20, DBG_IMPORTANT, "mem_hdr: " << (void *)this << " nodes.back() " << (nodes.empty() ? nullptr : nodes.back()));
 }
 
 size_t
@@ -368,7 +358,7 @@ mem_hdr::size() const
     return nodes.size();
 }
 
-const Splay<mem_node *> &
+const mem_hdr::Nodes &
 mem_hdr::getNodes() const
 {
     return nodes;
@@ -10,7 +10,9 @@
 #define SQUID_SRC_STMEM_H
 
 #include "base/Range.h"
-#include "splay.h"
+#include "fatal.h"
+
+#include <deque>
 
 class mem_node;
 
@@ -33,24 +35,33 @@ public:
     void dump() const;
     size_t size() const;
     mem_node *getBlockContainingLocation (int64_t location) const;
+
+    /// nodes ordered by their offsets; nodes never overlap
+    using Nodes = std::deque<mem_node *>;
+
     /* access the contained nodes - easier than punning
      * as a container ourselves
      */
-    const Splay<mem_node *> &getNodes() const;
+    const Nodes &getNodes() const;
     char * NodeGet(mem_node * aNode);
 
-    static Splay<mem_node *>::SPLAYCMP NodeCompare;
-
 private:
     void debugDump() const;
-    bool unlink(mem_node *aNode);
-    void appendNode (mem_node *aNode);
+    bool unlinkFirst();
+    size_t findNode(int64_t location) const;
     size_t copyAvailable(mem_node *aNode, int64_t location, size_t amount, char *target) const;
     bool unionNotEmpty (StoreIOBuffer const &);
     mem_node *nodeToRecieve(int64_t offset);
     size_t writeAvailable(mem_node *aNode, int64_t location, size_t amount, char const *source);
     int64_t inmem_hi;
-    Splay<mem_node *> nodes;
+
+    /// All nodes but the last one are usually full and adjacent, so the
+    /// node containing a given offset is usually found by dividing the
+    /// distance from the first node by the node capacity. Nodes freed from the
+    /// front (see freeDataUpto()) do not affect that arithmetic. Sparse
+    /// content falls back to a binary search. Unlike the Splay tree used
+    /// earlier, lookups do not modify this index.
+    Nodes nodes;
 };
 
 #endif /* SQUID_SRC_STMEM_H */
@@ -29,6 +29,7 @@
 #include "http.h"
 #include "HttpReply.h"
 #include "HttpRequest.h"
+#include "ipc/QueueWakeups.h"
 #include "mem_node.h"
 #include "MemObject.h"
 #include "MemStore.h"
@@ -44,6 +45,7 @@
 #include "store/Controller.h"
 #include "store/Disk.h"
 #include "store/Disks.h"
+#include "store/EntryIndex.h"
 #include "store/SwapMetaOut.h"
 #include "store_digest.h"
 #include "store_key_md5.h"
@@ -135,6 +137,8 @@ StatQueues(StoreEntry *e)
 {
     assert(e);
     PackableStream stream(*e);
+    Ipc::QueueWakeups::Stat(stream);
+    stream << "\n";
     CollapsedForwarding::StatQueue(stream);
 #if HAVE_DISKIO_MODULE_IPCIO
     stream << "\n";
@@ -403,7 +407,7 @@ void
 destroyStoreEntry(void *data)
 {
     debugs(20, 3, "destroyStoreEntry: destroying " <<  data);
-    StoreEntry *e = static_cast<StoreEntry *>(static_cast<hash_link *>(data));
+    StoreEntry *e = static_cast<StoreEntry *>(data);
     assert(e != nullptr);
 
     if (e->hasDisk())
@@ -426,14 +430,14 @@ StoreEntry::hashInsert(const cache_key * someKey)
     debugs(20, 3, "StoreEntry::hashInsert: Inserting Entry " << *this << " key '" << storeKeyText(someKey) << "'");
     assert(!key);
     key = storeKeyDup(someKey);
-    hash_join(store_table, this);
+    store_table->insert(*this);
 }
 
 void
 StoreEntry::hashDelete()
 {
     if (key) { // some test cases do not create keys and do not hashInsert()
-        hash_remove_link(store_table, this);
+        store_table->erase(*this);
         storeKeyFree((const cache_key *)key);
         key = nullptr;
     }
@@ -565,7 +569,7 @@ StoreEntry::setPrivateKey(const bool shareable, const bool permanent)
         mem_obj->id = getKeyCounter();
     const cache_key *newkey = storeKeyPrivate();
 
-    assert(hash_lookup(store_table, newkey) == nullptr);
+    assert(!store_table->find(newkey));
     EBIT_SET(flags, KEY_PRIVATE);
     shareableWhenPrivate = shareable;
     hashInsert(newkey);
@@ -628,7 +632,7 @@ StoreEntry::forcePublicKey(const cache_key *newkey)
     debugs(20, 3, storeKeyText(newkey) << " for " << *this);
     assert(mem_obj);
 
-    if (StoreEntry *e2 = (StoreEntry *)hash_lookup(store_table, newkey)) {
+    if (StoreEntry *e2 = store_table->find(newkey)) {
         assert(e2 != this);
         debugs(20, 3, "releasing clashing " << *e2);
         e2->release(true);
@@ -1166,7 +1170,7 @@ StoreEntry::release(const bool shareable)
 
     storeLog(STORE_LOG_RELEASE, this);
     Store::Root().evictCached(*this);
-    destroyStoreEntry(static_cast<hash_link *>(this));
+    destroyStoreEntry(this);
 }
 
 static void
@@ -1499,7 +1503,6 @@ void
 StoreEntry::dump(int l) const
 {
     debugs(20, l, "StoreEntry->key: " << getMD5Text());
-    debugs(20, l, "StoreEntry->next: " << next);
     debugs(20, l, "StoreEntry->mem_obj: " << mem_obj);
     debugs(20, l, "StoreEntry->timestamp: " << timestamp);
     debugs(20, l, "StoreEntry->lastref: " << lastref);
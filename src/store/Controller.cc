@@ -15,6 +15,7 @@
 #include "SquidMath.h"
 #include "store/Controller.h"
 #include "store/Disks.h"
+#include "store/EntryIndex.h"
 #include "store/forward.h"
 #include "store/LocalSearch.h"
 #include "tools.h"
@@ -193,7 +194,7 @@ Store::Controller::configure()
                                (float) Config.Swap.highWaterMark) / (float) 100);
     store_swap_low = (long) (((float) maxSize() *
                               (float) Config.Swap.lowWaterMark) / (float) 100);
-    store_pages_max = Config.memMaxSize / sizeof(mem_node);
+    store_pages_max = Config.memMaxSize / (sizeof(mem_node) + mem_node::PageSize());
 
     // TODO: move this into a memory cache class when we have one
     const int64_t memMax = static_cast<int64_t>(min(Config.Store.maxInMemObjSize, Config.memMaxSize));
@@ -395,7 +396,7 @@ Store::Controller::findCallbackXXX(const cache_key *key)
     // member or use an HTCP/ICP-specific index rather than store_table.
 
     // cannot reuse peekAtLocal() because HTCP/ICP callbacks may use private keys
-    return static_cast<StoreEntry*>(hash_lookup(store_table, key));
+    return store_table->find(key);
 }
 
 /// \returns either an existing local reusable StoreEntry object or nil
@@ -404,7 +405,7 @@ Store::Controller::findCallbackXXX(const cache_key *key)
 StoreEntry *
 Store::Controller::peekAtLocal(const cache_key *key)
 {
-    if (StoreEntry *e = static_cast<StoreEntry*>(hash_lookup(store_table, key))) {
+    if (StoreEntry *e = store_table->find(key)) {
         // callers must only search for public entries
         assert(!EBIT_TEST(e->flags, KEY_PRIVATE));
         assert(e->publicKey());
@@ -521,7 +522,8 @@ Store::Controller::memoryCacheHasSpaceFor(const int pagesRequired) const
 void
 Store::Controller::freeMemorySpace(const int bytesRequired)
 {
-    const auto pagesRequired = (bytesRequired + SM_PAGE_SIZE-1) / SM_PAGE_SIZE;
+    const auto pageSize = static_cast<int>(mem_node::PageSize());
+    const auto pagesRequired = (bytesRequired + pageSize-1) / pageSize;
 
     if (memoryCacheHasSpaceFor(pagesRequired))
         return;
@@ -613,6 +615,13 @@ Store::Controller::memoryDisconnect(StoreEntry &e)
     // else nothing to do for non-shared memory cache
 }
 
+ssize_t
+Store::Controller::memoryRead(const StoreEntry &e, const StoreIOBuffer &buf, InPlaceReadPosition &position)
+{
+    Assure(sharedMemStore);
+    return sharedMemStore->readInPlace(e, buf, position);
+}
+
 void
 Store::Controller::noteStoppedSharedWriting(StoreEntry &e)
 {
@@ -656,7 +665,7 @@ Store::Controller::handleIdleEntry(StoreEntry &e)
     // its own index, should not stay in the global store_table.
     if (!dereferenceIdle(e, keepInLocalMemory)) {
         debugs(20, 5, "destroying unlocked entry: " << &e << ' ' << e);
-        destroyStoreEntry(static_cast<hash_link*>(&e));
+        destroyStoreEntry(&e);
         return;
     }
 
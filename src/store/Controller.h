@@ -13,6 +13,7 @@
 
 class MemObject;
 class RequestFlags;
+class StoreIOBuffer;
 class HttpRequestMethod;
 
 namespace Store {
@@ -49,6 +50,8 @@ public:
     /// Faster than find() but the returned entry may not receive updates, may
     /// lack information from some of the Stores, and should not be updated
     /// except that purging peek()ed entries is supported.
+    /// Entries loaded from cache_dirs may be missing from store_table;
+    /// \sa Fs::Ufs::UFSSwapDir::get()
     /// Does not count as an entry reference from the removal policy p.o.v.
     StoreEntry *peek(const cache_key *);
 
@@ -123,6 +126,11 @@ public:
     /// disassociates the entry from the memory cache, preserving cached data
     void memoryDisconnect(StoreEntry &);
 
+    /// copies entry bytes kept in the shared memory cache (but not in the
+    /// entry data_hdr) into the given buffer; see MemObject::MemCache::inPlace
+    /// \returns the number of copied bytes
+    ssize_t memoryRead(const StoreEntry &, const StoreIOBuffer &, InPlaceReadPosition &);
+
     /// \returns an iterator for all Store entries
     StoreSearch *search();
 
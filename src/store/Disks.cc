@@ -20,6 +20,7 @@
 #include "Store.h"
 #include "store/Disk.h"
 #include "store/Disks.h"
+#include "store/EntryIndex.h"
 #include "store_rebuild.h"
 #include "StoreFileSystem.h"
 #include "swap_log_op.h"
@@ -263,25 +264,18 @@ Store::Disks::init()
     if (Config.Store.avgObjectSize <= 0)
         fatal("'store_avg_object_size' should be larger than 0.");
 
-    /* Calculate size of hash table (maximum currently 64k buckets).  */
-    /* this is very bogus, its specific to the any Store maintaining an
-     * in-core index, not global */
-    size_t buckets = (Store::Root().maxSize() + Config.memMaxSize) / Config.Store.avgObjectSize;
+    const size_t objects = (Store::Root().maxSize() + Config.memMaxSize) / Config.Store.avgObjectSize;
     debugs(20, Important(31), "Swap maxSize " << (Store::Root().maxSize() >> 10) <<
-           " + " << ( Config.memMaxSize >> 10) << " KB, estimated " << buckets << " objects");
-    buckets /= Config.Store.objectsPerBucket;
-    debugs(20, Important(32), "Target number of buckets: " << buckets);
-    /* ideally the full scan period should be configurable, for the
-     * moment it remains at approximately 24 hours.  */
-    store_hash_buckets = storeKeyHashBuckets(buckets);
-    debugs(20, Important(33), "Using " << store_hash_buckets << " Store buckets");
+           " + " << ( Config.memMaxSize >> 10) << " KB, estimated " << objects << " objects");
+    /* The in-core index starts small and grows as entries are added. Most
+     * cached objects may never get a StoreEntry in it: shared memory caches,
+     * SMP-aware cache_dirs (e.g., rock), and compact-index ufs cache_dirs
+     * index their objects elsewhere, so the estimate above would overshoot. */
+    store_table = new Store::EntryIndex();
     debugs(20, Important(34), "Max Mem  size: " << ( Config.memMaxSize >> 10) << " KB" <<
            (Config.memShared ? " [shared]" : ""));
     debugs(20, Important(35), "Max Swap size: " << (Store::Root().maxSize() >> 10) << " KB");
 
-    store_table = hash_create(storeKeyHashCmp,
-                              store_hash_buckets, storeKeyHashHash);
-
     // Increment _before_ any possible storeRebuildComplete() calls so that
     // storeRebuildComplete() can reliably detect when all disks are done. The
     // level is decremented in each corresponding storeRebuildComplete() call.
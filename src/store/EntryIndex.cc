@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+/* DEBUG: section 20    Storage Manager */
+
+#include "squid.h"
+#include "debug/Stream.h"
+#include "md5.h"
+#include "Store.h"
+#include "store/EntryIndex.h"
+
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/// the maximum number of full and deleted slots in a table with the given
+/// number of groups; keeps probe sequences short and guarantees that every
+/// probe sequence ends at an empty slot
+static size_t
+MaxLoad(const size_t groups)
+{
+    return groups * Store::EntryIndex::GroupSize / 8 * 7;
+}
+
+/// the smallest power-of-two number of groups that can hold the given
+/// number of entries
+static size_t
+GroupsFor(const size_t entries)
+{
+    size_t groups = 1;
+    while (MaxLoad(groups) < entries)
+        groups <<= 1;
+    return groups;
+}
+
+Store::EntryIndex::EntryIndex(const size_t expectedEntries)
+{
+    rehash(GroupsFor(expectedEntries));
+}
+
+uint64_t
+Store::EntryIndex::Hash(const cache_key *key)
+{
+    // MD5 digests are uniformly distributed, but storeKeyPrivate() keys
+    // start with a sequential counter; mix its bits (MurmurHash3 finalizer)
+    uint64_t hash;
+    memcpy(&hash, key, sizeof(hash));
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+uint32_t
+Store::EntryIndex::matchGroup(const size_t group, const uint8_t control) const
+{
+    const auto base = &controls[group * GroupSize];
+#if defined(__SSE2__)
+    const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(base));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8(static_cast<char>(control))));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < GroupSize; ++i) {
+        if (base[i] == control)
+            mask |= 1U << i;
+    }
+    return mask;
+#endif
+}
+
+uint32_t
+Store::EntryIndex::matchFree(const size_t group) const
+{
+    const auto base = &controls[group * GroupSize];
+#if defined(__SSE2__)
+    // empty and deleted control bytes are the only ones with the high bit set
+    return _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(base)));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < GroupSize; ++i) {
+        if (!IsFull(base[i]))
+            mask |= 1U << i;
+    }
+    return mask;
+#endif
+}
+
+StoreEntry *
+Store::EntryIndex::find(const cache_key *key) const
+{
+    const auto hash = Hash(key);
+    const uint8_t h2 = hash & 0x7F;
+    auto group = (hash >> 7) & groupMask;
+    // triangular probing visits every group when their number is a power of two
+    for (size_t probe = 1; ; ++probe) {
+        for (auto hits = matchGroup(group, h2); hits; hits &= hits - 1) {
+            const auto entry = slots[group * GroupSize + __builtin_ctz(hits)];
+            if (memcmp(entry->key, key, SQUID_MD5_DIGEST_LENGTH) == 0)
+                return entry;
+        }
+        if (matchGroup(group, ctrlEmpty))
+            return nullptr;
+        group = (group + probe) & groupMask;
+    }
+}
+
+size_t
+Store::EntryIndex::findSlot(const StoreEntry &entry) const
+{
+    const auto hash = Hash(static_cast<const cache_key *>(entry.key));
+    const uint8_t h2 = hash & 0x7F;
+    auto group = (hash >> 7) & groupMask;
+    for (size_t probe = 1; ; ++probe) {
+        for (auto hits = matchGroup(group, h2); hits; hits &= hits - 1) {
+            const auto slot = group * GroupSize + __builtin_ctz(hits);
+            if (slots[slot] == &entry)
+                return slot;
+        }
+        assert(!matchGroup(group, ctrlEmpty)); // the entry must be indexed
+        group = (group + probe) & groupMask;
+    }
+}
+
+size_t
+Store::EntryIndex::findFreeSlot(const uint64_t hash) const
+{
+    auto group = (hash >> 7) & groupMask;
+    for (size_t probe = 1; ; ++probe) {
+        if (const auto frees = matchFree(group))
+            return group * GroupSize + __builtin_ctz(frees);
+        group = (group + probe) & groupMask;
+    }
+}
+
+void
+Store::EntryIndex::insert(StoreEntry &entry)
+{
+    assert(entry.key);
+
+    if (!growthLeft) {
+        const auto groups = groupMask + 1;
+        // reclaim deleted slots in place unless the table is at least half full
+        rehash(count >= MaxLoad(groups) / 2 ? groups * 2 : groups);
+    }
+
+    const auto hash = Hash(static_cast<const cache_key *>(entry.key));
+    const auto slot = findFreeSlot(hash);
+    if (controls[slot] == ctrlEmpty)
+        --growthLeft;
+    setControl(slot, hash & 0x7F);
+    slots[slot] = &entry;
+    ++count;
+}
+
+void
+Store::EntryIndex::erase(StoreEntry &entry)
+{
+    const auto slot = findSlot(entry);
+    // A group with an empty slot has never been full since the last
+    // rehash(), so no probe sequence went past it and the slot may become
+    // empty again. Otherwise, lookups must continue probing past this slot.
+    if (matchGroup(slot / GroupSize, ctrlEmpty)) {
+        setControl(slot, ctrlEmpty);
+        ++growthLeft;
+    } else {
+        setControl(slot, ctrlDeleted);
+    }
+    slots[slot] = nullptr;
+    --count;
+}
+
+void
+Store::EntryIndex::reserve(const size_t expectedEntries)
+{
+    if (expectedEntries > MaxLoad(groupMask + 1))
+        rehash(GroupsFor(expectedEntries));
+}
+
+void
+Store::EntryIndex::rehash(const size_t groups)
+{
+    std::vector<uint8_t> oldControls;
+    std::vector<StoreEntry *> oldSlots;
+    oldControls.swap(controls);
+    oldSlots.swap(slots);
+    controls.assign(groups * GroupSize, ctrlEmpty);
+    slots.assign(groups * GroupSize, nullptr);
+    groupMask = groups - 1;
+    assert(count <= MaxLoad(groups));
+    growthLeft = MaxLoad(groups) - count;
+
+    for (size_t i = 0; i < oldSlots.size(); ++i) {
+        if (!IsFull(oldControls[i]))
+            continue;
+        const auto hash = Hash(static_cast<const cache_key *>(oldSlots[i]->key));
+        const auto slot = findFreeSlot(hash);
+        setControl(slot, hash & 0x7F);
+        slots[slot] = oldSlots[i];
+    }
+
+    debugs(20, 3, count << " entries in " << capacity() << " slots");
+}
+
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#ifndef SQUID_SRC_STORE_ENTRYINDEX_H
+#define SQUID_SRC_STORE_ENTRYINDEX_H
+
+#include "store/forward.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Store {
+
+/// An open-addressing hash table of StoreEntry objects indexed by their
+/// cache_key (an MD5 digest). Slots are probed in aligned groups of
+/// GroupSize, each slot having a control byte that holds 7 hash bits. A
+/// lookup usually compares one group of control bytes (with a single SSE2
+/// instruction where available) and one full key, instead of walking a
+/// chain of hash_link objects.
+///
+/// Each slot costs a control byte and an entry pointer. Growth doubles the
+/// table when it is 7/8 full, so it uses 10-21 bytes per indexed entry.
+///
+/// Entries are not owned. Indexed entries must keep their key unchanged.
+class EntryIndex
+{
+public:
+    /// the number of slots probed together
+    static const size_t GroupSize = 16;
+
+    /// creates an index able to hold the given number of entries without
+    /// growing
+    explicit EntryIndex(size_t expectedEntries = 0);
+    EntryIndex(EntryIndex &&) = delete; // no copying of any kind
+
+    /// \returns the entry with the given key or nil
+    StoreEntry *find(const cache_key *) const;
+
+    /// adds an entry with a key that is not indexed yet
+    void insert(StoreEntry &);
+
+    /// removes a previously inserted entry
+    void erase(StoreEntry &);
+
+    /// grows the table (if needed) to hold the given number of entries
+    void reserve(size_t expectedEntries);
+
+    /// the number of indexed entries
+    size_t size() const { return count; }
+
+    /// the number of slots; slot positions are [0, capacity())
+    size_t capacity() const { return slots.size(); }
+
+    /// \returns the entry in the given slot or nil for an unused slot
+    /// Slot positions change when the table grows.
+    StoreEntry *at(const size_t slot) const { return IsFull(controls[slot]) ? slots[slot] : nullptr; }
+
+    /// the approximate number of bytes allocated for the table
+    size_t memoryUsed() const { return capacity() * (sizeof(uint8_t) + sizeof(StoreEntry *)); }
+
+    /// the hash of the given key; the low 7 bits go into control bytes and
+    /// the rest selects the first group to probe
+    static uint64_t Hash(const cache_key *);
+
+private:
+    /// control byte values; a full slot stores 7 hash bits instead
+    enum : uint8_t { ctrlEmpty = 0x80, ctrlDeleted = 0xFE };
+
+    static bool IsFull(const uint8_t control) { return !(control & 0x80); }
+
+    /// a bitmask of group slots with the given control byte value
+    uint32_t matchGroup(size_t group, uint8_t control) const;
+    /// a bitmask of group slots that are empty or deleted
+    uint32_t matchFree(size_t group) const;
+
+    /// the slot holding the given entry
+    size_t findSlot(const StoreEntry &) const;
+
+    /// the first empty or deleted slot in the probe sequence of the hash
+    size_t findFreeSlot(uint64_t hash) const;
+
+    void setControl(const size_t slot, const uint8_t control) { controls[slot] = control; }
+
+    /// rebuilds the table with the given number of groups,
+    /// dropping deleted slots
+    void rehash(size_t groups);
+
+    std::vector<uint8_t> controls; ///< one control byte per slot
+    std::vector<StoreEntry *> slots; ///< entries for full slots
+    size_t groupMask = 0; ///< the number of groups minus one
+    size_t count = 0; ///< the number of full slots
+    size_t growthLeft = 0; ///< empty slots usable before the next rehash()
+};
+
+} // namespace Store
+
+#endif /* SQUID_SRC_STORE_ENTRYINDEX_H */
+
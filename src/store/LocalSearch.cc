@@ -11,9 +11,12 @@
 #include "squid.h"
 #include "debug/Stream.h"
 #include "globals.h"
+#include "store/EntryIndex.h"
 #include "store/LocalSearch.h"
 #include "StoreSearch.h"
 
+#include <algorithm>
+
 namespace Store {
 
 /// iterates local store_table
@@ -30,9 +33,9 @@ public:
     StoreEntry *currentItem() override;
 
 private:
-    void copyBucket();
+    void copyGroup();
     bool _done = false;
-    int bucket = 0;
+    size_t slot = 0; ///< the next store_table slot to copy
     std::vector<StoreEntry *> entries;
 };
 
@@ -60,7 +63,7 @@ Store::LocalSearch::next()
         entries.pop_back();
 
     while (!isDone() && !entries.size())
-        copyBucket();
+        copyGroup();
 
     return currentItem() != nullptr;
 }
@@ -74,7 +77,7 @@ Store::LocalSearch::error() const
 bool
 Store::LocalSearch::isDone() const
 {
-    return bucket >= store_hash_buckets || _done;
+    return (slot >= store_table->capacity() && entries.empty()) || _done;
 }
 
 StoreEntry *
@@ -86,27 +89,26 @@ Store::LocalSearch::currentItem()
     return entries.back();
 }
 
+/// copies entries from the next group of store_table slots
+/// If store_table grows during the search, some entries may be visited twice
+/// or not at all.
 void
-Store::LocalSearch::copyBucket()
+Store::LocalSearch::copyGroup()
 {
     /* probably need to lock the store entries...
-     * we copy them all to prevent races on the links. */
+     * we copy them all to prevent races on the index. */
     assert (!entries.size());
-    hash_link *link_ptr = nullptr;
-    hash_link *link_next = nullptr;
-    link_next = hash_get_bucket(store_table, bucket);
-
-    while (nullptr != (link_ptr = link_next)) {
-        link_next = link_ptr->next;
-        StoreEntry *e = (StoreEntry *) link_ptr;
-
-        entries.push_back(e);
+    const auto end = std::min(slot + Store::EntryIndex::GroupSize, store_table->capacity());
+    for (auto pos = end; pos > slot; --pos) {
+        // reverse order so that currentItem() yields entries in slot order
+        if (const auto e = store_table->at(pos - 1))
+            entries.push_back(e);
     }
 
     // minimize debugging: we may be called more than a million times on startup
     if (const auto count = entries.size())
-        debugs(47, 8, "bucket #" << bucket << " entries: " << count);
+        debugs(47, 8, "slots " << slot << '-' << end << " entries: " << count);
 
-    ++bucket;
+    slot = end;
 }
 
@@ -46,8 +46,18 @@ class Disks;
 class Disk;
 class DiskConfig;
 class EntryGuard;
+class EntryIndex;
 class ParsingBuffer;
 
+/// Where the previous MemStore::readInPlace() call stopped in the slice chain
+/// of an entry. Lets sequential readers resume without rescanning the chain.
+class InPlaceReadPosition
+{
+public:
+    int32_t slice = -1; ///< the last read slice or -1 (i.e. the chain start)
+    int64_t sliceOffset = 0; ///< entry offset of the first slice byte
+};
+
 typedef ::StoreEntry Entry;
 typedef ::MemStore Memory;
 typedef ::Transients Transients;
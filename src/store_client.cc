@@ -498,9 +498,13 @@ store_client::canReadFromMemory() const
 {
     const auto &mem = entry->mem();
     const auto memReadOffset = nextHttpReadOffset();
+    if (!parsingBuffer->spaceSize())
+        return false;
     // XXX: This (lo <= offset < end) logic does not support Content-Range gaps.
-    return mem.inmem_lo <= memReadOffset && memReadOffset < mem.endOffset() &&
-           parsingBuffer->spaceSize();
+    if (mem.inmem_lo <= memReadOffset && memReadOffset < mem.endOffset())
+        return true;
+    // the remaining bytes may be in the shared memory cache only
+    return mem.memCache.inPlace && memReadOffset < mem.object_sz;
 }
 
 /// The offset of the next stored HTTP response byte wanted by the client.
@@ -528,7 +532,10 @@ store_client::readFromMemory()
     const auto readInto = parsingBuffer->space().positionAt(nextHttpReadOffset());
 
     debugs(90, 3, "copying HTTP body bytes from memory into " << readInto);
-    const auto sz = entry->mem_obj->data_hdr.copy(readInto);
+    const auto &mem = entry->mem();
+    const auto sz = readInto.offset < mem.endOffset() ?
+                    mem.data_hdr.copy(readInto) :
+                    Store::Root().memoryRead(*entry, readInto, inPlacePosition); // no data_hdr copy
     Assure(sz > 0); // our canReadFromMemory() precondition guarantees that
     parsingBuffer->appended(readInto.data, sz);
 }
@@ -31,6 +31,7 @@
 #include "refresh.h"
 #include "SquidConfig.h"
 #include "Store.h"
+#include "store/EntryIndex.h"
 #include "StoreSearch.h"
 #include "util.h"
 
@@ -385,16 +386,16 @@ storeDigestRebuildFinish(void)
         storeDigestRewriteResume();
 }
 
-/* recalculate a few hash buckets per invocation; schedules next step */
+/* recalculate a few index slots per invocation; schedules next step */
 static void
 storeDigestRebuildStep(void *)
 {
     /* TODO: call Store::Root().size() to determine this.. */
-    int count = Config.Store.objectsPerBucket * (int) ceil((double) store_hash_buckets *
-                (double) Config.digest.rebuild_chunk_percentage / 100.0);
+    int count = (int) ceil((double) store_table->capacity() *
+                           (double) Config.digest.rebuild_chunk_percentage / 100.0);
     assert(sd_state.rebuild_lock);
 
-    debugs(71, 3, "storeDigestRebuildStep: buckets: " << store_hash_buckets << " entries to check: " << count);
+    debugs(71, 3, "storeDigestRebuildStep: slots: " << store_table->capacity() << " entries to check: " << count);
 
     while (count-- && !sd_state.theSearch->isDone() && sd_state.theSearch->next())
         storeDigestAdd(sd_state.theSearch->currentItem());
@@ -156,14 +156,3 @@ storeKeyFree(const cache_key * key)
     memFree((void *) key, MEM_MD5_DIGEST);
 }
 
-int
-storeKeyHashBuckets(int nbuckets)
-{
-    int n = 0x2000;
-
-    while (n < nbuckets)
-        n <<= 1;
-
-    return n;
-}
-
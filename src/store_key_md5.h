@@ -29,7 +29,6 @@ const cache_key *storeKeyPublic(const char *, const HttpRequestMethod&, const Ke
 const cache_key *storeKeyPublicByRequest(HttpRequest *, const KeyScope keyScope = ksDefault);
 const cache_key *storeKeyPublicByRequestMethod(HttpRequest *, const HttpRequestMethod&, const KeyScope keyScope = ksDefault);
 const cache_key *storeKeyPrivate();
-int storeKeyHashBuckets(int);
 
 extern HASHHASH storeKeyHashHash;
 extern HASHCMP storeKeyHashCmp;
@@ -135,7 +135,7 @@ doPages(StoreEntry *anEntry)
         int64_t swapout_size = mem->endOffset() - mem->swapout.queue_offset;
 
         if (anEntry->store_status == STORE_PENDING)
-            if (swapout_size < SM_PAGE_SIZE)
+            if (swapout_size < static_cast<int64_t>(mem_node::PageSize()))
                 break;
 
         if (swapout_size <= 0)
@@ -216,7 +216,7 @@ StoreEntry::swapOut()
     if (store_status == STORE_PENDING) {
         /* wait for a full block to write */
 
-        if (swapout_maxsize < SM_PAGE_SIZE)
+        if (swapout_maxsize < static_cast<int64_t>(mem_node::PageSize()))
             return;
 
         /*
@@ -396,6 +396,12 @@ StoreEntry::mayStartSwapOut()
         return false;
     }
 
+    if (mem_obj->memCache.inPlace) {
+        debugs(20, 3, "storeSwapOut: most bytes are in shared memory only");
+        swapOutDecision(MemObject::SwapOut::swImpossible);
+        return false;
+    }
+
     if (mem_obj->inmem_lo > 0) {
         debugs(20, 3, "storeSwapOut: (inmem_lo > 0)  imem_lo:" <<  mem_obj->inmem_lo);
         swapOutDecision(MemObject::SwapOut::swImpossible);
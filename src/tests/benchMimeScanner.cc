@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+/* Micro-benchmark of Http::One::ScanMimeLine() kernels */
+
+#include "squid.h"
+#include "benchmarkMain.h"
+#include "http/one/MimeScanner.h"
+
+#include <cstring>
+#include <initializer_list>
+#include <string>
+
+using namespace Http::One;
+
+/// a named mime header block
+struct Sample {
+    const char *name;
+    std::string block;
+};
+
+static const Sample Samples[] = {
+    // the testHttp1Parser::testDripFeed() message
+    { "drip-feed", "Host: example.com\r\n\r\n" },
+
+    // a typical browser request on small-object traffic
+    {
+        "browser",
+        "Host: www.example.com\r\n"
+        "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:128.0) Gecko/20100101 Firefox/128.0\r\n"
+        "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+        "Accept-Language: en-US,en;q=0.5\r\n"
+        "Accept-Encoding: gzip, deflate, br, zstd\r\n"
+        "Referer: https://www.example.com/index.html\r\n"
+        "Connection: keep-alive\r\n"
+        "Cookie: session=0123456789abcdef0123456789abcdef; theme=dark; lang=en\r\n"
+        "Upgrade-Insecure-Requests: 1\r\n"
+        "Priority: u=0, i\r\n"
+        "\r\n"
+    },
+
+    // few but long fields
+    {
+        "long-fields",
+        "Host: cdn.example.net\r\n"
+        "Cookie: " + std::string(2000, 'c') + "\r\n"
+        "X-Forwarded-For: " + std::string(300, '1') + "\r\n"
+        "\r\n"
+    },
+};
+
+/// scans every line of the block like HttpHeader::parse() does
+static size_t
+ScanBlock(const MimeScanKernel kernel, const std::string &block)
+{
+    size_t colons = 0;
+    const char *pos = block.data();
+    const char *end = pos + block.size();
+    while (pos < end) {
+        const auto line = ScanMimeLine(kernel, pos, end - pos);
+        if (!line.terminated)
+            break;
+        colons += line.colon != MimeLineScan::npos;
+        pos += line.length + 1;
+    }
+    return colons;
+}
+
+/// the NUL, LF, CR and ':' searches that HttpHeader::parse() and
+/// HttpHeaderEntry::parse() did before ScanMimeLine(); the baseline
+static size_t
+MemchrBlock(const std::string &block)
+{
+    size_t found = 0;
+    const char *pos = block.data();
+    const char *end = pos + block.size();
+    if (memchr(pos, '\0', block.size()))
+        return found;
+    while (pos < end) {
+        const auto lf = static_cast<const char *>(memchr(pos, '\n', end - pos));
+        if (!lf)
+            break;
+        auto fieldEnd = lf;
+        if (fieldEnd > pos && fieldEnd[-1] == '\r')
+            --fieldEnd;
+        found += memchr(pos, '\r', fieldEnd - pos) != nullptr;
+        found += memchr(pos, ':', fieldEnd - pos) != nullptr;
+        pos = lf + 1;
+    }
+    return found;
+}
+
+class MimeScannerBenchmarks: public BenchmarkProgram
+{
+public:
+    MimeScannerBenchmarks(): BenchmarkProgram("benchMimeScanner") {}
+
+    /* BenchmarkProgram API */
+    void addBenchmarks() override;
+};
+
+void
+MimeScannerBenchmarks::addBenchmarks()
+{
+    for (const auto &sample: Samples) {
+        const auto benchName = std::string("memchr/") + sample.name;
+        add(benchName.c_str(), [&sample]() {
+            BenchmarkKeep(MemchrBlock(sample.block));
+        }, sample.block.size());
+    }
+
+    for (const auto kernel: {MimeScanKernel::scalar, MimeScanKernel::sse2, MimeScanKernel::avx2}) {
+        if (!MimeScanKernelSupported(kernel))
+            continue;
+
+        for (const auto &sample: Samples) {
+            const auto benchName = std::string("ScanMimeLine/") + MimeScanKernelName(kernel) + "/" + sample.name;
+            add(benchName.c_str(), [kernel, &sample]() {
+                BenchmarkKeep(ScanBlock(kernel, sample.block));
+            }, sample.block.size());
+        }
+    }
+}
+
+int
+main(int argc, char *argv[])
+{
+    return MimeScannerBenchmarks().run(argc, argv);
+}
+
@@ -0,0 +1,464 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+/* Micro-benchmarks of hot parsing and storage primitives */
+
+#include "squid.h"
+#include "AccessLogEntry.h"
+#include "acl/DomainData.h"
+#include "acl/Ip.h"
+#include "acl/RegexData.h"
+#include "anyp/Uri.h"
+#include "base/RegexPattern.h"
+#include "benchmarkMain.h"
+#include "ConfigParser.h"
+#include "format/Format.h"
+#include "format/Token.h"
+#include "http/ContentLengthInterpreter.h"
+#include "http/one/RequestParser.h"
+#include "HttpHeader.h"
+#include "MemBuf.h"
+#include "md5.h"
+#include "mem/forward.h"
+#include "splay.h"
+#include "SquidConfig.h"
+#include "stmem.h"
+#include "Store.h"
+#include "store/EntryIndex.h"
+#include "StoreIOBuffer.h"
+#include "store_key_md5.h"
+
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+/// a typical browser request on small-object traffic
+static const std::string BrowserRequest =
+    "GET http://www.example.com/images/logo.png?v=20250101 HTTP/1.1\r\n"
+    "Host: www.example.com\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:128.0) Gecko/20100101 Firefox/128.0\r\n"
+    "Accept: image/avif,image/webp,image/png,image/svg+xml,image/*;q=0.8,*/*;q=0.5\r\n"
+    "Accept-Language: en-US,en;q=0.5\r\n"
+    "Accept-Encoding: gzip, deflate, br, zstd\r\n"
+    "Referer: http://www.example.com/index.html\r\n"
+    "Connection: keep-alive\r\n"
+    "Cookie: session=0123456789abcdef0123456789abcdef; theme=dark; lang=en\r\n"
+    "Priority: u=5, i\r\n"
+    "\r\n";
+
+static const char *BrowserUrl = "http://www.example.com/images/logo.png?v=20250101";
+
+/// the mime header block of BrowserRequest
+static std::string
+BrowserHeaders()
+{
+    const auto start = BrowserRequest.find("\r\n") + 2;
+    return BrowserRequest.substr(start);
+}
+
+/// orders domain values the way the splay-based ACLDomainData did
+static int
+SplayDomainCompare(char * const &a, char * const &b)
+{
+    // duplicate if set A contains B's root; see Acl::DomainTrie for details
+    return matchDomainName(b, a) ? matchDomainName(a, b) : 0;
+}
+
+/// looks up a host in the splay tree used by ACLDomainData before DomainTrie
+static int
+SplayHostCompare(char * const &host, char * const &domain)
+{
+    return matchDomainName(host, domain);
+}
+
+/// exposes ACLIP matching without an ACLChecklist
+class BenchIpAcl: public ACLIP
+{
+public:
+    using ACLIP::match;
+
+    size_t trieBytes() const { return addresses.memoryUsed(); }
+
+    /* Acl::Node API */
+    char const *typeString() const override { return "src"; }
+    int match(ACLChecklist *) override { return 0; }
+};
+
+class PrimitiveBenchmarks: public BenchmarkProgram
+{
+public:
+    PrimitiveBenchmarks(): BenchmarkProgram("benchPrimitives") {}
+
+    /* BenchmarkProgram API */
+    void startup() override;
+    void addBenchmarks() override;
+
+private:
+    void addParsers();
+    void addStrings();
+    void addStorage();
+    void addStoreIndex();
+    void addAcls();
+    void addLogFormat();
+};
+
+void
+PrimitiveBenchmarks::startup()
+{
+    Mem::Init();
+    AnyP::UriScheme::Init();
+    httpHeaderInitModule();
+    Format::Token::Init();
+    Config.maxRequestHeaderSize = 64 * 1024;
+}
+
+void
+PrimitiveBenchmarks::addBenchmarks()
+{
+    addParsers();
+    addStrings();
+    addStorage();
+    addStoreIndex();
+    addAcls();
+    addLogFormat();
+}
+
+void
+PrimitiveBenchmarks::addParsers()
+{
+    static const SBuf request(BrowserRequest.c_str());
+    add("Http1::RequestParser::parse/browser", []() {
+        Http1::RequestParser hp;
+        BenchmarkKeep(hp.parse(request));
+    }, request.length());
+
+    static const auto headers = BrowserHeaders();
+    add("HttpHeader::parse/browser", []() {
+        HttpHeader hdr(hoRequest);
+        Http::ContentLengthInterpreter interpreter;
+        BenchmarkKeep(hdr.parse(headers.data(), headers.size(), interpreter));
+    }, headers.size());
+
+    static HttpHeader parsed(hoRequest);
+    Http::ContentLengthInterpreter interpreter;
+    parsed.parse(headers.data(), headers.size(), interpreter);
+    add("HttpHeader::packInto/browser", []() {
+        MemBuf mb;
+        mb.init();
+        parsed.packInto(&mb);
+        BenchmarkKeep(mb.contentSize());
+        mb.clean();
+    }, headers.size());
+
+    static const SBuf url(BrowserUrl);
+    add("AnyP::Uri::parse/absolute", []() {
+        AnyP::Uri uri;
+        BenchmarkKeep(uri.parse(HttpRequestMethod(Http::METHOD_GET), url));
+    }, url.length());
+}
+
+void
+PrimitiveBenchmarks::addStrings()
+{
+    static const SBuf haystack(BrowserRequest.c_str());
+    static const SBuf needle("Cookie:");
+    add("SBuf::find/header", []() {
+        BenchmarkKeep(haystack.find(needle));
+    }, haystack.length());
+
+    static const SBuf field("Accept-Encoding: gzip, deflate, br, zstd\r\n");
+    add("SBuf::append/16-fields", []() {
+        SBuf out;
+        for (int i = 0; i < 16; ++i)
+            out.append(field);
+        BenchmarkKeep(out.length());
+    }, 16 * field.length());
+}
+
+void
+PrimitiveBenchmarks::addStorage()
+{
+    add("storeKeyPublic/GET", []() {
+        BenchmarkKeep(storeKeyPublic(BrowserUrl, HttpRequestMethod(Http::METHOD_GET)));
+    }, strlen(BrowserUrl));
+
+    // a 64 KB object body, read back in client-sized chunks
+    static const size_t objectSize = 64 * 1024;
+    static const size_t readSize = 4096;
+    static mem_hdr object;
+    static std::string body(objectSize, 'x');
+    object.write(StoreIOBuffer(body.size(), 0, &body[0]));
+    add("mem_hdr::copy/64KB-in-4KB-reads", []() {
+        char buf[readSize];
+        for (size_t offset = 0; offset < objectSize; offset += readSize)
+            BenchmarkKeep(object.copy(StoreIOBuffer(readSize, offset, buf)));
+    }, objectSize);
+
+    // a 16 MB in-transit object read by 8 clients at different offsets
+    static const size_t largeSize = 16 * 1024 * 1024;
+    static const int readers = 8;
+    static mem_hdr large;
+    for (size_t offset = 0; offset < largeSize; offset += body.size())
+        large.write(StoreIOBuffer(body.size(), offset, &body[0]));
+    add("mem_hdr::copy/16MB-8-interleaved-readers", []() {
+        char buf[readSize];
+        const size_t stride = largeSize / readers;
+        for (size_t step = 0; step < stride; step += readSize) {
+            for (int reader = 0; reader < readers; ++reader)
+                BenchmarkKeep(large.copy(StoreIOBuffer(readSize, reader * stride + step, buf)));
+        }
+    }, largeSize);
+}
+
+/// compares store_table lookups in the chained hash_table it used to be with
+/// lookups in the current Store::EntryIndex
+void
+PrimitiveBenchmarks::addStoreIndex()
+{
+    static const size_t entryCount = 1 << 18;
+    static const size_t keySize = SQUID_MD5_DIGEST_LENGTH;
+    static const int objectsPerBucket = 20; // the old store_objects_per_bucket default
+
+    static std::vector<cache_key> keys(2 * entryCount * keySize);
+    std::mt19937 rng(1);
+    for (auto &octet: keys)
+        octet = static_cast<cache_key>(rng());
+    // the first entryCount keys are indexed; the others are misses
+    const auto key = [](const size_t i) { return &keys[i * keySize]; };
+
+    static std::vector<hash_link> links(entryCount);
+    int buckets = 0x2000;
+    while (buckets < static_cast<int>(entryCount / objectsPerBucket))
+        buckets <<= 1;
+    static const auto chained = hash_create(storeKeyHashCmp, buckets, storeKeyHashHash);
+
+    static Store::EntryIndex flat;
+    for (size_t i = 0; i < entryCount; ++i) {
+        links[i].key = key(i);
+        hash_join(chained, &links[i]);
+        const auto e = new StoreEntry();
+        e->key = key(i);
+        flat.insert(*e);
+    }
+
+    // visit keys in a cache-unfriendly order
+    static size_t next = 0;
+    const auto step = [](const size_t offset) {
+        next = (next + 7919) % entryCount;
+        return &keys[(offset + next) * keySize];
+    };
+    add("store_table/find/hit/chained", [step]() {
+        BenchmarkKeep(hash_lookup(chained, step(0)));
+    });
+    add("store_table/find/hit/flat", [step]() {
+        BenchmarkKeep(flat.find(step(0)));
+    });
+    add("store_table/find/miss/chained", [step]() {
+        BenchmarkKeep(hash_lookup(chained, step(entryCount)));
+    });
+    add("store_table/find/miss/flat", [step]() {
+        BenchmarkKeep(flat.find(step(entryCount)));
+    });
+
+    // index overheads beyond the entries themselves
+    const auto chainedBytes = buckets * sizeof(hash_link *) + entryCount * sizeof(hash_link::next);
+    addMetric("store_table/entries", entryCount);
+    addMetric("store_table/bytes_per_entry/chained", double(chainedBytes) / entryCount);
+    addMetric("store_table/bytes_per_entry/flat", double(flat.memoryUsed()) / entryCount);
+    addMetric("sizeof(StoreEntry)", sizeof(StoreEntry));
+}
+
+void
+PrimitiveBenchmarks::addAcls()
+{
+    static ACLDomainData domains;
+    char domainLine[] = ".example.com .example.net .example.org www.squid-cache.org .test .invalid";
+    ConfigParser::SetCfgLine(domainLine);
+    domains.parse();
+    domains.prepareForUse();
+    add("ACLDomainData::match/hit", []() {
+        BenchmarkKeep(domains.match("www.example.com"));
+    });
+    add("ACLDomainData::match/miss", []() {
+        BenchmarkKeep(domains.match("www.example.info"));
+    });
+
+    // a blocklist-sized ACL with a mix of domain names and domain name sets
+    const size_t blockedCount = 200000;
+    static const char *tlds[] = { "com", "net", "org", "info", "ru", "de", "io" };
+    std::mt19937 rng(20250101);
+    std::string blockedLine;
+    static std::string blockedHost; // a subdomain of a blocked domain name set
+    for (size_t i = 0; i < blockedCount; ++i) {
+        const auto domain = "tracker" + std::to_string(rng()) + '.' + tlds[i % (sizeof(tlds)/sizeof(tlds[0]))];
+        blockedLine += (i % 3) ? " ads." : " .";
+        blockedLine += domain;
+        if (blockedHost.empty())
+            blockedHost = "cdn.www." + domain;
+    }
+    static ACLDomainData blocked;
+    std::vector<char> blockedBuf(blockedLine.begin(), blockedLine.end());
+    blockedBuf.push_back('\0');
+    // parse() time is dominated by ConfigParser tokenizing
+    const auto parseStart = std::chrono::steady_clock::now();
+    ConfigParser::SetCfgLine(blockedBuf.data());
+    blocked.parse();
+    const auto prepareStart = std::chrono::steady_clock::now();
+    blocked.prepareForUse();
+    const auto prepareEnd = std::chrono::steady_clock::now();
+    const std::chrono::duration<double, std::milli> blockedParseTime = prepareStart - parseStart;
+    const std::chrono::duration<double, std::milli> blockedPrepareTime = prepareEnd - prepareStart;
+    addMetric("ACLDomainData/blocklist/values", blockedCount);
+    addMetric("ACLDomainData/blocklist/parse_ms", blockedParseTime.count());
+    addMetric("ACLDomainData/blocklist/prepare_ms", blockedPrepareTime.count());
+    addMetric("ACLDomainData/blocklist/bytes_per_value", double(blocked.domains.memoryUsed()) / blockedCount);
+
+    // the same values in the splay tree that ACLDomainData used before
+    static Splay<char *> blockedSplay;
+    std::vector<char *> splayValues;
+    for (auto *value = strtok(&blockedLine[0], " "); value; value = strtok(nullptr, " "))
+        splayValues.push_back(value);
+    const auto splayStart = std::chrono::steady_clock::now();
+    for (const auto value: splayValues)
+        blockedSplay.insert(xstrdup(value), SplayDomainCompare);
+    const std::chrono::duration<double, std::milli> splayLoadTime = std::chrono::steady_clock::now() - splayStart;
+    addMetric("ACLDomainData/blocklist/splay_insert_ms", splayLoadTime.count());
+    // tree nodes plus value copies, ignoring malloc() overheads
+    addMetric("ACLDomainData/blocklist/splay_bytes_per_value",
+              double(blockedSplay.size() * sizeof(SplayNode<char *>) + blockedLine.size()) / blockedCount);
+
+    add("ACLDomainData::match/blocklist_hit", []() {
+        BenchmarkKeep(blocked.match(blockedHost.c_str()));
+    });
+    add("ACLDomainData::match/blocklist_miss", []() {
+        BenchmarkKeep(blocked.match("www.ads1234.example.com"));
+    });
+    add("Splay<char*>::find/blocklist_hit", []() {
+        auto host = const_cast<char *>(blockedHost.c_str());
+        BenchmarkKeep(blockedSplay.find(host, SplayHostCompare));
+    });
+    add("Splay<char*>::find/blocklist_miss", []() {
+        static char host[] = "www.ads1234.example.com";
+        char *hostPtr = host;
+        BenchmarkKeep(blockedSplay.find(hostPtr, SplayHostCompare));
+    });
+
+    // a url_regex ACL with thousands of site-specific patterns
+    const size_t regexCount = 5000;
+    std::string regexLine;
+    for (size_t i = 0; i < regexCount; ++i) {
+        if (i % 1000 == 999)
+            regexLine += " \\.(exe|scr|pif)$"; // lacks a required literal
+        else
+            regexLine += " ^https?://([a-z0-9-]+\\.)*site" + std::to_string(i) + "\\.example/";
+    }
+    static ACLRegexData urlPatterns;
+    std::vector<char> regexBuf(regexLine.begin(), regexLine.end());
+    regexBuf.push_back('\0');
+    ConfigParser::SetCfgLine(regexBuf.data());
+    // squid.conf defaults for parsing regular expressions
+    ConfigParser::RecognizeQuotedValues = false;
+    ConfigParser::StrictMode = false;
+    urlPatterns.parse();
+    urlPatterns.prepareForUse();
+    add("ACLRegexData::match/5000_hit", []() {
+        BenchmarkKeep(urlPatterns.match("http://cdn.site4321.example/lib.js"));
+    });
+    add("ACLRegexData::match/5000_miss", []() {
+        BenchmarkKeep(urlPatterns.match(BrowserUrl));
+    });
+
+    static BenchIpAcl addresses;
+    char ipLine[] = "10.0.0.0/8 172.16.0.0/12 192.168.0.0/16 127.0.0.1 fc00::/7 ::1";
+    ConfigParser::SetCfgLine(ipLine);
+    addresses.parse();
+    addresses.prepareForUse();
+    static const Ip::Address inside("192.168.10.20");
+    static const Ip::Address outside("198.51.100.7");
+    add("ACLIP::match/hit", []() {
+        BenchmarkKeep(addresses.match(inside));
+    });
+    add("ACLIP::match/miss", []() {
+        BenchmarkKeep(addresses.match(outside));
+    });
+
+    // a GeoIP-sized ACL with IPv4 and IPv6 prefixes of various lengths
+    const size_t networkCount = 100000;
+    std::mt19937 ipRng(20250101);
+    std::string networkLine;
+    for (size_t i = 0; i < networkCount; ++i) {
+        const uint32_t bits = ipRng();
+        if (i % 10 == 9) {
+            char buf[64];
+            snprintf(buf, sizeof(buf), " 2001:db8:%x:%x::/64", bits >> 16, bits & 0xFFFF);
+            networkLine += buf;
+        } else {
+            const auto length = 16 + bits % 17;
+            const uint32_t network = bits & ~static_cast<uint32_t>(0xFFFFFFFFull >> length);
+            networkLine += ' ' + std::to_string(network >> 24) + '.' + std::to_string((network >> 16) & 0xFF) +
+                           '.' + std::to_string((network >> 8) & 0xFF) + '.' + std::to_string(network & 0xFF) +
+                           '/' + std::to_string(length);
+        }
+    }
+    static BenchIpAcl networks;
+    std::vector<char> networkBuf(networkLine.begin(), networkLine.end());
+    networkBuf.push_back('\0');
+    const auto loadStart = std::chrono::steady_clock::now();
+    ConfigParser::SetCfgLine(networkBuf.data());
+    networks.parse();
+    networks.prepareForUse();
+    const std::chrono::duration<double, std::milli> loadTime = std::chrono::steady_clock::now() - loadStart;
+    addMetric("ACLIP/networks/values", networkCount);
+    addMetric("ACLIP/networks/load_ms", loadTime.count());
+    addMetric("ACLIP/networks/trie_bytes_per_value", double(networks.trieBytes()) / networkCount);
+
+    static std::vector<Ip::Address> probes;
+    for (size_t i = 0; i < 1024; ++i) {
+        const uint32_t bits = ipRng();
+        const auto ip = std::to_string(bits >> 24) + '.' + std::to_string((bits >> 16) & 0xFF) +
+                        '.' + std::to_string((bits >> 8) & 0xFF) + '.' + std::to_string(bits & 0xFF);
+        probes.emplace_back(ip.c_str());
+    }
+    add("ACLIP::match/networks_random", []() {
+        static size_t next = 0;
+        BenchmarkKeep(networks.match(probes[next++ % probes.size()]));
+    });
+}
+
+void
+PrimitiveBenchmarks::addLogFormat()
+{
+    // the built-in "squid" logformat
+    static Format::Format format("squid");
+    format.parse("%ts.%03tu %6tr %>a %Ss/%03>Hs %<st %rm %ru %[un %Sh/%<a %mt");
+
+    static const AccessLogEntryPointer al = new AccessLogEntry();
+    al->url = SBuf(BrowserUrl);
+    al->http.method = HttpRequestMethod(Http::METHOD_GET);
+    al->cache.caddr = Ip::Address("192.168.10.20");
+    al->cache.code.update(LOG_TCP_MEM_HIT);
+    al->http.code = 200;
+    al->http.content_type = "image/png";
+    al->cache.highOffset = 4321;
+
+    add("Format::Format::assemble/squid", []() {
+        MemBuf mb;
+        mb.init();
+        format.assemble(mb, al, 0);
+        BenchmarkKeep(mb.contentSize());
+        mb.clean();
+    });
+}
+
+int
+main(int argc, char *argv[])
+{
+    return PrimitiveBenchmarks().run(argc, argv);
+}
+
@@ -8,6 +8,7 @@
 
 #include "squid.h"
 #include "AccessLogEntry.h"
+#include "acl/Memo.h"
 #include "HttpRequest.h"
 
 #define STUB_API "HttpRequest.cc"
@@ -58,4 +59,5 @@ bool HttpRequest::sanityCheckStartLine(const char *, const size_t, Http::StatusC
 void HttpRequest::hdrCacheInit() STUB
 bool HttpRequest::inheritProperties(const Http::Message *) STUB_RETVAL(false)
 NotePairs::Pointer HttpRequest::notes() STUB_RETVAL(NotePairs::Pointer())
+Acl::MemoPointer HttpRequest::aclMemo() STUB_RETVAL(Acl::MemoPointer())
 
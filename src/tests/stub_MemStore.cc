@@ -20,6 +20,7 @@ bool MemStore::keepInLocalMemory(const StoreEntry &) const STUB_RETVAL(false)
 void MemStore::write(StoreEntry &) STUB
 void MemStore::completeWriting(StoreEntry &) STUB
 void MemStore::disconnect(StoreEntry &) STUB
+ssize_t MemStore::readInPlace(const StoreEntry &, const StoreIOBuffer &, Store::InPlaceReadPosition &) const STUB_RETVAL(0)
 void MemStore::reference(StoreEntry &) STUB
 void MemStore::updateHeaders(StoreEntry *) STUB
 void MemStore::maintain() STUB
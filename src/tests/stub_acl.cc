@@ -15,6 +15,22 @@
 
 #include "acl/forward.h"
 
+#include "acl/Options.h"
+const Acl::Options &Acl::NoOptions() STUB_RETREF(Acl::Options)
+
 #include "acl/Gadgets.h"
 size_t aclParseAclList(ConfigParser &, ACLList **, const char *) STUB_RETVAL(0)
 
+#include "acl/Node.h"
+Acl::Node::Node() STUB_NOP
+Acl::Node::~Node() STUB_NOP
+void *Acl::Node::operator new(size_t) STUB_RETVAL((void *)1)
+void Acl::Node::operator delete(void *) STUB
+bool Acl::Node::isProxyAuth() const STUB_RETVAL(false)
+bool Acl::Node::valid() const STUB_RETVAL(true)
+int Acl::Node::matchForCache(ACLChecklist *) STUB_RETVAL(0)
+bool Acl::Node::requiresAle() const STUB_RETVAL(false)
+bool Acl::Node::requiresRequest() const STUB_RETVAL(false)
+bool Acl::Node::requiresReply() const STUB_RETVAL(false)
+bool Acl::Node::memoizable() const STUB_RETVAL(false)
+
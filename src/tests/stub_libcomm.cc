@@ -44,12 +44,6 @@ const char * Comm::ConnOpener::getHost() const STUB_RETVAL(nullptr)
 #include "comm/forward.h"
 bool Comm::IsConnOpen(const Comm::ConnectionPointer &) STUB_RETVAL(false)
 
-#include "comm/IoCallback.h"
-void Comm::IoCallback::setCallback(iocb_type, AsyncCall::Pointer &, char *, FREE *, int) STUB
-void Comm::IoCallback::selectOrQueueWrite() STUB
-void Comm::IoCallback::cancel(const char *) STUB
-void Comm::IoCallback::finish(Comm::Flag, int) STUB
-
 #include "comm/Loops.h"
 void Comm::SelectLoopInit(void) STUB
 void Comm::SetSelect(int, unsigned int, PF *, void *, time_t) STUB
@@ -79,8 +73,12 @@ void Comm::ApplyTcpKeepAlive(int, const TcpKeepAlive &) STUB
 #include "comm/Write.h"
 void Comm::Write(const Comm::ConnectionPointer &, const char *, int, AsyncCall::Pointer &, FREE *) STUB
 void Comm::Write(const Comm::ConnectionPointer &, MemBuf *, AsyncCall::Pointer &) STUB
+void Comm::Write(const Comm::ConnectionPointer &, const struct iovec *, int, AsyncCall::Pointer &, FREE *) STUB
+void Comm::Write(const Comm::ConnectionPointer &, MemBuf *, const char *, int, AsyncCall::Pointer &) STUB
+void Comm::WriteWhenReady(const Comm::ConnectionPointer &, AsyncCall::Pointer &) STUB
 void Comm::WriteCancel(const Comm::ConnectionPointer &, const char *) STUB
 /*PF*/ void Comm::HandleWrite(int, void*) STUB
+/*PF*/ void Comm::HandleWriteReady(int, void*) STUB
 
 std::ostream &Comm::operator <<(std::ostream &os, const Connection &) STUB_RETVAL(os << "[Connection object]")
 
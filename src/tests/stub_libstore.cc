@@ -52,6 +52,7 @@ void Controller::noteStoppedSharedWriting(StoreEntry &) STUB
 int Controller::transientReaders(const StoreEntry &) const STUB_RETVAL(0)
 void Controller::transientsDisconnect(StoreEntry &) STUB
 void Controller::memoryDisconnect(StoreEntry &) STUB
+ssize_t Controller::memoryRead(const StoreEntry &, const StoreIOBuffer &, InPlaceReadPosition &) STUB_RETVAL(0)
 StoreSearch *Controller::search() STUB_RETVAL(nullptr)
 bool Controller::SmpAware() STUB_RETVAL(false)
 int Controller::store_dirs_rebuilding = 0;
@@ -12,6 +12,8 @@
 #define STUB_API "mem_node.cc"
 #include "tests/STUB.h"
 
-mem_node::mem_node(int64_t offset) : nodeBuffer(0,offset,data) STUB
+mem_node::mem_node(int64_t offset) : data(nullptr), capacity(0), nodeBuffer(0,offset,data) STUB
     size_t mem_node::InUseCount() STUB_RETVAL(0)
+    size_t mem_node::PageSize() STUB_RETVAL(SM_PAGE_SIZE)
+    void mem_node::Configure(size_t, bool) STUB
 
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#include "squid.h"
+#include "acl/DomainData.h"
+#include "base/TextException.h"
+#include "compat/cppunit.h"
+#include "ConfigParser.h"
+#include "unitTestMain.h"
+#if USE_OPENSSL
+#include "acl/ServerName.h"
+#endif
+
+class TestACLDomainData : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(TestACLDomainData);
+    CPPUNIT_TEST(testDomainData);
+    CPPUNIT_TEST(testUnprepared);
+#if USE_OPENSSL
+    CPPUNIT_TEST(testServerNameData);
+    CPPUNIT_TEST(testServerNameUnprepared);
+#endif
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    void testDomainData();
+    void testUnprepared();
+#if USE_OPENSSL
+    void testServerNameData();
+    void testServerNameUnprepared();
+#endif
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestACLDomainData );
+
+/// feeds the given ACL parameters to data.parse()
+static void
+Parse(ACLDomainData &data, const char *parameters)
+{
+    char line[256];
+    xstrncpy(line, parameters, sizeof(line));
+    ConfigParser::SetCfgLine(line);
+    data.parse();
+}
+
+void
+TestACLDomainData::testDomainData()
+{
+    ACLDomainData data;
+    Parse(data, "example.com .Example.NET");
+    // a second squid.conf line with the same ACL name
+    Parse(data, "www.squid-cache.org");
+    data.prepareForUse();
+
+    CPPUNIT_ASSERT(data.match("example.com"));
+    CPPUNIT_ASSERT(data.match("EXAMPLE.com"));
+    CPPUNIT_ASSERT(!data.match("www.example.com"));
+    CPPUNIT_ASSERT(data.match("example.net"));
+    CPPUNIT_ASSERT(data.match("www.example.net"));
+    CPPUNIT_ASSERT(data.match("www.squid-cache.org"));
+    CPPUNIT_ASSERT(!data.match("squid-cache.org"));
+    CPPUNIT_ASSERT(!data.match(nullptr));
+
+    // ACLDomainData does not honor wildcards
+    CPPUNIT_ASSERT(!data.match("*.example.com"));
+
+    CPPUNIT_ASSERT_EQUAL(size_t(3), data.dump().size());
+}
+
+void
+TestACLDomainData::testUnprepared()
+{
+    ACLDomainData data;
+    Parse(data, ".example.com");
+    CPPUNIT_ASSERT_THROW(data.match("www.example.com"), TextException);
+
+    data.prepareForUse();
+    CPPUNIT_ASSERT(data.match("www.example.com"));
+
+    // values parsed after prepareForUse() need another prepareForUse() call
+    Parse(data, ".example.net");
+    CPPUNIT_ASSERT_THROW(data.match("www.example.com"), TextException);
+}
+
+#if USE_OPENSSL
+
+void
+TestACLDomainData::testServerNameData()
+{
+    ACLServerNameData data;
+    Parse(data, "example.com .example.net");
+    data.prepareForUse();
+
+    CPPUNIT_ASSERT(data.match("example.com"));
+    CPPUNIT_ASSERT(!data.match("www.example.com"));
+    CPPUNIT_ASSERT(data.match("www.example.net"));
+    CPPUNIT_ASSERT(!data.match("example.org"));
+    CPPUNIT_ASSERT(!data.match(nullptr));
+
+    // certificate names like *.example.com are matched with wildcards
+    CPPUNIT_ASSERT(data.match("*.example.net"));
+    CPPUNIT_ASSERT(data.match("*.com"));
+    CPPUNIT_ASSERT(!data.match("*.org"));
+}
+
+void
+TestACLDomainData::testServerNameUnprepared()
+{
+    ACLServerNameData data;
+    Parse(data, "example.com");
+    CPPUNIT_ASSERT_THROW(data.match("example.com"), TextException);
+}
+
+#endif /* USE_OPENSSL */
+
+int
+main(int argc, char *argv[])
+{
+    return TestProgram().run(argc, argv);
+}
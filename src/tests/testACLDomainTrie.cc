@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#include "squid.h"
+#include "acl/DomainTrie.h"
+#include "compat/cppunit.h"
+#include "unitTestMain.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+class TestACLDomainTrie : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(TestACLDomainTrie);
+    CPPUNIT_TEST(testNames);
+    CPPUNIT_TEST(testSets);
+    CPPUNIT_TEST(testWildcards);
+    CPPUNIT_TEST(testDuplicates);
+    CPPUNIT_TEST(testValues);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    void testNames();
+    void testSets();
+    void testWildcards();
+    void testDuplicates();
+    void testValues();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestACLDomainTrie );
+
+namespace {
+
+/// remembers values reported by DomainTrie::add()
+class Reports
+{
+public:
+    Acl::DomainTrie::Reporter reporter() {
+        return [this](const std::string &ignored, const std::string &coveringValue, const bool ignoredEarlier) {
+            items.push_back((ignoredEarlier ? "earlier " : "") + ignored + " by " + coveringValue);
+        };
+    }
+
+    std::vector<std::string> items;
+};
+
+/// a compiled trie with the given values
+Acl::DomainTrie
+Compile(const std::vector<const char *> &values, Reports &reports)
+{
+    Acl::DomainTrie trie;
+    for (const auto value: values)
+        trie.add(value, reports.reporter());
+    trie.compile();
+    return trie;
+}
+
+Acl::DomainTrie
+Compile(const std::vector<const char *> &values)
+{
+    Reports ignored;
+    return Compile(values, ignored);
+}
+
+} // namespace
+
+void
+TestACLDomainTrie::testNames()
+{
+    const auto trie = Compile({"example.com", "www.example.net", "localhost"});
+
+    CPPUNIT_ASSERT(trie.match("example.com"));
+    CPPUNIT_ASSERT(trie.match("EXAMPLE.Com"));
+    CPPUNIT_ASSERT(trie.match(".example.com"));
+    CPPUNIT_ASSERT(trie.match("www.example.net"));
+    CPPUNIT_ASSERT(trie.match("localhost"));
+
+    CPPUNIT_ASSERT(!trie.match("www.example.com"));
+    CPPUNIT_ASSERT(!trie.match("xexample.com"));
+    CPPUNIT_ASSERT(!trie.match("example.net"));
+    CPPUNIT_ASSERT(!trie.match("com"));
+    CPPUNIT_ASSERT(!trie.match("example.com."));
+    CPPUNIT_ASSERT(!trie.match(""));
+    CPPUNIT_ASSERT(!trie.match("..."));
+    CPPUNIT_ASSERT(!trie.match(nullptr));
+}
+
+void
+TestACLDomainTrie::testSets()
+{
+    const auto trie = Compile({".example.com", "x.example.net"});
+
+    CPPUNIT_ASSERT(trie.match("example.com"));
+    CPPUNIT_ASSERT(trie.match("www.example.com"));
+    CPPUNIT_ASSERT(trie.match("a.b.c.Example.COM"));
+
+    CPPUNIT_ASSERT(!trie.match("wwwexample.com"));
+    CPPUNIT_ASSERT(!trie.match("example.org"));
+    CPPUNIT_ASSERT(!trie.match("y.x.example.net"));
+}
+
+void
+TestACLDomainTrie::testWildcards()
+{
+    const auto trie = Compile({"x.example.com", ".example.net", "example.org"});
+
+    CPPUNIT_ASSERT(trie.match("*.example.com", true));
+    CPPUNIT_ASSERT(trie.match("*.example.net", true));
+    CPPUNIT_ASSERT(!trie.match("*.example.org", true));
+    CPPUNIT_ASSERT(!trie.match("*", true));
+
+    // wildcards are ignored by default
+    CPPUNIT_ASSERT(!trie.match("*.example.com"));
+    CPPUNIT_ASSERT(trie.match("*.example.net"));
+}
+
+void
+TestACLDomainTrie::testDuplicates()
+{
+    Reports reports;
+    const auto trie = Compile({
+        ".example.com", "example.com", "a.example.com", ".example.com",
+        "b.example.org", ".d.example.org", ".example.org",
+        "example.net", "example.net"
+    }, reports);
+
+    const std::vector<std::string> expected = {
+        "example.com by .example.com",
+        "a.example.com by .example.com",
+        ".example.com by .example.com",
+        "earlier b.example.org by .example.org",
+        "earlier .d.example.org by .example.org",
+        "example.net by example.net"
+    };
+    CPPUNIT_ASSERT(reports.items == expected);
+
+    CPPUNIT_ASSERT(trie.match("b.example.org"));
+    CPPUNIT_ASSERT(trie.match("x.d.example.org"));
+}
+
+void
+TestACLDomainTrie::testValues()
+{
+    Acl::DomainTrie trie;
+    CPPUNIT_ASSERT(trie.empty());
+
+    Reports reports;
+    trie.add("example.com", reports.reporter());
+    trie.add(".example.net", reports.reporter());
+    CPPUNIT_ASSERT(!trie.empty());
+    CPPUNIT_ASSERT(!trie.compiled());
+    trie.compile();
+    CPPUNIT_ASSERT(trie.compiled());
+
+    // values added after compile() must be compiled again
+    trie.add("www.example.com", reports.reporter());
+    trie.add("ftp.example.net", reports.reporter());
+    CPPUNIT_ASSERT(!trie.compiled());
+    CPPUNIT_ASSERT(!trie.match("www.example.com"));
+    trie.compile();
+    CPPUNIT_ASSERT(trie.compiled());
+    CPPUNIT_ASSERT(trie.match("www.example.com"));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), reports.items.size());
+
+    auto values = trie.values();
+    std::sort(values.begin(), values.end());
+    const std::vector<std::string> expected = { ".example.net", "example.com", "www.example.com" };
+    CPPUNIT_ASSERT(values == expected);
+    CPPUNIT_ASSERT(trie.memoryUsed() > 0);
+}
+
+int
+main(int argc, char *argv[])
+{
+    return TestProgram().run(argc, argv);
+}
+
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#include "squid.h"
+#include "acl/IpTrie.h"
+#include "compat/cppunit.h"
+#include "ip/Address.h"
+#include "unitTestMain.h"
+
+#include <string>
+
+class TestACLIpTrie : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(TestACLIpTrie);
+    CPPUNIT_TEST(testEmpty);
+    CPPUNIT_TEST(testIpv4);
+    CPPUNIT_TEST(testIpv6);
+    CPPUNIT_TEST(testMixed);
+    CPPUNIT_TEST(testLarge);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    void testEmpty();
+    void testIpv4();
+    void testIpv6();
+    void testMixed();
+    void testLarge();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestACLIpTrie );
+
+/// adds the given inclusive range of addresses
+static void
+Add(Acl::IpTrie &trie, const char *first, const char *last)
+{
+    trie.add(Ip::Address(first), Ip::Address(last));
+}
+
+/// whether the given address matches
+static bool
+Match(const Acl::IpTrie &trie, const char *address)
+{
+    return trie.match(Ip::Address(address));
+}
+
+void
+TestACLIpTrie::testEmpty()
+{
+    Acl::IpTrie trie;
+    CPPUNIT_ASSERT(!trie.compiled());
+    CPPUNIT_ASSERT(!Match(trie, "127.0.0.1"));
+    trie.compile();
+    CPPUNIT_ASSERT(trie.compiled());
+    CPPUNIT_ASSERT(!Match(trie, "127.0.0.1"));
+    CPPUNIT_ASSERT(!Match(trie, "::1"));
+
+    // reversed ranges are empty
+    Add(trie, "10.0.0.9", "10.0.0.1");
+    trie.compile();
+    CPPUNIT_ASSERT(!Match(trie, "10.0.0.5"));
+}
+
+void
+TestACLIpTrie::testIpv4()
+{
+    Acl::IpTrie trie;
+    Add(trie, "10.0.0.0", "10.255.255.255");
+    Add(trie, "192.168.1.7", "192.168.1.7");
+    Add(trie, "172.16.0.5", "172.16.1.10");
+    trie.compile();
+
+    CPPUNIT_ASSERT(Match(trie, "10.0.0.0"));
+    CPPUNIT_ASSERT(Match(trie, "10.20.30.40"));
+    CPPUNIT_ASSERT(Match(trie, "10.255.255.255"));
+    CPPUNIT_ASSERT(!Match(trie, "9.255.255.255"));
+    CPPUNIT_ASSERT(!Match(trie, "11.0.0.0"));
+
+    CPPUNIT_ASSERT(Match(trie, "192.168.1.7"));
+    CPPUNIT_ASSERT(!Match(trie, "192.168.1.6"));
+    CPPUNIT_ASSERT(!Match(trie, "192.168.1.8"));
+
+    CPPUNIT_ASSERT(Match(trie, "172.16.0.5"));
+    CPPUNIT_ASSERT(Match(trie, "172.16.0.255"));
+    CPPUNIT_ASSERT(Match(trie, "172.16.1.10"));
+    CPPUNIT_ASSERT(!Match(trie, "172.16.0.4"));
+    CPPUNIT_ASSERT(!Match(trie, "172.16.1.11"));
+
+    // an IPv6 address that shares low bits with a matching IPv4 address
+    CPPUNIT_ASSERT(!Match(trie, "::10.20.30.40"));
+}
+
+void
+TestACLIpTrie::testIpv6()
+{
+    Acl::IpTrie trie;
+    Add(trie, "2001:db8::", "2001:db8:ffff:ffff:ffff:ffff:ffff:ffff");
+    Add(trie, "fe80::1", "fe80::1");
+    trie.compile();
+
+    CPPUNIT_ASSERT(Match(trie, "2001:db8::1"));
+    CPPUNIT_ASSERT(Match(trie, "2001:db8:1234::5678"));
+    CPPUNIT_ASSERT(!Match(trie, "2001:db9::"));
+    CPPUNIT_ASSERT(!Match(trie, "2001:db7:ffff::"));
+    CPPUNIT_ASSERT(Match(trie, "fe80::1"));
+    CPPUNIT_ASSERT(!Match(trie, "fe80::2"));
+    CPPUNIT_ASSERT(!Match(trie, "10.0.0.1"));
+}
+
+void
+TestACLIpTrie::testMixed()
+{
+    Acl::IpTrie trie;
+    // overlapping and adjacent ranges
+    Add(trie, "10.0.0.0", "10.0.0.127");
+    Add(trie, "10.0.0.100", "10.0.0.200");
+    Add(trie, "10.0.0.201", "10.0.0.210");
+    // an IPv6 range that contains the IPv4-mapped address space
+    Add(trie, "::", "::1:0:0:0");
+    trie.compile();
+
+    CPPUNIT_ASSERT(Match(trie, "10.0.0.0"));
+    CPPUNIT_ASSERT(Match(trie, "10.0.0.150"));
+    CPPUNIT_ASSERT(Match(trie, "10.0.0.210"));
+    CPPUNIT_ASSERT(Match(trie, "8.8.8.8"));
+    CPPUNIT_ASSERT(Match(trie, "::1"));
+    CPPUNIT_ASSERT(Match(trie, "::1:0:0:0"));
+    CPPUNIT_ASSERT(!Match(trie, "::1:0:0:1"));
+    CPPUNIT_ASSERT(!Match(trie, "2001:db8::1"));
+}
+
+void
+TestACLIpTrie::testLarge()
+{
+    // enough IPv4 ranges to index them by their leading address bits
+    Acl::IpTrie trie;
+    for (int i = 0; i < 8192; ++i) {
+        const auto network = "10." + std::to_string(i / 256) + "." + std::to_string(i % 256) + ".";
+        Add(trie, (network + "16").c_str(), (network + "31").c_str());
+    }
+    Add(trie, "192.168.0.0", "192.168.255.255");
+    trie.compile();
+
+    CPPUNIT_ASSERT(Match(trie, "10.0.0.16"));
+    CPPUNIT_ASSERT(Match(trie, "10.31.255.31"));
+    CPPUNIT_ASSERT(Match(trie, "10.17.3.20"));
+    CPPUNIT_ASSERT(!Match(trie, "10.17.3.15"));
+    CPPUNIT_ASSERT(!Match(trie, "10.17.3.32"));
+    CPPUNIT_ASSERT(!Match(trie, "10.32.0.16"));
+    CPPUNIT_ASSERT(Match(trie, "192.168.42.1"));
+    CPPUNIT_ASSERT(!Match(trie, "192.169.0.0"));
+}
+
+int
+main(int argc, char *argv[])
+{
+    return TestProgram().run(argc, argv);
+}
+
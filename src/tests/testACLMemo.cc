@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#include "squid.h"
+#include "acl/Memo.h"
+#include "compat/cppunit.h"
+#include "HttpReply.h"
+#include "unitTestMain.h"
+
+#include <functional>
+
+class TestACLMemo : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(TestACLMemo);
+    CPPUNIT_TEST(testRemember);
+    CPPUNIT_TEST(testAsyncResults);
+    CPPUNIT_TEST(testSync);
+    CPPUNIT_TEST(testInvalidation);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    void testRemember();
+    void testAsyncResults();
+    void testSync();
+    void testInvalidation();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestACLMemo );
+
+namespace
+{
+
+/// a trivial ACL for identifying remembered results
+class TestNode: public Acl::Node
+{
+    MEMPROXY_CLASS(TestNode);
+
+public:
+    /* Acl::Node API */
+    void parse() override {}
+    char const *typeString() const override { return "test"; }
+    SBufList dump() const override { return SBufList(); }
+    bool empty() const override { return false; }
+
+private:
+    /* Acl::Node API */
+    int match(ACLChecklist *) override { return 0; }
+    bool memoizable() const override { return true; }
+};
+
+/// the checked transaction state that remembered results depend on
+class State
+{
+public:
+    State():
+        source("10.0.0.1"),
+        destination("192.0.2.1"),
+        local("10.0.0.2"),
+        peerName("peer")
+    {
+        source.port(12345);
+        destination.port(80);
+        local.port(3128);
+    }
+
+    /// calls memo.sync() with our state
+    void sync(Acl::Memo &memo) const { memo.sync(urlGeneration, reply, source, destination, local, peerName); }
+
+    uint64_t urlGeneration = 1;
+    HttpReply::Pointer reply;
+    Ip::Address source;
+    Ip::Address destination;
+    Ip::Address local;
+    SBuf peerName;
+};
+
+/// the remembered result of the given ACL
+/// \returns -1 if there is no remembered result
+int
+Remembered(const Acl::Memo &memo, const Acl::Node &acl)
+{
+    auto matched = false;
+    if (!memo.find(acl, matched))
+        return -1;
+    return matched ? 1 : 0;
+}
+
+} // namespace
+
+void
+TestACLMemo::testRemember()
+{
+    const RefCount<TestNode> a = new TestNode;
+    const RefCount<TestNode> b = new TestNode;
+
+    Acl::Memo::Pointer memo = new Acl::Memo;
+    CPPUNIT_ASSERT_EQUAL(-1, Remembered(*memo, *a));
+
+    CPPUNIT_ASSERT(memo->remember(*a, 1, false));
+    CPPUNIT_ASSERT(memo->remember(*b, 0, false));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), memo->size());
+    CPPUNIT_ASSERT_EQUAL(1, Remembered(*memo, *a));
+    CPPUNIT_ASSERT_EQUAL(0, Remembered(*memo, *b));
+
+    // newer results replace older ones
+    CPPUNIT_ASSERT(memo->remember(*a, 0, false));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), memo->size());
+    CPPUNIT_ASSERT_EQUAL(0, Remembered(*memo, *a));
+
+    // remembered ACLs outlive their (reconfigured) owners
+    CPPUNIT_ASSERT_EQUAL(2U, a->LockCount());
+    memo = nullptr;
+    CPPUNIT_ASSERT_EQUAL(1U, a->LockCount());
+}
+
+void
+TestACLMemo::testAsyncResults()
+{
+    const RefCount<TestNode> acl = new TestNode;
+    Acl::Memo memo;
+
+    // an ACL waiting for an async lookup has no result yet
+    CPPUNIT_ASSERT(!memo.remember(*acl, -1, true));
+    CPPUNIT_ASSERT(!memo.remember(*acl, 0, true));
+    CPPUNIT_ASSERT_EQUAL(-1, Remembered(memo, *acl));
+
+    // neither has an ACL that could not be evaluated
+    CPPUNIT_ASSERT(!memo.remember(*acl, -1, false));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), memo.size());
+
+    // the result after the lookup completion is remembered
+    CPPUNIT_ASSERT(memo.remember(*acl, 1, false));
+    CPPUNIT_ASSERT_EQUAL(1, Remembered(memo, *acl));
+}
+
+void
+TestACLMemo::testSync()
+{
+    const RefCount<TestNode> acl = new TestNode;
+    Acl::Memo memo;
+    State state;
+
+    state.sync(memo);
+    CPPUNIT_ASSERT(memo.remember(*acl, 1, false));
+
+    // the same state keeps the results
+    state.sync(memo);
+    State().sync(memo);
+    CPPUNIT_ASSERT_EQUAL(1, Remembered(memo, *acl));
+
+    // results computed for the new state survive future syncs with it
+    state.urlGeneration = 2;
+    state.sync(memo);
+    CPPUNIT_ASSERT_EQUAL(-1, Remembered(memo, *acl));
+    CPPUNIT_ASSERT(memo.remember(*acl, 0, false));
+    state.sync(memo);
+    CPPUNIT_ASSERT_EQUAL(0, Remembered(memo, *acl));
+}
+
+void
+TestACLMemo::testInvalidation()
+{
+    const RefCount<TestNode> acl = new TestNode;
+
+    // HttpReply changes are not tested here because test replies are
+    // expensive to create; Acl::Memo compares them the same way
+
+    using Change = std::function<void(State &)>;
+    const auto changes = {
+        Change([](State &state) { ++state.urlGeneration; }),
+        Change([](State &state) { state.source.port(54321); }),
+        Change([](State &state) { state.source = Ip::Address("10.0.0.3"); }),
+        Change([](State &state) { state.destination = Ip::Address("192.0.2.2"); }),
+        Change([](State &state) { state.destination.port(443); }),
+        Change([](State &state) { state.local = Ip::Address("10.0.0.4"); }),
+        Change([](State &state) { state.peerName = SBuf("other"); }),
+    };
+
+    for (const auto &change: changes) {
+        Acl::Memo memo;
+        State state;
+        state.sync(memo);
+        CPPUNIT_ASSERT(memo.remember(*acl, 1, false));
+
+        change(state);
+        state.sync(memo);
+        CPPUNIT_ASSERT_EQUAL(-1, Remembered(memo, *acl));
+        CPPUNIT_ASSERT_EQUAL(size_t(0), memo.size());
+    }
+}
+
+int
+main(int argc, char *argv[])
+{
+    return TestProgram().run(argc, argv);
+}
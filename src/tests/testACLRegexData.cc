@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#include "squid.h"
+#include "acl/RegexData.h"
+#include "base/RegexPattern.h"
+#include "compat/cppunit.h"
+#include "ConfigParser.h"
+#include "sbuf/Stream.h"
+#include "unitTestMain.h"
+
+class TestACLRegexData : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(TestACLRegexData);
+    CPPUNIT_TEST(testMatch);
+    CPPUNIT_TEST(testConfigurationOrder);
+    CPPUNIT_TEST(testCaseFlags);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    void testMatch();
+    void testConfigurationOrder();
+    void testCaseFlags();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestACLRegexData );
+
+/// feeds the given ACL parameters to data.parse()
+static void
+Parse(ACLRegexData &data, const char *parameters)
+{
+    // squid.conf defaults that allow unquoted regular expressions
+    ConfigParser::RecognizeQuotedValues = false;
+    ConfigParser::StrictMode = false;
+    char line[256];
+    xstrncpy(line, parameters, sizeof(line));
+    ConfigParser::SetCfgLine(line);
+    data.parse();
+}
+
+/// the first pattern matching the given word (as it would be reported)
+/// or an empty string if no pattern matches
+static SBuf
+FirstMatch(ACLRegexData &data, const char *word)
+{
+    SBufStream os;
+    if (const auto pattern = data.firstMatch(word))
+        os << *pattern;
+    return os.buf();
+}
+
+/// dump() output as a single string
+static SBuf
+Dump(const ACLRegexData &data)
+{
+    const auto dump = data.dump();
+    CPPUNIT_ASSERT_EQUAL(size_t(1), dump.size());
+    return dump.front();
+}
+
+void
+TestACLRegexData::testMatch()
+{
+    ACLRegexData data;
+    Parse(data, "^www[.]example[.]com$ [0-9]+[.]test$ \\.gov$");
+    data.prepareForUse();
+
+    CPPUNIT_ASSERT(data.match("www.example.com"));
+    CPPUNIT_ASSERT(!data.match("www.example.com.au"));
+    CPPUNIT_ASSERT(data.match("host42.test"));
+    CPPUNIT_ASSERT(!data.match("host.test"));
+    CPPUNIT_ASSERT(data.match("www.usa.gov"));
+    CPPUNIT_ASSERT(!data.match(nullptr));
+}
+
+void
+TestACLRegexData::testConfigurationOrder()
+{
+    ACLRegexData data;
+    // a pattern without required literals precedes one with them
+    Parse(data, "[0-9]+$ foo[0-9]+");
+    // and follows one on the next squid.conf line
+    Parse(data, "bar[0-9]+ ^[a-z]+[0-9]x$");
+    data.prepareForUse();
+
+    CPPUNIT_ASSERT_EQUAL(SBuf("([0-9]+$)"), FirstMatch(data, "foo123"));
+    CPPUNIT_ASSERT_EQUAL(SBuf("foo[0-9]+"), FirstMatch(data, "foo12x"));
+    CPPUNIT_ASSERT_EQUAL(SBuf("bar[0-9]+"), FirstMatch(data, "bar1x"));
+    CPPUNIT_ASSERT_EQUAL(SBuf("(^[a-z]+[0-9]x$)"), FirstMatch(data, "ab1x"));
+    CPPUNIT_ASSERT_EQUAL(SBuf(), FirstMatch(data, "xyz"));
+
+    CPPUNIT_ASSERT_EQUAL(SBuf("([0-9]+$) foo[0-9]+ bar[0-9]+ (^[a-z]+[0-9]x$)"), Dump(data));
+}
+
+void
+TestACLRegexData::testCaseFlags()
+{
+    ACLRegexData data;
+    Parse(data, "-i [a-z]+[0-9] Example[.]com +i ^[A-Z]+$ Squid-cache");
+    data.prepareForUse();
+
+    CPPUNIT_ASSERT_EQUAL(SBuf("-i ([a-z]+[0-9])"), FirstMatch(data, "X1"));
+    CPPUNIT_ASSERT_EQUAL(SBuf("-i Example[.]com"), FirstMatch(data, "www.EXAMPLE.com"));
+    CPPUNIT_ASSERT_EQUAL(SBuf("(^[A-Z]+$)"), FirstMatch(data, "ABC"));
+    CPPUNIT_ASSERT_EQUAL(SBuf(), FirstMatch(data, "abc"));
+    CPPUNIT_ASSERT_EQUAL(SBuf("Squid-cache"), FirstMatch(data, "www.Squid-cache.org"));
+    CPPUNIT_ASSERT_EQUAL(SBuf(), FirstMatch(data, "www.squid-cache.org"));
+
+    CPPUNIT_ASSERT_EQUAL(SBuf("-i ([a-z]+[0-9]) Example[.]com +i (^[A-Z]+$) Squid-cache"), Dump(data));
+}
+
+int
+main(int argc, char *argv[])
+{
+    return TestProgram().run(argc, argv);
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#include "squid.h"
+#include "acl/RegexPrefilter.h"
+#include "compat/cppunit.h"
+#include "unitTestMain.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+class TestACLRegexPrefilter : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(TestACLRegexPrefilter);
+    CPPUNIT_TEST(testRequiredLiteral);
+    CPPUNIT_TEST(testFind);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    void testRequiredLiteral();
+    void testFind();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestACLRegexPrefilter );
+
+/// RequiredLiteral() result for the given pattern
+static std::string
+Literal(const char *pattern)
+{
+    return Acl::RegexPrefilter::RequiredLiteral(pattern);
+}
+
+void
+TestACLRegexPrefilter::testRequiredLiteral()
+{
+    CPPUNIT_ASSERT_EQUAL(std::string(".jpg"), Literal("\\.jpg$"));
+    CPPUNIT_ASSERT_EQUAL(std::string("http://www.example.com/"), Literal("^http://www\\.example\\.com/"));
+    CPPUNIT_ASSERT_EQUAL(std::string("defg"), Literal("(abc)+defg"));
+    CPPUNIT_ASSERT_EQUAL(std::string("yzw"), Literal("x[abc]yzw"));
+    CPPUNIT_ASSERT_EQUAL(std::string("foobar"), Literal("[[:alpha:]]+foobar"));
+    CPPUNIT_ASSERT_EQUAL(std::string("hello"), Literal("\\w+hello\\b"));
+
+    // GNU anchors are not literals
+    CPPUNIT_ASSERT_EQUAL(std::string("hello"), Literal("\\<hello\\>"));
+    CPPUNIT_ASSERT_EQUAL(std::string("world"), Literal("abc\\>world"));
+    CPPUNIT_ASSERT_EQUAL(std::string("hello"), Literal("\\`hello\\'"));
+    CPPUNIT_ASSERT_EQUAL(std::string("world"), Literal("ab\\'world"));
+    CPPUNIT_ASSERT_EQUAL(std::string(), Literal("\\<ab\\>"));
+
+    // quantified characters are optional
+    CPPUNIT_ASSERT_EQUAL(std::string("abc"), Literal("abcd?e"));
+    CPPUNIT_ASSERT_EQUAL(std::string("cdefg"), Literal("ab{2,3}cdefg"));
+    CPPUNIT_ASSERT_EQUAL(std::string("abc"), Literal("abcd+?e"));
+    CPPUNIT_ASSERT_EQUAL(std::string("abcd"), Literal("abcd+e"));
+
+    // no literals or too short ones
+    CPPUNIT_ASSERT_EQUAL(std::string(), Literal(".*"));
+    CPPUNIT_ASSERT_EQUAL(std::string(), Literal("ab"));
+    CPPUNIT_ASSERT_EQUAL(std::string(), Literal("abc|def"));
+    CPPUNIT_ASSERT_EQUAL(std::string(), Literal("[]abcdef]gh"));
+
+    // malformed patterns
+    CPPUNIT_ASSERT_EQUAL(std::string(), Literal("foobar\\"));
+    CPPUNIT_ASSERT_EQUAL(std::string(), Literal("(foobar"));
+    CPPUNIT_ASSERT_EQUAL(std::string(), Literal("foobar)"));
+}
+
+void
+TestACLRegexPrefilter::testFind()
+{
+    Acl::RegexPrefilter prefilter;
+    CPPUNIT_ASSERT(prefilter.empty());
+    prefilter.add("he", 0);
+    prefilter.add("She", 1);
+    prefilter.add("his", 2);
+    prefilter.add("hers", 3);
+    prefilter.add("hers", 4);
+    CPPUNIT_ASSERT(!prefilter.empty());
+    CPPUNIT_ASSERT(!prefilter.compiled());
+    prefilter.compile();
+    CPPUNIT_ASSERT(prefilter.compiled());
+
+    const auto find = [&prefilter](const char *text) {
+        std::vector<size_t> ids;
+        prefilter.find(text, ids);
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        return ids;
+    };
+
+    CPPUNIT_ASSERT(find("USHERS") == std::vector<size_t>({0, 1, 3, 4}));
+    CPPUNIT_ASSERT(find("this") == std::vector<size_t>({2}));
+    CPPUNIT_ASSERT(find("shi") == std::vector<size_t>());
+    CPPUNIT_ASSERT(find("") == std::vector<size_t>());
+}
+
+int
+main(int argc, char *argv[])
+{
+    return TestProgram().run(argc, argv);
+}
+
@@ -7,15 +7,25 @@
  */
 
 #include "squid.h"
+#include "acl/Acl.h"
+#include "acl/FilledChecklist.h"
+#include "acl/StatsAction.h"
 #include "anyp/Uri.h"
 #include "CacheManager.h"
 #include "compat/cppunit.h"
+#include "ConfigParser.h"
+#include "ipc/TypedMsgHdr.h"
 #include "mgr/Action.h"
+#include "mgr/Command.h"
 #include "mgr/Registration.h"
+#include "sbuf/Stream.h"
+#include "SquidConfig.h"
 #include "Store.h"
+#include "tests/CapturingStoreEntry.h"
 #include "unitTestMain.h"
 
 #include <cppunit/TestAssert.h>
+#include <sstream>
 /*
  * test the CacheManager implementation
  */
@@ -26,12 +36,16 @@ class TestCacheManager : public CPPUNIT_NS::TestFixture
     CPPUNIT_TEST(testCreate);
     CPPUNIT_TEST(testRegister);
     CPPUNIT_TEST(testParseUrl);
+    CPPUNIT_TEST(testAclTiming);
+    CPPUNIT_TEST(testAclStatsAggregation);
     CPPUNIT_TEST_SUITE_END();
 
 protected:
     void testCreate();
     void testRegister();
     void testParseUrl();
+    void testAclTiming();
+    void testAclStatsAggregation();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION( TestCacheManager );
@@ -60,6 +74,68 @@ CacheManagerInternals::testInvalidUrl(const AnyP::Uri &url, const char *const pr
     CPPUNIT_ASSERT_THROW_MESSAGE(problem, ParseUrl(url), TextException);
 }
 
+/// Provides test code access to Acl::StatsAction internal symbols
+class AclStatsActionInternals: public Acl::StatsAction
+{
+public:
+    AclStatsActionInternals(): StatsAction(NewCommand()) {}
+
+    using StatsAction::collect;
+    using StatsAction::dump;
+
+private:
+    /// a command for the registered acl_stats action
+    static Mgr::Command::Pointer NewCommand()
+    {
+        const Mgr::Command::Pointer cmd = new Mgr::Command;
+        cmd->profile = CacheManager::GetInstance()->findAction("acl_stats");
+        CPPUNIT_ASSERT(cmd->profile);
+        return cmd;
+    }
+};
+
+/// an ACL that always matches
+class TestAcl: public Acl::Node
+{
+    MEMPROXY_CLASS(TestAcl);
+
+public:
+    explicit TestAcl(Acl::TypeName) {}
+
+    /* Acl::Node API */
+    void parse() override {}
+    char const *typeString() const override { return "test"; }
+    SBufList dump() const override { return SBufList(); }
+    bool empty() const override { return false; }
+
+private:
+    /* Acl::Node API */
+    int match(ACLChecklist *) override { return 1; }
+};
+
+/// configures a named TestAcl
+static Acl::Node &
+AddTestAcl(const SBuf &name)
+{
+    const auto line = xstrdup(SBuf(name).append(" test").c_str());
+    ConfigParser::SetCfgLine(line);
+    ConfigParser parser;
+    Acl::Node::ParseNamedAcl(parser, Config.namedAcls);
+    xfree(line);
+    const auto acl = Acl::Node::FindByName(name);
+    CPPUNIT_ASSERT(acl);
+    return *acl;
+}
+
+/// the acl_stats report produced by the given action
+static std::string
+AclStatsReport(AclStatsActionInternals &action)
+{
+    CapturingStoreEntry entry;
+    action.dump(&entry);
+    return entry._appended_text.termedBuf();
+}
+
 /// customizes our test setup
 class MyTestProgram: public TestProgram
 {
@@ -73,6 +149,8 @@ MyTestProgram::startup()
 {
     Mem::Init();
     AnyP::UriScheme::Init();
+    Acl::RegisterMaker("test", [](Acl::TypeName name)->Acl::Node* { return new TestAcl(name); });
+    Acl::StatsAction::RegisterWithCacheManager();
 }
 
 /*
@@ -254,6 +332,107 @@ TestCacheManager::testParseUrl()
     }
 }
 
+void
+TestCacheManager::testAclTiming()
+{
+    const auto &acl = AddTestAcl(SBuf("timed"));
+    ACLFilledChecklist checklist(nullptr, nullptr);
+
+    // acl_timing is off by default
+    CPPUNIT_ASSERT(acl.matches(&checklist));
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), acl.stats.evaluations);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), acl.stats.matches);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), acl.stats.totalTime);
+
+    Config.onoff.aclTiming = 1;
+    for (int i = 0; i < 10; ++i)
+        CPPUNIT_ASSERT(acl.matches(&checklist));
+    Config.onoff.aclTiming = 0;
+    CPPUNIT_ASSERT_EQUAL(uint64_t(11), acl.stats.evaluations);
+    CPPUNIT_ASSERT(acl.stats.totalTime > 0);
+    CPPUNIT_ASSERT(acl.stats.maxTime <= acl.stats.totalTime);
+
+    Acl::FreeNamedAcls(&Config.namedAcls);
+}
+
+void
+TestCacheManager::testAclStatsAggregation()
+{
+    // the first kid evaluated more ACLs than fit into one IPC message
+    const auto aclCount = 500;
+    uint64_t evaluations = 0;
+    for (int i = 0; i < aclCount; ++i) {
+        auto &acl = AddTestAcl(ToSBuf("acl_stats_test_", i));
+        acl.stats.evaluations = i + 1;
+        acl.stats.totalTime = (i + 1) * 1000;
+        evaluations += acl.stats.evaluations;
+    }
+    AclStatsActionInternals firstKid;
+    firstKid.collect();
+    Ipc::TypedMsgHdr firstResponse;
+    firstKid.pack(firstResponse);
+
+    // the second kid evaluated only the cheapest and the most expensive ACLs
+    Acl::VisitNamedAcls([](const Acl::Node &acl) { acl.stats = Acl::NodeStats(); });
+    Acl::Node::FindByName(SBuf("acl_stats_test_0"))->stats.evaluations = 1;
+    Acl::Node::FindByName(ToSBuf("acl_stats_test_", aclCount - 1))->stats.evaluations = 1;
+    evaluations += 2;
+    AclStatsActionInternals secondKid;
+    secondKid.collect();
+    Ipc::TypedMsgHdr secondResponse;
+    secondKid.pack(secondResponse);
+
+    // Coordinator combines kid responses
+    AclStatsActionInternals aggregate;
+    AclStatsActionInternals firstReceived;
+    firstReceived.unpack(Ipc::TypedMsgHdr(firstResponse));
+    aggregate.add(firstReceived);
+    AclStatsActionInternals secondReceived;
+    secondReceived.unpack(Ipc::TypedMsgHdr(secondResponse));
+    aggregate.add(secondReceived);
+
+    std::istringstream report(AclStatsReport(aggregate));
+    uint64_t reported = 0;
+    auto rows = 0;
+    auto partialRows = 0;
+    auto otherRows = 0;
+    auto cheapestMarked = false;
+    std::string line;
+    while (std::getline(report, line)) {
+        if (line.find("acl_stats_test_") != 0 && line.find("(other ACLs)") != 0)
+            continue;
+        const auto name = line.substr(0, line.find('\t'));
+        const auto columns = line.substr(name.size() + 1);
+        std::istringstream values(columns.substr(columns.find('\t') + 1));
+        uint64_t rowEvaluations = 0;
+        values >> rowEvaluations;
+        reported += rowEvaluations;
+
+        if (name == "(other ACLs)") {
+            ++otherRows;
+            continue;
+        }
+        ++rows;
+        if (name.back() == '*')
+            ++partialRows;
+
+        // the first kid sent its most expensive ACLs but omitted the cheapest
+        if (name == ToSBuf("acl_stats_test_", aclCount - 1).toStdString())
+            CPPUNIT_ASSERT_EQUAL(uint64_t(aclCount + 1), rowEvaluations);
+        if (name == "acl_stats_test_0*")
+            cheapestMarked = true;
+    }
+
+    // omitted ACLs are accounted for
+    CPPUNIT_ASSERT_EQUAL(evaluations, reported);
+    CPPUNIT_ASSERT_EQUAL(1, otherRows);
+    CPPUNIT_ASSERT(rows < aclCount);
+    CPPUNIT_ASSERT_EQUAL(1, partialRows);
+    CPPUNIT_ASSERT(cheapestMarked);
+
+    Acl::FreeNamedAcls(&Config.namedAcls);
+}
+
 int
 main(int argc, char *argv[])
 {
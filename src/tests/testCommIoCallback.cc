@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#include "squid.h"
+#include "base/AsyncCall.h"
+#include "base/AsyncFunCalls.h"
+#include "comm/Connection.h"
+#include "comm/IoCallback.h"
+#include "compat/cppunit.h"
+#include "unitTestMain.h"
+
+class TestCommIoCallback: public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(TestCommIoCallback);
+    CPPUNIT_TEST(testSingleBuffer);
+    CPPUNIT_TEST(testPartialWrites);
+    CPPUNIT_TEST(testByteLimit);
+    CPPUNIT_TEST(testEmptyBuffers);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    void testSingleBuffer();
+    void testPartialWrites();
+    void testByteLimit();
+    void testEmptyBuffers();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestCommIoCallback );
+
+namespace
+{
+
+/// the three buffers of a vectored write used by most test cases
+char First[10];
+char Second[20];
+char Third[30];
+
+void
+IgnoreCall()
+{
+}
+
+/// starts a write of First (via setCallback()) followed by Second and Third
+void
+StartWrite(Comm::IoCallback &writer)
+{
+    writer.type = Comm::IOCB_WRITE;
+    AsyncCall::Pointer call = asyncCall(5, 5, "TestCommIoCallback", NullaryFunDialer(&IgnoreCall));
+    writer.setCallback(Comm::IOCB_WRITE, call, First, nullptr, sizeof(First));
+
+    struct iovec more[2];
+    more[0].iov_base = Second;
+    more[0].iov_len = sizeof(Second);
+    more[1].iov_base = Third;
+    more[1].iov_len = sizeof(Third);
+    writer.appendBuffers(more, 2);
+}
+
+/// asserts that the given iov entry covers the given buffer area
+void
+CheckEntry(const struct iovec &entry, const char *start, const size_t length)
+{
+    CPPUNIT_ASSERT_EQUAL(static_cast<const void *>(start), static_cast<const void *>(entry.iov_base));
+    CPPUNIT_ASSERT_EQUAL(length, entry.iov_len);
+}
+
+} // namespace
+
+void
+TestCommIoCallback::testSingleBuffer()
+{
+    Comm::IoCallback writer = {};
+    writer.type = Comm::IOCB_WRITE;
+    AsyncCall::Pointer call = asyncCall(5, 5, "TestCommIoCallback", NullaryFunDialer(&IgnoreCall));
+    writer.setCallback(Comm::IOCB_WRITE, call, First, nullptr, sizeof(First));
+
+    struct iovec iov[Comm::IoCallback::MaxBuffers];
+    CPPUNIT_ASSERT_EQUAL(1, writer.unwrittenBuffers(iov, 1000));
+    CheckEntry(iov[0], First, sizeof(First));
+
+    writer.offset = 4;
+    CPPUNIT_ASSERT_EQUAL(1, writer.unwrittenBuffers(iov, 1000));
+    CheckEntry(iov[0], First + 4, sizeof(First) - 4);
+
+    writer.offset = sizeof(First);
+    CPPUNIT_ASSERT_EQUAL(0, writer.unwrittenBuffers(iov, 1000));
+}
+
+void
+TestCommIoCallback::testPartialWrites()
+{
+    Comm::IoCallback writer = {};
+    StartWrite(writer);
+    CPPUNIT_ASSERT_EQUAL(60, writer.size);
+
+    struct iovec iov[Comm::IoCallback::MaxBuffers];
+    CPPUNIT_ASSERT_EQUAL(3, writer.unwrittenBuffers(iov, 1000));
+    CheckEntry(iov[0], First, sizeof(First));
+    CheckEntry(iov[1], Second, sizeof(Second));
+    CheckEntry(iov[2], Third, sizeof(Third));
+
+    // a partial write that ended inside the second buffer
+    writer.offset = 15;
+    CPPUNIT_ASSERT_EQUAL(2, writer.unwrittenBuffers(iov, 1000));
+    CheckEntry(iov[0], Second + 5, sizeof(Second) - 5);
+    CheckEntry(iov[1], Third, sizeof(Third));
+
+    // a partial write that ended exactly at a buffer boundary
+    writer.offset = 30;
+    CPPUNIT_ASSERT_EQUAL(1, writer.unwrittenBuffers(iov, 1000));
+    CheckEntry(iov[0], Third, sizeof(Third));
+
+    // one byte left
+    writer.offset = 59;
+    CPPUNIT_ASSERT_EQUAL(1, writer.unwrittenBuffers(iov, 1000));
+    CheckEntry(iov[0], Third + 29, 1);
+
+    writer.offset = 60;
+    CPPUNIT_ASSERT_EQUAL(0, writer.unwrittenBuffers(iov, 1000));
+}
+
+void
+TestCommIoCallback::testByteLimit()
+{
+    Comm::IoCallback writer = {};
+    StartWrite(writer);
+
+    struct iovec iov[Comm::IoCallback::MaxBuffers];
+
+    // the limit ends inside the second buffer
+    CPPUNIT_ASSERT_EQUAL(2, writer.unwrittenBuffers(iov, 25));
+    CheckEntry(iov[0], First, sizeof(First));
+    CheckEntry(iov[1], Second, 15);
+
+    // the limit ends at a buffer boundary
+    CPPUNIT_ASSERT_EQUAL(1, writer.unwrittenBuffers(iov, 10));
+    CheckEntry(iov[0], First, sizeof(First));
+
+    // both an offset and a limit inside the same buffer
+    writer.offset = 12;
+    CPPUNIT_ASSERT_EQUAL(1, writer.unwrittenBuffers(iov, 3));
+    CheckEntry(iov[0], Second + 2, 3);
+
+    // no quota
+    CPPUNIT_ASSERT_EQUAL(0, writer.unwrittenBuffers(iov, 0));
+}
+
+void
+TestCommIoCallback::testEmptyBuffers()
+{
+    Comm::IoCallback writer = {};
+    writer.type = Comm::IOCB_WRITE;
+    AsyncCall::Pointer call = asyncCall(5, 5, "TestCommIoCallback", NullaryFunDialer(&IgnoreCall));
+    writer.setCallback(Comm::IOCB_WRITE, call, First, nullptr, 0);
+
+    struct iovec more[2];
+    more[0].iov_base = Second;
+    more[0].iov_len = 0;
+    more[1].iov_base = Third;
+    more[1].iov_len = sizeof(Third);
+    writer.appendBuffers(more, 2);
+    CPPUNIT_ASSERT_EQUAL(1, writer.moreBufsCount);
+    CPPUNIT_ASSERT_EQUAL(static_cast<int>(sizeof(Third)), writer.size);
+
+    struct iovec iov[Comm::IoCallback::MaxBuffers];
+    CPPUNIT_ASSERT_EQUAL(1, writer.unwrittenBuffers(iov, 1000));
+    CheckEntry(iov[0], Third, sizeof(Third));
+}
+
+int
+main(int argc, char *argv[])
+{
+    return TestProgram().run(argc, argv);
+}
+
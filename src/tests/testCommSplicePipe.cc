@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#include "squid.h"
+#include "compat/cppunit.h"
+#include "unitTestMain.h"
+
+#if HAVE_SPLICE
+
+#include "comm/SplicePipe.h"
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#if HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#if HAVE_SYS_SOCKET_H
+#include <sys/socket.h>
+#endif
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+class TestCommSplicePipe: public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(TestCommSplicePipe);
+    CPPUNIT_TEST(testRelay);
+    CPPUNIT_TEST(testPartialDrain);
+    CPPUNIT_TEST(testNothingToFill);
+    CPPUNIT_TEST(testEof);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    void testRelay();
+    void testPartialDrain();
+    void testNothingToFill();
+    void testEof();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestCommSplicePipe );
+
+namespace
+{
+
+/// a connected pair of non-blocking stream sockets, closed on destruction
+class SocketPair
+{
+public:
+    SocketPair()
+    {
+        CPPUNIT_ASSERT_EQUAL(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+        for (const auto fd: fds)
+            CPPUNIT_ASSERT(fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK) >= 0);
+    }
+    ~SocketPair()
+    {
+        for (const auto fd: fds)
+            close(fd);
+    }
+
+    /// sends all of the given bytes from the first to the second socket
+    void send(const std::string &bytes)
+    {
+        CPPUNIT_ASSERT_EQUAL(static_cast<ssize_t>(bytes.size()), write(fds[0], bytes.data(), bytes.size()));
+    }
+
+    /// receives whatever the second socket has (up to 64 KB)
+    std::string receive()
+    {
+        char buf[64*1024];
+        const auto len = read(fds[1], buf, sizeof(buf));
+        return len > 0 ? std::string(buf, len) : std::string();
+    }
+
+    int fds[2];
+};
+
+} // namespace
+
+void
+TestCommSplicePipe::testRelay()
+{
+    SocketPair in;
+    SocketPair out;
+    Comm::SplicePipe pipe;
+    CPPUNIT_ASSERT(!pipe.isOpen());
+    CPPUNIT_ASSERT(pipe.open());
+    CPPUNIT_ASSERT(pipe.isOpen());
+    CPPUNIT_ASSERT(pipe.readFd() >= 0);
+    CPPUNIT_ASSERT(pipe.writeFd() >= 0);
+
+    in.send("hello, world");
+    CPPUNIT_ASSERT_EQUAL(static_cast<ssize_t>(12), pipe.fill(in.fds[1], 64*1024));
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(12), pipe.size());
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<ssize_t>(12), pipe.drain(out.fds[0]));
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), pipe.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("hello, world"), out.receive());
+
+    // the fill size limit
+    in.send("0123456789");
+    CPPUNIT_ASSERT_EQUAL(static_cast<ssize_t>(4), pipe.fill(in.fds[1], 4));
+    CPPUNIT_ASSERT_EQUAL(static_cast<ssize_t>(4), pipe.drain(out.fds[0]));
+    CPPUNIT_ASSERT_EQUAL(std::string("0123"), out.receive());
+    CPPUNIT_ASSERT_EQUAL(static_cast<ssize_t>(6), pipe.fill(in.fds[1], 64*1024));
+    CPPUNIT_ASSERT_EQUAL(static_cast<ssize_t>(6), pipe.drain(out.fds[0]));
+    CPPUNIT_ASSERT_EQUAL(std::string("456789"), out.receive());
+}
+
+void
+TestCommSplicePipe::testPartialDrain()
+{
+    SocketPair in;
+    SocketPair out;
+    Comm::SplicePipe pipe;
+    CPPUNIT_ASSERT(pipe.open());
+
+    // fill the outgoing socket buffers so that drain() cannot finish
+    const std::string chunk(4096, 'x');
+    while (write(out.fds[0], chunk.data(), chunk.size()) > 0) {}
+    while (write(out.fds[0], "x", 1) > 0) {}
+    CPPUNIT_ASSERT(errno == EAGAIN || errno == EWOULDBLOCK);
+
+    in.send("payload");
+    CPPUNIT_ASSERT_EQUAL(static_cast<ssize_t>(7), pipe.fill(in.fds[1], 64*1024));
+    CPPUNIT_ASSERT_EQUAL(static_cast<ssize_t>(-1), pipe.drain(out.fds[0]));
+    CPPUNIT_ASSERT(errno == EAGAIN || errno == EWOULDBLOCK);
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(7), pipe.size());
+
+    // make room and finish
+    std::string received;
+    while (true) {
+        const auto bytes = out.receive();
+        if (bytes.empty())
+            break;
+        received += bytes;
+    }
+    CPPUNIT_ASSERT(!received.empty());
+    CPPUNIT_ASSERT_EQUAL(static_cast<ssize_t>(7), pipe.drain(out.fds[0]));
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), pipe.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("payload"), out.receive());
+}
+
+void
+TestCommSplicePipe::testNothingToFill()
+{
+    SocketPair in;
+    Comm::SplicePipe pipe;
+    CPPUNIT_ASSERT(pipe.open());
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<ssize_t>(-1), pipe.fill(in.fds[1], 64*1024));
+    CPPUNIT_ASSERT(errno == EAGAIN || errno == EWOULDBLOCK);
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), pipe.size());
+}
+
+void
+TestCommSplicePipe::testEof()
+{
+    SocketPair in;
+    Comm::SplicePipe pipe;
+    CPPUNIT_ASSERT(pipe.open());
+
+    CPPUNIT_ASSERT_EQUAL(0, shutdown(in.fds[0], SHUT_WR));
+    CPPUNIT_ASSERT_EQUAL(static_cast<ssize_t>(0), pipe.fill(in.fds[1], 64*1024));
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), pipe.size());
+}
+
+#endif /* HAVE_SPLICE */
+
+int
+main(int argc, char *argv[])
+{
+    return TestProgram().run(argc, argv);
+}
+
@@ -0,0 +1,259 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#include "squid.h"
+#include "compat/cppunit.h"
+#include "unitTestMain.h"
+
+#include "DiskIO/IpcIo/IpcIoRing.h"
+
+#if USE_IPCIO_RING
+
+#include "comm/Loops.h"
+#include "fd.h"
+#include "ipc/mem/Pages.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#if HAVE_POLL_H
+#include <poll.h>
+#endif
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+class TestIpcIoRing: public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(TestIpcIoRing);
+    CPPUNIT_TEST(testWriteRead);
+    CPPUNIT_TEST(testFull);
+    CPPUNIT_TEST(testAbandon);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+protected:
+    void testWriteRead();
+    void testFull();
+    void testAbandon();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestIpcIoRing );
+
+namespace
+{
+
+const size_t TestPageSize = 4096;
+
+/// the contents of shared memory pages, indexed by PageId::number
+std::vector<char> Pages(8 * TestPageSize);
+/// PageId::number of pages returned via Ipc::Mem::PutPage()
+std::vector<uint32_t> FreedPages;
+/// responses sent via IpcIoFile::DiskerRespond()
+std::vector<IpcIoMsg> Responses;
+
+/// the completion handler that IpcIoRing registered with Comm::SetSelect()
+PF *CompletionHandler = nullptr;
+void *CompletionData = nullptr;
+int CompletionFd = -1;
+
+/// a temporary db file, removed on destruction
+class DbFile
+{
+public:
+    DbFile()
+    {
+        char name[] = "/tmp/testIpcIoRing.XXXXXX";
+        fd = mkstemp(name);
+        CPPUNIT_ASSERT(fd >= 0);
+        unlink(name);
+    }
+    ~DbFile() { close(fd); }
+
+    int fd = -1;
+};
+
+/// an I/O request for the given page
+IpcIoMsg
+Request(const IpcIo::Command command, const uint32_t pageNumber, const off_t offset, const unsigned int requestId)
+{
+    IpcIoMsg msg;
+    msg.requestId = requestId;
+    msg.command = command;
+    msg.offset = offset;
+    msg.len = TestPageSize;
+    msg.page.pool = 1;
+    msg.page.number = pageNumber;
+    msg.page.purpose = Ipc::Mem::PageId::ioPage;
+    msg.workerPid = getpid();
+    return msg;
+}
+
+/// waits for the ring to signal completions and handles them
+void
+HandleCompletions()
+{
+    CPPUNIT_ASSERT(CompletionHandler);
+    pollfd pfd = { CompletionFd, POLLIN, 0 };
+    CPPUNIT_ASSERT_EQUAL(1, poll(&pfd, 1, 5000));
+    CompletionHandler(CompletionFd, CompletionData);
+}
+
+/// waits until the ring responds to the given number of requests
+void
+WaitForResponses(const size_t count)
+{
+    while (Responses.size() < count)
+        HandleCompletions();
+}
+
+} // namespace
+
+void
+TestIpcIoRing::setUp()
+{
+    FreedPages.clear();
+    Responses.clear();
+    CompletionHandler = nullptr;
+    CompletionData = nullptr;
+    CompletionFd = -1;
+}
+
+void
+TestIpcIoRing::tearDown()
+{
+    // the ring unregisters its handler on destruction
+    CPPUNIT_ASSERT(!CompletionHandler);
+}
+
+void
+TestIpcIoRing::testWriteRead()
+{
+    DbFile db;
+    const auto ring = IpcIoRing::Create(db.fd, SBuf("testWriteRead"), 4);
+    CPPUNIT_ASSERT(ring);
+
+    memset(&Pages[1 * TestPageSize], 'w', TestPageSize);
+    ring->start(1, Request(IpcIo::cmdWrite, 1, TestPageSize, 10));
+    ring->submit();
+    WaitForResponses(1);
+
+    CPPUNIT_ASSERT_EQUAL(10U, Responses[0].requestId);
+    CPPUNIT_ASSERT_EQUAL(0, Responses[0].xerrno);
+    CPPUNIT_ASSERT_EQUAL(TestPageSize, Responses[0].len);
+    // written pages are freed by the disker
+    CPPUNIT_ASSERT_EQUAL(size_t(1), FreedPages.size());
+    CPPUNIT_ASSERT_EQUAL(1U, FreedPages[0]);
+
+    ring->start(1, Request(IpcIo::cmdRead, 2, TestPageSize, 11));
+    ring->submit();
+    WaitForResponses(2);
+
+    CPPUNIT_ASSERT_EQUAL(11U, Responses[1].requestId);
+    CPPUNIT_ASSERT_EQUAL(0, Responses[1].xerrno);
+    CPPUNIT_ASSERT_EQUAL(TestPageSize, Responses[1].len);
+    CPPUNIT_ASSERT_EQUAL(0, memcmp(&Pages[1 * TestPageSize], &Pages[2 * TestPageSize], TestPageSize));
+    // read pages are freed by the worker receiving the response
+    CPPUNIT_ASSERT_EQUAL(size_t(1), FreedPages.size());
+
+    // reading past the end of the file is not an error
+    ring->start(1, Request(IpcIo::cmdRead, 3, 8 * TestPageSize, 12));
+    ring->submit();
+    WaitForResponses(3);
+    CPPUNIT_ASSERT_EQUAL(0, Responses[2].xerrno);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), Responses[2].len);
+
+    delete ring;
+}
+
+void
+TestIpcIoRing::testFull()
+{
+    DbFile db;
+    const auto ring = IpcIoRing::Create(db.fd, SBuf("testFull"), 2);
+    CPPUNIT_ASSERT(ring);
+
+    CPPUNIT_ASSERT(!ring->full());
+    ring->start(1, Request(IpcIo::cmdWrite, 1, 0, 20));
+    CPPUNIT_ASSERT(!ring->full());
+    ring->start(2, Request(IpcIo::cmdWrite, 2, TestPageSize, 21));
+    CPPUNIT_ASSERT(ring->full());
+    ring->submit();
+
+    WaitForResponses(2);
+    CPPUNIT_ASSERT(!ring->full());
+    for (const auto &response: Responses)
+        CPPUNIT_ASSERT_EQUAL(0, response.xerrno);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), FreedPages.size());
+
+    delete ring;
+}
+
+void
+TestIpcIoRing::testAbandon()
+{
+    DbFile db;
+    const auto ring = IpcIoRing::Create(db.fd, SBuf("testAbandon"), 4);
+    CPPUNIT_ASSERT(ring);
+
+    ring->start(1, Request(IpcIo::cmdWrite, 1, 0, 30));
+    ring->start(1, Request(IpcIo::cmdRead, 2, 0, 31));
+    ring->submit();
+    ring->start(1, Request(IpcIo::cmdRead, 3, 0, 32)); // queued, not submitted
+
+    // the ring waits for the kernel before freeing pages of all requests
+    delete ring;
+    CPPUNIT_ASSERT(Responses.empty());
+    CPPUNIT_ASSERT_EQUAL(size_t(3), FreedPages.size());
+}
+
+/* test doubles for IpcIoRing dependencies */
+
+IpcIoMsg::IpcIoMsg():
+    requestId(0),
+    offset(0),
+    len(0),
+    workerPid(-1),
+    command(IpcIo::cmdNone),
+    xerrno(0)
+{
+    start.tv_sec = 0;
+    start.tv_usec = 0;
+}
+
+bool IpcIoFile::DiskerHandleMoreRequestsScheduled = false;
+void IpcIoFile::DiskerHandleRequests() {}
+void IpcIoFile::DiskerRespond(const int, IpcIoMsg &ipcIo) { Responses.push_back(ipcIo); }
+
+size_t Ipc::Mem::PageSize() { return TestPageSize; }
+char *Ipc::Mem::PagePointer(const PageId &page) { return &Pages[page.number * TestPageSize]; }
+void Ipc::Mem::PutPage(PageId &page) { FreedPages.push_back(page.number); page = PageId(); }
+
+void
+Comm::SetSelect(const int fd, unsigned int, PF *handler, void *data, time_t)
+{
+    CompletionHandler = handler;
+    CompletionData = data;
+    CompletionFd = fd;
+}
+
+void fd_open(int, unsigned int, const char *) {}
+void fd_close(int) {}
+void fd_bytes(int, int, IoDirection) {}
+
+#endif /* USE_IPCIO_RING */
+
+int
+main(int argc, char *argv[])
+{
+    return TestProgram().run(argc, argv);
+}
+
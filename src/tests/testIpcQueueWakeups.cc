@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#include "squid.h"
+#include "base/RunnersRegistry.h"
+#include "comm/Loops.h"
+#include "compat/cppunit.h"
+#include "fd.h"
+#include "globals.h"
+#include "ipc/mem/Segment.h"
+#include "ipc/QueueWakeups.h"
+#include "SquidConfig.h"
+#include "tools.h"
+#include "unitTestMain.h"
+
+#if HAVE_SYS_EVENTFD_H
+
+#include <sstream>
+#if HAVE_POLL_H
+#include <poll.h>
+#endif
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+class TestIpcQueueWakeups: public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(TestIpcQueueWakeups);
+    CPPUNIT_TEST(testNotify);
+    CPPUNIT_TEST(testCoalescing);
+    CPPUNIT_TEST(testOtherKids);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+
+protected:
+    void testNotify();
+    void testCoalescing();
+    void testOtherKids();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestIpcQueueWakeups );
+
+namespace
+{
+
+/// the number of kids in our simulated SMP configuration
+const int KidCount = 3;
+
+/// the number of HandleQueue() calls
+int QueueHandled = 0;
+
+/// the eventfd handler registered with Comm::SetSelect() and its descriptor
+PF *WakeupHandler = nullptr;
+int WakeupFd = -1;
+
+/// a subscribed queue reader
+void
+HandleQueue()
+{
+    ++QueueHandled;
+}
+
+/// whether this kid has been woken up
+bool
+Woken()
+{
+    CPPUNIT_ASSERT(WakeupFd >= 0);
+    pollfd pfd = { WakeupFd, POLLIN, 0 };
+    return poll(&pfd, 1, 0) == 1;
+}
+
+/// handles a pending wakeup like the main loop would
+void
+Wakeup()
+{
+    CPPUNIT_ASSERT(Woken());
+    CPPUNIT_ASSERT(WakeupHandler);
+    WakeupHandler(WakeupFd, nullptr);
+}
+
+/// the named counter value from the Ipc::QueueWakeups::Stat() report
+uint64_t
+Reported(const std::string &name)
+{
+    std::ostringstream os;
+    Ipc::QueueWakeups::Stat(os);
+    const auto report = os.str();
+    const auto pos = report.find("  " + name + ": ");
+    CPPUNIT_ASSERT(pos != std::string::npos);
+    return std::stoull(report.substr(pos + name.size() + 4));
+}
+
+} // namespace
+
+void
+TestIpcQueueWakeups::setUp()
+{
+    QueueHandled = 0;
+    // drain wakeups left by the previous test case
+    if (WakeupFd >= 0 && Woken())
+        WakeupHandler(WakeupFd, nullptr);
+}
+
+void
+TestIpcQueueWakeups::testNotify()
+{
+    const auto sent = Reported("sent");
+    const auto handled = Reported("handled");
+
+    CPPUNIT_ASSERT(!Woken());
+    CPPUNIT_ASSERT(Ipc::QueueWakeups::Notify(KidIdentifier));
+    CPPUNIT_ASSERT(Woken());
+
+    // repeated subscriptions do not result in repeated calls
+    Ipc::QueueWakeups::Subscribe(&HandleQueue);
+    Ipc::QueueWakeups::Subscribe(&HandleQueue);
+    Wakeup();
+    CPPUNIT_ASSERT_EQUAL(1, QueueHandled);
+    CPPUNIT_ASSERT(!Woken());
+    CPPUNIT_ASSERT_EQUAL(sent + 1, Reported("sent"));
+    CPPUNIT_ASSERT_EQUAL(handled + 1, Reported("handled"));
+}
+
+void
+TestIpcQueueWakeups::testCoalescing()
+{
+    const auto sent = Reported("sent");
+    const auto handled = Reported("handled");
+
+    // wakeups sent before the reader wakes up are handled together
+    Ipc::QueueWakeups::Subscribe(&HandleQueue);
+    for (int i = 0; i < 3; ++i)
+        CPPUNIT_ASSERT(Ipc::QueueWakeups::Notify(KidIdentifier));
+    Wakeup();
+    CPPUNIT_ASSERT_EQUAL(1, QueueHandled);
+    CPPUNIT_ASSERT(!Woken());
+    CPPUNIT_ASSERT_EQUAL(sent + 3, Reported("sent"));
+    CPPUNIT_ASSERT_EQUAL(handled + 1, Reported("handled"));
+}
+
+void
+TestIpcQueueWakeups::testOtherKids()
+{
+    const auto sent = Reported("sent");
+
+    // other kids have their own descriptors
+    CPPUNIT_ASSERT(Ipc::QueueWakeups::Notify(KidIdentifier + 1));
+    CPPUNIT_ASSERT(!Woken());
+
+    // unknown kids must be notified using UDS messages
+    CPPUNIT_ASSERT(!Ipc::QueueWakeups::Notify(0));
+    CPPUNIT_ASSERT(!Ipc::QueueWakeups::Notify(KidCount + 1));
+    CPPUNIT_ASSERT_EQUAL(sent, Reported("sent"));
+    CPPUNIT_ASSERT_EQUAL(0, QueueHandled);
+}
+
+/* test doubles for the process and Comm dependencies of Ipc::QueueWakeups */
+
+SBuf service_name(APP_SHORTNAME);
+bool IamMasterProcess() { return KidIdentifier == 0; }
+bool InDaemonMode() { return true; }
+bool UsingSmp() { return true; }
+int NumberOfKids() { return KidCount; }
+
+void
+Comm::SetSelect(const int fd, unsigned int, PF *handler, void *, time_t)
+{
+    WakeupFd = fd;
+    WakeupHandler = handler;
+}
+
+void fd_open(int, unsigned int, const char *) {}
+
+/// customizes our test setup
+class MyTestProgram: public TestProgram
+{
+public:
+    /* TestProgram API */
+    void startup() override;
+};
+
+void
+MyTestProgram::startup()
+{
+    Config.shmLocking.configure(false);
+
+    // use current directory for shared segments (on path-based OSes)
+    static char cwd[MAXPATHLEN];
+    Ipc::Mem::Segment::BasePath = getcwd(cwd, MAXPATHLEN);
+    if (!Ipc::Mem::Segment::BasePath)
+        Ipc::Mem::Segment::BasePath = ".";
+
+    CallRunnerRegistrator(QueueWakeupsRr);
+
+    // the master process creates the shared state and kid descriptors
+    KidIdentifier = 0;
+    RunRegisteredHere(RegisteredRunner::useConfig);
+
+    // a kid attaches to that state
+    KidIdentifier = 1;
+    RunRegisteredHere(RegisteredRunner::useConfig);
+}
+
+#endif /* HAVE_SYS_EVENTFD_H */
+
+int
+main(int argc, char *argv[])
+{
+#if HAVE_SYS_EVENTFD_H
+    return MyTestProgram().run(argc, argv);
+#else
+    return TestProgram().run(argc, argv);
+#endif
+}
+
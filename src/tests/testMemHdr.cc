@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#include "squid.h"
+#include "compat/cppunit.h"
+#include "mem_node.h"
+#include "stmem.h"
+#include "StoreIOBuffer.h"
+
+#include <algorithm>
+#include <string>
+
+class TestMemHdr : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(TestMemHdr);
+    CPPUNIT_TEST(testSequential);
+    CPPUNIT_TEST(testFreedPrefix);
+    CPPUNIT_TEST(testSparse);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    void testSequential();
+    void testFreedPrefix();
+    void testSparse();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestMemHdr );
+
+namespace {
+
+/// a string of the given size with bytes that depend on their offset
+std::string
+Content(const int64_t offset, const size_t size)
+{
+    std::string result(size, '\0');
+    for (size_t i = 0; i < size; ++i)
+        result[i] = static_cast<char>((offset + i) % 251);
+    return result;
+}
+
+/// writes Content() at the given offset
+void
+Write(mem_hdr &hdr, const int64_t offset, const size_t size)
+{
+    auto content = Content(offset, size);
+    CPPUNIT_ASSERT(hdr.write(StoreIOBuffer(size, offset, &content[0])));
+}
+
+/// checks that mem_hdr::copy() returns the expected bytes
+void
+CheckCopy(const mem_hdr &hdr, const int64_t offset, const size_t size, const size_t expectedSize)
+{
+    std::string buf(size, '\0');
+    const auto copied = hdr.copy(StoreIOBuffer(size, offset, &buf[0]));
+    CPPUNIT_ASSERT_EQUAL(static_cast<ssize_t>(expectedSize), copied);
+    CPPUNIT_ASSERT(buf.compare(0, expectedSize, Content(offset, expectedSize)) == 0);
+}
+
+} // namespace
+
+void
+TestMemHdr::testSequential()
+{
+    mem_hdr hdr;
+    const size_t objectSize = 10 * SM_PAGE_SIZE + 123;
+    // odd-sized writes, like those of a response relayed from a server
+    for (int64_t offset = 0; offset < static_cast<int64_t>(objectSize); offset += 1000)
+        Write(hdr, offset, std::min<size_t>(1000, objectSize - offset));
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<int64_t>(objectSize), hdr.endOffset());
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(11), hdr.size());
+
+    for (int64_t offset = 0; offset < hdr.endOffset(); offset += 777) {
+        const auto node = hdr.getBlockContainingLocation(offset);
+        CPPUNIT_ASSERT(node);
+        CPPUNIT_ASSERT(node->contains(offset));
+        CheckCopy(hdr, offset, 3000, std::min<size_t>(3000, objectSize - offset));
+    }
+    CPPUNIT_ASSERT(!hdr.getBlockContainingLocation(objectSize));
+    CPPUNIT_ASSERT(hdr.hasContigousContentRange(Range<int64_t>(0, objectSize)));
+    CPPUNIT_ASSERT(!hdr.hasContigousContentRange(Range<int64_t>(0, objectSize + 1)));
+}
+
+void
+TestMemHdr::testFreedPrefix()
+{
+    mem_hdr hdr;
+    const size_t objectSize = 8 * SM_PAGE_SIZE;
+    Write(hdr, 0, objectSize);
+
+    const auto lowest = hdr.freeDataUpto(3 * SM_PAGE_SIZE + 10);
+    CPPUNIT_ASSERT_EQUAL(static_cast<int64_t>(3 * SM_PAGE_SIZE), lowest);
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(5), hdr.size());
+    CPPUNIT_ASSERT(!hdr.getBlockContainingLocation(lowest - 1));
+    CheckCopy(hdr, lowest, 2 * SM_PAGE_SIZE, 2 * SM_PAGE_SIZE);
+    CheckCopy(hdr, objectSize - 100, 1000, 100);
+
+    // appending after freeing keeps lookups working
+    Write(hdr, objectSize, SM_PAGE_SIZE + 5);
+    CheckCopy(hdr, objectSize - 10, SM_PAGE_SIZE, SM_PAGE_SIZE);
+    CPPUNIT_ASSERT(hdr.getBlockContainingLocation(objectSize + SM_PAGE_SIZE + 4));
+
+    // the last node is never freed
+    hdr.freeDataUpto(hdr.endOffset());
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), hdr.size());
+}
+
+void
+TestMemHdr::testSparse()
+{
+    mem_hdr hdr;
+    Write(hdr, 0, 100);
+    Write(hdr, 3 * SM_PAGE_SIZE + 50, 2 * SM_PAGE_SIZE);
+    Write(hdr, SM_PAGE_SIZE, 10); // between existing nodes
+
+    CPPUNIT_ASSERT(hdr.getBlockContainingLocation(99));
+    CPPUNIT_ASSERT(!hdr.getBlockContainingLocation(100));
+    CPPUNIT_ASSERT(hdr.getBlockContainingLocation(SM_PAGE_SIZE + 9));
+    CPPUNIT_ASSERT(!hdr.getBlockContainingLocation(SM_PAGE_SIZE + 10));
+    CPPUNIT_ASSERT(hdr.getBlockContainingLocation(4 * SM_PAGE_SIZE));
+    CPPUNIT_ASSERT(!hdr.getBlockContainingLocation(5 * SM_PAGE_SIZE + 50));
+
+    // copying stops at the first gap
+    CheckCopy(hdr, 50, 1000, 50);
+    CheckCopy(hdr, SM_PAGE_SIZE, 1000, 10);
+    CheckCopy(hdr, 3 * SM_PAGE_SIZE + 60, 2 * SM_PAGE_SIZE, 2 * SM_PAGE_SIZE - 10);
+
+    CPPUNIT_ASSERT(hdr.hasContigousContentRange(Range<int64_t>(3 * SM_PAGE_SIZE + 50, 5 * SM_PAGE_SIZE + 50)));
+    CPPUNIT_ASSERT(!hdr.hasContigousContentRange(Range<int64_t>(0, 200)));
+
+    // filling a gap
+    Write(hdr, 100, 200);
+    CheckCopy(hdr, 0, 1000, 300);
+}
+
+// This test uses main() from ./testStore.cc.
+
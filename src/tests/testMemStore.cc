@@ -0,0 +1,353 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#include "squid.h"
+#include "base/RunnersRegistry.h"
+#include "compat/cppunit.h"
+#include "ipc/mem/Pages.h"
+#include "ipc/mem/Segment.h"
+#include "md5.h"
+#include "MemObject.h"
+#include "MemStore.h"
+#include "SquidConfig.h"
+#include "Store.h"
+#include "unitTestMain.h"
+
+#include <cstring>
+#include <vector>
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+class TestMemStore: public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(TestMemStore);
+    CPPUNIT_TEST(testReadInPlace);
+    CPPUNIT_TEST(testSequentialReadInPlace);
+    CPPUNIT_TEST(testPageClassSelection);
+    CPPUNIT_TEST(testPageClassFallback);
+    CPPUNIT_TEST(testPageClassRelease);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+protected:
+    void testReadInPlace();
+    void testSequentialReadInPlace();
+    void testPageClassSelection();
+    void testPageClassFallback();
+    void testPageClassRelease();
+
+private:
+    MemStore *store = nullptr;
+    MemStoreMap *map = nullptr;
+    Ipc::Mem::Pointer<MemStoreMapExtras> extras;
+    StoreEntry *entry = nullptr;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestMemStore );
+
+namespace
+{
+
+/// the sizes of the test entry slices
+const uint32_t SliceSizes[] = { 10, 20, 30 };
+const int64_t EntrySize = 60;
+
+/// the expected test entry byte at the given entry offset
+char
+ByteAt(const int64_t offset)
+{
+    return 'a' + (offset % 26);
+}
+
+/// reads the given entry area using the given position
+std::string
+Read(MemStore &store, const StoreEntry &e, const int64_t offset, const size_t length, Store::InPlaceReadPosition &position)
+{
+    std::string buf(length, '\0');
+    const auto copied = store.readInPlace(e, StoreIOBuffer(length, offset, &buf[0]), position);
+    CPPUNIT_ASSERT(copied >= 0);
+    buf.resize(copied);
+    return buf;
+}
+
+/// gets all free pages of the given cache page class
+std::vector<Ipc::Mem::PageId>
+TakeAllPages(const size_t pageClass)
+{
+    std::vector<Ipc::Mem::PageId> pages;
+    for (;;) {
+        Ipc::Mem::PageId page;
+        if (!Ipc::Mem::GetCachePage(pageClass, page))
+            break;
+        CPPUNIT_ASSERT_EQUAL(pageClass, Ipc::Mem::CachePageClass(page));
+        pages.push_back(page);
+    }
+    CPPUNIT_ASSERT_EQUAL(Ipc::Mem::CachePageLimit(pageClass), Ipc::Mem::CachePageLevel(pageClass));
+    return pages;
+}
+
+/// returns the given pages to their pools
+void
+PutAllPages(std::vector<Ipc::Mem::PageId> &pages)
+{
+    for (auto &page: pages)
+        Ipc::Mem::PutPage(page);
+    pages.clear();
+}
+
+/// the cache page class of a page that GetCachePageFor() gets for the given
+/// number of bytes or CachePageClasses() if no page was found
+size_t
+PageClassGotFor(const int64_t bytes)
+{
+    Ipc::Mem::PageId page;
+    if (!Ipc::Mem::GetCachePageFor(bytes, page))
+        return Ipc::Mem::CachePageClasses();
+    const auto pageClass = Ipc::Mem::CachePageClass(page);
+    Ipc::Mem::PutPage(page);
+    return pageClass;
+}
+
+/// the expected test entry bytes in the given area
+std::string
+Expected(const int64_t offset, const size_t length)
+{
+    std::string result;
+    for (auto i = offset; i < EntrySize && result.size() < length; ++i)
+        result += ByteAt(i);
+    return result;
+}
+
+} // namespace
+
+void
+TestMemStore::setUp()
+{
+    store = new MemStore;
+    store->init();
+    map = new MemStoreMap(SBuf("cache_mem_map"));
+    extras = shm_old(MemStoreMapExtras)("cache_mem_ex");
+
+    // write a complete three-slice entry directly into the shared map
+    const cache_key key[SQUID_MD5_DIGEST_LENGTH] = { 1, 2, 3 };
+    sfileno index = -1;
+    const auto anchor = map->openForWriting(key, index);
+    CPPUNIT_ASSERT(anchor);
+    memcpy(anchor->key, key, sizeof(anchor->key)); // setKey() needs Store::Root()
+    int64_t offset = 0;
+    Ipc::StoreMapSliceId previous = -1;
+    for (size_t sid = 0; sid < sizeof(SliceSizes)/sizeof(SliceSizes[0]); ++sid) {
+        auto &page = extras->items[sid].page;
+        CPPUNIT_ASSERT(Ipc::Mem::GetCachePage(0, page));
+        const auto data = Ipc::Mem::PagePointer(page);
+        for (uint32_t i = 0; i < SliceSizes[sid]; ++i)
+            data[i] = ByteAt(offset + i);
+        offset += SliceSizes[sid];
+
+        auto &slice = map->writeableSlice(index, sid);
+        slice.size = SliceSizes[sid];
+        slice.next = -1;
+        if (previous >= 0)
+            map->writeableSlice(index, previous).next = sid;
+        else
+            anchor->start = sid;
+        previous = sid;
+    }
+    anchor->basics.swap_file_sz = EntrySize;
+    map->closeForWriting(index);
+    CPPUNIT_ASSERT(map->openForReadingAt(index, key));
+
+    entry = new StoreEntry();
+    entry->createMemObject();
+    auto &memCache = entry->mem().memCache;
+    memCache.index = index;
+    memCache.io = Store::ioReading;
+    memCache.inPlace = true;
+}
+
+void
+TestMemStore::tearDown()
+{
+    const auto index = entry->mem().memCache.index;
+    store->disconnect(*entry); // closes our reading lock
+    map->freeEntry(index);
+    // our map has no cleaner to free slice pages
+    for (size_t sid = 0; sid < sizeof(SliceSizes)/sizeof(SliceSizes[0]); ++sid)
+        Ipc::Mem::PutPage(extras->items[sid].page);
+    entry->destroyMemObject();
+    delete entry;
+    entry = nullptr;
+    delete map;
+    map = nullptr;
+    delete store;
+    store = nullptr;
+}
+
+void
+TestMemStore::testReadInPlace()
+{
+    Store::InPlaceReadPosition position;
+    CPPUNIT_ASSERT_EQUAL(Expected(0, EntrySize), Read(*store, *entry, 0, EntrySize, position));
+    CPPUNIT_ASSERT_EQUAL(2, position.slice);
+    CPPUNIT_ASSERT_EQUAL(int64_t(30), position.sliceOffset);
+
+    // areas spanning slice boundaries
+    CPPUNIT_ASSERT_EQUAL(Expected(5, 30), Read(*store, *entry, 5, 30, position));
+    CPPUNIT_ASSERT_EQUAL(Expected(29, 2), Read(*store, *entry, 29, 2, position));
+
+    // areas before the remembered position are found from the chain start
+    CPPUNIT_ASSERT_EQUAL(2, position.slice);
+    CPPUNIT_ASSERT_EQUAL(Expected(0, 1), Read(*store, *entry, 0, 1, position));
+    CPPUNIT_ASSERT_EQUAL(0, position.slice);
+
+    // nothing to read past the entry end
+    CPPUNIT_ASSERT_EQUAL(std::string(), Read(*store, *entry, EntrySize, 10, position));
+    CPPUNIT_ASSERT_EQUAL(Expected(EntrySize - 1, 10), Read(*store, *entry, EntrySize - 1, 10, position));
+}
+
+void
+TestMemStore::testSequentialReadInPlace()
+{
+    Store::InPlaceReadPosition position;
+    std::string content;
+    for (int64_t offset = 0; offset < EntrySize;) {
+        const auto piece = Read(*store, *entry, offset, 7, position);
+        CPPUNIT_ASSERT(!piece.empty());
+        content += piece;
+        offset += piece.size();
+
+        // the next read starts at the slice where this one stopped
+        const auto lastByte = offset - 1;
+        const auto expectedSlice = lastByte < 10 ? 0 : (lastByte < 30 ? 1 : 2);
+        CPPUNIT_ASSERT_EQUAL(expectedSlice, position.slice);
+    }
+    CPPUNIT_ASSERT_EQUAL(Expected(0, EntrySize), content);
+}
+
+void
+TestMemStore::testPageClassSelection()
+{
+    using Ipc::Mem::CachePageClassFor;
+
+    // see MyTestProgram::startup() for page class configuration
+    CPPUNIT_ASSERT_EQUAL(size_t(3), Ipc::Mem::CachePageClasses());
+    CPPUNIT_ASSERT_EQUAL(size_t(1024), Ipc::Mem::CachePageSize(0));
+    CPPUNIT_ASSERT_EQUAL(size_t(4096), Ipc::Mem::CachePageSize(1));
+    CPPUNIT_ASSERT_EQUAL(Ipc::Mem::PageSize(), Ipc::Mem::CachePageSize(2));
+
+    // the smallest page that fits
+    CPPUNIT_ASSERT_EQUAL(size_t(0), CachePageClassFor(0));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), CachePageClassFor(100));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), CachePageClassFor(1024));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), CachePageClassFor(3072));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), CachePageClassFor(4096));
+
+    // the next smaller page if the fitting one would waste more than 1 KB
+    CPPUNIT_ASSERT_EQUAL(size_t(0), CachePageClassFor(1025));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), CachePageClassFor(3071));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), CachePageClassFor(4097));
+
+    // the largest page for large or unknown sizes
+    CPPUNIT_ASSERT_EQUAL(size_t(2), CachePageClassFor(1024*1024));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), CachePageClassFor(-1));
+
+    // free pages of the preferred class are used first
+    CPPUNIT_ASSERT_EQUAL(size_t(0), PageClassGotFor(100));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), PageClassGotFor(4000));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), PageClassGotFor(-1));
+}
+
+void
+TestMemStore::testPageClassFallback()
+{
+    // when the preferred class runs out, larger pages come first
+    auto smallPages = TakeAllPages(0);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), PageClassGotFor(100));
+    auto mediumPages = TakeAllPages(1);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), PageClassGotFor(100));
+
+    // then smaller ones
+    PutAllPages(smallPages);
+    auto largePages = TakeAllPages(2);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), PageClassGotFor(-1));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), PageClassGotFor(4000));
+
+    // no pages at all
+    smallPages = TakeAllPages(0);
+    CPPUNIT_ASSERT_EQUAL(Ipc::Mem::CachePageClasses(), PageClassGotFor(100));
+
+    PutAllPages(mediumPages);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), PageClassGotFor(-1));
+
+    PutAllPages(smallPages);
+    PutAllPages(largePages);
+}
+
+void
+TestMemStore::testPageClassRelease()
+{
+    std::vector<size_t> levels;
+    for (size_t pageClass = 0; pageClass < Ipc::Mem::CachePageClasses(); ++pageClass)
+        levels.push_back(Ipc::Mem::CachePageLevel(pageClass));
+
+    for (size_t pageClass = 0; pageClass < Ipc::Mem::CachePageClasses(); ++pageClass) {
+        Ipc::Mem::PageId page;
+        CPPUNIT_ASSERT(Ipc::Mem::GetCachePage(pageClass, page));
+        CPPUNIT_ASSERT_EQUAL(pageClass, Ipc::Mem::CachePageClass(page));
+        CPPUNIT_ASSERT_EQUAL(Ipc::Mem::CachePageSize(pageClass), Ipc::Mem::PageSize(page));
+        CPPUNIT_ASSERT_EQUAL(levels[pageClass] + 1, Ipc::Mem::CachePageLevel(pageClass));
+
+        // the page returns to its own pool, leaving other classes intact
+        Ipc::Mem::PutPage(page);
+        CPPUNIT_ASSERT(!page);
+        for (size_t i = 0; i < Ipc::Mem::CachePageClasses(); ++i)
+            CPPUNIT_ASSERT_EQUAL(levels[i], Ipc::Mem::CachePageLevel(i));
+    }
+}
+
+/// customizes our test setup
+class MyTestProgram: public TestProgram
+{
+public:
+    /* TestProgram API */
+    void startup() override;
+};
+
+void
+MyTestProgram::startup()
+{
+    Config.memShared.configure(true);
+    Config.memMaxSize = 1024*1024;
+    Config.Store.maxInMemObjSize = 64*1024;
+    Config.memPageClasses[1024] = 10;
+    Config.memPageClasses[4096] = 10;
+    Config.shmLocking.configure(false);
+
+    // use current directory for shared segments (on path-based OSes)
+    static char cwd[MAXPATHLEN];
+    Ipc::Mem::Segment::BasePath = getcwd(cwd, MAXPATHLEN);
+    if (!Ipc::Mem::Segment::BasePath)
+        Ipc::Mem::Segment::BasePath = ".";
+
+    CallRunnerRegistrator(SharedMemPagesRr);
+    CallRunnerRegistrator(MemStoreRr);
+    RunRegisteredHere(RegisteredRunner::finalizeConfig);
+    RunRegisteredHere(RegisteredRunner::claimMemoryNeeds);
+    RunRegisteredHere(RegisteredRunner::useConfig);
+}
+
+int
+main(int argc, char *argv[])
+{
+    return MyTestProgram().run(argc, argv);
+}
+
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#include "squid.h"
+#include "compat/cppunit.h"
+#include "http/one/MimeScanner.h"
+#include "unitTestMain.h"
+
+#include <initializer_list>
+#include <random>
+#include <string>
+
+using namespace Http::One;
+
+class TestMimeScanner : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(TestMimeScanner);
+    CPPUNIT_TEST(testScalar);
+    CPPUNIT_TEST(testKernelsAgree);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    void testScalar();
+    void testKernelsAgree();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestMimeScanner );
+
+/// asserts that two scans of the same input are identical
+static void
+assertSameScan(const MimeLineScan &expected, const MimeLineScan &actual, const std::string &input, const MimeScanKernel kernel)
+{
+    const auto context = std::string(MimeScanKernelName(kernel)) + " kernel scanning " + std::to_string(input.size()) + " octets";
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(context, expected.length, actual.length);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(context, expected.colon, actual.colon);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(context, expected.crs, actual.crs);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(context, expected.terminated, actual.terminated);
+}
+
+void
+TestMimeScanner::testScalar()
+{
+    {
+        const std::string line("Host: example.com\r\nAccept: */*\r\n");
+        const auto scan = ScanMimeLine(MimeScanKernel::scalar, line.data(), line.size());
+        CPPUNIT_ASSERT(scan.terminated);
+        CPPUNIT_ASSERT_EQUAL(size_t(18), scan.length);
+        CPPUNIT_ASSERT_EQUAL(size_t(4), scan.colon);
+        CPPUNIT_ASSERT_EQUAL(size_t(1), scan.crs);
+    }
+
+    {
+        // no LF
+        const std::string line("X-Tab:\tvalue");
+        const auto scan = ScanMimeLine(MimeScanKernel::scalar, line.data(), line.size());
+        CPPUNIT_ASSERT(!scan.terminated);
+        CPPUNIT_ASSERT_EQUAL(line.size(), scan.length);
+        CPPUNIT_ASSERT_EQUAL(size_t(5), scan.colon);
+    }
+
+    {
+        // NUL and bare CR before LF; octets after LF are ignored
+        const std::string line("Bad\0 name\r\r\n:\x7f", 14);
+        const auto scan = ScanMimeLine(MimeScanKernel::scalar, line.data(), line.size());
+        CPPUNIT_ASSERT(scan.terminated);
+        CPPUNIT_ASSERT_EQUAL(size_t(11), scan.length);
+        CPPUNIT_ASSERT_EQUAL(MimeLineScan::npos, scan.colon);
+        CPPUNIT_ASSERT_EQUAL(size_t(2), scan.crs);
+    }
+
+    {
+        const auto scan = ScanMimeLine(MimeScanKernel::scalar, "", 0);
+        CPPUNIT_ASSERT(!scan.terminated);
+        CPPUNIT_ASSERT_EQUAL(size_t(0), scan.length);
+    }
+}
+
+void
+TestMimeScanner::testKernelsAgree()
+{
+    // random lines dense in interesting octets and spanning several blocks
+    static const char interesting[] = "\r\n\t :\x01\x1f\x7f\x80\xff";
+    std::mt19937 rng(1);
+
+    for (int i = 0; i < 20000; ++i) {
+        std::string input;
+        const auto length = rng() % 100;
+        for (size_t pos = 0; pos < length; ++pos) {
+            if (rng() % 4 == 0)
+                input += interesting[rng() % (sizeof(interesting) - 1)];
+            else
+                input += static_cast<char>('a' + rng() % 26);
+        }
+
+        const auto expected = ScanMimeLine(MimeScanKernel::scalar, input.data(), input.size());
+        for (const auto kernel: {MimeScanKernel::sse2, MimeScanKernel::avx2}) {
+            if (MimeScanKernelSupported(kernel))
+                assertSameScan(expected, ScanMimeLine(kernel, input.data(), input.size()), input, kernel);
+        }
+    }
+}
+
+int
+main(int argc, char *argv[])
+{
+    return TestProgram().run(argc, argv);
+}
+
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#include "squid.h"
+#include "compat/cppunit.h"
+#include "CpuAffinityMap.h"
+#include "ipc/mem/Numa.h"
+#include "unitTestMain.h"
+
+#include <sstream>
+
+class TestNuma: public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(TestNuma);
+    CPPUNIT_TEST(testParseSysList);
+    CPPUNIT_TEST(testMalformedSysList);
+    CPPUNIT_TEST(testAffinityMapNodes);
+    CPPUNIT_TEST(testBadAffinityMapNodes);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    void testParseSysList();
+    void testMalformedSysList();
+    void testAffinityMapNodes();
+    void testBadAffinityMapNodes();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestNuma );
+
+/// parses the given sysfs list
+static std::vector<int>
+Parse(const char *list)
+{
+    std::istringstream in(list);
+    return Ipc::Mem::Numa::ParseSysList(in);
+}
+
+void
+TestNuma::testParseSysList()
+{
+    CPPUNIT_ASSERT(Parse("").empty());
+    CPPUNIT_ASSERT(Parse("\n").empty());
+    CPPUNIT_ASSERT(Parse("0\n") == std::vector<int>({0}));
+    CPPUNIT_ASSERT(Parse("0-3\n") == std::vector<int>({0, 1, 2, 3}));
+    CPPUNIT_ASSERT(Parse("0-1,8,10-11\n") == std::vector<int>({0, 1, 8, 10, 11}));
+    CPPUNIT_ASSERT(Parse("5-5") == std::vector<int>({5}));
+}
+
+void
+TestNuma::testMalformedSysList()
+{
+    // parsing stops at the first malformed item
+    CPPUNIT_ASSERT(Parse("2-1").empty());
+    CPPUNIT_ASSERT(Parse("0,x,3") == std::vector<int>({0}));
+    CPPUNIT_ASSERT(Parse("0-1,-3") == std::vector<int>({0, 1}));
+    CPPUNIT_ASSERT(Parse("0-1,2+3") == std::vector<int>({0, 1}));
+    CPPUNIT_ASSERT(Parse("node0").empty());
+}
+
+void
+TestNuma::testAffinityMapNodes()
+{
+    // cpu_affinity_map process_numbers=1,2,3 numa_nodes=1,2,2
+    CpuAffinityMap map;
+    CPPUNIT_ASSERT(map.add({1, 2, 3}, {}, {1, 2, 2}));
+    CPPUNIT_ASSERT_EQUAL(1, map.numaNode(1));
+    CPPUNIT_ASSERT_EQUAL(2, map.numaNode(2));
+    CPPUNIT_ASSERT_EQUAL(2, map.numaNode(3));
+    CPPUNIT_ASSERT_EQUAL(0, map.numaNode(4));
+
+    // cpu_affinity_map process_numbers=4 cores=5
+    CPPUNIT_ASSERT(map.add({4}, {5}, {}));
+    CPPUNIT_ASSERT_EQUAL(0, map.numaNode(4));
+
+    // cpu_affinity_map process_numbers=5 cores=1 numa_nodes=1
+    CPPUNIT_ASSERT(map.add({5}, {1}, {1}));
+    CPPUNIT_ASSERT_EQUAL(1, map.numaNode(5));
+    CPPUNIT_ASSERT(map.numaNodes() == std::vector<int>({1, 2, 2, 0, 1}));
+}
+
+void
+TestNuma::testBadAffinityMapNodes()
+{
+    CpuAffinityMap map;
+    // neither cores nor numa_nodes
+    CPPUNIT_ASSERT(!map.add({1}, {}, {}));
+    // list length mismatch
+    CPPUNIT_ASSERT(!map.add({1, 2}, {}, {1}));
+    CPPUNIT_ASSERT(!map.add({1}, {1}, {1, 2}));
+    // nodes are numbered from one
+    CPPUNIT_ASSERT(!map.add({1}, {}, {0}));
+    CPPUNIT_ASSERT(!map.add({1}, {}, {-1}));
+    CPPUNIT_ASSERT(map.processes().empty());
+}
+
+int
+main(int argc, char *argv[])
+{
+    return TestProgram().run(argc, argv);
+}
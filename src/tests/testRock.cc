@@ -11,7 +11,11 @@
 #include "ConfigParser.h"
 #include "DiskIO/DiskIOModule.h"
 #include "fde.h"
+#include "fs/rock/RockDbCell.h"
+#include "fs/rock/RockIndexSnapshot.h"
+#include "fs/rock/RockIoRequests.h"
 #include "fs/rock/RockSwapDir.h"
+#include "ipc/mem/Pages.h"
 #include "globals.h"
 #include "HttpHeader.h"
 #include "HttpReply.h"
@@ -26,7 +30,10 @@
 #include "testStoreSupport.h"
 #include "unitTestMain.h"
 
+#include <fstream>
+#include <iterator>
 #include <stdexcept>
+#include <vector>
 #if HAVE_SYS_STAT_H
 #include <sys/stat.h>
 #endif
@@ -45,6 +52,8 @@ class TestRock : public CPPUNIT_NS::TestFixture
     CPPUNIT_TEST_SUITE(TestRock);
     CPPUNIT_TEST(testRockCreate);
     CPPUNIT_TEST(testRockSwapOut);
+    CPPUNIT_TEST(testRockIndexSnapshot);
+    CPPUNIT_TEST(testRockWriteRuns);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -58,10 +67,12 @@ protected:
     void commonInit();
     void storeInit();
     StoreEntry *createEntry(const int i);
-    StoreEntry *addEntry(const int i);
+    StoreEntry *addEntry(const int i, const std::string &body = std::string());
     StoreEntry *getEntry(const int i);
     void testRockCreate();
     void testRockSwapOut();
+    void testRockIndexSnapshot();
+    void testRockWriteRuns();
 
 private:
     SwapDirPointer store;
@@ -69,6 +80,31 @@ private:
 };
 CPPUNIT_TEST_SUITE_REGISTRATION(TestRock);
 
+/// a disk write request made by Rock::IoState
+class RecordedWrite
+{
+public:
+    Rock::SlotId sidFirst; ///< the first slot written
+    Rock::SlotId slotCount; ///< the number of adjacent slots written
+    size_t len; ///< the number of bytes written
+};
+
+/// a Rock cache_dir that remembers its disk write requests
+class RecordingSwapDir: public Rock::SwapDir
+{
+public:
+    std::vector<RecordedWrite> writes;
+
+protected:
+    /* IORequestor API */
+    void writeCompleted(int errflag, size_t len, RefCount< ::WriteRequest> r) override {
+        const auto request = dynamic_cast<Rock::WriteRequest*>(r.getRaw());
+        CPPUNIT_ASSERT(request);
+        writes.push_back(RecordedWrite{request->sidCurrent, request->slotCount, request->len});
+        Rock::SwapDir::writeCompleted(errflag, len, r);
+    }
+};
+
 static void
 addSwapDir(TestRock::SwapDirPointer aStore)
 {
@@ -85,13 +121,15 @@ TestRock::setUp()
     if (0 > system ("rm -rf " TESTDIR))
         throw std::runtime_error("Failed to clean test work directory");
 
-    store = new Rock::SwapDir();
+    store = new RecordingSwapDir();
 
     addSwapDir(store);
 
     char *path=xstrdup(TESTDIR);
 
-    char *config_line=xstrdup("10 max-size=16384");
+    // small slots so that entries with bodies span several slots, but too
+    // few of them (512) for the rebuild to report its (stubbed) progress
+    char *config_line=xstrdup("2 max-size=131072 slot-size=4096");
 
     ConfigParser::SetCfgLine(config_line);
 
@@ -132,6 +170,9 @@ TestRock::tearDown()
 void
 TestRock::storeInit()
 {
+    // each test case indexes its own cache_dir (see store_dirs_rebuilding)
+    StoreController::store_dirs_rebuilding = 1;
+
     /* ok, ready to use */
     Store::Root().init();
 
@@ -176,12 +217,14 @@ TestRock::createEntry(const int i)
 }
 
 StoreEntry *
-TestRock::addEntry(const int i)
+TestRock::addEntry(const int i, const std::string &body)
 {
     StoreEntry *const pe = createEntry(i);
 
     pe->buffer();
     pe->mem().freshestReply().packHeadersUsingSlowPacker(*pe);
+    if (!body.empty())
+        pe->append(body.data(), body.size());
     pe->flush();
     pe->timestampsSet();
     pe->complete();
@@ -309,6 +352,166 @@ TestRock::testRockSwapOut()
     }
 }
 
+/// the index snapshot file of the test cache_dir
+static const char *SnapshotFile = TESTDIR "/rock.index";
+
+static std::string
+readSnapshot()
+{
+    std::ifstream in(SnapshotFile, std::ios::binary);
+    CPPUNIT_ASSERT(in);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static void
+writeSnapshot(const std::string &content)
+{
+    std::ofstream out(SnapshotFile, std::ios::binary | std::ios::trunc);
+    CPPUNIT_ASSERT(out.write(content.data(), content.size()));
+}
+
+void
+TestRock::testRockIndexSnapshot()
+{
+    storeInit();
+
+    // nothing was saved for this db yet
+    CPPUNIT_ASSERT(!Rock::IndexSnapshot(*store).valid());
+
+    for (int i = 0; i < 3; ++i) {
+        StoreEntry *const pe = addEntry(i);
+        StockEventLoop loop;
+        loop.run();
+        CPPUNIT_ASSERT_EQUAL(SWAPOUT_DONE, pe->swap_status);
+        pe->unlock("TestRock::testRockIndexSnapshot");
+    }
+
+    Rock::IndexSnapshot(*store).save();
+    CPPUNIT_ASSERT(Rock::IndexSnapshot(*store).valid());
+    const auto saved = readSnapshot();
+
+    // a newer snapshot invalidates older ones
+    Rock::IndexSnapshot(*store).save();
+    CPPUNIT_ASSERT(Rock::IndexSnapshot(*store).valid());
+    const auto current = readSnapshot();
+    CPPUNIT_ASSERT_EQUAL(saved.size(), current.size());
+    writeSnapshot(saved);
+    CPPUNIT_ASSERT(!Rock::IndexSnapshot(*store).valid());
+    writeSnapshot(current);
+    CPPUNIT_ASSERT(Rock::IndexSnapshot(*store).valid());
+
+    // damaged files are rejected
+    writeSnapshot(current.substr(0, current.size() - 1));
+    CPPUNIT_ASSERT(!Rock::IndexSnapshot(*store).valid());
+    writeSnapshot(current + '\0');
+    CPPUNIT_ASSERT(!Rock::IndexSnapshot(*store).valid());
+    auto badMagic = current;
+    badMagic[0] ^= 1;
+    writeSnapshot(badMagic);
+    CPPUNIT_ASSERT(!Rock::IndexSnapshot(*store).valid());
+    // the file ends with a slot record: a 32-bit slot ID and a 32-bit size
+    auto badSlot = current;
+    badSlot.replace(badSlot.size() - 8, 4, 4, '\xff'); // a negative slot ID
+    writeSnapshot(badSlot);
+    CPPUNIT_ASSERT(!Rock::IndexSnapshot(*store).valid());
+
+    // an invalidated snapshot stays invalid even if its file is restored
+    writeSnapshot(current);
+    Rock::IndexSnapshot(*store).invalidate();
+    CPPUNIT_ASSERT(!Rock::IndexSnapshot(*store).valid());
+    writeSnapshot(current);
+    CPPUNIT_ASSERT(!Rock::IndexSnapshot(*store).valid());
+
+    for (int i = 0; i < 3; ++i) {
+        StoreEntry *const pe = getEntry(i);
+        CPPUNIT_ASSERT(pe);
+        pe->release();
+    }
+}
+
+/// reads the db cell header and payload of the given slot
+static Rock::DbCellHeader
+readSlot(const Rock::SwapDir &dir, const Rock::SlotId sid, std::string &payload)
+{
+    std::ifstream db(TESTDIR "/rock", std::ios::binary);
+    CPPUNIT_ASSERT(db.seekg(dir.diskOffset(sid)));
+    Rock::DbCellHeader header;
+    CPPUNIT_ASSERT(db.read(reinterpret_cast<char*>(&header), sizeof(header)));
+    CPPUNIT_ASSERT(header.payloadSize <= dir.slotSize - sizeof(header));
+    std::string slotPayload(header.payloadSize, '\0');
+    CPPUNIT_ASSERT(db.read(&slotPayload[0], slotPayload.size()));
+    payload += slotPayload;
+    return header;
+}
+
+void
+TestRock::testRockWriteRuns()
+{
+    storeInit();
+
+    auto &recorder = dynamic_cast<RecordingSwapDir&>(*store);
+    const auto maxSlotsPerWrite = Ipc::Mem::PageSize() / store->slotSize;
+    CPPUNIT_ASSERT_EQUAL(maxSlotsPerWrite, store->maxSlotsPerWrite());
+    CPPUNIT_ASSERT(maxSlotsPerWrite > 1);
+
+    // an entry spanning more than two maximum runs, with a partial last slot
+    const auto payloadPerSlot = store->slotSize - sizeof(Rock::DbCellHeader);
+    std::string body(payloadPerSlot * (2 * maxSlotsPerWrite + 2) + payloadPerSlot / 3, '\0');
+    for (size_t i = 0; i < body.size(); ++i)
+        body[i] = 'a' + i % 26;
+
+    recorder.writes.clear();
+    StoreEntry *const pe = addEntry(0, body);
+    CPPUNIT_ASSERT_EQUAL(SWAPOUT_WRITING, pe->swap_status);
+    StockEventLoop loop;
+    loop.run();
+    CPPUNIT_ASSERT_EQUAL(SWAPOUT_DONE, pe->swap_status);
+
+    // a fresh db reserves ascending slots, so all but the last run are full
+    const auto &writes = recorder.writes;
+    CPPUNIT_ASSERT(writes.size() >= 3);
+    Rock::SlotId slots = 0;
+    for (size_t i = 0; i < writes.size(); ++i) {
+        const auto &write = writes[i];
+        CPPUNIT_ASSERT(write.slotCount > 0);
+        CPPUNIT_ASSERT(static_cast<size_t>(write.slotCount) <= maxSlotsPerWrite);
+        if (i + 1 < writes.size()) {
+            CPPUNIT_ASSERT_EQUAL(static_cast<Rock::SlotId>(maxSlotsPerWrite), write.slotCount);
+            CPPUNIT_ASSERT_EQUAL(write.slotCount * store->slotSize, static_cast<uint64_t>(write.len));
+            CPPUNIT_ASSERT_EQUAL(write.sidFirst + write.slotCount, writes[i + 1].sidFirst);
+        }
+        slots += write.slotCount;
+    }
+    const auto &last = writes.back();
+    CPPUNIT_ASSERT(last.slotCount > 1); // a multi-slot run ending with...
+    CPPUNIT_ASSERT(last.len % store->slotSize); // ... a partial slot
+    CPPUNIT_ASSERT(last.len > (last.slotCount - 1) * store->slotSize);
+
+    // the slots written by each run are chained and carry the whole entry
+    std::string payload;
+    Rock::SlotId sid = writes.front().sidFirst;
+    Rock::SlotId chained = 0;
+    Rock::DbCellHeader header;
+    do {
+        header = readSlot(*store, sid, payload);
+        CPPUNIT_ASSERT_EQUAL(writes.front().sidFirst, header.firstSlot);
+        ++chained;
+        if (header.nextSlot >= 0)
+            CPPUNIT_ASSERT_EQUAL(sid + 1, header.nextSlot);
+        sid = header.nextSlot;
+    } while (sid >= 0 && chained <= slots);
+    CPPUNIT_ASSERT_EQUAL(slots, chained);
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(payload.size()), header.entrySize);
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(payload.size()), static_cast<uint64_t>(pe->swap_file_sz));
+    CPPUNIT_ASSERT(payload.size() > body.size());
+    CPPUNIT_ASSERT(payload.compare(payload.size() - body.size(), body.size(), body) == 0);
+
+    pe->unlock("TestRock::testRockWriteRuns");
+    StoreEntry *const pe2 = getEntry(0);
+    CPPUNIT_ASSERT(pe2);
+    pe2->release();
+}
+
 /// customizes our test setup
 class MyTestProgram: public TestProgram
 {
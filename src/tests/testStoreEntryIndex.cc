@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 1996-2025 The Squid Software Foundation and contributors
+ *
+ * Squid software is distributed under GPLv2+ license and includes
+ * contributions from numerous individuals and organizations.
+ * Please see the COPYING and CONTRIBUTORS files for details.
+ */
+
+#include "squid.h"
+#include "compat/cppunit.h"
+#include "md5.h"
+#include "Store.h"
+#include "store/EntryIndex.h"
+
+#include <memory>
+#include <random>
+#include <set>
+#include <vector>
+
+class TestStoreEntryIndex : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(TestStoreEntryIndex);
+    CPPUNIT_TEST(testInsertFind);
+    CPPUNIT_TEST(testErase);
+    CPPUNIT_TEST(testSlots);
+    CPPUNIT_TEST(testSequentialKeys);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    void testInsertFind();
+    void testErase();
+    void testSlots();
+    void testSequentialKeys();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestStoreEntryIndex );
+
+namespace {
+
+/// StoreEntry objects with random keys or, if requested, keys built like
+/// storeKeyPrivate() does: a sequential counter followed by constant octets
+class Entries
+{
+public:
+    explicit Entries(const size_t count, const bool sequential = false) {
+        std::mt19937 rng(count);
+        keys.resize(count * SQUID_MD5_DIGEST_LENGTH);
+        for (auto &octet: keys)
+            octet = static_cast<cache_key>(rng());
+        if (sequential) {
+            for (size_t i = 0; i < count; ++i) {
+                const uint64_t counter = i + 1;
+                memcpy(&keys[i * SQUID_MD5_DIGEST_LENGTH], &counter, sizeof(counter));
+                memcpy(&keys[i * SQUID_MD5_DIGEST_LENGTH + sizeof(counter)], &keys[sizeof(counter)], SQUID_MD5_DIGEST_LENGTH - sizeof(counter));
+            }
+        }
+        for (size_t i = 0; i < count; ++i) {
+            entries.emplace_back(new StoreEntry());
+            entries.back()->key = &keys[i * SQUID_MD5_DIGEST_LENGTH];
+        }
+    }
+
+    ~Entries() {
+        for (auto &entry: entries)
+            entry->key = nullptr;
+    }
+
+    size_t size() const { return entries.size(); }
+    StoreEntry &operator [](const size_t i) { return *entries[i]; }
+    const cache_key *key(const size_t i) const { return &keys[i * SQUID_MD5_DIGEST_LENGTH]; }
+
+private:
+    std::vector<cache_key> keys;
+    std::vector< std::unique_ptr<StoreEntry> > entries;
+};
+
+} // namespace
+
+void
+TestStoreEntryIndex::testInsertFind()
+{
+    Entries entries(20000);
+    Store::EntryIndex index; // grows as needed
+
+    for (size_t i = 0; i < entries.size(); ++i) {
+        CPPUNIT_ASSERT(!index.find(entries.key(i)));
+        index.insert(entries[i]);
+    }
+    CPPUNIT_ASSERT_EQUAL(entries.size(), index.size());
+    CPPUNIT_ASSERT(index.capacity() >= entries.size());
+
+    for (size_t i = 0; i < entries.size(); ++i)
+        CPPUNIT_ASSERT_EQUAL(&entries[i], index.find(entries.key(i)));
+
+    // keys that differ from indexed ones in the last octet only
+    cache_key missing[SQUID_MD5_DIGEST_LENGTH];
+    for (size_t i = 0; i < 100; ++i) {
+        memcpy(missing, entries.key(i), sizeof(missing));
+        missing[SQUID_MD5_DIGEST_LENGTH - 1] ^= 0xFF;
+        CPPUNIT_ASSERT(!index.find(missing));
+    }
+}
+
+void
+TestStoreEntryIndex::testErase()
+{
+    Entries entries(5000);
+    Store::EntryIndex index(entries.size());
+    const auto capacity = index.capacity();
+
+    // repeatedly erase and re-insert, leaving deleted slots behind
+    for (int round = 0; round < 10; ++round) {
+        for (size_t i = 0; i < entries.size(); ++i)
+            index.insert(entries[i]);
+        for (size_t i = round % 2; i < entries.size(); i += 2)
+            index.erase(entries[i]);
+
+        for (size_t i = 0; i < entries.size(); ++i) {
+            const auto expected = (i % 2 == static_cast<size_t>(round % 2)) ? nullptr : &entries[i];
+            CPPUNIT_ASSERT_EQUAL(expected, index.find(entries.key(i)));
+        }
+
+        for (size_t i = 1 - round % 2; i < entries.size(); i += 2)
+            index.erase(entries[i]);
+        CPPUNIT_ASSERT_EQUAL(size_t(0), index.size());
+    }
+
+    // deleted slots were reclaimed without growing the table
+    CPPUNIT_ASSERT_EQUAL(capacity, index.capacity());
+}
+
+void
+TestStoreEntryIndex::testSlots()
+{
+    Entries entries(1000);
+    Store::EntryIndex index;
+    for (size_t i = 0; i < entries.size(); ++i)
+        index.insert(entries[i]);
+    for (size_t i = 0; i < entries.size(); i += 3)
+        index.erase(entries[i]);
+
+    std::set<StoreEntry *> seen;
+    for (size_t slot = 0; slot < index.capacity(); ++slot) {
+        if (const auto entry = index.at(slot))
+            CPPUNIT_ASSERT(seen.insert(entry).second);
+    }
+    CPPUNIT_ASSERT_EQUAL(index.size(), seen.size());
+
+    for (size_t i = 0; i < entries.size(); ++i)
+        CPPUNIT_ASSERT_EQUAL(i % 3 != 0, seen.count(&entries[i]) > 0);
+}
+
+void
+TestStoreEntryIndex::testSequentialKeys()
+{
+    Entries entries(4096, true);
+    Store::EntryIndex index(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i)
+        index.insert(entries[i]);
+    for (size_t i = 0; i < entries.size(); ++i)
+        CPPUNIT_ASSERT_EQUAL(&entries[i], index.find(entries.key(i)));
+
+    // Consecutive keys must not share their first probed group. Without bit
+    // mixing, every run of 128 counter values would start in the same group.
+    const auto groups = index.capacity() / Store::EntryIndex::GroupSize;
+    std::set<uint64_t> homeGroups;
+    for (size_t i = 0; i < 1024; ++i)
+        homeGroups.insert((Store::EntryIndex::Hash(entries.key(i)) >> 7) % groups);
+    CPPUNIT_ASSERT(homeGroups.size() > groups / 2);
+}
+
+// This test uses main() from ./testStore.cc.
+
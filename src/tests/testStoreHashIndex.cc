@@ -165,8 +165,9 @@ TestStoreHashIndex::testSearch()
     /* we should have access to a entry now, that matches the entry we had before */
     CPPUNIT_ASSERT_EQUAL(false, search->error());
     CPPUNIT_ASSERT_EQUAL(false, search->isDone());
-    /* note the hash order is random - the test happens to be in a nice order */
-    CPPUNIT_ASSERT_EQUAL(entry1, search->currentItem());
+    /* note the hash order is random */
+    const auto firstItem = search->currentItem();
+    CPPUNIT_ASSERT(firstItem == entry1 || firstItem == entry2);
     //CPPUNIT_ASSERT_EQUAL(false, search->next());
 
     /* trigger another callback */
@@ -177,7 +178,7 @@ TestStoreHashIndex::testSearch()
     /* we should have access to a entry now, that matches the entry we had before */
     CPPUNIT_ASSERT_EQUAL(false, search->error());
     CPPUNIT_ASSERT_EQUAL(false, search->isDone());
-    CPPUNIT_ASSERT_EQUAL(entry2, search->currentItem());
+    CPPUNIT_ASSERT_EQUAL(firstItem == entry1 ? entry2 : entry1, search->currentItem());
     //CPPUNIT_ASSERT_EQUAL(false, search->next());
 
     /* trigger another callback */
@@ -17,6 +17,7 @@
 #include "unitTestMain.h"
 
 #include <cppunit/TestAssert.h>
+#include <functional>
 #include <sstream>
 
 /*
@@ -29,12 +30,14 @@ class TestUri : public CPPUNIT_NS::TestFixture
     CPPUNIT_TEST(testConstructScheme);
     CPPUNIT_TEST(testDefaultConstructor);
     CPPUNIT_TEST(testEncoding);
+    CPPUNIT_TEST(testGeneration);
     CPPUNIT_TEST_SUITE_END();
 
 protected:
     void testConstructScheme();
     void testDefaultConstructor();
     void testEncoding();
+    void testGeneration();
 };
 CPPUNIT_TEST_SUITE_REGISTRATION(TestUri);
 
@@ -129,6 +132,40 @@ TestUri::testEncoding()
     };
 }
 
+void
+TestUri::testGeneration()
+{
+    AnyP::Uri url(AnyP::PROTO_HTTP);
+    const AnyP::Uri other(AnyP::PROTO_HTTP);
+    CPPUNIT_ASSERT(url.generation() != other.generation());
+
+    // copies share the generation of the copied URI
+    auto copy = url;
+    CPPUNIT_ASSERT_EQUAL(url.generation(), copy.generation());
+
+    // changes result in new generations
+    const auto changes = {
+        std::function<void()>([&url]() { url.host("example.com"); }),
+        std::function<void()>([&url]() { url.port(8080); }),
+        std::function<void()>([&url]() { url.path(SBuf("/index.html")); }),
+        std::function<void()>([&url]() { url.setScheme(AnyP::PROTO_HTTPS, nullptr); }),
+        std::function<void()>([&url]() { url.userInfo(SBuf("user")); }),
+        std::function<void()>([&url]() { url.clear(); }),
+    };
+    for (const auto &change: changes) {
+        const auto before = url.generation();
+        change();
+        CPPUNIT_ASSERT(url.generation() != before);
+        CPPUNIT_ASSERT(url.generation() != copy.generation());
+        CPPUNIT_ASSERT(url.generation() != other.generation());
+    }
+
+    // a copied URI does not change with its copy
+    const auto copyGeneration = copy.generation();
+    url.host("example.net");
+    CPPUNIT_ASSERT_EQUAL(copyGeneration, copy.generation());
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -10,6 +10,7 @@
 #include "compat/cppunit.h"
 #include "DiskIO/DiskIOModule.h"
 #include "fde.h"
+#include "fs/ufs/RebuildReader.h"
 #include "fs/ufs/UFSSwapDir.h"
 #include "globals.h"
 #include "HttpHeader.h"
@@ -22,7 +23,15 @@
 #include "testStoreSupport.h"
 #include "unitTestMain.h"
 
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <random>
 #include <stdexcept>
+#include <thread>
+#include <vector>
 
 #define TESTDIR "TestUfs_Store"
 
@@ -35,6 +44,12 @@ class TestUfs : public CPPUNIT_NS::TestFixture
     CPPUNIT_TEST_SUITE(TestUfs);
     CPPUNIT_TEST(testUfsSearch);
     CPPUNIT_TEST(testUfsDefaultEngine);
+    CPPUNIT_TEST(testCompactIndex);
+#if USE_UFS_REBUILD_THREADS
+    CPPUNIT_TEST(testRebuildQueueBounds);
+    CPPUNIT_TEST(testRebuildQueueStop);
+    CPPUNIT_TEST(testCacheDirWalker);
+#endif
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -42,6 +57,12 @@ protected:
     void commonInit();
     void testUfsSearch();
     void testUfsDefaultEngine();
+    void testCompactIndex();
+#if USE_UFS_REBUILD_THREADS
+    void testRebuildQueueBounds();
+    void testRebuildQueueStop();
+    void testCacheDirWalker();
+#endif
 };
 CPPUNIT_TEST_SUITE_REGISTRATION(TestUfs);
 
@@ -255,6 +276,191 @@ TestUfs::testUfsDefaultEngine()
         throw std::runtime_error("Failed to clean test work directory");
 }
 
+void
+TestUfs::testCompactIndex()
+{
+    const size_t count = 5000;
+    std::vector<cache_key> keys(count * SQUID_MD5_DIGEST_LENGTH);
+    std::mt19937 rng(count);
+    for (auto &octet: keys)
+        octet = static_cast<cache_key>(rng());
+    const auto key = [&keys](const size_t i) { return &keys[i * SQUID_MD5_DIGEST_LENGTH]; };
+
+    Fs::Ufs::CompactIndex index; // grows as needed
+    for (size_t i = 0; i < count; ++i) {
+        CPPUNIT_ASSERT(!index.find(key(i)));
+        // -1 and -2 are special time values that must survive packing
+        index.add(Fs::Ufs::CompactIndex::Record(key(i), i, 1000 + i, -2, 1700000000, 1700000000 + i, -1, 1, 0));
+    }
+    CPPUNIT_ASSERT_EQUAL(count, index.size());
+
+    for (size_t i = 0; i < count; ++i) {
+        const auto record = index.find(key(i));
+        CPPUNIT_ASSERT(record);
+        CPPUNIT_ASSERT_EQUAL(static_cast<sfileno>(i), record->swap_filen);
+        CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(1000 + i), record->swap_file_sz);
+        CPPUNIT_ASSERT_EQUAL(static_cast<time_t>(1700000000 + i), record->lastref());
+    }
+
+    // remove every other record by key and the first record in each slot
+    // run by position; others must remain reachable after backward shifts
+    for (size_t i = 0; i < count; i += 2) {
+        Fs::Ufs::CompactIndex::Record removed;
+        CPPUNIT_ASSERT(index.remove(key(i), &removed));
+        CPPUNIT_ASSERT_EQUAL(static_cast<sfileno>(i), removed.swap_filen);
+        CPPUNIT_ASSERT(!index.remove(key(i)));
+    }
+    for (size_t slot = 0; slot < index.capacity(); ++slot) {
+        if (index.at(slot) && !index.at((slot + index.capacity() - 1) % index.capacity()))
+            index.removeAt(slot);
+    }
+
+    size_t remaining = 0;
+    for (size_t slot = 0; slot < index.capacity(); ++slot) {
+        if (const auto record = index.at(slot)) {
+            CPPUNIT_ASSERT_EQUAL(record, index.find(record->key));
+            CPPUNIT_ASSERT(record->swap_filen % 2);
+            ++remaining;
+        }
+    }
+    CPPUNIT_ASSERT_EQUAL(index.size(), remaining);
+    CPPUNIT_ASSERT(remaining < count / 2);
+}
+
+#if USE_UFS_REBUILD_THREADS
+
+namespace {
+
+/// a RebuildQueue fed by a helper thread that pushes one-item batches
+class TestRebuildQueue: public Fs::Ufs::RebuildQueue<Fs::Ufs::CacheFile>
+{
+public:
+    static constexpr size_t Limit = MaxBatches;
+
+    /// starts pushing the given number of batches; sets quit if the helper
+    /// thread was told to stop before it pushed them all
+    TestRebuildQueue(const size_t batches, std::atomic<bool> &quit) {
+        start([this, batches, &quit] {
+            std::vector<Fs::Ufs::CacheFile> batch;
+            for (size_t i = 0; i < batches; ++i) {
+                batch.emplace_back();
+                batch.back().filen = i;
+                if (!push(batch)) {
+                    quit = true;
+                    return finished();
+                }
+                ++pushed;
+            }
+            finished();
+        });
+    }
+    ~TestRebuildQueue() override { stop(); }
+
+    std::atomic<size_t> pushed{0}; ///< the number of queued batches
+};
+
+} // namespace
+
+/// waits up to a few seconds for the helper thread to queue the given
+/// number of batches
+static bool
+WaitForPushes(const TestRebuildQueue &queue, const size_t batches)
+{
+    for (int i = 0; i < 500 && queue.pushed < batches; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    return queue.pushed == batches;
+}
+
+void
+TestUfs::testRebuildQueueBounds()
+{
+    const auto limit = TestRebuildQueue::Limit;
+    std::atomic<bool> quit(false);
+    TestRebuildQueue queue(limit + 10, quit);
+
+    // the helper thread waits for queue space after filling the queue
+    CPPUNIT_ASSERT(WaitForPushes(queue, limit));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CPPUNIT_ASSERT_EQUAL(limit, queue.pushed.load());
+    CPPUNIT_ASSERT(queue.ready());
+
+    // and resumes when the main thread takes batches, delivering all items
+    Fs::Ufs::CacheFile file;
+    size_t received = 0;
+    while (queue.next(file)) {
+        CPPUNIT_ASSERT_EQUAL(static_cast<sfileno>(received), file.filen);
+        ++received;
+    }
+    CPPUNIT_ASSERT_EQUAL(limit + 10, received);
+    CPPUNIT_ASSERT(queue.ready()); // no more items
+    CPPUNIT_ASSERT(!quit);
+}
+
+void
+TestUfs::testRebuildQueueStop()
+{
+    std::atomic<bool> quit(false);
+    {
+        TestRebuildQueue queue(TestRebuildQueue::Limit + 1, quit);
+        CPPUNIT_ASSERT(WaitForPushes(queue, TestRebuildQueue::Limit));
+        // the destructor must wake up and join the waiting helper thread
+    }
+    CPPUNIT_ASSERT(quit);
+}
+
+void
+TestUfs::testCacheDirWalker()
+{
+    if (0 > system ("rm -rf " TESTDIR))
+        throw std::runtime_error("Failed to clean test work directory");
+
+    Fs::Ufs::CacheFile file;
+
+    // every subdirectory of a missing cache_dir is reported as a failure
+    {
+        Fs::Ufs::CacheDirWalker walker(TESTDIR, 2, 3);
+        size_t failures = 0;
+        while (walker.next(file)) {
+            CPPUNIT_ASSERT_EQUAL(static_cast<sfileno>(-1), file.filen);
+            CPPUNIT_ASSERT_EQUAL(std::string("opendir"), std::string(file.failedCall));
+            CPPUNIT_ASSERT_EQUAL(ENOENT, file.xerrno);
+            ++failures;
+        }
+        CPPUNIT_ASSERT_EQUAL(size_t(6), failures);
+    }
+
+    // a readable cache file, an unreadable one, and a foreign file name
+    if (0 > system("mkdir -p " TESTDIR "/00/00/00000001 " TESTDIR "/00/00/zz"))
+        throw std::runtime_error("Failed to create test cache_dir");
+    const auto fp = fopen(TESTDIR "/00/00/00000000", "w");
+    CPPUNIT_ASSERT(fp);
+    CPPUNIT_ASSERT(fputs("hello", fp) >= 0);
+    fclose(fp);
+
+    std::map<sfileno, Fs::Ufs::CacheFile> files;
+    {
+        Fs::Ufs::CacheDirWalker walker(TESTDIR, 1, 1);
+        while (walker.next(file))
+            files[file.filen] = file;
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(2), files.size());
+
+    const auto &good = files[0];
+    CPPUNIT_ASSERT(!good.failedCall);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(5), good.size);
+    CPPUNIT_ASSERT_EQUAL(std::string("hello"), good.prefix);
+
+    const auto &bad = files[1];
+    CPPUNIT_ASSERT_EQUAL(std::string("read"), std::string(bad.failedCall));
+    CPPUNIT_ASSERT_EQUAL(EISDIR, bad.xerrno);
+    CPPUNIT_ASSERT_EQUAL(std::string(TESTDIR "/00/00/00000001"), bad.path);
+
+    if (0 > system ("rm -rf " TESTDIR))
+        throw std::runtime_error("Failed to clean test work directory");
+}
+
+#endif /* USE_UFS_REBUILD_THREADS */
+
 int
 main(int argc, char *argv[])
 {
@@ -23,6 +23,7 @@
 #include "comm/Connection.h"
 #include "comm/ConnOpener.h"
 #include "comm/Read.h"
+#include "comm/SplicePipe.h"
 #include "comm/Write.h"
 #include "errorpage.h"
 #include "fd.h"
@@ -52,11 +53,15 @@
 #include "tools.h"
 #include "tunnel.h"
 #if USE_DELAY_POOLS
+#include "BandwidthBucket.h"
 #include "DelayId.h"
 #endif
 
 #include <climits>
 #include <cerrno>
+#if HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
 
 /**
  * TunnelStateData is the state engine performing the tasks for
@@ -171,6 +176,18 @@ public:
         TunnelStateData *readPending;
         EVH *readPendingFunc;
 
+#if HAVE_SPLICE
+        /// whether bytes read from this connection go through splicePipe
+        bool splicing() const { return splicePipe.isOpen(); }
+
+        /// creates the splice(2) pipe; \returns whether that succeeded
+        bool openSplicePipe();
+
+        /// kernel pipe holding the unwritten part of len bytes read from
+        /// this connection
+        Comm::SplicePipe splicePipe;
+#endif
+
 #if USE_DELAY_POOLS
 
         DelayId delayId;
@@ -282,6 +299,24 @@ public:
     void copyClientBytes();
     void copyServerBytes();
 
+#if HAVE_SPLICE
+    static void SpliceReadyClient(const Comm::ConnectionPointer &, char *buf, size_t len, Comm::Flag errcode, int xerrno, void *data);
+    static void SpliceReadyServer(const Comm::ConnectionPointer &, char *buf, size_t len, Comm::Flag errcode, int xerrno, void *data);
+    static void SpliceWriteReadyClient(const Comm::ConnectionPointer &, char *buf, size_t len, Comm::Flag errcode, int xerrno, void *data);
+    static void SpliceWriteReadyServer(const Comm::ConnectionPointer &, char *buf, size_t len, Comm::Flag errcode, int xerrno, void *data);
+
+    /// whether the from-to byte stream may bypass our buffers from now on
+    bool mayStartSplicing(const Connection &from, const Connection &to) const;
+    /// splices available from.conn bytes into from.splicePipe
+    void spliceRead(Connection &from, Comm::Flag errcode, int xerrno);
+    /// splices buffered from.splicePipe bytes into to.conn
+    void spliceWrite(Connection &from, Connection &to);
+    /// resumes spliceWrite() after Comm::WriteWhenReady() (or a write error)
+    void spliceWriteReady(Connection &from, Connection &to, Comm::Flag errcode, int xerrno);
+    /// reports the end of the spliceWrite() sequence to to.writer
+    void finishSpliceWrite(Connection &from, Connection &to, Comm::Flag flag, int xerrno);
+#endif
+
     /// handles client-to-Squid connection closure; may destroy us
     void clientClosed();
 
@@ -446,6 +481,14 @@ TunnelStateData::Connection::~Connection()
     if (readPending)
         eventDelete(readPendingFunc, readPending);
 
+#if HAVE_SPLICE
+    // splicePipe closes these descriptors after we are done
+    if (splicing()) {
+        fd_close(splicePipe.readFd());
+        fd_close(splicePipe.writeFd());
+    }
+#endif
+
     safe_free(buf);
 }
 
@@ -698,6 +741,16 @@ TunnelStateData::copy(size_t len, Connection &from, Connection &to, IOCB *comple
     debugs(26, 3, "Schedule Write");
     AsyncCall::Pointer call = commCbCall(5,5, "TunnelBlindCopyWriteHandler",
                                          CommIoCbPtrFun(completion, this));
+#if HAVE_SPLICE
+    if (from.splicing()) {
+        assert(static_cast<size_t>(from.len) == len);
+        to.writer = call;
+        to.dirty = true;
+        fd_table[to.conn->fd].writeStart = squid_curtime;
+        spliceWrite(from, to);
+        return;
+    }
+#endif
     to.write(from.buf, len, call, nullptr);
 }
 
@@ -911,6 +964,18 @@ void
 TunnelStateData::copyRead(Connection &from, IOCB *completion)
 {
     assert(from.len == 0);
+
+#if HAVE_SPLICE
+    const auto &to = (&from == &client) ? server : client;
+    if (from.splicing() || (mayStartSplicing(from, to) && from.openSplicePipe())) {
+        const auto splicer = (&from == &client) ? &SpliceReadyClient : &SpliceReadyServer;
+        AsyncCall::Pointer call = commCbCall(5,4, "TunnelSpliceReadHandler",
+                                             CommIoCbPtrFun(splicer, this));
+        Comm::Read(from.conn, call);
+        return;
+    }
+#endif
+
     // If only the minimum permitted read size is going to be attempted
     // then we schedule an event to try again in a few I/O cycles.
     // Allow at least 1 byte to be read every (0.3*10) seconds.
@@ -929,6 +994,179 @@ TunnelStateData::copyRead(Connection &from, IOCB *completion)
     comm_read(from.conn, from.buf, bw, call);
 }
 
+#if HAVE_SPLICE
+bool
+TunnelStateData::mayStartSplicing(const Connection &from, const Connection &to) const
+{
+    if (!Config.onoff.tunnel_splice)
+        return false;
+
+    if (!Comm::IsConnOpen(from.conn) || !Comm::IsConnOpen(to.conn))
+        return false;
+
+    // leave the reserve for new connections; the regular relay needs no FDs
+    if (fdNFree() < RESERVED_FD + 2) {
+        debugs(26, 3, "not splicing " << from.conn << "; too few free FDs: " << fdNFree());
+        return false;
+    }
+
+    // TLS and other I/O methods need to see the bytes
+    const auto &fromFd = fd_table[from.conn->fd];
+    const auto &toFd = fd_table[to.conn->fd];
+    if (!fromFd.readsDirectly() || fromFd.flags.read_pending || !toFd.writesDirectly())
+        return false;
+
+#if USE_DELAY_POOLS
+    // delay pools and client write quotas meter individual reads and writes
+    if (from.delayId || to.delayId || BandwidthBucket::SelectBucket(&fd_table[to.conn->fd]))
+        return false;
+#endif
+
+    return true;
+}
+
+bool
+TunnelStateData::Connection::openSplicePipe()
+{
+    if (!splicePipe.open()) {
+        debugs(26, 2, "cannot splice " << conn);
+        return false;
+    }
+
+    fd_open(splicePipe.readFd(), FD_PIPE, "tunnel splice pipe read end");
+    fd_open(splicePipe.writeFd(), FD_PIPE, "tunnel splice pipe write end");
+    debugs(26, 3, "splicing " << conn << " through FDs " << splicePipe.readFd() << " and " << splicePipe.writeFd());
+    return true;
+}
+
+/// TunnelStateData::spliceRead() wrapper for client-to-Squid bytes
+void
+TunnelStateData::SpliceReadyClient(const Comm::ConnectionPointer &, char *, size_t, Comm::Flag errcode, int xerrno, void *data)
+{
+    const auto tunnelState = static_cast<TunnelStateData *>(data);
+    assert(cbdataReferenceValid(tunnelState));
+    tunnelState->spliceRead(tunnelState->client, errcode, xerrno);
+}
+
+/// TunnelStateData::spliceRead() wrapper for server-to-Squid bytes
+void
+TunnelStateData::SpliceReadyServer(const Comm::ConnectionPointer &, char *, size_t, Comm::Flag errcode, int xerrno, void *data)
+{
+    const auto tunnelState = static_cast<TunnelStateData *>(data);
+    assert(cbdataReferenceValid(tunnelState));
+    tunnelState->spliceRead(tunnelState->server, errcode, xerrno);
+}
+
+void
+TunnelStateData::spliceRead(Connection &from, Comm::Flag errcode, int xerrno)
+{
+    const auto fromClient = (&from == &client);
+    ssize_t len = 0;
+
+    if (errcode == Comm::OK) {
+        const auto fd = from.conn->fd;
+        // the pipe is empty (see copyRead()), so we can fill its default capacity
+        len = from.splicePipe.fill(fd, 64*1024);
+        xerrno = errno;
+        ++statCounter.syscalls.sock.reads;
+        fd_bytes(fd, len, IoDirection::Read);
+        debugs(26, 5, from.conn << " spliced " << len << " bytes in");
+
+        if (len < 0) {
+            if (ignoreErrno(xerrno)) {
+                AsyncCall::Pointer call = commCbCall(5,4, "TunnelSpliceReadHandler",
+                                                     CommIoCbPtrFun(fromClient ? &SpliceReadyClient : &SpliceReadyServer, this));
+                Comm::Read(from.conn, call);
+                return;
+            }
+            errcode = Comm::COMM_ERROR;
+            len = 0;
+        }
+    }
+
+    // the read callbacks do the rest, including byte accounting for logging
+    if (fromClient)
+        readClient(nullptr, len, errcode, xerrno);
+    else
+        readServer(nullptr, len, errcode, xerrno);
+}
+
+/// TunnelStateData::spliceWriteReady() wrapper for Squid-to-client bytes
+void
+TunnelStateData::SpliceWriteReadyClient(const Comm::ConnectionPointer &, char *, size_t, Comm::Flag errcode, int xerrno, void *data)
+{
+    const auto tunnelState = static_cast<TunnelStateData *>(data);
+    assert(cbdataReferenceValid(tunnelState));
+    tunnelState->spliceWriteReady(tunnelState->server, tunnelState->client, errcode, xerrno);
+}
+
+/// TunnelStateData::spliceWriteReady() wrapper for Squid-to-server bytes
+void
+TunnelStateData::SpliceWriteReadyServer(const Comm::ConnectionPointer &, char *, size_t, Comm::Flag errcode, int xerrno, void *data)
+{
+    const auto tunnelState = static_cast<TunnelStateData *>(data);
+    assert(cbdataReferenceValid(tunnelState));
+    tunnelState->spliceWriteReady(tunnelState->client, tunnelState->server, errcode, xerrno);
+}
+
+void
+TunnelStateData::spliceWriteReady(Connection &from, Connection &to, const Comm::Flag errcode, const int xerrno)
+{
+    if (errcode == Comm::ERR_CLOSING)
+        return; // to.conn closure handler will clear to.writer
+
+    if (errcode != Comm::OK) // e.g., write_timeout
+        return finishSpliceWrite(from, to, errcode, xerrno);
+
+    spliceWrite(from, to);
+}
+
+void
+TunnelStateData::spliceWrite(Connection &from, Connection &to)
+{
+    assert(to.writer);
+    const auto fd = to.conn->fd;
+    const auto len = from.splicePipe.drain(fd);
+    const auto xerrno = errno;
+    ++statCounter.syscalls.sock.writes;
+    fd_bytes(fd, len, IoDirection::Write);
+    if (len > 0)
+        fd_table[fd].writeStart = squid_curtime; // like Comm::HandleWrite()
+    debugs(26, 5, to.conn << " spliced " << len << " bytes out");
+
+    if (len < 0 && !ignoreErrno(xerrno))
+        return finishSpliceWrite(from, to, Comm::COMM_ERROR, xerrno);
+
+    if (len == 0) // the pipe was not supposed to be empty
+        return finishSpliceWrite(from, to, Comm::COMM_ERROR, 0);
+
+    if (from.splicePipe.size()) {
+        // wait using Comm write state to get write_timeout and closure handling
+        const auto handler = (&to == &client) ? &SpliceWriteReadyClient : &SpliceWriteReadyServer;
+        AsyncCall::Pointer call = commCbCall(5,5, "TunnelSpliceWriteHandler",
+                                             CommIoCbPtrFun(handler, this));
+        Comm::WriteWhenReady(to.conn, call);
+        return;
+    }
+
+    finishSpliceWrite(from, to, Comm::OK, 0);
+}
+
+void
+TunnelStateData::finishSpliceWrite(Connection &from, Connection &to, Comm::Flag flag, int xerrno)
+{
+    // to.writer stays set until the callback is called (see WriteServerDone())
+    AsyncCall::Pointer call = to.writer;
+    auto &params = GetCommParams<CommIoCbParams>(call);
+    params.conn = to.conn;
+    params.fd = to.conn->fd;
+    params.size = from.len - from.splicePipe.size();
+    params.flag = flag;
+    params.xerrno = xerrno;
+    ScheduleCallHere(call);
+}
+#endif /* HAVE_SPLICE */
+
 void
 TunnelStateData::copyClientBytes()
 {